@@ -65,6 +65,7 @@ $SCRIPTPATH/include/roaring/bitset_util.h
 $SCRIPTPATH/include/roaring/containers/array.h
 $SCRIPTPATH/include/roaring/containers/bitset.h
 $SCRIPTPATH/include/roaring/containers/run.h
+$SCRIPTPATH/include/roaring/containers/packed.h
 $SCRIPTPATH/include/roaring/containers/convert.h
 $SCRIPTPATH/include/roaring/containers/mixed_equal.h
 $SCRIPTPATH/include/roaring/containers/mixed_subset.h
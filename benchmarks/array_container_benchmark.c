@@ -72,6 +72,18 @@ int intersection_test(array_container_t* B1, array_container_t* B2,
     array_container_intersection(B1, B2, BO);
     return BO->cardinality;
 }
+
+int xor_test(array_container_t* B1, array_container_t* B2,
+             array_container_t* BO) {
+    array_container_xor(B1, B2, BO);
+    return BO->cardinality;
+}
+
+int andnot_test(array_container_t* B1, array_container_t* B2,
+                array_container_t* BO) {
+    array_container_andnot(B1, B2, BO);
+    return BO->cardinality;
+}
 int main() {
     int repeat = 500;
     int size = TESTSIZE;
@@ -126,6 +138,9 @@ int main() {
         "(both arrays)\n");
     printf(
         "intersection times are expressed in cycles per number of output "
+        "elements\n");
+    printf(
+        "xor and andnot times are expressed in cycles per number of input "
         "elements\n\n");
     printf("==intersection and union test 1 \n");
     printf("input 1 cardinality = %d, input 2 cardinality = %d \n",
@@ -137,6 +152,12 @@ int main() {
     answer = intersection_test(B1, B2, BO);
     printf("intersection cardinality = %d \n", answer);
     BEST_TIME(intersection_test(B1, B2, BO), answer, repeat, answer);
+    answer = xor_test(B1, B2, BO);
+    printf("xor cardinality = %d \n", answer);
+    BEST_TIME(xor_test(B1, B2, BO), answer, repeat, inputsize);
+    answer = andnot_test(B1, B2, BO);
+    printf("andnot cardinality = %d \n", answer);
+    BEST_TIME(andnot_test(B1, B2, BO), answer, repeat, inputsize);
     printf("==intersection and union test 2 \n");
     B1->cardinality = 0;
     B2->cardinality = 0;
@@ -155,6 +176,12 @@ int main() {
     answer = intersection_test(B1, B2, BO);
     printf("intersection cardinality = %d \n", answer);
     BEST_TIME(intersection_test(B1, B2, BO), answer, repeat, answer);
+    answer = xor_test(B1, B2, BO);
+    printf("xor cardinality = %d \n", answer);
+    BEST_TIME(xor_test(B1, B2, BO), answer, repeat, inputsize);
+    answer = andnot_test(B1, B2, BO);
+    printf("andnot cardinality = %d \n", answer);
+    BEST_TIME(andnot_test(B1, B2, BO), answer, repeat, inputsize);
 
     array_container_free(B1);
     array_container_free(B2);
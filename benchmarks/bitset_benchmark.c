@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <roaring/bitset/bitset.h>
+#include <roaring/misc/configreport.h>
+#include <roaring/portability.h>
+
+#include "benchmark.h"
+#include "random.h"
+
+const int repeat = 50;
+
+/* Plain word loops, as a baseline for the dispatched implementations. */
+size_t scalar_count(const bitset_t *b) {
+    size_t card = 0;
+    for (size_t k = 0; k < b->arraysize; k++) {
+        card += roaring_hamming(b->array[k]);
+    }
+    return card;
+}
+
+size_t scalar_intersection_count(const bitset_t *b1, const bitset_t *b2) {
+    size_t card = 0;
+    size_t n = b1->arraysize < b2->arraysize ? b1->arraysize : b2->arraysize;
+    for (size_t k = 0; k < n; k++) {
+        card += roaring_hamming(b1->array[k] & b2->array[k]);
+    }
+    return card;
+}
+
+int scalar_inplace_union(bitset_t *b1, const bitset_t *b2) {
+    size_t n = b1->arraysize < b2->arraysize ? b1->arraysize : b2->arraysize;
+    for (size_t k = 0; k < n; k++) {
+        b1->array[k] |= b2->array[k];
+    }
+    return 0;
+}
+
+int inplace_union(bitset_t *b1, const bitset_t *b2) {
+    return bitset_inplace_union(b1, b2) ? 0 : -1;
+}
+
+int inplace_intersection(bitset_t *b1, const bitset_t *b2) {
+    bitset_inplace_intersection(b1, b2);
+    return 0;
+}
+
+bitset_t *random_bitset(size_t bits, uint32_t one_in) {
+    bitset_t *b = bitset_create_with_capacity(bits);
+    for (size_t i = 0; i < bits; i++) {
+        if (ranged_random(one_in) == 0) bitset_set(b, i);
+    }
+    return b;
+}
+
+/* BEST_TIME may measure the CPU time of the calling thread only, so the
+ * parallel functions are timed on the wall clock. */
+double wall_seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+#define BEST_WALL_TIME(test, answer, repeat, bytes)                          \
+    do {                                                                     \
+        double best = 1e30;                                                  \
+        int wrong_answer = 0;                                                \
+        for (int i = 0; i < repeat; i++) {                                   \
+            double start = wall_seconds();                                   \
+            if ((test) != (answer)) wrong_answer = 1;                        \
+            double elapsed = wall_seconds() - start;                         \
+            if (elapsed < best) best = elapsed;                              \
+        }                                                                    \
+        printf("%s: %.2f GB/s%s\n", #test, (double)(bytes) / best * 1e-9,    \
+               wrong_answer ? " [ERROR]" : "");                              \
+    } while (0)
+
+int inplace_union_parallel(bitset_t *b1, const bitset_t *b2, size_t threads) {
+    return bitset_inplace_union_parallel(b1, b2, threads) ? 0 : -1;
+}
+
+void benchmark_parallel(size_t bits) {
+    printf("\nparallel operations on %zu bits, GB of bitset per second:\n",
+           bits);
+    bitset_t *b1 = random_bitset(bits, 3);
+    bitset_t *b2 = random_bitset(bits, 5);
+    size_t bytes = bitset_size_in_bytes(b1);
+    size_t card = bitset_count(b1);
+    uint32_t *out = malloc(card * sizeof(uint32_t));
+    bitset_t *u = bitset_copy(b1);
+    for (size_t threads = 1; threads <= 8; threads *= 2) {
+        printf("%zu threads\n", threads);
+        BEST_WALL_TIME(bitset_count_parallel(b1, threads), card, repeat,
+                       bytes);
+        BEST_WALL_TIME(inplace_union_parallel(u, b2, threads), 0, repeat,
+                       bytes);
+        BEST_WALL_TIME(bitset_extract_setbits_parallel(b1, out, threads), card,
+                       repeat / 10, bytes);
+    }
+    free(out);
+    bitset_free(u);
+    bitset_free(b1);
+    bitset_free(b2);
+}
+
+void benchmark_size(size_t bits) {
+    printf("\nbitsets of %zu bits (%zu words), cycles per word:\n", bits,
+           (bits + 63) / 64);
+    bitset_t *b1 = random_bitset(bits, 3);
+    bitset_t *b2 = random_bitset(bits, 5);
+    bitset_t *out = bitset_copy(b1);
+    size_t words = b1->arraysize;
+
+    size_t card = bitset_count(b1);
+    BEST_TIME(scalar_count(b1), card, repeat, words);
+    BEST_TIME(bitset_count(b1), card, repeat, words);
+
+    size_t inter = bitset_intersection_count(b1, b2);
+    BEST_TIME(scalar_intersection_count(b1, b2), inter, repeat, words);
+    BEST_TIME(bitset_intersection_count(b1, b2), inter, repeat, words);
+    size_t uni = bitset_union_count(b1, b2);
+    BEST_TIME(bitset_union_count(b1, b2), uni, repeat, words);
+    size_t diff = bitset_difference_count(b1, b2);
+    BEST_TIME(bitset_difference_count(b1, b2), diff, repeat, words);
+    size_t sym = bitset_symmetric_difference_count(b1, b2);
+    BEST_TIME(bitset_symmetric_difference_count(b1, b2), sym, repeat, words);
+
+    // unions and intersections are idempotent, so repeating them on the same
+    // output is fine
+    BEST_TIME(scalar_inplace_union(out, b2), 0, repeat, words);
+    BEST_TIME(inplace_union(out, b2), 0, repeat, words);
+    BEST_TIME(inplace_intersection(out, b2), 0, repeat, words);
+
+    bitset_free(out);
+    bitset_free(b1);
+    bitset_free(b2);
+}
+
+int main() {
+    tellmeall();
+    printf("bitset_t benchmarks\n");
+    // the sizes used by cbitset_unit, then cache-resident and memory-bound
+    // filters
+    benchmark_size(3000);
+    benchmark_size(100003);
+    benchmark_size(1 << 20);
+    benchmark_size(1 << 28);
+    // only scales when built with ROARING_USE_THREADS
+    benchmark_parallel(1 << 28);
+    return 0;
+}
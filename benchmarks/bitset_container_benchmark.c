@@ -1,5 +1,7 @@
 #include <roaring/containers/bitset.h>
 #include <roaring/containers/convert.h>
+#include <roaring/containers/mixed_andnot.h>
+#include <roaring/containers/mixed_intersection.h>
 #include <roaring/misc/configreport.h>
 #include <roaring/portability.h>
 
@@ -119,6 +121,81 @@ void benchmark_logical_operations() {
     printf("\n");
 }
 
+int array_intersection_test(const array_container_t* A,
+                            const bitset_container_t* B,
+                            array_container_t* AO) {
+    array_bitset_container_intersection(A, B, AO);
+    return AO->cardinality;
+}
+
+int array_andnot_test(const array_container_t* A, const bitset_container_t* B,
+                      array_container_t* AO) {
+    array_bitset_container_andnot(A, B, AO);
+    return AO->cardinality;
+}
+
+int run_intersection_test(const run_container_t* R,
+                          const bitset_container_t* B) {
+    // the runs hold fewer than 4096 values, so the result is an array
+    container_t* out = NULL;
+    run_bitset_container_intersection(R, B, &out);
+    int card = ((array_container_t*)out)->cardinality;
+    array_container_free((array_container_t*)out);
+    return card;
+}
+
+int run_andnot_test(const run_container_t* R, const bitset_container_t* B) {
+    container_t* out = NULL;
+    run_bitset_container_andnot(R, B, &out);
+    int card = ((array_container_t*)out)->cardinality;
+    array_container_free((array_container_t*)out);
+    return card;
+}
+
+void benchmark_mixed_operations() {
+    printf("\nArray and run operations against a bitset (time units per "
+           "value):\n");
+    bitset_container_t* B = bitset_container_create();
+    for (int x = 0; x < 1 << 16; x += 3) {
+        bitset_container_set(B, (uint16_t)x);
+    }
+    for (int stride = 16; stride <= 256; stride *= 4) {
+        array_container_t* A = array_container_create();
+        for (int x = 0; x < 1 << 16; x += stride) {
+            array_container_add(A, (uint16_t)x);
+        }
+        array_container_t* AO = array_container_create();
+        printf("array of %d values\n", A->cardinality);
+        int inter = array_bitset_container_intersection_cardinality(A, B);
+        BEST_TIME(array_intersection_test(A, B, AO), inter, repeat,
+                  A->cardinality);
+        BEST_TIME(array_bitset_container_intersection_cardinality(A, B), inter,
+                  repeat, A->cardinality);
+        BEST_TIME(array_andnot_test(A, B, AO), A->cardinality - inter, repeat,
+                  A->cardinality);
+        array_container_free(AO);
+        array_container_free(A);
+    }
+    for (int length = 4; length <= 256; length *= 8) {
+        // 4000 values or so
+        run_container_t* R = run_container_create();
+        const int step = (1 << 16) / (4000 / (length + 1));
+        for (int x = 0; x + length < 1 << 16; x += step) {
+            for (int y = x; y <= x + length; y++) {
+                run_container_add(R, (uint16_t)y);
+            }
+        }
+        int card = run_container_cardinality(R);
+        printf("runs of %d values, %d values\n", length + 1, card);
+        int inter = run_bitset_container_intersection_cardinality(R, B);
+        BEST_TIME(run_intersection_test(R, B), inter, repeat, card);
+        BEST_TIME(run_andnot_test(R, B), card - inter, repeat, card);
+        run_container_free(R);
+    }
+    bitset_container_free(B);
+    printf("\n");
+}
+
 int main() {
     int size = (1 << 16) / 3;
     tellmeall();
@@ -160,6 +237,7 @@ int main() {
     printf("\n");
 
     benchmark_logical_operations();
+    benchmark_mixed_operations();
 
     // next we are going to benchmark conversion from bitset to array (an
     // important step)
@@ -25,6 +25,16 @@ void contains_multi_bulk(roaring_bitmap_t* bm, const uint32_t* values,
     }
 }
 
+void contains_multi_many(roaring_bitmap_t* bm, const uint32_t* values,
+                         bool* results, const size_t count) {
+    uint64_t* bits = (uint64_t*)malloc(((count + 63) / 64) * sizeof(uint64_t));
+    roaring_bitmap_contains_many(bm, values, count, bits);
+    for (size_t i = 0; i < count; ++i) {
+        results[i] = (bits[i / 64] >> (i % 64)) & 1;
+    }
+    free(bits);
+}
+
 int compare_uint32(const void* a, const void* b) {
     uint32_t arg1 = *(const uint32_t*)a;
     uint32_t arg2 = *(const uint32_t*)b;
@@ -94,6 +104,16 @@ int main(int argc, char* argv[]) {
     }
     printf("\n");
 
+    printf("                     roaring_bitmap_contains_many:");
+    for (int p = 0; p < num_passes; p++) {
+        bool result[count[p]];
+        RDTSC_START(cycles_start);
+        contains_multi_many(bm, values[p], result, count[p]);
+        RDTSC_FINAL(cycles_final);
+        printf(" %10f", (cycles_final - cycles_start) * 1.0 / count[p]);
+    }
+    printf("\n");
+
     // sort input array
     for (size_t i = 0; i < fields; ++i) {
         qsort(values[i], count[i], sizeof(uint32_t), compare_uint32);
@@ -119,6 +139,16 @@ int main(int argc, char* argv[]) {
     }
     printf("\n");
 
+    printf("   roaring_bitmap_contains_many with sorted input:");
+    for (int p = 0; p < num_passes; p++) {
+        bool result[count[p]];
+        RDTSC_START(cycles_start);
+        contains_multi_many(bm, values[p], result, count[p]);
+        RDTSC_FINAL(cycles_final);
+        printf(" %10f", (cycles_final - cycles_start) * 1.0 / count[p]);
+    }
+    printf("\n");
+
     roaring_bitmap_free(bm);
     for (size_t i = 0; i < fields; ++i) {
         free(values[i]);
@@ -1,3 +1,4 @@
+#include <roaring/containers/mixed_intersection.h>
 #include <roaring/containers/run.h>
 #include <roaring/misc/configreport.h>
 #include <roaring/portability.h>
@@ -74,6 +75,57 @@ static inline int intersection_test(run_container_t* B1, run_container_t* B2,
     return run_container_cardinality(BO);
 }
 
+static inline int xor_test(run_container_t* B1, run_container_t* B2,
+                           run_container_t* BO) {
+    run_container_xor(B1, B2, BO);
+    return run_container_cardinality(BO);
+}
+
+static inline int andnot_test(run_container_t* B1, run_container_t* B2,
+                              run_container_t* BO) {
+    run_container_andnot(B1, B2, BO);
+    return run_container_cardinality(BO);
+}
+
+static inline int array_intersection_test(array_container_t* A,
+                                          run_container_t* B,
+                                          array_container_t* AO) {
+    array_run_container_intersection(A, B, AO);
+    return AO->cardinality;
+}
+
+// times the run-run operations, in cycles per input run, and the
+// intersection of an array with B2, in cycles per input value
+static void run_operations_test(run_container_t* B1, run_container_t* B2,
+                                int repeat) {
+    run_container_t* BO = run_container_create();
+    printf("input 1 runs = %d, input 2 runs = %d \n", B1->n_runs,
+           B2->n_runs);
+    const int32_t inputsize = B1->n_runs + B2->n_runs;
+    int answer = union_test(B1, B2, BO);
+    BEST_TIME(union_test(B1, B2, BO), answer, repeat, inputsize);
+    answer = intersection_test(B1, B2, BO);
+    BEST_TIME(intersection_test(B1, B2, BO), answer, repeat, inputsize);
+    answer = xor_test(B1, B2, BO);
+    BEST_TIME(xor_test(B1, B2, BO), answer, repeat, inputsize);
+    answer = andnot_test(B1, B2, BO);
+    BEST_TIME(andnot_test(B1, B2, BO), answer, repeat, inputsize);
+    answer = andnot_test(B2, B1, BO);
+    BEST_TIME(andnot_test(B2, B1, BO), answer, repeat, inputsize);
+    run_container_free(BO);
+
+    array_container_t* A = array_container_create();
+    for (int x = 0; x < (1 << 16); x += 61) {
+        array_container_add(A, (uint16_t)x);
+    }
+    array_container_t* AO = array_container_create();
+    answer = array_intersection_test(A, B2, AO);
+    BEST_TIME(array_intersection_test(A, B2, AO), answer, repeat,
+              A->cardinality);
+    array_container_free(A);
+    array_container_free(AO);
+}
+
 int main() {
     int repeat = 500;
     int size = TESTSIZE;
@@ -142,9 +194,13 @@ int main() {
     answer = intersection_test(B1, B2, BO);
     printf("intersection cardinality = %d \n", answer);
     BEST_TIME(intersection_test(B1, B2, BO), answer, repeat, answer);
+    printf("==set operations on interleaved runs \n");
+    run_operations_test(B1, B2, repeat);
     printf("==intersection and union test 2 \n");
     B1->n_runs = 0;
+    B1->cardinality = 0;
     B2->n_runs = 0;
+    B2->cardinality = 0;
     for (int x = 0; x < (1 << 16); x += 64) {
         int length = x % 11;
         for (int y = 0; y < length; ++y)
@@ -166,6 +222,18 @@ int main() {
     printf("intersection cardinality = %d \n", answer);
     BEST_TIME(intersection_test(B1, B2, BO), answer, repeat, answer);
 
+    printf("==set operations on few long runs against many short runs \n");
+    // B2 holds 16 long runs, B1 about a thousand short ones
+    B2->n_runs = 0;
+    B2->cardinality = 0;
+    for (int x = 0; x < (1 << 16); x += 4096) {
+        for (int y = 100; y < 1000; ++y) {
+            run_container_add(B2, (uint16_t)(x + y));
+        }
+    }
+    run_operations_test(B1, B2, repeat);
+    run_operations_test(B2, B1, repeat);
+
     run_container_free(B1);
     run_container_free(B2);
     run_container_free(BO);
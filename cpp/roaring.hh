@@ -40,6 +40,7 @@ A C++ header for Roaring Bitmaps.
 namespace roaring {
 
 class RoaringSetBitForwardIterator;
+class RoaringContainerRange;
 
 /**
  * A bit of context usable with `*Bulk()` functions.
@@ -212,6 +213,16 @@ class Roaring {
                                                  x);
     }
 
+    /**
+     * Check the n_args values of vals for membership, setting bit i of
+     * out_bits (which holds at least (n_args + 63) / 64 words) when vals[i]
+     * is present. Fastest when vals is sorted or nearly sorted.
+     */
+    void containsMany(size_t n_args, const uint32_t *vals,
+                      uint64_t *out_bits) const noexcept {
+        api::roaring_bitmap_contains_many(&roaring, vals, n_args, out_bits);
+    }
+
     /**
      * Remove value x
      */
@@ -486,6 +497,19 @@ class Roaring {
         api::roaring_iterate(&roaring, iterator, ptr);
     }
 
+    /**
+     * (For advanced users.)
+     *
+     * Returns a read-only range over the containers of the bitmap. It yields
+     * `api::roaring_container_view_t` values pointing at the native container
+     * payloads, without copying them:
+     *
+     *     for (const auto &view : r.containers()) { ... }
+     *
+     * Any modification of the bitmap invalidates the range.
+     */
+    RoaringContainerRange containers() const noexcept;
+
     /**
      * Selects the value at index rnk in the bitmap, where the smallest value
      * is at index 0.
@@ -985,6 +1009,78 @@ class RoaringSetBitForwardIterator final {
               // analyzers.
 };
 
+/**
+ * Read-only range over the containers of a bitmap, see Roaring::containers().
+ */
+class RoaringContainerRange final {
+   public:
+    class const_iterator final {
+       public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef const api::roaring_container_view_t *pointer;
+        typedef const api::roaring_container_view_t &reference_type;
+        typedef api::roaring_container_view_t value_type;
+        typedef int32_t difference_type;
+
+        const_iterator(const api::roaring_bitmap_t *r, uint32_t index)
+            : r_(r), index_(index) {
+            load();
+        }
+
+        reference_type operator*() const { return view_; }
+
+        pointer operator->() const { return &view_; }
+
+        const_iterator &operator++() {  // ++i, must returned inc. value
+            index_++;
+            load();
+            return *this;
+        }
+
+        const_iterator operator++(int) {  // i++, must return orig. value
+            const_iterator orig(*this);
+            ++*this;
+            return orig;
+        }
+
+        bool operator==(const const_iterator &o) const {
+            return r_ == o.r_ && index_ == o.index_;
+        }
+
+        bool operator!=(const const_iterator &o) const {
+            return r_ != o.r_ || index_ != o.index_;
+        }
+
+       private:
+        // Leaves the view untouched past the last container.
+        void load() { api::roaring_bitmap_container_view(r_, index_, &view_); }
+
+        const api::roaring_bitmap_t *r_;
+        uint32_t index_;
+        api::roaring_container_view_t view_{};
+    };
+
+    explicit RoaringContainerRange(const api::roaring_bitmap_t *r) : r_(r) {}
+
+    const_iterator begin() const { return const_iterator(r_, 0); }
+
+    const_iterator end() const {
+        return const_iterator(r_, api::roaring_bitmap_container_count(r_));
+    }
+
+    /**
+     * Returns the number of containers.
+     */
+    size_t size() const { return api::roaring_bitmap_container_count(r_); }
+
+   private:
+    const api::roaring_bitmap_t *r_;
+};
+
+inline RoaringContainerRange Roaring::containers() const noexcept {
+    return RoaringContainerRange(&roaring);
+}
+
 inline RoaringSetBitForwardIterator Roaring::begin() const {
     return RoaringSetBitForwardIterator(*this);
 }
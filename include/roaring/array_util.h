@@ -140,6 +140,28 @@ int32_t intersect_vector16(const uint16_t *__restrict__ A, size_t s_a,
 int32_t intersect_vector16_inplace(uint16_t *__restrict__ A, size_t s_a,
                                    const uint16_t *__restrict__ B, size_t s_b);
 
+/**
+ * Matches the sorted sets A[*i_a, s_a) and B[*i_b, s_b) and writes the
+ * positions of up to `capacity` common values to pos_a and pos_b (in
+ * increasing order). The cursors *i_a and *i_b are advanced so that a
+ * subsequent call resumes where this one stopped. Returns the number of
+ * matches written; it is zero only when one of the sets is exhausted,
+ * provided that capacity is at least 8. Positions must fit in 16 bits.
+ * match_vector16 uses SSE4.2 string comparisons over blocks of 8 values.
+ */
+int32_t match_vector16(const uint16_t *__restrict__ A, size_t s_a,
+                       size_t *i_a, const uint16_t *__restrict__ B, size_t s_b,
+                       size_t *i_b, uint16_t *pos_a, uint16_t *pos_b,
+                       size_t capacity);
+
+/**
+ * Whether key is in the sorted array. A branchless binary search narrows the
+ * array down to one vector register, which is then compared in one go.
+ * Requires AVX2 and length >= 16; AVX-512 is used when available.
+ */
+bool array_contains_vector16(const uint16_t *array, int32_t length,
+                             uint16_t key);
+
 /**
  * Take an array container and write it out to a 32-bit array, using base
  * as the offset.
@@ -181,6 +203,12 @@ bool intersect_skewed_uint16_nonempty(const uint16_t *smallarray, size_t size_s,
  */
 int32_t intersect_uint16(const uint16_t *A, const size_t lenA,
                          const uint16_t *B, const size_t lenB, uint16_t *out);
+/**
+ * Scalar version of match_vector16.
+ */
+int32_t match_uint16(const uint16_t *A, size_t s_a, size_t *i_a,
+                     const uint16_t *B, size_t s_b, size_t *i_b,
+                     uint16_t *pos_a, uint16_t *pos_b, size_t capacity);
 /**
  * Compute the size of the intersection (generic).
  */
@@ -248,6 +276,23 @@ int32_t difference_vector16(const uint16_t *__restrict__ A, size_t s_a,
                             const uint16_t *__restrict__ B, size_t s_b,
                             uint16_t *C);
 
+#if CROARING_COMPILER_SUPPORTS_AVX512
+/**
+ * AVX-512 versions of union_vector16 and xor_vector16, which merge blocks of
+ * 32 values with a bitonic network. They fall back on the SSE functions
+ * when either input has fewer than 32 values; otherwise, they do not write
+ * past the end of the result.
+ */
+uint32_t avx512_union_vector16(const uint16_t *__restrict__ array1,
+                               uint32_t length1,
+                               const uint16_t *__restrict__ array2,
+                               uint32_t length2, uint16_t *__restrict__ output);
+uint32_t avx512_xor_vector16(const uint16_t *__restrict__ array1,
+                             uint32_t length1,
+                             const uint16_t *__restrict__ array2,
+                             uint32_t length2, uint16_t *__restrict__ output);
+#endif
+
 /**
  * Generic union function, returns just the cardinality.
  */
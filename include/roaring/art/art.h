@@ -36,10 +36,58 @@ typedef uint8_t art_key_chunk_t;
 typedef struct art_node_s art_node_t;
 
 /**
- * Wrapper to allow an empty tree.
+ * Allocator of objects of a single size, carved out of larger blocks whose
+ * size doubles up to a limit. Freed objects are kept for reuse until the
+ * allocator is released, so that the objects are packed together without any
+ * per-object overhead. A zeroed allocator is empty. Users should treat this as
+ * an opaque type.
+ */
+typedef struct art_slab_s {
+    void *free_list;  // Freed objects, linked through their first bytes.
+    char *next;       // Next object never handed out in the current block.
+    char *end;        // End of the current block.
+    void *blocks;     // Allocated blocks, from the most recent one.
+} art_slab_t;
+
+/**
+ * Returns an object of `size` bytes, which must be the same for all the
+ * objects of the allocator.
+ */
+void *art_slab_alloc(art_slab_t *slab, size_t size);
+
+/**
+ * Makes the object available to `art_slab_alloc` again.
+ */
+void art_slab_free(art_slab_t *slab, void *object);
+
+/**
+ * Frees all the blocks of the allocator, and all its objects with them, and
+ * leaves it empty.
+ */
+void art_slab_release(art_slab_t *slab);
+
+typedef void (*art_slab_visitor_t)(void *object, void *context);
+
+/**
+ * Calls `visitor` on all the objects of `size` bytes handed out by the
+ * allocator, in the order of their addresses within each block. This includes
+ * the objects freed since, which the caller has to tell apart.
+ */
+void art_slab_iterate(const art_slab_t *slab, size_t size,
+                      art_slab_visitor_t visitor, void *context);
+
+/**
+ * Returns the number of bytes allocated for the blocks of the allocator.
+ */
+size_t art_slab_size_in_bytes(const art_slab_t *slab);
+
+/**
+ * Wrapper to allow an empty tree. The inner nodes are allocated from one slab
+ * allocator per node type, so a zero-initialized ART is empty.
  */
 typedef struct art_s {
     art_node_t *root;
+    art_slab_t node_slabs[4];
 } art_t;
 
 /**
@@ -67,6 +115,51 @@ int art_compare_keys(const art_key_chunk_t key1[],
  */
 void art_insert(art_t *art, const art_key_chunk_t *key, art_val_t *val);
 
+/**
+ * Builds the ART from `count` values, which must have distinct keys and be
+ * sorted by key. Unlike `art_insert`, the key of each value must already be
+ * set. The ART must be empty.
+ *
+ * Inner nodes are created bottom-up with their final type and prefix, so no
+ * node is ever grown or split.
+ */
+void art_bulk_load(art_t *art, art_val_t **vals, size_t count);
+
+/**
+ * Builds an ART from values appended in increasing key order. The builder keeps
+ * the path from the root to the last value appended, so that appending costs
+ * amortized constant time, where `art_insert` walks down from the root. Users
+ * should treat this as an opaque type.
+ */
+typedef struct art_builder_s {
+    art_t *art;
+    art_node_t *root;
+    art_key_chunk_t last_key[ART_KEY_BYTES];
+    // Inner nodes on the path to the last value, from the root, along with the
+    // depth of the key chunk that each of them indexes its children with.
+    uint8_t spine_size;
+    art_node_t *spine[ART_KEY_BYTES];
+    uint8_t spine_chunk_depth[ART_KEY_BYTES];
+} art_builder_t;
+
+/**
+ * Initializes an empty builder for the given ART, which must be empty. The
+ * nodes are allocated from the allocators of the ART.
+ */
+void art_builder_init(art_builder_t *builder, art_t *art);
+
+/**
+ * Appends the value with the given key, which must be greater than the key of
+ * the previously appended value.
+ */
+void art_builder_append(art_builder_t *builder, const art_key_chunk_t *key,
+                        art_val_t *val);
+
+/**
+ * Moves the tree built into the ART of the builder.
+ */
+void art_builder_finish(art_builder_t *builder);
+
 /**
  * Returns the value erased, NULL if not found.
  */
@@ -84,16 +177,44 @@ bool art_is_empty(const art_t *art);
 
 /**
  * Frees the nodes of the ART except the values, which the user is expected to
- * free.
+ * free, and leaves it empty.
  */
 void art_free(art_t *art);
 
 /**
  * Returns the size in bytes of the ART. Includes size of pointers to values,
- * but not the values themselves.
+ * but not the values themselves. This counts the nodes in use, see
+ * `art_allocated_size_in_bytes` for the memory held by the ART.
  */
 size_t art_size_in_bytes(const art_t *art);
 
+/**
+ * Returns the number of bytes allocated for the ART, including the freed nodes
+ * kept for reuse by its allocators, but not the values.
+ */
+size_t art_allocated_size_in_bytes(const art_t *art);
+
+/**
+ * Statistics about the nodes of an ART, see `art_statistics`.
+ */
+typedef struct art_statistics_s {
+    // Number of inner nodes of each type.
+    uint64_t n_node4;
+    uint64_t n_node16;
+    uint64_t n_node48;
+    uint64_t n_node256;
+    // Number of values.
+    uint64_t n_leaves;
+    // Same as `art_size_in_bytes` and `art_allocated_size_in_bytes`.
+    uint64_t n_bytes;
+    uint64_t n_bytes_allocated;
+} art_statistics_t;
+
+/**
+ * Collects statistics about the ART in a single walk of its nodes.
+ */
+void art_statistics(const art_t *art, art_statistics_t *stats);
+
 /**
  * Prints the ART using printf, useful for debugging.
  */
@@ -78,6 +78,31 @@ inline size_t bitset_size_in_words(const bitset_t *bitset) {
  * bits with padding. Return true in case of success, false for failure. */
 bool bitset_grow(bitset_t *bitset, size_t newarraysize);
 
+/*
+ * Initialize *view as a read-only bitset over words[0, nwords), without
+ * copying: the memory stays owned by the caller (e.g., an mmapped file) and
+ * must outlive the view. words must be aligned on 8 bytes; returns false
+ * otherwise. An empty view (nwords == 0) does not reference words.
+ *
+ * The view can be passed wherever a const bitset_t * is expected: counts,
+ * intersections and other comparisons, iteration, bitset_copy and the
+ * roaring conversions. It must not be passed to bitset_free. The functions
+ * modifying a bitset leave views alone: those returning a bool return false,
+ * the others do nothing.
+ *
+ *   bitset_t view;
+ *   if (bitset_view_init(&view, mapped_words, nwords)) {
+ *       size_t card = bitset_count(&view);
+ *   }
+ */
+bool bitset_view_init(bitset_t *view, const uint64_t *words, size_t nwords);
+
+/* Returns true if the bitset is a view over memory it does not own. */
+inline bool bitset_is_view(const bitset_t *bitset) {
+    // owned buffers hold at most SIZE_MAX / 64 words, see bitset_resize
+    return bitset->capacity == SIZE_MAX;
+}
+
 /* attempts to recover unused memory, return false in case of
  * roaring_reallocation failure */
 bool bitset_trim(bitset_t *bitset);
@@ -93,6 +118,7 @@ void bitset_shift_right(bitset_t *bitset, size_t s);
 /* Set the ith bit. Attempts to resize the bitset if needed (may silently fail)
  */
 inline void bitset_set(bitset_t *bitset, size_t i) {
+    if (bitset_is_view(bitset)) return;
     size_t shiftedi = i / 64;
     if (shiftedi >= bitset->arraysize) {
         if (!bitset_grow(bitset, shiftedi + 1)) {
@@ -105,6 +131,7 @@ inline void bitset_set(bitset_t *bitset, size_t i) {
 /* Set the ith bit to the specified value. Attempts to resize the bitset if
  * needed (may silently fail) */
 inline void bitset_set_to_value(bitset_t *bitset, size_t i, bool flag) {
+    if (bitset_is_view(bitset)) return;
     size_t shiftedi = i / 64;
     uint64_t mask = ((uint64_t)1) << (i % 64);
     uint64_t dynmask = ((uint64_t)flag) << (i % 64);
@@ -185,6 +212,38 @@ bool bitset_inplace_symmetric_difference(bitset_t *CBITSET_RESTRICT b1,
 size_t bitset_symmetric_difference_count(const bitset_t *CBITSET_RESTRICT b1,
                                          const bitset_t *CBITSET_RESTRICT b2);
 
+/*
+ * Parallel variants for very large bitsets. The word array is split into
+ * cache-sized chunks that are spread over up to num_threads threads, the
+ * calling thread included. The results are the same as for the sequential
+ * functions. Bitsets of a few chunks, or num_threads <= 1, are processed on
+ * the calling thread.
+ *
+ * Threads are only used when the library is built with ROARING_USE_THREADS
+ * (CROARING_USE_THREADS=1 and -pthread for the amalgamation); otherwise
+ * these functions run sequentially.
+ */
+bool bitset_inplace_union_parallel(bitset_t *CBITSET_RESTRICT b1,
+                                   const bitset_t *CBITSET_RESTRICT b2,
+                                   size_t num_threads);
+void bitset_inplace_intersection_parallel(bitset_t *CBITSET_RESTRICT b1,
+                                          const bitset_t *CBITSET_RESTRICT b2,
+                                          size_t num_threads);
+void bitset_inplace_difference_parallel(bitset_t *CBITSET_RESTRICT b1,
+                                        const bitset_t *CBITSET_RESTRICT b2,
+                                        size_t num_threads);
+size_t bitset_count_parallel(const bitset_t *bitset, size_t num_threads);
+
+/*
+ * Writes the positions of all set bits to out, in increasing order, and
+ * returns how many were written; out must have room for bitset_count(bitset)
+ * values. Positions are 32-bit, so the bitset must hold at most 2^32 bits:
+ * larger bitsets write nothing and return 0. Returns 0 as well if memory
+ * cannot be allocated.
+ */
+size_t bitset_extract_setbits_parallel(const bitset_t *bitset, uint32_t *out,
+                                       size_t num_threads);
+
 /* iterate over the set bits
  like so :
   for(size_t i = 0; bitset_next_set_bit(b,&i) ; i++) {
@@ -66,6 +66,35 @@ static inline int bitset_lenrange_cardinality(const uint64_t *words,
     return answer;
 }
 
+/*
+ * Write to "out" the values of [start, start + lenminusone] whose bit is set,
+ * or unset if "complement" is true, and return how many were written. This
+ * decodes whole words, which beats testing the values one by one on long
+ * ranges.
+ */
+static inline int bitset_lenrange_extract_uint16(const uint64_t *words,
+                                                 uint32_t start,
+                                                 uint32_t lenminusone,
+                                                 bool complement,
+                                                 uint16_t *out) {
+    const uint64_t flip = complement ? ~UINT64_C(0) : 0;
+    const uint32_t firstword = start / 64;
+    const uint32_t endword = (start + lenminusone) / 64;
+    int count = 0;
+    for (uint32_t i = firstword; i <= endword; i++) {
+        uint64_t w = words[i] ^ flip;
+        if (i == firstword) w &= (~UINT64_C(0)) << (start % 64);
+        if (i == endword) {
+            w &= (~UINT64_C(0)) >> ((63 - (start + lenminusone)) % 64);
+        }
+        while (w != 0) {
+            out[count++] = (uint16_t)(i * 64 + roaring_trailing_zeroes(w));
+            w &= w - 1;
+        }
+    }
+    return count;
+}
+
 /*
  * Check whether the cardinality of the bitset in [begin,begin+lenminusone] is 0
  */
@@ -267,6 +296,26 @@ uint64_t bitset_flip_list_withcard(uint64_t *words, uint64_t card,
 
 void bitset_flip_list(uint64_t *words, const uint16_t *list, uint64_t length);
 
+#if CROARING_IS_X64 && CROARING_COMPILER_SUPPORTS_AVX512
+/*
+ * Writes to "out" the values of the list (there are length of them) whose bit
+ * is set in the bitset, or unset if "complement" is true, and returns how many
+ * were written. The list is looked up sixteen values at a time with AVX-512
+ * gathers. "out" may be the list itself.
+ */
+size_t bitset_filter_list_avx512(const uint64_t *words, const uint16_t *list,
+                                 uint64_t length, uint16_t *out,
+                                 bool complement);
+
+/* Returns how many values of the list have their bit set in the bitset. */
+uint64_t bitset_count_list_avx512(const uint64_t *words, const uint16_t *list,
+                                  uint64_t length);
+
+/* Returns true if any value of the list has its bit set in the bitset. */
+bool bitset_intersects_list_avx512(const uint64_t *words, const uint16_t *list,
+                                   uint64_t length);
+#endif
+
 #if CROARING_IS_X64
 /***
  * BEGIN Harley-Seal popcount functions.
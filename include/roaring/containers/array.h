@@ -333,6 +333,12 @@ static inline bool array_container_remove(array_container_t *arr,
 /* Check whether x is present.  */
 inline bool array_container_contains(const array_container_t *arr,
                                      uint16_t pos) {
+#if CROARING_IS_X64
+    if (arr->cardinality >= 16 &&
+        (croaring_hardware_support() & ROARING_SUPPORTS_AVX2)) {
+        return array_contains_vector16(arr->array, arr->cardinality, pos);
+    }
+#endif
     //    return binarySearch(arr->array, arr->cardinality, pos) >= 0;
     // binary search with fallback to linear search for short ranges
     int32_t low = 0;
@@ -364,6 +370,16 @@ inline bool array_container_contains(const array_container_t *arr,
 void array_container_offset(const array_container_t *c, container_t **loc,
                             container_t **hic, uint16_t offset);
 
+/*
+ * Tests the probes vals[begin, end) against the container, considering only
+ * the low 16 bits of each value, and sets bit i of out_bits for every probe
+ * vals[i] that is present. Other bits are left alone. Ascending probes are
+ * answered with a single forward pass over the container.
+ */
+void array_container_contains_many(const array_container_t *arr,
+                                   const uint32_t *vals, size_t begin,
+                                   size_t end, uint64_t *out_bits);
+
 //* Check whether a range of values from range_start (included) to range_end
 //(excluded) is present. */
 static inline bool array_container_contains_range(const array_container_t *arr,
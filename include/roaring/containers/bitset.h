@@ -188,6 +188,16 @@ inline bool bitset_container_get(const bitset_container_t *bitset,
 
 #endif
 
+/*
+ * Tests the probes vals[begin, end) against the container, considering only
+ * the low 16 bits of each value, and sets bit i of out_bits for every probe
+ * vals[i] that is present. Other bits are left alone. Ascending probes are
+ * answered with a single forward pass over the container.
+ */
+void bitset_container_contains_many(const bitset_container_t *bitset,
+                                    const uint32_t *vals, size_t begin,
+                                    size_t end, uint64_t *out_bits);
+
 /*
  * Check if all bits are set in a range of positions from pos_start (included)
  * to pos_end (excluded).
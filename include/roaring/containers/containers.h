@@ -16,6 +16,7 @@
 #include <roaring/containers/mixed_subset.h>
 #include <roaring/containers/mixed_union.h>
 #include <roaring/containers/mixed_xor.h>
+#include <roaring/containers/packed.h>
 #include <roaring/containers/run.h>
 
 #ifdef __cplusplus
@@ -38,6 +39,14 @@ namespace internal {
 #define RUN_CONTAINER_TYPE 3
 #define SHARED_CONTAINER_TYPE 4
 
+/**
+ * Packed containers are read-only and only produced by
+ * roaring_bitmap_pack_optimize. They never take part in PAIR_CONTAINER_TYPES
+ * switches: the binary operations first turn them back into array containers
+ * (see the container_*_unpacked functions).
+ */
+#define PACKED_CONTAINER_TYPE 5
+
 /**
  * Macros for pairing container type codes, suitable for switch statements.
  * Use PAIR_CONTAINER_TYPES() for the switch, CONTAINER_PAIR() for the cases:
@@ -139,13 +148,117 @@ static inline container_t *get_writable_copy_if_shared(container_t *c,
     }
 }
 
+/**
+ * The full container singleton: a process-wide shared container holding every
+ * 16-bit value as a single run. Bitmaps reference it for their full chunks
+ * instead of allocating a container of their own, whether or not they are
+ * copy-on-write. It is immutable and its counter is never updated: copying it
+ * returns it, freeing it does nothing, and get_writable_copy_if_shared clones
+ * the run like for any other shared container.
+ */
+extern shared_container_t container_full_singleton;
+
+static inline bool container_is_full_singleton(const container_t *c) {
+    return c == &container_full_singleton;
+}
+
+#ifdef __cplusplus
+/* Sets up the singleton, once; every reference to it is obtained through
+ * container_get_full_singleton, which calls this first. */
+void container_full_singleton_init(void);
+#endif
+
+/* Returns the full container singleton, setting its typecode. */
+static inline container_t *container_get_full_singleton(uint8_t *type) {
+#ifdef __cplusplus
+    container_full_singleton_init();
+#endif
+    *type = SHARED_CONTAINER_TYPE;
+    return &container_full_singleton;
+}
+
 /**
  * End of shared container code
  */
 
-static const char *container_names[] = {"bitset", "array", "run", "shared"};
+/**
+ * Fallbacks of the operations below for packed containers (either operand may
+ * be one). The packed operands are decoded into temporary array containers,
+ * and each fallback follows the memory contract of its operation. Shared
+ * containers must already be unwrapped.
+ */
+bool container_equals_unpacked(const container_t *c1, uint8_t type1,
+                               const container_t *c2, uint8_t type2);
+bool container_is_subset_unpacked(const container_t *c1, uint8_t type1,
+                                  const container_t *c2, uint8_t type2);
+container_t *container_and_unpacked(const container_t *c1, uint8_t type1,
+                                    const container_t *c2, uint8_t type2,
+                                    uint8_t *result_type);
+int container_and_cardinality_unpacked(const container_t *c1, uint8_t type1,
+                                       const container_t *c2, uint8_t type2);
+bool container_intersect_unpacked(const container_t *c1, uint8_t type1,
+                                  const container_t *c2, uint8_t type2);
+container_t *container_iand_unpacked(container_t *c1, uint8_t type1,
+                                     const container_t *c2, uint8_t type2,
+                                     uint8_t *result_type);
+container_t *container_or_unpacked(const container_t *c1, uint8_t type1,
+                                   const container_t *c2, uint8_t type2,
+                                   uint8_t *result_type);
+container_t *container_lazy_or_unpacked(const container_t *c1, uint8_t type1,
+                                        const container_t *c2, uint8_t type2,
+                                        uint8_t *result_type);
+container_t *container_ior_unpacked(container_t *c1, uint8_t type1,
+                                    const container_t *c2, uint8_t type2,
+                                    uint8_t *result_type);
+container_t *container_lazy_ior_unpacked(container_t *c1, uint8_t type1,
+                                         const container_t *c2, uint8_t type2,
+                                         uint8_t *result_type);
+container_t *container_xor_unpacked(const container_t *c1, uint8_t type1,
+                                    const container_t *c2, uint8_t type2,
+                                    uint8_t *result_type);
+container_t *container_lazy_xor_unpacked(const container_t *c1, uint8_t type1,
+                                         const container_t *c2, uint8_t type2,
+                                         uint8_t *result_type);
+container_t *container_ixor_unpacked(container_t *c1, uint8_t type1,
+                                     const container_t *c2, uint8_t type2,
+                                     uint8_t *result_type);
+container_t *container_lazy_ixor_unpacked(container_t *c1, uint8_t type1,
+                                          const container_t *c2, uint8_t type2,
+                                          uint8_t *result_type);
+container_t *container_andnot_unpacked(const container_t *c1, uint8_t type1,
+                                       const container_t *c2, uint8_t type2,
+                                       uint8_t *result_type);
+container_t *container_iandnot_unpacked(container_t *c1, uint8_t type1,
+                                        const container_t *c2, uint8_t type2,
+                                        uint8_t *result_type);
+container_t *container_not_unpacked(const container_t *c, uint8_t *result_type);
+container_t *container_not_range_unpacked(const container_t *c,
+                                          uint32_t range_start,
+                                          uint32_t range_end,
+                                          uint8_t *result_type);
+container_t *container_inot_unpacked(container_t *c, uint8_t *result_type);
+container_t *container_inot_range_unpacked(container_t *c, uint32_t range_start,
+                                           uint32_t range_end,
+                                           uint8_t *result_type);
+container_t *container_add_unpacked(container_t *c, uint16_t val,
+                                    uint8_t *new_typecode);
+container_t *container_remove_unpacked(container_t *c, uint16_t val,
+                                       uint8_t *new_typecode);
+container_t *container_add_range_unpacked(container_t *c, uint32_t min,
+                                          uint32_t max, uint8_t *result_type);
+container_t *container_remove_range_unpacked(container_t *c, uint32_t min,
+                                             uint32_t max,
+                                             uint8_t *result_type);
+void container_contains_many_unpacked(const container_t *c,
+                                      const uint32_t *vals, size_t begin,
+                                      size_t end, uint64_t *out_bits);
+void container_add_offset_unpacked(const container_t *c, container_t **lo,
+                                   container_t **hi, uint16_t offset);
+
+static const char *container_names[] = {"bitset", "array", "run", "shared",
+                                        "packed"};
 static const char *shared_container_names[] = {
-    "bitset (shared)", "array (shared)", "run (shared)"};
+    "bitset (shared)", "array (shared)", "run (shared)", "packed (shared)"};
 
 // no matter what the initial container was, convert it to a bitset
 // if a new container is produced, caller responsible for freeing the previous
@@ -163,6 +276,9 @@ static inline bitset_container_t *container_to_bitset(container_t *c,
         case RUN_CONTAINER_TYPE:
             result = bitset_container_from_run(CAST_run(c));
             return result;
+        case PACKED_CONTAINER_TYPE:
+            result = bitset_container_from_packed(CAST_packed(c));
+            return result;
         case SHARED_CONTAINER_TYPE:
             assert(false);
             roaring_unreachable;
@@ -202,6 +318,8 @@ static inline const char *get_full_container_name(const container_t *c,
             return container_names[1];
         case RUN_CONTAINER_TYPE:
             return container_names[2];
+        case PACKED_CONTAINER_TYPE:
+            return container_names[4];
         case SHARED_CONTAINER_TYPE:
             switch (const_CAST_shared(c)->typecode) {
                 case BITSET_CONTAINER_TYPE:
@@ -210,6 +328,8 @@ static inline const char *get_full_container_name(const container_t *c,
                     return shared_container_names[1];
                 case RUN_CONTAINER_TYPE:
                     return shared_container_names[2];
+                case PACKED_CONTAINER_TYPE:
+                    return shared_container_names[3];
                 default:
                     assert(false);
                     roaring_unreachable;
@@ -238,6 +358,8 @@ static inline int container_get_cardinality(const container_t *c,
             return array_container_cardinality(const_CAST_array(c));
         case RUN_CONTAINER_TYPE:
             return run_container_cardinality(const_CAST_run(c));
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_cardinality(const_CAST_packed(c));
     }
     assert(false);
     roaring_unreachable;
@@ -258,6 +380,8 @@ static inline bool container_is_full(const container_t *c, uint8_t typecode) {
                    (1 << 16);
         case RUN_CONTAINER_TYPE:
             return run_container_is_full(const_CAST_run(c));
+        case PACKED_CONTAINER_TYPE:
+            return false;  // never more than DEFAULT_MAX_SIZE values
     }
     assert(false);
     roaring_unreachable;
@@ -273,6 +397,8 @@ static inline int container_shrink_to_fit(container_t *c, uint8_t type) {
             return array_container_shrink_to_fit(CAST_array(c));
         case RUN_CONTAINER_TYPE:
             return run_container_shrink_to_fit(CAST_run(c));
+        case PACKED_CONTAINER_TYPE:
+            return 0;  // allocated to size
     }
     assert(false);
     roaring_unreachable;
@@ -331,6 +457,7 @@ static inline container_t *container_from_range(uint8_t *type, uint32_t min,
  */
 static inline container_t *container_repair_after_lazy(container_t *c,
                                                        uint8_t *type) {
+    if (container_is_full_singleton(c)) return c;  // nothing to repair
     c = get_writable_copy_if_shared(c, type);  // !!! unnecessary cloning
     container_t *result = NULL;
     switch (*type) {
@@ -350,6 +477,8 @@ static inline container_t *container_repair_after_lazy(container_t *c,
         case RUN_CONTAINER_TYPE:
             return convert_run_to_efficient_container_and_free(CAST_run(c),
                                                                type);
+        case PACKED_CONTAINER_TYPE:
+            return c;  // nothing to do
         case SHARED_CONTAINER_TYPE:
             assert(false);
     }
@@ -376,6 +505,8 @@ static inline int32_t container_write(const container_t *c, uint8_t typecode,
             return array_container_write(const_CAST_array(c), buf);
         case RUN_CONTAINER_TYPE:
             return run_container_write(const_CAST_run(c), buf);
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_write(const_CAST_packed(c), buf);
     }
     assert(false);
     roaring_unreachable;
@@ -397,6 +528,8 @@ static inline int32_t container_size_in_bytes(const container_t *c,
             return array_container_size_in_bytes(const_CAST_array(c));
         case RUN_CONTAINER_TYPE:
             return run_container_size_in_bytes(const_CAST_run(c));
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_size_in_bytes(const_CAST_packed(c));
     }
     assert(false);
     roaring_unreachable;
@@ -432,6 +565,8 @@ static inline bool container_nonzero_cardinality(const container_t *c,
             return array_container_nonzero_cardinality(const_CAST_array(c));
         case RUN_CONTAINER_TYPE:
             return run_container_nonzero_cardinality(const_CAST_run(c));
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_nonzero_cardinality(const_CAST_packed(c));
     }
     assert(false);
     roaring_unreachable;
@@ -443,6 +578,19 @@ static inline bool container_nonzero_cardinality(const container_t *c,
  */
 void container_free(container_t *container, uint8_t typecode);
 
+/**
+ * If the container is known to be full, free it and return the full container
+ * singleton instead (updating the typecode), otherwise return it as is.
+ */
+static inline container_t *container_share_if_full(container_t *c,
+                                                   uint8_t *type) {
+    if (!container_is_full_singleton(c) && container_is_full(c, *type)) {
+        container_free(c, *type);
+        return container_get_full_singleton(type);
+    }
+    return c;
+}
+
 /**
  * Convert a container to an array of values, requires a  typecode as well as a
  * "base" (most significant values)
@@ -462,6 +610,9 @@ static inline int container_to_uint32_array(uint32_t *output,
         case RUN_CONTAINER_TYPE:
             return run_container_to_uint32_array(output, const_CAST_run(c),
                                                  base);
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_to_uint32_array(
+                output, const_CAST_packed(c), base);
     }
     assert(false);
     roaring_unreachable;
@@ -479,6 +630,9 @@ static inline container_t *container_add(
     uint8_t typecode,  // !!! should be second argument?
     uint8_t *new_typecode) {
     c = get_writable_copy_if_shared(c, &typecode);
+    if (typecode == PACKED_CONTAINER_TYPE) {
+        return container_add_unpacked(c, val, new_typecode);
+    }
     switch (typecode) {
         case BITSET_CONTAINER_TYPE:
             bitset_container_set(CAST_bitset(c), val);
@@ -520,6 +674,9 @@ static inline container_t *container_remove(
     uint8_t typecode,  // !!! should be second argument?
     uint8_t *new_typecode) {
     c = get_writable_copy_if_shared(c, &typecode);
+    if (typecode == PACKED_CONTAINER_TYPE) {
+        return container_remove_unpacked(c, val, new_typecode);
+    }
     switch (typecode) {
         case BITSET_CONTAINER_TYPE:
             if (bitset_container_remove(CAST_bitset(c), val)) {
@@ -562,6 +719,8 @@ static inline bool container_contains(
             return array_container_contains(const_CAST_array(c), val);
         case RUN_CONTAINER_TYPE:
             return run_container_contains(const_CAST_run(c), val);
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_contains(const_CAST_packed(c), val);
         default:
             assert(false);
             roaring_unreachable;
@@ -569,6 +728,37 @@ static inline bool container_contains(
     }
 }
 
+/**
+ * Sets bit i of out_bits for every probe vals[i], begin <= i < end, whose low
+ * 16 bits are in the container. Requires a typecode.
+ */
+static inline void container_contains_many(const container_t *c,
+                                           uint8_t typecode,
+                                           const uint32_t *vals, size_t begin,
+                                           size_t end, uint64_t *out_bits) {
+    c = container_unwrap_shared(c, &typecode);
+    switch (typecode) {
+        case BITSET_CONTAINER_TYPE:
+            bitset_container_contains_many(const_CAST_bitset(c), vals, begin,
+                                           end, out_bits);
+            break;
+        case ARRAY_CONTAINER_TYPE:
+            array_container_contains_many(const_CAST_array(c), vals, begin,
+                                          end, out_bits);
+            break;
+        case RUN_CONTAINER_TYPE:
+            run_container_contains_many(const_CAST_run(c), vals, begin, end,
+                                        out_bits);
+            break;
+        case PACKED_CONTAINER_TYPE:
+            container_contains_many_unpacked(c, vals, begin, end, out_bits);
+            break;
+        default:
+            assert(false);
+            roaring_unreachable;
+    }
+}
+
 /**
  * Check whether a range of values from range_start (included) to range_end
  * (excluded) is in a container, requires a typecode
@@ -588,6 +778,9 @@ static inline bool container_contains_range(
         case RUN_CONTAINER_TYPE:
             return run_container_contains_range(const_CAST_run(c), range_start,
                                                 range_end);
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_contains_range(const_CAST_packed(c),
+                                                   range_start, range_end);
         default:
             assert(false);
             roaring_unreachable;
@@ -603,6 +796,9 @@ static inline bool container_equals(const container_t *c1, uint8_t type1,
                                     const container_t *c2, uint8_t type2) {
     c1 = container_unwrap_shared(c1, &type1);
     c2 = container_unwrap_shared(c2, &type2);
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_equals_unpacked(c1, type1, c2, type2);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             return bitset_container_equals(const_CAST_bitset(c1),
@@ -656,6 +852,9 @@ static inline bool container_is_subset(const container_t *c1, uint8_t type1,
                                        const container_t *c2, uint8_t type2) {
     c1 = container_unwrap_shared(c1, &type1);
     c2 = container_unwrap_shared(c2, &type2);
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_is_subset_unpacked(c1, type1, c2, type2);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             return bitset_container_is_subset(const_CAST_bitset(c1),
@@ -712,6 +911,9 @@ static inline container_t *container_and(const container_t *c1, uint8_t type1,
     c1 = container_unwrap_shared(c1, &type1);
     c2 = container_unwrap_shared(c2, &type2);
     container_t *result = NULL;
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_and_unpacked(c1, type1, c2, type2, result_type);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             *result_type =
@@ -797,6 +999,9 @@ static inline int container_and_cardinality(const container_t *c1,
                                             uint8_t type2) {
     c1 = container_unwrap_shared(c1, &type1);
     c2 = container_unwrap_shared(c2, &type2);
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_and_cardinality_unpacked(c1, type1, c2, type2);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             return bitset_container_and_justcard(const_CAST_bitset(c1),
@@ -848,6 +1053,9 @@ static inline bool container_intersect(const container_t *c1, uint8_t type1,
                                        const container_t *c2, uint8_t type2) {
     c1 = container_unwrap_shared(c1, &type1);
     c2 = container_unwrap_shared(c2, &type2);
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_intersect_unpacked(c1, type1, c2, type2);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             return bitset_container_intersect(const_CAST_bitset(c1),
@@ -907,6 +1115,9 @@ static inline container_t *container_iand(container_t *c1, uint8_t type1,
     c1 = get_writable_copy_if_shared(c1, &type1);
     c2 = container_unwrap_shared(c2, &type2);
     container_t *result = NULL;
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_iand_unpacked(c1, type1, c2, type2, result_type);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             *result_type = bitset_bitset_container_intersection_inplace(
@@ -994,6 +1205,9 @@ static inline container_t *container_or(const container_t *c1, uint8_t type1,
     c1 = container_unwrap_shared(c1, &type1);
     c2 = container_unwrap_shared(c2, &type2);
     container_t *result = NULL;
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_or_unpacked(c1, type1, c2, type2, result_type);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             result = bitset_container_create();
@@ -1101,6 +1315,9 @@ static inline container_t *container_lazy_or(const container_t *c1,
     c1 = container_unwrap_shared(c1, &type1);
     c2 = container_unwrap_shared(c2, &type2);
     container_t *result = NULL;
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_lazy_or_unpacked(c1, type1, c2, type2, result_type);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             result = bitset_container_create();
@@ -1212,6 +1429,9 @@ static inline container_t *container_ior(container_t *c1, uint8_t type1,
     c1 = get_writable_copy_if_shared(c1, &type1);
     c2 = container_unwrap_shared(c2, &type2);
     container_t *result = NULL;
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_ior_unpacked(c1, type1, c2, type2, result_type);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             bitset_container_or(const_CAST_bitset(c1), const_CAST_bitset(c2),
@@ -1321,6 +1541,9 @@ static inline container_t *container_lazy_ior(container_t *c1, uint8_t type1,
     // c1 = get_writable_copy_if_shared(c1,&type1);
     c2 = container_unwrap_shared(c2, &type2);
     container_t *result = NULL;
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_lazy_ior_unpacked(c1, type1, c2, type2, result_type);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
 #ifdef LAZY_OR_BITSET_CONVERSION_TO_FULL
@@ -1435,6 +1658,9 @@ static inline container_t *container_xor(const container_t *c1, uint8_t type1,
     c1 = container_unwrap_shared(c1, &type1);
     c2 = container_unwrap_shared(c2, &type2);
     container_t *result = NULL;
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_xor_unpacked(c1, type1, c2, type2, result_type);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             *result_type =
@@ -1535,6 +1761,9 @@ static inline void container_add_offset(const container_t *c, uint8_t type,
         case RUN_CONTAINER_TYPE:
             run_container_offset(const_CAST_run(c), lo, hi, offset);
             break;
+        case PACKED_CONTAINER_TYPE:
+            container_add_offset_unpacked(c, lo, hi, offset);
+            break;
         default:
             assert(false);
             roaring_unreachable;
@@ -1558,6 +1787,9 @@ static inline container_t *container_lazy_xor(const container_t *c1,
     c1 = container_unwrap_shared(c1, &type1);
     c2 = container_unwrap_shared(c2, &type2);
     container_t *result = NULL;
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_lazy_xor_unpacked(c1, type1, c2, type2, result_type);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             result = bitset_container_create();
@@ -1651,6 +1883,9 @@ static inline container_t *container_ixor(container_t *c1, uint8_t type1,
     c1 = get_writable_copy_if_shared(c1, &type1);
     c2 = container_unwrap_shared(c2, &type2);
     container_t *result = NULL;
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_ixor_unpacked(c1, type1, c2, type2, result_type);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             *result_type = bitset_bitset_container_ixor(
@@ -1736,6 +1971,9 @@ static inline container_t *container_lazy_ixor(container_t *c1, uint8_t type1,
     assert(type1 != SHARED_CONTAINER_TYPE);
     // c1 = get_writable_copy_if_shared(c1,&type1);
     c2 = container_unwrap_shared(c2, &type2);
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_lazy_ixor_unpacked(c1, type1, c2, type2, result_type);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             bitset_container_xor_nocard(CAST_bitset(c1), const_CAST_bitset(c2),
@@ -1771,6 +2009,9 @@ static inline container_t *container_andnot(const container_t *c1,
     c1 = container_unwrap_shared(c1, &type1);
     c2 = container_unwrap_shared(c2, &type2);
     container_t *result = NULL;
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_andnot_unpacked(c1, type1, c2, type2, result_type);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             *result_type =
@@ -1875,6 +2116,9 @@ static inline container_t *container_iandnot(container_t *c1, uint8_t type1,
     c1 = get_writable_copy_if_shared(c1, &type1);
     c2 = container_unwrap_shared(c2, &type2);
     container_t *result = NULL;
+    if (type1 == PACKED_CONTAINER_TYPE || type2 == PACKED_CONTAINER_TYPE) {
+        return container_iandnot_unpacked(c1, type1, c2, type2, result_type);
+    }
     switch (PAIR_CONTAINER_TYPES(type1, type2)) {
         case CONTAINER_PAIR(BITSET, BITSET):
             *result_type = bitset_bitset_container_iandnot(
@@ -1956,6 +2200,9 @@ static inline bool container_iterate(const container_t *c, uint8_t type,
         case RUN_CONTAINER_TYPE:
             return run_container_iterate(const_CAST_run(c), base, iterator,
                                          ptr);
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_iterate(const_CAST_packed(c), base,
+                                            iterator, ptr);
         default:
             assert(false);
             roaring_unreachable;
@@ -1980,6 +2227,9 @@ static inline bool container_iterate64(const container_t *c, uint8_t type,
         case RUN_CONTAINER_TYPE:
             return run_container_iterate64(const_CAST_run(c), base, iterator,
                                            high_bits, ptr);
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_iterate64(const_CAST_packed(c), base,
+                                              iterator, high_bits, ptr);
         default:
             assert(false);
             roaring_unreachable;
@@ -1993,6 +2243,9 @@ static inline container_t *container_not(const container_t *c, uint8_t type,
                                          uint8_t *result_type) {
     c = container_unwrap_shared(c, &type);
     container_t *result = NULL;
+    if (type == PACKED_CONTAINER_TYPE) {
+        return container_not_unpacked(c, result_type);
+    }
     switch (type) {
         case BITSET_CONTAINER_TYPE:
             *result_type =
@@ -2026,6 +2279,10 @@ static inline container_t *container_not_range(const container_t *c,
                                                uint8_t *result_type) {
     c = container_unwrap_shared(c, &type);
     container_t *result = NULL;
+    if (type == PACKED_CONTAINER_TYPE) {
+        return container_not_range_unpacked(c, range_start, range_end,
+                                            result_type);
+    }
     switch (type) {
         case BITSET_CONTAINER_TYPE:
             *result_type =
@@ -2059,6 +2316,9 @@ static inline container_t *container_inot(container_t *c, uint8_t type,
                                           uint8_t *result_type) {
     c = get_writable_copy_if_shared(c, &type);
     container_t *result = NULL;
+    if (type == PACKED_CONTAINER_TYPE) {
+        return container_inot_unpacked(c, result_type);
+    }
     switch (type) {
         case BITSET_CONTAINER_TYPE:
             *result_type =
@@ -2093,6 +2353,10 @@ static inline container_t *container_inot_range(container_t *c, uint8_t type,
                                                 uint8_t *result_type) {
     c = get_writable_copy_if_shared(c, &type);
     container_t *result = NULL;
+    if (type == PACKED_CONTAINER_TYPE) {
+        return container_inot_range_unpacked(c, range_start, range_end,
+                                             result_type);
+    }
     switch (type) {
         case BITSET_CONTAINER_TYPE:
             *result_type = bitset_container_negation_range_inplace(
@@ -2142,6 +2406,9 @@ static inline bool container_select(const container_t *c, uint8_t type,
         case RUN_CONTAINER_TYPE:
             return run_container_select(const_CAST_run(c), start_rank, rank,
                                         element);
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_select(const_CAST_packed(c), start_rank,
+                                           rank, element);
         default:
             assert(false);
             roaring_unreachable;
@@ -2160,6 +2427,8 @@ static inline uint16_t container_maximum(const container_t *c, uint8_t type) {
             return array_container_maximum(const_CAST_array(c));
         case RUN_CONTAINER_TYPE:
             return run_container_maximum(const_CAST_run(c));
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_maximum(const_CAST_packed(c));
         default:
             assert(false);
             roaring_unreachable;
@@ -2178,6 +2447,8 @@ static inline uint16_t container_minimum(const container_t *c, uint8_t type) {
             return array_container_minimum(const_CAST_array(c));
         case RUN_CONTAINER_TYPE:
             return run_container_minimum(const_CAST_run(c));
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_minimum(const_CAST_packed(c));
         default:
             assert(false);
             roaring_unreachable;
@@ -2198,6 +2469,8 @@ static inline int container_rank(const container_t *c, uint8_t type,
             return array_container_rank(const_CAST_array(c), x);
         case RUN_CONTAINER_TYPE:
             return run_container_rank(const_CAST_run(c), x);
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_rank(const_CAST_packed(c), x);
         default:
             assert(false);
             roaring_unreachable;
@@ -2223,6 +2496,9 @@ static inline uint32_t container_rank_many(const container_t *c, uint8_t type,
         case RUN_CONTAINER_TYPE:
             return run_container_rank_many(const_CAST_run(c), start_rank, begin,
                                            end, ans);
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_rank_many(const_CAST_packed(c), start_rank,
+                                              begin, end, ans);
         default:
             assert(false);
             roaring_unreachable;
@@ -2243,6 +2519,8 @@ static inline int container_get_index(const container_t *c, uint8_t type,
             return array_container_get_index(const_CAST_array(c), x);
         case RUN_CONTAINER_TYPE:
             return run_container_get_index(const_CAST_run(c), x);
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_get_index(const_CAST_packed(c), x);
         default:
             assert(false);
             roaring_unreachable;
@@ -2264,6 +2542,9 @@ static inline container_t *container_add_range(container_t *c, uint8_t type,
                                                uint32_t min, uint32_t max,
                                                uint8_t *result_type) {
     // NB: when selecting new container type, we perform only inexpensive checks
+    if (type == PACKED_CONTAINER_TYPE) {
+        return container_add_range_unpacked(c, min, max, result_type);
+    }
     switch (type) {
         case BITSET_CONTAINER_TYPE: {
             bitset_container_t *bitset = CAST_bitset(c);
@@ -2352,6 +2633,9 @@ static inline container_t *container_add_range(container_t *c, uint8_t type,
 static inline container_t *container_remove_range(container_t *c, uint8_t type,
                                                   uint32_t min, uint32_t max,
                                                   uint8_t *result_type) {
+    if (type == PACKED_CONTAINER_TYPE) {
+        return container_remove_range_unpacked(c, min, max, result_type);
+    }
     switch (type) {
         case BITSET_CONTAINER_TYPE: {
             bitset_container_t *bitset = CAST_bitset(c);
@@ -2453,6 +2737,16 @@ bool container_iterator_lower_bound(const container_t *c, uint8_t typecode,
                                     roaring_container_iterator_t *it,
                                     uint16_t *value_out, uint16_t val);
 
+/**
+ * Reads the maximal range of consecutive values starting at the entry the
+ * iterator points to, whose value is `value`, and sets `range_end` to the last
+ * value of that range. Then moves the iterator past the range. Returns true
+ * and sets `value` if a value is present after the range.
+ */
+bool container_iterator_read_range(const container_t *c, uint8_t typecode,
+                                   roaring_container_iterator_t *it,
+                                   uint16_t *value, uint16_t *range_end);
+
 /**
  * Reads up to `count` entries from the container, and writes them into `buf`
  * as `high16 | entry`. Returns true and sets `value_out` if a value is present
@@ -8,6 +8,7 @@
 
 #include <roaring/containers/array.h>
 #include <roaring/containers/bitset.h>
+#include <roaring/containers/packed.h>
 #include <roaring/containers/run.h>
 
 #ifdef __cplusplus
@@ -34,6 +35,23 @@ array_container_t *array_container_from_bitset(const bitset_container_t *bits);
  */
 run_container_t *run_container_from_array(const array_container_t *c);
 
+/* Convert an array into a packed container. The input container is not freed
+ * or modified. */
+packed_container_t *packed_container_from_array(const array_container_t *arr);
+
+/* Convert a packed container into an array. The input container is not freed
+ * or modified. */
+array_container_t *array_container_from_packed(const packed_container_t *p);
+
+/* Convert a packed container into a bitset. The input container is not freed
+ * or modified. */
+bitset_container_t *bitset_container_from_packed(const packed_container_t *p);
+
+/* Convert an array into a packed container if that takes less memory, in
+ * which case the array is freed. */
+container_t *convert_array_to_packed_if_smaller(array_container_t *arr,
+                                                uint8_t *typecode_after);
+
 /* convert a run into either an array or a bitset
  * might free the container. This does not free the input run container. */
 container_t *convert_to_bitset_or_array_container(run_container_t *rc,
@@ -0,0 +1,270 @@
+/*
+ * packed.h
+ *
+ */
+
+#ifndef INCLUDE_CONTAINERS_PACKED_H_
+#define INCLUDE_CONTAINERS_PACKED_H_
+
+#include <roaring/roaring_types.h>  // roaring_iterator
+
+// Include other headers after roaring_types.h
+#include <roaring/containers/container_defs.h>  // container_t, perfparameters
+#include <roaring/portability.h>
+
+#ifdef __cplusplus
+extern "C" {
+namespace roaring {
+
+// Note: in pure C++ code, you should avoid putting `using` in header files
+using api::roaring_iterator;
+using api::roaring_iterator64;
+
+namespace internal {
+#endif
+
+/* Number of values per block of a packed container */
+enum { PACKED_BLOCK_SIZE = 32 };
+
+/* Bytes of slack after the gaps, so that decoders can use wide loads */
+enum { PACKED_PADDING = 16 };
+
+/* struct packed_container - compressed representation of a sparse container
+ *
+ * The sorted values are cut into blocks of PACKED_BLOCK_SIZE values. Each
+ * block keeps its first value, and the gaps between its consecutive values,
+ * minus one, bit-packed at the width of its largest gap. For clustered values
+ * this takes a fraction of the two bytes per value of an array container.
+ *
+ * Packed containers are read-only: they are created from array containers by
+ * roaring_bitmap_pack_optimize, and any update goes through an array
+ * container again.
+ *
+ * @cardinality: number of values (at most DEFAULT_MAX_SIZE)
+ * @n_blocks:    number of blocks, (cardinality + 31) / 32
+ * @data:        a single allocation holding, in order, the first value of
+ *               each block (uint16_t), the byte offset of the gaps of each
+ *               block (uint16_t), the width of the gaps of each block
+ *               (uint8_t), the gaps themselves, and PACKED_PADDING bytes
+ */
+STRUCT_CONTAINER(packed_container_s) {
+    int32_t cardinality;
+    int32_t n_blocks;
+    uint8_t *data;
+};
+
+typedef struct packed_container_s packed_container_t;
+
+#define CAST_packed(c) CAST(packed_container_t *, c)  // safer downcast
+#define const_CAST_packed(c) CAST(const packed_container_t *, c)
+#define movable_CAST_packed(c) movable_CAST(packed_container_t **, c)
+
+static inline const uint16_t *packed_container_firsts(
+    const packed_container_t *packed) {
+    return (const uint16_t *)packed->data;
+}
+
+static inline const uint16_t *packed_container_offsets(
+    const packed_container_t *packed) {
+    return (const uint16_t *)packed->data + packed->n_blocks;
+}
+
+static inline const uint8_t *packed_container_widths(
+    const packed_container_t *packed) {
+    return packed->data + 4 * packed->n_blocks;
+}
+
+static inline const uint8_t *packed_container_gaps(
+    const packed_container_t *packed) {
+    return packed->data + 5 * packed->n_blocks;
+}
+
+/* Number of values in block `block' */
+static inline int32_t packed_container_block_length(
+    const packed_container_t *packed, int32_t block) {
+    int32_t remaining = packed->cardinality - block * PACKED_BLOCK_SIZE;
+    return remaining < PACKED_BLOCK_SIZE ? remaining : PACKED_BLOCK_SIZE;
+}
+
+/* Reads the `index'-th gap of a block (the gap preceding its value of rank
+ * index + 1), given the packed gaps of the block and their width. */
+static inline uint32_t packed_read_gap(const uint8_t *gaps, uint32_t width,
+                                       uint32_t index) {
+    uint32_t bit = index * width;
+    const uint8_t *p = gaps + (bit >> 3);
+    uint32_t word = (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+                    ((uint32_t)p[2] << 16);
+    return (word >> (bit & 7)) & ((UINT32_C(1) << width) - 1);
+}
+
+/* Returns the difference between the values of rank index and index - 1,
+ * which must belong to the same block. */
+static inline uint32_t packed_container_delta(const packed_container_t *packed,
+                                              int32_t index) {
+    int32_t block = index / PACKED_BLOCK_SIZE;
+    const uint8_t *gaps =
+        packed_container_gaps(packed) + packed_container_offsets(packed)[block];
+    return packed_read_gap(gaps, packed_container_widths(packed)[block],
+                           (uint32_t)(index % PACKED_BLOCK_SIZE) - 1) +
+           1;
+}
+
+/* Returns the number of bytes needed by the data of a packed container
+ * holding the `cardinality' sorted values of `values'. */
+int32_t packed_container_data_size(const uint16_t *values, int32_t cardinality);
+
+/* Create a packed container holding the `cardinality' sorted values of
+ * `values'. Return NULL in case of failure. */
+packed_container_t *packed_container_create_from_values(const uint16_t *values,
+                                                        int32_t cardinality);
+
+/* Free memory owned by `packed'. */
+void packed_container_free(packed_container_t *packed);
+
+/* Duplicate container */
+packed_container_t *packed_container_clone(const packed_container_t *src);
+
+/* Get the cardinality of `packed'. */
+static inline int packed_container_cardinality(
+    const packed_container_t *packed) {
+    return packed->cardinality;
+}
+
+static inline bool packed_container_nonzero_cardinality(
+    const packed_container_t *packed) {
+    return packed->cardinality > 0;
+}
+
+/* Returns the number of bytes allocated for the container, which is what it
+ * costs in memory. */
+int32_t packed_container_memory_size_in_bytes(const packed_container_t *packed);
+
+/* Writes the values of block `block' to `out', and returns how many there
+ * were. `out' must have room for PACKED_BLOCK_SIZE values. */
+int32_t packed_container_decode_block(const packed_container_t *packed,
+                                      int32_t block, uint16_t *out);
+
+/* Writes all the values of the container to `out', which must have room for
+ * its cardinality. */
+void packed_container_decode(const packed_container_t *packed, uint16_t *out);
+
+/* Check whether `pos' is present in `packed'. */
+bool packed_container_contains(const packed_container_t *packed, uint16_t pos);
+
+/* Returns the smallest value (assumes not empty) */
+static inline uint16_t packed_container_minimum(
+    const packed_container_t *packed) {
+    if (packed->cardinality == 0) return 0;
+    return packed_container_firsts(packed)[0];
+}
+
+/* Returns the largest value (assumes not empty) */
+uint16_t packed_container_maximum(const packed_container_t *packed);
+
+/* Returns the value of rank `index' (starting at zero, assumes it exists) */
+uint16_t packed_container_get(const packed_container_t *packed, int32_t index);
+
+/* Returns the number of values equal or smaller than x */
+int packed_container_rank(const packed_container_t *packed, uint16_t x);
+
+/* Returns the index of x, or -1 if it is not present */
+int packed_container_get_index(const packed_container_t *packed, uint16_t x);
+
+/* Returns the index of the first value equal or larger than x, or -1 */
+int packed_container_index_equalorlarger(const packed_container_t *packed,
+                                         uint16_t x);
+
+/* Check whether all values in range [range_start, range_end) are present */
+bool packed_container_contains_range(const packed_container_t *packed,
+                                     uint32_t range_start, uint32_t range_end);
+
+/* Bulk version of packed_container_rank (see array_container_rank_many);
+ * returns the number of consumed elements */
+uint32_t packed_container_rank_many(const packed_container_t *packed,
+                                    uint64_t start_rank, const uint32_t *begin,
+                                    const uint32_t *end, uint64_t *ans);
+
+/**
+ * If the element of given rank is in this container, supposing that the first
+ * element has rank start_rank, then the function returns true and sets element
+ * accordingly.
+ * Otherwise, it returns false and update start_rank.
+ */
+static inline bool packed_container_select(const packed_container_t *packed,
+                                           uint32_t *start_rank, uint32_t rank,
+                                           uint32_t *element) {
+    int card = packed_container_cardinality(packed);
+    if (*start_rank + card <= rank) {
+        *start_rank += card;
+        return false;
+    } else {
+        *element =
+            packed_container_get(packed, (int32_t)(rank - *start_rank));
+        return true;
+    }
+}
+
+/* Compute the number of runs */
+int32_t packed_container_number_of_runs(const packed_container_t *packed);
+
+/*
+ * Write out the 16-bit integers contained in this container as a list of 32-bit
+ * integers using base as the starting value. The function returns the number
+ * of values written. The caller is responsible for allocating enough memory in
+ * out.
+ */
+int packed_container_to_uint32_array(void *vout,
+                                     const packed_container_t *packed,
+                                     uint32_t base);
+
+bool packed_container_iterate(const packed_container_t *packed, uint32_t base,
+                              roaring_iterator iterator, void *ptr);
+bool packed_container_iterate64(const packed_container_t *packed,
+                                uint32_t base, roaring_iterator64 iterator,
+                                uint64_t high_bits, void *ptr);
+
+/*
+ * Print this container using printf (useful for debugging).
+ */
+void packed_container_printf(const packed_container_t *packed);
+
+/*
+ * Print this container using printf as a comma-separated list of 32-bit
+ * integers starting at base.
+ */
+void packed_container_printf_as_uint32_array(const packed_container_t *packed,
+                                             uint32_t base);
+
+bool packed_container_validate(const packed_container_t *packed,
+                               const char **reason);
+
+/**
+ * Packed containers are serialized as array containers, so that the
+ * serialized bitmaps stay compatible with the Java and Go versions of
+ * Roaring. This returns the serialized size in bytes (see
+ * array_container_size_in_bytes).
+ */
+static inline int32_t packed_container_size_in_bytes(
+    const packed_container_t *packed) {
+    return packed->cardinality * (int32_t)sizeof(uint16_t);
+}
+
+/**
+ * Writes the values to buf in the layout of array_container_write, outputs how
+ * many bytes were written.
+ */
+int32_t packed_container_write(const packed_container_t *packed, char *buf);
+
+/**
+ * Return true if the two containers have the same content.
+ */
+bool packed_container_equals(const packed_container_t *packed1,
+                             const packed_container_t *packed2);
+
+#ifdef __cplusplus
+}
+}
+}  // extern "C" { namespace roaring { namespace internal {
+#endif
+
+#endif /* INCLUDE_CONTAINERS_PACKED_H_ */
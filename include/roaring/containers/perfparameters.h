@@ -24,6 +24,19 @@ enum { RUN_DEFAULT_INIT_SIZE = 0 };
    setting it to zero delays the malloc */
 enum { ARRAY_DEFAULT_INIT_SIZE = 0 };
 
+/* the array/run operations walk the runs and gallop over the array, rather
+   than the other way around, when the array has at least this many values
+   per run */
+enum { ARRAY_RUN_GALLOP_RATIO = 16 };
+
+/* the array/bitset operations look up the array values sixteen at a time
+   with AVX-512 gathers when the array has at least this many values */
+enum { ARRAY_BITSET_GATHER_THRESHOLD = 64 };
+
+/* the run/bitset operations decode whole bitset words, rather than test the
+   values one by one, for runs of at least this many values */
+enum { RUN_BITSET_DECODE_THRESHOLD = 16 };
+
 /* automatic bitset conversion during lazy or */
 #ifndef LAZY_OR_BITSET_CONVERSION
 #define LAZY_OR_BITSET_CONVERSION true
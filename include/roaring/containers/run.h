@@ -54,14 +54,17 @@ typedef struct rle16_s rle16_t;
 
 /* struct run_container_s - run container bitmap
  *
- * @n_runs:   number of rle_t pairs in `runs`.
- * @capacity: capacity in rle_t pairs `runs` can hold.
- * @runs:     pairs of rle_t.
+ * @n_runs:      number of rle_t pairs in `runs`.
+ * @capacity:    capacity in rle_t pairs `runs` can hold.
+ * @runs:        pairs of rle_t.
+ * @cardinality: number of values in the runs, kept up to date by every
+ *               function that modifies them.
  */
 STRUCT_CONTAINER(run_container_s) {
     int32_t n_runs;
     int32_t capacity;
     rle16_t *runs;
+    int32_t cardinality;
 };
 
 typedef struct run_container_s run_container_t;
@@ -222,6 +225,7 @@ static inline bool run_container_remove(run_container_t *run, uint16_t pos) {
             run->runs[index].value++;
             run->runs[index].length--;
         }
+        run->cardinality--;
         return true;
     }
     index = -index - 2;  // points to preceding value, possibly -1
@@ -237,10 +241,12 @@ static inline bool run_container_remove(run_container_t *run, uint16_t pos) {
             makeRoomAtIndex(run, (uint16_t)(index + 1));
             run->runs[index + 1].value = newvalue;
             run->runs[index + 1].length = (uint16_t)newlength;
+            run->cardinality--;
             return true;
 
         } else if (offset == le) {
             run->runs[index].length--;
+            run->cardinality--;
             return true;
         }
     }
@@ -248,8 +254,23 @@ static inline bool run_container_remove(run_container_t *run, uint16_t pos) {
     return false;
 }
 
+#if CROARING_IS_X64
+/*
+ * Check whether `pos' is present in `run', narrowing the runs with a
+ * branchless search and testing the last register-wide block with SIMD.
+ * Requires AVX2 and at least 8 runs; AVX-512 is used when available.
+ */
+bool run_container_contains_vector(const run_container_t *run, uint16_t pos);
+#endif
+
 /* Check whether `pos' is present in `run'.  */
 inline bool run_container_contains(const run_container_t *run, uint16_t pos) {
+#if CROARING_IS_X64
+    if (run->n_runs >= 8 &&
+        (croaring_hardware_support() & ROARING_SUPPORTS_AVX2)) {
+        return run_container_contains_vector(run, pos);
+    }
+#endif
     int32_t index = interleavedBinarySearch(run->runs, run->n_runs, pos);
     if (index >= 0) return true;
     index = -index - 2;  // points to preceding value, possibly -1
@@ -261,6 +282,56 @@ inline bool run_container_contains(const run_container_t *run, uint16_t pos) {
     return false;
 }
 
+/*
+ * Returns the index of the first run in runs[pos, n_runs) that ends at or
+ * after `min', or n_runs if there is none, assuming that runs[pos] ends
+ * before `min'. It gallops over the runs and compares blocks of them with
+ * AVX2 or AVX-512 when available, so that skipping many runs is cheap.
+ */
+int32_t run_gallop_end(const rle16_t *runs, int32_t pos, int32_t n_runs,
+                       uint32_t min);
+
+/* Same as run_gallop_end, for the first run that starts at or after `min'. */
+int32_t run_gallop_start(const rle16_t *runs, int32_t pos, int32_t n_runs,
+                         uint32_t min);
+
+/*
+ * Skips runs of runs[pos, n_runs) that end before `min': when the run eight
+ * places ahead still ends before `min', returns the index of the first run
+ * that ends at or after it (or n_runs), and otherwise returns pos. The
+ * merges step through the runs one by one as usual, and call this in
+ * passing so that they gallop over long stretches of runs of one input that
+ * lie before the current run of the other. The probe is cheap and well
+ * predicted when the runs of both inputs interleave.
+ */
+static inline int32_t run_skip_until_end(const rle16_t *runs, int32_t pos,
+                                         int32_t n_runs, uint32_t min) {
+    if ((pos + 8 < n_runs) &&
+        ((uint32_t)runs[pos + 8].value + runs[pos + 8].length < min)) {
+        return run_gallop_end(runs, pos + 8, n_runs, min);
+    }
+    return pos;
+}
+
+/* Same as run_skip_until_end, with runs that start before `min'. */
+static inline int32_t run_skip_until_start(const rle16_t *runs, int32_t pos,
+                                           int32_t n_runs, uint32_t min) {
+    if ((pos + 8 < n_runs) && (runs[pos + 8].value < min)) {
+        return run_gallop_start(runs, pos + 8, n_runs, min);
+    }
+    return pos;
+}
+
+/*
+ * Tests the probes vals[begin, end) against the container, considering only
+ * the low 16 bits of each value, and sets bit i of out_bits for every probe
+ * vals[i] that is present. Other bits are left alone. Ascending probes are
+ * answered with a single forward pass over the container.
+ */
+void run_container_contains_many(const run_container_t *run,
+                                 const uint32_t *vals, size_t begin, size_t end,
+                                 uint64_t *out_bits);
+
 /*
  * Check whether all positions in a range of positions from pos_start (included)
  * to pos_end (excluded) is present in `run'.
@@ -293,8 +364,14 @@ static inline bool run_container_contains_range(const run_container_t *run,
     return count >= (pos_end - pos_start - 1);
 }
 
-/* Get the cardinality of `run'. Requires an actual computation. */
-int run_container_cardinality(const run_container_t *run);
+/* Get the cardinality of `run'. */
+inline int run_container_cardinality(const run_container_t *run) {
+    return run->cardinality;
+}
+
+/* Sum the lengths of the runs of `run'. Functions that write the runs
+ * directly set the cardinality with this. */
+int run_container_compute_cardinality(const run_container_t *run);
 
 /* Card > 0?, see run_container_empty for the reverse */
 static inline bool run_container_nonzero_cardinality(
@@ -326,10 +403,12 @@ static inline void run_container_append(run_container_t *run, rle16_t vl,
     if (vl.value > previousend + 1) {  // we add a new one
         run->runs[run->n_runs] = vl;
         run->n_runs++;
+        run->cardinality += vl.length + 1;
         *previousrl = vl;
     } else {
         uint32_t newend = vl.value + vl.length + UINT32_C(1);
-        if (newend > previousend) {  // we merge
+        if (newend > previousend + 1) {  // we merge
+            run->cardinality += newend - previousend - 1;
             previousrl->length = (uint16_t)(newend - 1 - previousrl->value);
             run->runs[run->n_runs - 1] = *previousrl;
         }
@@ -343,6 +422,7 @@ static inline rle16_t run_container_append_first(run_container_t *run,
                                                  rle16_t vl) {
     run->runs[run->n_runs] = vl;
     run->n_runs++;
+    run->cardinality += vl.length + 1;
     return vl;
 }
 
@@ -363,9 +443,11 @@ static inline void run_container_append_value(run_container_t *run,
         *previousrl = MAKE_RLE16(val, 0);
         run->runs[run->n_runs] = *previousrl;
         run->n_runs++;
+        run->cardinality++;
     } else if (val == previousend + 1) {  // we merge
         previousrl->length++;
         run->runs[run->n_runs - 1] = *previousrl;
+        run->cardinality++;
     }
 }
 
@@ -378,6 +460,7 @@ static inline rle16_t run_container_append_value_first(run_container_t *run,
     rle16_t newrle = MAKE_RLE16(val, 0);
     run->runs[run->n_runs] = newrle;
     run->n_runs++;
+    run->cardinality++;
     return newrle;
 }
 
@@ -605,6 +688,7 @@ static inline void run_container_add_range_nruns(run_container_t *run,
         makeRoomAtIndex(run, (uint16_t)nruns_less);
         run->runs[nruns_less].value = (uint16_t)min;
         run->runs[nruns_less].length = (uint16_t)(max - min);
+        run->cardinality += max - min + 1;
     } else {
         uint32_t common_min = run->runs[nruns_less].value;
         uint32_t common_max = run->runs[nruns_less + nruns_common - 1].value +
@@ -612,6 +696,12 @@ static inline void run_container_add_range_nruns(run_container_t *run,
         uint32_t result_min = (common_min < min) ? common_min : min;
         uint32_t result_max = (common_max > max) ? common_max : max;
 
+        // the common runs merge into [result_min, result_max]
+        run->cardinality += result_max - result_min + 1;
+        for (int32_t i = nruns_less; i < nruns_less + nruns_common; i++) {
+            run->cardinality -= run->runs[i].length + 1;
+        }
+
         run->runs[nruns_less].value = (uint16_t)result_min;
         run->runs[nruns_less].length = (uint16_t)(result_max - result_min);
 
@@ -660,6 +750,16 @@ static inline void run_container_remove_range(run_container_t *run,
     int32_t first = rle16_find_run(run->runs, run->n_runs, (uint16_t)min);
     int32_t last = rle16_find_run(run->runs, run->n_runs, (uint16_t)max);
 
+    // count the values removed from the runs that overlap [min, max]
+    const int32_t overlap_end = (last >= 0) ? last : -last - 2;
+    for (int32_t i = (first >= 0) ? first : -first - 1; i <= overlap_end;
+         i++) {
+        const uint32_t start = run->runs[i].value;
+        const uint32_t end = start + run->runs[i].length;
+        run->cardinality -=
+            ((end < max) ? end : max) - ((start > min) ? start : min) + 1;
+    }
+
     if (first >= 0 && min > run->runs[first].value &&
         max < ((uint32_t)run->runs[first].value +
                (uint32_t)run->runs[first].length)) {
@@ -250,6 +250,13 @@ inline int roaring_leading_zeroes(unsigned long long input_num) {
 #define CROARING_WARN_UNUSED
 #endif
 
+// Hint that the memory at p will soon be read.
+#if defined(__GNUC__) || defined(__clang__)
+#define croaring_prefetch(p) __builtin_prefetch(p)
+#else
+#define croaring_prefetch(p) ((void)(p))
+#endif
+
 #define IS_BIG_ENDIAN (*(uint16_t *)"\0\xff" < 0x100)
 
 #ifdef CROARING_USENEON
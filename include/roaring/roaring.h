@@ -92,6 +92,29 @@ inline void roaring_bitmap_set_copy_on_write(roaring_bitmap_t *r, bool cow) {
     }
 }
 
+/**
+ * Maintains an 8 KiB summary of the 16-bit high keys in use. With it,
+ * `roaring_bitmap_contains` rejects values whose high bits are absent without
+ * searching, and pairwise intersections and differences between two bitmaps
+ * that both have a summary skip regions where their keys do not overlap.
+ *
+ * The summary is kept up to date as the bitmap is modified. It is not carried
+ * over to copies or to the results of operations, and roaring_bitmap_clear
+ * releases it. Frozen bitmaps cannot have one. Returns false if the summary
+ * cannot be allocated.
+ */
+bool roaring_bitmap_enable_key_summary(roaring_bitmap_t *r);
+
+/**
+ * Releases the summary set up by `roaring_bitmap_enable_key_summary`.
+ */
+void roaring_bitmap_disable_key_summary(roaring_bitmap_t *r);
+
+/**
+ * Whether the bitmap maintains a summary of its high keys.
+ */
+bool roaring_bitmap_has_key_summary(const roaring_bitmap_t *r);
+
 roaring_bitmap_t *roaring_bitmap_add_offset(const roaring_bitmap_t *bm,
                                             int64_t offset);
 /**
@@ -454,6 +477,19 @@ bool roaring_bitmap_contains_bulk(const roaring_bitmap_t *r,
                                   roaring_bulk_context_t *context,
                                   uint32_t val);
 
+/**
+ * Tests the n values in `vals` for membership: bit i of `out_bits` (bit
+ * i % 64 of word i / 64) is set if `vals[i]` is in the bitmap and cleared
+ * otherwise. `out_bits` must hold at least (n + 63) / 64 words.
+ *
+ * Probes sharing the same high 16 bits are answered together, so this is
+ * much faster than calling `roaring_bitmap_contains` in a loop when the
+ * values are sorted or nearly sorted. Any order is accepted.
+ */
+void roaring_bitmap_contains_many(const roaring_bitmap_t *r,
+                                  const uint32_t *vals, size_t n,
+                                  uint64_t *out_bits);
+
 /**
  * Get the cardinality of the bitmap (number of elements).
  */
@@ -505,6 +541,29 @@ void roaring_bitmap_to_uint32_array(const roaring_bitmap_t *r, uint32_t *ans);
  */
 bool roaring_bitmap_to_bitset(const roaring_bitmap_t *r, bitset_t *bitset);
 
+/**
+ * Create a bitmap holding the set bits of a bitset. The bitset is processed in
+ * chunks of 65536 bits, and each chunk becomes an array, bitset or run
+ * container, whichever is smallest. Bits at positions 2^32 and above are
+ * ignored. Returns NULL if memory cannot be allocated.
+ *
+ * The caller is responsible for freeing the result.
+ */
+roaring_bitmap_t *roaring_bitmap_from_bitset(const bitset_t *bitset);
+
+/**
+ * Write the values of the bitmap that are in [lo, hi) to `out` as a dense
+ * bitset: bit (x - lo) of `out` is set iff x is in the bitmap. `hi` is capped
+ * at 2^32. The window is written in full, including the zero bits, so `out`
+ * needs room for (hi - lo + 63) / 64 words; the bits past hi in the last word
+ * are cleared. Nothing is written if lo >= hi.
+ *
+ * This is meant for exporting a slice of a bitmap, e.g. as the validity bitmap
+ * of a column.
+ */
+void roaring_bitmap_to_dense(const roaring_bitmap_t *r, uint64_t lo,
+                             uint64_t hi, uint64_t *out);
+
 /**
  * Convert the bitmap to a sorted array from `offset` by `limit`, output in
  * `ans`.
@@ -533,6 +592,22 @@ bool roaring_bitmap_remove_run_compression(roaring_bitmap_t *r);
  */
 bool roaring_bitmap_run_optimize(roaring_bitmap_t *r);
 
+/**
+ * Convert array containers to packed containers when it takes less memory.
+ * A packed container stores the gaps between consecutive values, bit-packed
+ * by blocks of 32 values, so that clustered sparse chunks take a fraction of
+ * the two bytes per value of an array container.
+ *
+ * Packed containers are meant for bitmaps that are built once and then
+ * queried: membership, rank, select and iteration work on them directly,
+ * while the other operations decode them first. Modifying a bitmap turns the
+ * packed containers involved back into array containers. The serialized
+ * formats are not affected: packed containers are written as arrays.
+ *
+ * Returns true if the result has at least one packed container.
+ */
+bool roaring_bitmap_pack_optimize(roaring_bitmap_t *r);
+
 /**
  * If needed, reallocate memory to shrink the memory usage.
  * Returns the number of bytes saved.
@@ -762,6 +837,39 @@ bool roaring_iterate(const roaring_bitmap_t *r, roaring_iterator iterator,
 bool roaring_iterate64(const roaring_bitmap_t *r, roaring_iterator64 iterator,
                        uint64_t high_bits, void *ptr);
 
+/**
+ * (For advanced users.)
+ *
+ * Visit the containers of the bitmap in increasing key order. The function
+ * `visitor` is called once per container with a view on its payload (see
+ * roaring_types.h for a description of roaring_container_view_t) and with ptr
+ * (can be NULL) as the second parameter. Nothing is copied, so this is a cheap
+ * way to feed the native container layouts to vectorized code. It works on
+ * frozen views as well.
+ *
+ * Returns true if `visitor` returned true throughout (so that all containers
+ * were necessarily visited).
+ */
+bool roaring_iterate_containers(const roaring_bitmap_t *r,
+                                roaring_container_visitor visitor, void *ptr);
+
+/**
+ * (For advanced users.)
+ *
+ * Returns the number of containers in the bitmap.
+ */
+uint32_t roaring_bitmap_container_count(const roaring_bitmap_t *r);
+
+/**
+ * (For advanced users.)
+ *
+ * Fills `view` with a description of the i-th container of the bitmap, in
+ * increasing key order. Returns false if `i` is not smaller than
+ * `roaring_bitmap_container_count(r)`.
+ */
+bool roaring_bitmap_container_view(const roaring_bitmap_t *r, uint32_t i,
+                                   roaring_container_view_t *view);
+
 /**
  * Return true if the two bitmaps contain the same elements.
  */
@@ -1106,6 +1214,174 @@ CROARING_DEPRECATED static inline uint32_t roaring_read_uint32_iterator(
     return roaring_uint32_iterator_read(it, buf, count);
 }
 
+/*********************
+* What follows are lazy iterators over the result of a set operation between
+* several bitmaps. The result is never materialized: containers sharing the
+* same key are merged one key at a time into scratch buffers owned by the
+* iterator, so memory usage stays bounded by a few containers.
+
+const roaring_bitmap_t *inputs[3] = {r1, r2, r3};
+roaring_many_iterator_t *it = roaring_or_many_iterator_create(3, inputs);
+while (roaring_many_iterator_has_value(it)) {
+  printf("value = %d\n", roaring_many_iterator_value(it));
+  roaring_many_iterator_advance(it);
+}
+roaring_many_iterator_free(it);
+
+The input bitmaps must outlive the iterator and must not be modified while
+it is in use.
+*/
+
+typedef struct roaring_many_iterator_s roaring_many_iterator_t;
+
+/**
+ * Create an iterator over the union of `number` bitmaps. Caller is
+ * responsible for calling `roaring_many_iterator_free()`. Returns NULL in case
+ * of allocation failure.
+ *
+ * If there is a value, then the iterator points to the first value and
+ * `roaring_many_iterator_has_value()` returns true.
+ */
+roaring_many_iterator_t *roaring_or_many_iterator_create(
+    size_t number, const roaring_bitmap_t **x);
+
+/**
+ * Create an iterator over the intersection of `number` bitmaps, see
+ * `roaring_or_many_iterator_create()`.
+ */
+roaring_many_iterator_t *roaring_and_many_iterator_create(
+    size_t number, const roaring_bitmap_t **x);
+
+/**
+ * Create an iterator over the symmetric difference of `number` bitmaps (the
+ * values present in an odd number of inputs), see
+ * `roaring_or_many_iterator_create()`.
+ */
+roaring_many_iterator_t *roaring_xor_many_iterator_create(
+    size_t number, const roaring_bitmap_t **x);
+
+/**
+ * Create an iterator over the values of `x[0]` that are present in none of
+ * `x[1]`, ..., `x[number - 1]`, see `roaring_or_many_iterator_create()`.
+ */
+roaring_many_iterator_t *roaring_andnot_many_iterator_create(
+    size_t number, const roaring_bitmap_t **x);
+
+/**
+ * Free the iterator and its scratch buffers. Does nothing if `it` is NULL.
+ */
+void roaring_many_iterator_free(roaring_many_iterator_t *it);
+
+/**
+ * Returns true if the iterator currently points to a value. If so, calling
+ * `roaring_many_iterator_value()` returns the value.
+ */
+bool roaring_many_iterator_has_value(const roaring_many_iterator_t *it);
+
+/**
+ * Returns the value the iterator currently points to. Should only be called if
+ * `roaring_many_iterator_has_value()` returns true.
+ */
+uint32_t roaring_many_iterator_value(const roaring_many_iterator_t *it);
+
+/**
+ * Advance the iterator. Values are traversed in increasing order. For
+ * convenience, returns the result of `roaring_many_iterator_has_value()`.
+ *
+ * Once this returns false, `roaring_many_iterator_advance` should not be called
+ * on the iterator again.
+ */
+bool roaring_many_iterator_advance(roaring_many_iterator_t *it);
+
+/**
+ * Move the iterator to the first value greater than or equal to `val`, if it
+ * exists at or after the current position of the iterator. For convenience,
+ * returns the result of `roaring_many_iterator_has_value()`.
+ */
+bool roaring_many_iterator_move_equalorlarger(roaring_many_iterator_t *it,
+                                              uint32_t val);
+
+/**
+ * Reads up to `count` values from the iterator into the given `buf`. Returns
+ * the number of elements read. The number of elements read can be smaller than
+ * `count`, which means that the iterator is drained.
+ *
+ * This function can be used together with other iterator functions.
+ */
+uint32_t roaring_many_iterator_read(roaring_many_iterator_t *it, uint32_t *buf,
+                                    uint32_t count);
+
+/*********************
+* What follows is code used to iterate through the maximal ranges of
+* consecutive values of a bitmap, rather than through individual values. Runs
+* of values are reported in one step regardless of their length, including
+* runs spanning several containers.
+
+roaring_range_iterator_t *it = roaring_range_iterator_create(r);
+while (roaring_range_iterator_has_value(it)) {
+  printf("[%u, %u]\n", roaring_range_iterator_start(it),
+         roaring_range_iterator_end(it));
+  roaring_range_iterator_advance(it);
+}
+roaring_range_iterator_free(it);
+*/
+
+typedef struct roaring_range_iterator_s roaring_range_iterator_t;
+
+/**
+ * Create an iterator object that can be used to iterate through the ranges of
+ * consecutive values. Caller is responsible for calling
+ * `roaring_range_iterator_free()`. Returns NULL in case of allocation failure.
+ *
+ * If there is a range, then the iterator points to the first range and
+ * `roaring_range_iterator_has_value()` returns true.
+ */
+roaring_range_iterator_t *roaring_range_iterator_create(
+    const roaring_bitmap_t *r);
+
+/**
+ * Free memory following `roaring_range_iterator_create()`.
+ */
+void roaring_range_iterator_free(roaring_range_iterator_t *it);
+
+/**
+ * Returns true if the iterator currently points to a range.
+ */
+bool roaring_range_iterator_has_value(const roaring_range_iterator_t *it);
+
+/**
+ * Returns the smallest value of the current range. Should only be called if
+ * `roaring_range_iterator_has_value()` returns true.
+ */
+uint32_t roaring_range_iterator_start(const roaring_range_iterator_t *it);
+
+/**
+ * Returns the largest value of the current range (the range is closed). Should
+ * only be called if `roaring_range_iterator_has_value()` returns true.
+ */
+uint32_t roaring_range_iterator_end(const roaring_range_iterator_t *it);
+
+/**
+ * Advance the iterator to the next range. Ranges are traversed in increasing
+ * order, and two consecutive ranges are separated by at least one value absent
+ * from the bitmap. For convenience, returns the result of
+ * `roaring_range_iterator_has_value()`.
+ */
+bool roaring_range_iterator_advance(roaring_range_iterator_t *it);
+
+/**
+ * Write the maximal ranges of consecutive values of the bitmap to `out` as
+ * closed intervals: `out[2 * i]` is the start and `out[2 * i + 1]` is the end
+ * of the i-th range. At most `capacity` ranges are written, so `out` must have
+ * room for `2 * capacity` values.
+ *
+ * Returns the total number of ranges in the bitmap, which can exceed
+ * `capacity`. Calling with a capacity of zero (and `out` possibly NULL)
+ * returns the size to allocate.
+ */
+size_t roaring_bitmap_to_ranges(const roaring_bitmap_t *r, uint32_t *out,
+                                size_t capacity);
+
 #ifdef __cplusplus
 }
 }
@@ -48,7 +48,8 @@ void roaring64_bitmap_free(roaring64_bitmap_t *r);
 roaring64_bitmap_t *roaring64_bitmap_copy(const roaring64_bitmap_t *r);
 
 /**
- * Creates a new bitmap of a pointer to N 64-bit integers.
+ * Creates a new bitmap of a pointer to N 64-bit integers. Sorted input is
+ * loaded faster.
  */
 roaring64_bitmap_t *roaring64_bitmap_of_ptr(size_t n_args,
                                             const uint64_t *vals);
@@ -133,7 +134,8 @@ void roaring64_bitmap_add_bulk(roaring64_bitmap_t *r,
  *
  * In order to exploit this optimization, the caller should attempt to keep
  * values with the same high 48 bits of the value as consecutive elements in
- * `vals`.
+ * `vals`. When the bitmap is empty and `vals` is sorted, the bitmap is built
+ * in bulk, which is faster still (see also `roaring64_bitmap_of_ptr`).
  */
 void roaring64_bitmap_add_many(roaring64_bitmap_t *r, size_t n_args,
                                const uint64_t *vals);
@@ -292,6 +294,16 @@ uint64_t roaring64_bitmap_maximum(const roaring64_bitmap_t *r);
  */
 bool roaring64_bitmap_run_optimize(roaring64_bitmap_t *r);
 
+/**
+ * (For advanced users.)
+ *
+ * Collect statistics about the bitmap, see roaring_types.h for a description
+ * of roaring64_statistics_t. This walks the ART and the leaves once, without
+ * iterating over the values, so it is cheap enough to call periodically.
+ */
+void roaring64_bitmap_statistics(const roaring64_bitmap_t *r,
+                                 roaring64_statistics_t *stat);
+
 /**
  * Perform internal consistency checks.
  *
@@ -353,6 +365,15 @@ uint64_t roaring64_bitmap_and_cardinality(const roaring64_bitmap_t *r1,
 void roaring64_bitmap_and_inplace(roaring64_bitmap_t *r1,
                                   const roaring64_bitmap_t *r2);
 
+/**
+ * Computes the intersection of `number` bitmaps and returns a new bitmap. All
+ * the bitmaps are walked at once, and each of them skips directly to the
+ * largest key reached by the others. The caller is responsible for free-ing
+ * the result.
+ */
+roaring64_bitmap_t *roaring64_bitmap_and_many(size_t number,
+                                              const roaring64_bitmap_t **rs);
+
 /**
  * Check whether two bitmaps intersect.
  */
@@ -393,6 +414,15 @@ uint64_t roaring64_bitmap_or_cardinality(const roaring64_bitmap_t *r1,
 void roaring64_bitmap_or_inplace(roaring64_bitmap_t *r1,
                                  const roaring64_bitmap_t *r2);
 
+/**
+ * Computes the union of `number` bitmaps and returns a new bitmap. The bitmaps
+ * are merged at once, in the order of their keys, and the containers sharing
+ * a key are unioned lazily. This is faster than computing the union two by
+ * two. The caller is responsible for free-ing the result.
+ */
+roaring64_bitmap_t *roaring64_bitmap_or_many(size_t number,
+                                             const roaring64_bitmap_t **rs);
+
 /**
  * Computes the symmetric difference (xor) between two bitmaps and returns a new
  * bitmap. The caller is responsible for free-ing the result.
@@ -413,6 +443,80 @@ uint64_t roaring64_bitmap_xor_cardinality(const roaring64_bitmap_t *r1,
 void roaring64_bitmap_xor_inplace(roaring64_bitmap_t *r1,
                                   const roaring64_bitmap_t *r2);
 
+/**
+ * Computes the symmetric difference (xor) of `number` bitmaps and returns a
+ * new bitmap, see `roaring64_bitmap_or_many()`. The caller is responsible for
+ * free-ing the result.
+ */
+roaring64_bitmap_t *roaring64_bitmap_xor_many(size_t number,
+                                              const roaring64_bitmap_t **rs);
+
+/**
+ * (For expert users who seek high performance.)
+ *
+ * Computes the union between two bitmaps and returns a new bitmap. The caller
+ * is responsible for free-ing the result.
+ *
+ * The lazy version defers some computations such as the maintenance of the
+ * cardinality counts. Thus you must call `roaring64_bitmap_repair_after_lazy()`
+ * after executing "lazy" computations.
+ *
+ * It is safe to repeatedly call `roaring64_bitmap_lazy_or_inplace()` on the
+ * result.
+ *
+ * `bitsetconversion` is a flag which determines whether container-container
+ * operations force a bitset conversion.
+ */
+roaring64_bitmap_t *roaring64_bitmap_lazy_or(const roaring64_bitmap_t *r1,
+                                             const roaring64_bitmap_t *r2,
+                                             bool bitsetconversion);
+
+/**
+ * (For expert users who seek high performance.)
+ *
+ * In-place version of `roaring64_bitmap_lazy_or()`, modifies `r1`.
+ *
+ * `bitsetconversion` is a flag which determines whether container-container
+ * operations force a bitset conversion.
+ */
+void roaring64_bitmap_lazy_or_inplace(roaring64_bitmap_t *r1,
+                                      const roaring64_bitmap_t *r2,
+                                      bool bitsetconversion);
+
+/**
+ * (For expert users who seek high performance.)
+ *
+ * Computes the symmetric difference (xor) between two bitmaps and returns a
+ * new bitmap. The caller is responsible for free-ing the result.
+ *
+ * The lazy version defers some computations such as the maintenance of the
+ * cardinality counts. Thus you must call `roaring64_bitmap_repair_after_lazy()`
+ * after executing "lazy" computations.
+ *
+ * It is safe to repeatedly call `roaring64_bitmap_lazy_xor_inplace()` on the
+ * result.
+ */
+roaring64_bitmap_t *roaring64_bitmap_lazy_xor(const roaring64_bitmap_t *r1,
+                                              const roaring64_bitmap_t *r2);
+
+/**
+ * (For expert users who seek high performance.)
+ *
+ * In-place version of `roaring64_bitmap_lazy_xor()`, modifies `r1`. `r1` and
+ * `r2` are not allowed to be equal.
+ */
+void roaring64_bitmap_lazy_xor_inplace(roaring64_bitmap_t *r1,
+                                       const roaring64_bitmap_t *r2);
+
+/**
+ * (For expert users who seek high performance.)
+ *
+ * Execute maintenance on a bitmap created or modified by the
+ * `roaring64_bitmap_lazy_*()` functions. Until then, the bitmap must only be
+ * passed to other lazy functions.
+ */
+void roaring64_bitmap_repair_after_lazy(roaring64_bitmap_t *r);
+
 /**
  * Computes the difference (andnot) between two bitmaps and returns a new
  * bitmap. The caller is responsible for free-ing the result.
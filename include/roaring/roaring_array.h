@@ -81,6 +81,50 @@ inline int32_t ra_get_index(const roaring_array_t *ra, uint16_t x) {
     return binarySearch(ra->keys, (int32_t)ra->size, x);
 }
 
+/**
+ * Returns false when the key summary (if any) shows that x is not a key of
+ * the array. A true result means that the key may be present.
+ */
+inline bool ra_may_contain_key(const roaring_array_t *ra, uint16_t x) {
+    return ra->key_summary == NULL ||
+           (ra->key_summary[x >> 6] & (UINT64_C(1) << (x & 63))) != 0;
+}
+
+/**
+ * Records x in the key summary, if there is one.
+ */
+inline void ra_summary_add_key(roaring_array_t *ra, uint16_t x) {
+    if (ra->key_summary != NULL) {
+        ra->key_summary[x >> 6] |= UINT64_C(1) << (x & 63);
+    }
+}
+
+/**
+ * Removes x from the key summary, if there is one. In-place rewrites that
+ * drop keys must call this for each of them (see ra_downsize).
+ */
+inline void ra_summary_remove_key(roaring_array_t *ra, uint16_t x) {
+    if (ra->key_summary != NULL) {
+        ra->key_summary[x >> 6] &= ~(UINT64_C(1) << (x & 63));
+    }
+}
+
+/**
+ * Allocates and fills the key summary. Returns false if memory allocation
+ * fails. Does nothing if the summary is already enabled.
+ */
+bool ra_enable_key_summary(roaring_array_t *ra);
+
+/**
+ * Frees the key summary, if any.
+ */
+void ra_disable_key_summary(roaring_array_t *ra);
+
+/**
+ * Recomputes the key summary from the keys, clearing stale bits.
+ */
+void ra_rebuild_key_summary(roaring_array_t *ra);
+
 /**
  * Retrieves the container at index i, filling in the typecode
  */
@@ -183,6 +227,26 @@ static inline int32_t ra_advance_until(const roaring_array_t *ra, uint16_t x,
 
 int32_t ra_advance_until_freeing(roaring_array_t *ra, uint16_t x, int32_t pos);
 
+/**
+ * Finds the keys shared by ra1 and ra2, starting from *pos1 and *pos2. The
+ * positions of up to `capacity` matching keys are written, in increasing
+ * order, to index1 (in ra1) and index2 (in ra2), and the cursors are
+ * advanced so that the next call resumes after them. Returns the number of
+ * matches; zero means that no further key is shared. Capacity must be at
+ * least 8. When both arrays have a key summary, regions without common keys
+ * are skipped a word (64 keys) at a time. Skewed inputs are galloped, others
+ * go through a SIMD merge when the hardware supports it.
+ */
+int32_t ra_intersect_keys(const roaring_array_t *ra1, int32_t *pos1,
+                          const roaring_array_t *ra2, int32_t *pos2,
+                          uint16_t *index1, uint16_t *index2,
+                          int32_t capacity);
+
+/**
+ * Truncates the array to its first new_length entries. The entries cut off
+ * are left over from an in-place rewrite, and their keys stay in the key
+ * summary: the rewrite removes the keys it drops with ra_summary_remove_key.
+ */
 void ra_downsize(roaring_array_t *ra, int32_t new_length);
 
 inline void ra_replace_key_and_container_at_index(roaring_array_t *ra,
@@ -192,6 +256,7 @@ inline void ra_replace_key_and_container_at_index(roaring_array_t *ra,
     assert(i < ra->size);
 
     ra->keys[i] = key;
+    ra_summary_add_key(ra, key);
     ra->containers[i] = c;
     ra->typecodes[i] = typecode;
 }
@@ -267,6 +332,7 @@ void ra_remove_at_index(roaring_array_t *ra, int32_t i);
 
 /**
  * clears all containers, sets the size at 0 and shrinks the memory usage.
+ * The key summary, if any, is released.
  */
 void ra_reset(roaring_array_t *ra);
 
@@ -292,7 +358,8 @@ void ra_copy_range(roaring_array_t *ra, uint32_t begin, uint32_t end,
  * to the right (distance > 0).
  * Allocates memory if necessary.
  * This function doesn't free or create new containers.
- * Caller is responsible for that.
+ * Caller is responsible for that, and for removing the keys it drops from
+ * the key summary.
  */
 void ra_shift_tail(roaring_array_t *ra, int32_t count, int32_t distance);
 
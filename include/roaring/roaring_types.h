@@ -55,6 +55,10 @@ typedef struct roaring_array_s {
     uint16_t *keys;
     uint8_t *typecodes;
     uint8_t flags;
+    // Optional 65536-bit summary of the keys in use (NULL when disabled).
+    // Every key present has its bit set; stale bits may remain set while
+    // the array is being rewritten in place.
+    uint64_t *key_summary;
 } roaring_array_t;
 
 typedef bool (*roaring_iterator)(uint32_t value, void *param);
@@ -97,6 +101,95 @@ typedef struct roaring_statistics_s {
     // and n_values_arrays, n_values_rle, n_values_bitmap
 } roaring_statistics_t;
 
+/**
+ *  (For advanced users.)
+ * The roaring64_statistics_t can be used to collect detailed statistics about
+ * the composition of a 64-bit roaring bitmap, and about its memory usage.
+ */
+typedef struct roaring64_statistics_s {
+    uint64_t n_containers; /* number of containers, one per leaf of the ART */
+
+    uint64_t n_array_containers;  /* number of array containers */
+    uint64_t n_run_containers;    /* number of run containers */
+    uint64_t n_bitset_containers; /* number of bitmap containers */
+
+    uint64_t
+        n_values_array_containers;    /* number of values in array containers */
+    uint64_t n_values_run_containers; /* number of values in run containers */
+    uint64_t
+        n_values_bitset_containers; /* number of values in bitmap containers */
+
+    uint64_t n_bytes_array_containers;  /* number of serialized bytes in array
+                                           containers */
+    uint64_t n_bytes_run_containers;    /* number of serialized bytes in run
+                                           containers */
+    uint64_t n_bytes_bitset_containers; /* number of serialized bytes in
+                                           bitmap containers */
+
+    uint64_t n_art_node4; /* number of inner nodes of the ART by type */
+    uint64_t n_art_node16;
+    uint64_t n_art_node48;
+    uint64_t n_art_node256;
+
+    uint64_t n_bytes_art;        /* number of allocated bytes for the ART */
+    uint64_t n_bytes_leaves;     /* number of allocated bytes for the leaves */
+    uint64_t n_bytes_containers; /* number of allocated bytes for the
+                                    containers */
+    uint64_t n_bytes_total;      /* number of allocated bytes for the bitmap,
+                                    the sum of the above and of the bitmap
+                                    itself, without allocator overhead */
+
+    uint64_t
+        max_value; /* the maximal value, undefined if cardinality is zero */
+    uint64_t
+        min_value; /* the minimal value, undefined if cardinality is zero */
+
+    uint64_t cardinality; /* total number of values stored in the bitmap */
+} roaring64_statistics_t;
+
+/**
+ * (For advanced users.)
+ * Container kinds reported in roaring_container_view_t.
+ */
+#define ROARING_CONTAINER_TYPE_BITSET UINT8_C(1)
+#define ROARING_CONTAINER_TYPE_ARRAY UINT8_C(2)
+#define ROARING_CONTAINER_TYPE_RUN UINT8_C(3)
+#define ROARING_CONTAINER_TYPE_PACKED UINT8_C(5)
+
+/**
+ * (For advanced users.)
+ * The roaring_container_view_t gives read-only access to the native payload
+ * of one container of a bitmap, without copying it. The layout of `data`
+ * depends on `typecode`:
+ *
+ * - ROARING_CONTAINER_TYPE_ARRAY: `length` sorted uint16_t values.
+ * - ROARING_CONTAINER_TYPE_BITSET: `length` (1024) uint64_t words, the value
+ *   v being present if bit (v % 64) of word (v / 64) is set.
+ * - ROARING_CONTAINER_TYPE_RUN: `length` sorted runs, each made of two
+ *   uint16_t: a start value followed by the run length minus one.
+ * - ROARING_CONTAINER_TYPE_PACKED (see roaring_bitmap_pack_optimize): `length`
+ *   bytes. With n = (cardinality + 31) / 32 blocks of 32 values, they hold the
+ *   first value of each block (n uint16_t), the byte offset of the gaps of
+ *   each block (n uint16_t), the bit width of the gaps of each block
+ *   (n uint8_t), then the gaps. The gaps of a block are the differences minus
+ *   one between its consecutive values, packed least significant bit first
+ *   at the width of the block.
+ *
+ * The values of the container are `(key << 16) | low` for each low 16-bit
+ * value described by the payload. The view is valid as long as the bitmap is
+ * not modified or freed.
+ */
+typedef struct roaring_container_view_s {
+    uint16_t key;        /* high 16 bits shared by the container values */
+    uint8_t typecode;    /* one of the ROARING_CONTAINER_TYPE_* values */
+    int32_t cardinality; /* number of values in the container */
+    int32_t length;      /* number of entries in `data` */
+    const void *data;    /* payload, see above */
+} roaring_container_view_t;
+
+typedef bool (*roaring_container_visitor)(const roaring_container_view_t *view,
+                                          void *param);
+
 /**
  * Roaring-internal type used to iterate within a roaring container.
  */
@@ -183,6 +183,39 @@ struct random_access {
 auto RandomAccess = BasicBench<random_access>;
 BENCHMARK(RandomAccess);
 
+struct random_access_many {
+    static uint64_t run() {
+        uint64_t marker = 0;
+        const uint32_t probes[3] = {maxvalue / 4, maxvalue / 2,
+                                    3 * maxvalue / 4};
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t bits;
+            roaring_bitmap_contains_many(bitmaps[i], probes, 3, &bits);
+            marker += (bits & 1) + ((bits >> 1) & 1) + ((bits >> 2) & 1);
+        }
+        return marker;
+    }
+};
+auto RandomAccessMany = BasicBench<random_access_many>;
+BENCHMARK(RandomAccessMany);
+
+// Probes spread over the whole range, so that most lookups search inside
+// array and run containers rather than hitting the same few values.
+struct random_access_spread {
+    static uint64_t run() {
+        uint64_t marker = 0;
+        for (size_t i = 0; i < count; ++i) {
+            for (uint32_t k = 1; k < 64; ++k) {
+                marker += roaring_bitmap_contains(
+                    bitmaps[i], (uint32_t)((uint64_t)maxvalue * k / 64));
+            }
+        }
+        return marker;
+    }
+};
+auto RandomAccessSpread = BasicBench<random_access_spread>;
+BENCHMARK(RandomAccessSpread);
+
 struct random_access64 {
     static uint64_t run() {
         uint64_t marker = 0;
@@ -197,6 +230,23 @@ struct random_access64 {
 auto RandomAccess64 = BasicBench<random_access64>;
 BENCHMARK(RandomAccess64);
 
+// Spread probes walk down many different paths of the ART, and so mostly
+// measure the key search within inner nodes.
+struct random_access_spread64 {
+    static uint64_t run() {
+        uint64_t marker = 0;
+        for (size_t i = 0; i < count; ++i) {
+            for (uint64_t k = 1; k < 64; ++k) {
+                marker += roaring64_bitmap_contains(
+                    bitmaps64[i], (uint64_t)maxvalue * k / 64);
+            }
+        }
+        return marker;
+    }
+};
+auto RandomAccessSpread64 = BasicBench<random_access_spread64>;
+BENCHMARK(RandomAccessSpread64);
+
 struct random_access64_cpp {
     static uint64_t run() {
         uint64_t marker = 0;
@@ -649,6 +649,71 @@ int32_t intersect_vector16_cardinality(const uint16_t *__restrict__ A,
 }
 CROARING_UNTARGET_AVX2
 
+CROARING_TARGET_AVX2
+int32_t match_vector16(const uint16_t *__restrict__ A, size_t s_a,
+                       size_t *i_a, const uint16_t *__restrict__ B, size_t s_b,
+                       size_t *i_b, uint16_t *pos_a, uint16_t *pos_b,
+                       size_t capacity) {
+    const size_t vectorlength = sizeof(__m128i) / sizeof(uint16_t);
+    size_t count = 0;
+    size_t ia = *i_a, ib = *i_b;
+    // Each pair of blocks yields at most vectorlength matches. The explicit
+    // length variant of the string compare is used so that zero keys are
+    // not mistaken for terminators.
+    while (ia + vectorlength <= s_a && ib + vectorlength <= s_b &&
+           count + vectorlength <= capacity) {
+        const __m128i v_a = _mm_lddqu_si128((__m128i *)&A[ia]);
+        const __m128i v_b = _mm_lddqu_si128((__m128i *)&B[ib]);
+        uint32_t mask_a = (uint32_t)_mm_extract_epi32(
+            _mm_cmpestrm(v_b, vectorlength, v_a, vectorlength,
+                         _SIDD_UWORD_OPS | _SIDD_CMP_EQUAL_ANY |
+                             _SIDD_BIT_MASK),
+            0);
+        if (mask_a != 0) {
+            uint32_t mask_b = (uint32_t)_mm_extract_epi32(
+                _mm_cmpestrm(v_a, vectorlength, v_b, vectorlength,
+                             _SIDD_UWORD_OPS | _SIDD_CMP_EQUAL_ANY |
+                                 _SIDD_BIT_MASK),
+                0);
+            // both blocks are sorted, so the k-th match on one side pairs
+            // with the k-th match on the other side
+            do {
+                pos_a[count] =
+                    (uint16_t)(ia + roaring_trailing_zeroes(mask_a));
+                pos_b[count] =
+                    (uint16_t)(ib + roaring_trailing_zeroes(mask_b));
+                count++;
+                mask_a &= mask_a - 1;
+                mask_b &= mask_b - 1;
+            } while (mask_a != 0);
+        }
+        const uint16_t a_max = A[ia + vectorlength - 1];
+        const uint16_t b_max = B[ib + vectorlength - 1];
+        if (a_max <= b_max) ia += vectorlength;
+        if (b_max <= a_max) ib += vectorlength;
+    }
+    // finish with a scalar merge; elements of a block that was not
+    // advanced and already matched are smaller than anything left on the
+    // other side, so they are skipped rather than reported twice
+    while (ia < s_a && ib < s_b && count < capacity) {
+        const uint16_t a = A[ia];
+        const uint16_t b = B[ib];
+        if (a < b) {
+            ia++;
+        } else if (b < a) {
+            ib++;
+        } else {
+            pos_a[count] = (uint16_t)ia++;
+            pos_b[count] = (uint16_t)ib++;
+            count++;
+        }
+    }
+    *i_a = ia;
+    *i_b = ib;
+    return (int32_t)count;
+}
+CROARING_UNTARGET_AVX2
+
 CROARING_TARGET_AVX2
 /////////
 // Warning:
@@ -792,6 +857,58 @@ int32_t difference_vector16(const uint16_t *__restrict__ A, size_t s_a,
     return count;
 }
 CROARING_UNTARGET_AVX2
+
+#if CROARING_COMPILER_SUPPORTS_AVX512
+CROARING_TARGET_AVX512
+ALLOW_UNALIGNED
+static bool avx512_contains_vector16(const uint16_t *array, int32_t length,
+                                     uint16_t key) {
+    const int32_t lanes = sizeof(__m512i) / sizeof(uint16_t);
+    const uint16_t *base = array;
+    int32_t n = length;
+    while (n >= lanes) {
+        const int32_t half = n >> 1;
+        base = (base[half] < key) ? base + half : base;
+        n -= half;
+    }
+    // the first value >= key is within base[0, n], one register wide
+    if (base + lanes > array + length) base = array + length - lanes;
+    const __m512i v = _mm512_loadu_si512((const void *)base);
+    return _mm512_cmpeq_epi16_mask(v, _mm512_set1_epi16((short)key)) != 0;
+}
+CROARING_UNTARGET_AVX512
+#endif  // CROARING_COMPILER_SUPPORTS_AVX512
+
+CROARING_TARGET_AVX2
+ALLOW_UNALIGNED
+static bool avx2_contains_vector16(const uint16_t *array, int32_t length,
+                                   uint16_t key) {
+    const int32_t lanes = sizeof(__m256i) / sizeof(uint16_t);
+    const uint16_t *base = array;
+    int32_t n = length;
+    while (n >= lanes) {
+        const int32_t half = n >> 1;
+        base = (base[half] < key) ? base + half : base;
+        n -= half;
+    }
+    // the first value >= key is within base[0, n], one register wide
+    if (base + lanes > array + length) base = array + length - lanes;
+    const __m256i v = _mm256_loadu_si256((const __m256i *)base);
+    const __m256i eq = _mm256_cmpeq_epi16(v, _mm256_set1_epi16((short)key));
+    return _mm256_movemask_epi8(eq) != 0;
+}
+CROARING_UNTARGET_AVX2
+
+bool array_contains_vector16(const uint16_t *array, int32_t length,
+                             uint16_t key) {
+#if CROARING_COMPILER_SUPPORTS_AVX512
+    if (length >= 32 &&
+        (croaring_hardware_support() & ROARING_SUPPORTS_AVX512)) {
+        return avx512_contains_vector16(array, length, key);
+    }
+#endif
+    return avx2_contains_vector16(array, length, key);
+}
 #endif  // CROARING_IS_X64
 
 /**
@@ -1048,6 +1165,29 @@ bool intersect_uint16_nonempty(const uint16_t *A, const size_t lenA,
     return false;  // NOTREACHED
 }
 
+int32_t match_uint16(const uint16_t *A, size_t s_a, size_t *i_a,
+                     const uint16_t *B, size_t s_b, size_t *i_b,
+                     uint16_t *pos_a, uint16_t *pos_b, size_t capacity) {
+    size_t count = 0;
+    size_t ia = *i_a, ib = *i_b;
+    while (ia < s_a && ib < s_b && count < capacity) {
+        const uint16_t a = A[ia];
+        const uint16_t b = B[ib];
+        if (a < b) {
+            ia++;
+        } else if (b < a) {
+            ib++;
+        } else {
+            pos_a[count] = (uint16_t)ia++;
+            pos_b[count] = (uint16_t)ib++;
+            count++;
+        }
+    }
+    *i_a = ia;
+    *i_b = ib;
+    return (int32_t)count;
+}
+
 /**
  * Generic intersection function.
  */
@@ -1884,6 +2024,174 @@ CROARING_UNTARGET_AVX2
  * End of SIMD 16-bit XOR code
  */
 
+#if CROARING_COMPILER_SUPPORTS_AVX512
+/**
+ * Start of the AVX-512 16-bit merge code
+ *
+ * Same one-pass merge as union_vector16, but over blocks of 32 values that
+ * are merged with a bitonic network. The merged stream is sorted, so the
+ * union keeps the values of the stream that differ from their predecessor,
+ * and the XOR keeps the values that differ from both of their neighbours.
+ *
+ * There is no such version of intersect_vector16 and difference_vector16:
+ * without VP2INTERSECT, comparing all pairs of 16-bit values is no faster in
+ * 512-bit registers than with _mm_cmpistrm, and merging the arrays instead
+ * was measured to be slower.
+ */
+CROARING_TARGET_AVX512
+
+typedef enum { AVX512_MERGE_UNION, AVX512_MERGE_XOR } avx512_merge_op_t;
+
+static const uint16_t avx512_merge_iota[32] = {
+    0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31};
+
+// one step of a bitonic network: the lanes in upper receive the maximum of
+// x and partner, the others the minimum
+static inline __m512i avx512_minmax16(__m512i x, __m512i partner,
+                                      __mmask32 upper) {
+    return _mm512_mask_max_epu16(_mm512_min_epu16(x, partner), upper, x,
+                                 partner);
+}
+
+// sorts a bitonic sequence of 32 values, comparing lanes 16, 8, 4, 2 and
+// then 1 apart
+static inline __m512i avx512_bitonic_sort16(__m512i x) {
+    x = avx512_minmax16(x, _mm512_shuffle_i64x2(x, x, 0x4E), 0xFFFF0000);
+    x = avx512_minmax16(x, _mm512_shuffle_i64x2(x, x, 0xB1), 0xFF00FF00);
+    x = avx512_minmax16(x, _mm512_shuffle_epi32(x, (_MM_PERM_ENUM)0x4E),
+                        0xF0F0F0F0);
+    x = avx512_minmax16(x, _mm512_shuffle_epi32(x, (_MM_PERM_ENUM)0xB1),
+                        0xCCCCCCCC);
+    x = avx512_minmax16(x, _mm512_rol_epi32(x, 16), 0xAAAAAAAA);
+    return x;
+}
+
+// merges the sorted vectors a and b into the sorted vectors *vecMin and
+// *vecMax; b is reversed so that a new block stays off the dependency chain
+// of vecMax
+static inline void avx512_merge16(__m512i a, __m512i b, __m512i reverse,
+                                  __m512i *vecMin, __m512i *vecMax) {
+    b = _mm512_permutexvar_epi16(reverse, b);
+    *vecMin = avx512_bitonic_sort16(_mm512_min_epu16(a, b));
+    *vecMax = avx512_bitonic_sort16(_mm512_max_epu16(a, b));
+}
+
+// writes the values of the stream block newval that op keeps, given that
+// old is the block that precedes it; the XOR lags one value behind since it
+// needs the successor of a value
+static inline uint32_t avx512_merge_store16(__m512i old, __m512i newval,
+                                            __m512i prev1, __m512i prev2,
+                                            avx512_merge_op_t op,
+                                            uint16_t *output) {
+    const __m512i before = _mm512_permutex2var_epi16(old, prev1, newval);
+    __m512i values = newval;
+    __mmask32 keep;
+    if (op == AVX512_MERGE_UNION) {
+        keep = _mm512_cmpneq_epu16_mask(newval, before);
+    } else {
+        const __m512i twobefore = _mm512_permutex2var_epi16(old, prev2, newval);
+        keep = _mm512_mask_cmpneq_epu16_mask(
+            _mm512_cmpneq_epu16_mask(before, twobefore), before, newval);
+        values = before;
+    }
+    const uint32_t count = (uint32_t)_mm_popcnt_u32(keep);
+    _mm512_mask_storeu_epi16(output, _bzhi_u32(0xFFFFFFFF, count),
+                             _mm512_maskz_compress_epi16(keep, values));
+    return count;
+}
+
+// requires length1 >= 32 and length2 >= 32
+static inline uint32_t avx512_merge_vector16(
+    const uint16_t *__restrict__ array1, uint32_t length1,
+    const uint16_t *__restrict__ array2, uint32_t length2,
+    uint16_t *__restrict__ output, avx512_merge_op_t op) {
+    const __m512i iota = _mm512_loadu_si512(avx512_merge_iota);
+    const __m512i reverse = _mm512_sub_epi16(_mm512_set1_epi16(31), iota);
+    // with _mm512_permutex2var_epi16(old, prev, newval), lane i selects the
+    // value one (resp. two) places before newval[i] in the stream
+    const __m512i prev1 = _mm512_add_epi16(iota, _mm512_set1_epi16(31));
+    const __m512i prev2 = _mm512_add_epi16(iota, _mm512_set1_epi16(30));
+    uint16_t *initoutput = output;
+    const uint32_t len1 = length1 / 32;
+    const uint32_t len2 = length2 / 32;
+    uint32_t pos1 = 1;
+    uint32_t pos2 = 1;
+    __m512i vecMin, vecMax, laststore;
+    avx512_merge16(_mm512_loadu_si512(array1), _mm512_loadu_si512(array2),
+                   reverse, &vecMin, &vecMax);
+    // the smallest value of the stream cannot be 0xFFFF
+    output += avx512_merge_store16(_mm512_set1_epi16(-1), vecMin, prev1, prev2,
+                                   op, output);
+    laststore = vecMin;
+    while ((pos1 < len1) && (pos2 < len2)) {
+        __m512i V;
+        if (array1[32 * pos1] <= array2[32 * pos2]) {
+            V = _mm512_loadu_si512(array1 + 32 * pos1);
+            pos1++;
+        } else {
+            V = _mm512_loadu_si512(array2 + 32 * pos2);
+            pos2++;
+        }
+        avx512_merge16(vecMax, V, reverse, &vecMin, &vecMax);
+        output += avx512_merge_store16(laststore, vecMin, prev1, prev2, op,
+                                       output);
+        laststore = vecMin;
+    }
+    // The values that remain in vecMax or in the arrays are no smaller than
+    // the last value of the stream, and every value below it is settled. We
+    // finish with a scalar algorithm from the first unsettled value.
+    // The union has written the last value, the XOR has not decided it yet.
+    const uint16_t last = (uint16_t)_mm_extract_epi16(
+        _mm512_extracti32x4_epi32(laststore, 3), 7);
+    const uint32_t from =
+        (op == AVX512_MERGE_UNION) ? (uint32_t)last + 1 : last;
+    uint32_t i1 = 32 * pos1;
+    while ((i1 > 0) && (array1[i1 - 1] >= from)) i1--;
+    while ((i1 < length1) && (array1[i1] < from)) i1++;
+    uint32_t i2 = 32 * pos2;
+    while ((i2 > 0) && (array2[i2 - 1] >= from)) i2--;
+    while ((i2 < length2) && (array2[i2] < from)) i2++;
+    uint32_t len = (uint32_t)(output - initoutput);
+    if (op == AVX512_MERGE_UNION) {
+        len += (uint32_t)union_uint16(array1 + i1, length1 - i1, array2 + i2,
+                                      length2 - i2, output);
+    } else {
+        len += (uint32_t)xor_uint16(array1 + i1, (int32_t)(length1 - i1),
+                                    array2 + i2, (int32_t)(length2 - i2),
+                                    output);
+    }
+    return len;
+}
+
+uint32_t avx512_union_vector16(const uint16_t *__restrict__ array1,
+                               uint32_t length1,
+                               const uint16_t *__restrict__ array2,
+                               uint32_t length2,
+                               uint16_t *__restrict__ output) {
+    if ((length1 < 32) || (length2 < 32)) {
+        return union_vector16(array1, length1, array2, length2, output);
+    }
+    return avx512_merge_vector16(array1, length1, array2, length2, output,
+                                 AVX512_MERGE_UNION);
+}
+
+uint32_t avx512_xor_vector16(const uint16_t *__restrict__ array1,
+                             uint32_t length1,
+                             const uint16_t *__restrict__ array2,
+                             uint32_t length2, uint16_t *__restrict__ output) {
+    if ((length1 < 32) || (length2 < 32)) {
+        return xor_vector16(array1, length1, array2, length2, output);
+    }
+    return avx512_merge_vector16(array1, length1, array2, length2, output,
+                                 AVX512_MERGE_XOR);
+}
+CROARING_UNTARGET_AVX512
+/**
+ * End of the AVX-512 16-bit merge code
+ */
+#endif  // CROARING_COMPILER_SUPPORTS_AVX512
+
 #endif  // CROARING_IS_X64
 
 size_t union_uint32(const uint32_t *set_1, size_t size_1, const uint32_t *set_2,
@@ -1983,6 +2291,12 @@ size_t fast_union_uint16(const uint16_t *set_1, size_t size_1,
                          const uint16_t *set_2, size_t size_2,
                          uint16_t *buffer) {
 #if CROARING_IS_X64
+#if CROARING_COMPILER_SUPPORTS_AVX512
+    if (croaring_hardware_support() & ROARING_SUPPORTS_AVX512) {
+        return avx512_union_vector16(set_1, (uint32_t)size_1, set_2,
+                                     (uint32_t)size_2, buffer);
+    }
+#endif  // CROARING_COMPILER_SUPPORTS_AVX512
     if (croaring_hardware_support() & ROARING_SUPPORTS_AVX2) {
         // compute union with smallest array first
         if (size_1 < size_2) {
@@ -71,6 +71,10 @@ typedef struct art_inner_node_s {
 } art_inner_node_t;
 
 // Inner node types.
+//
+// The header, count and keys of node4 and node16 fit in their first 24 bytes,
+// so that searching the keys touches a single cache line, and following the
+// matching child one more.
 
 // Node4: key[i] corresponds with children[i]. Keys are sorted.
 typedef struct art_node4_s {
@@ -134,55 +138,172 @@ static inline void art_init_inner_node(art_inner_node_t *node,
     memcpy(node->prefix, prefix, prefix_size * sizeof(art_key_chunk_t));
 }
 
-static void art_free_node(art_node_t *node);
+// ========================== Slab allocator ===================================
+
+// Header of the blocks of a slab allocator, followed by the objects.
+typedef struct art_slab_block_s {
+    struct art_slab_block_s *next;
+    size_t size;  // Size of the block in bytes, including the header.
+} art_slab_block_t;
+
+// The first block holds two objects, and each following block twice as many
+// as the previous one, up to ART_SLAB_MAX_BLOCK_BYTES (or a single object if
+// that is larger). Small trees thus waste little memory, and large trees have
+// few blocks.
+#define ART_SLAB_MIN_BLOCK_OBJECTS 2
+#define ART_SLAB_MAX_BLOCK_BYTES (64 * 1024)
+
+static inline size_t art_slab_object_size(size_t size) {
+    // Objects hold a free list pointer when freed, and are pointer-aligned.
+    size_t align = sizeof(void *);
+    if (size < align) {
+        return align;
+    }
+    return (size + align - 1) & ~(align - 1);
+}
+
+void *art_slab_alloc(art_slab_t *slab, size_t size) {
+    size = art_slab_object_size(size);
+    if (slab->free_list != NULL) {
+        void *object = slab->free_list;
+        memcpy(&slab->free_list, object, sizeof(void *));
+        return object;
+    }
+    if ((size_t)(slab->end - slab->next) < size) {
+        size_t objects = ART_SLAB_MIN_BLOCK_OBJECTS;
+        art_slab_block_t *last = (art_slab_block_t *)slab->blocks;
+        if (last != NULL) {
+            objects = 2 * ((last->size - sizeof(art_slab_block_t)) / size);
+            if (objects * size > ART_SLAB_MAX_BLOCK_BYTES) {
+                objects = ART_SLAB_MAX_BLOCK_BYTES / size;
+            }
+            if (objects == 0) {
+                objects = 1;
+            }
+        }
+        size_t block_size = sizeof(art_slab_block_t) + objects * size;
+        art_slab_block_t *block =
+            (art_slab_block_t *)roaring_malloc(block_size);
+        block->next = last;
+        block->size = block_size;
+        slab->blocks = block;
+        slab->next = (char *)(block + 1);
+        slab->end = (char *)block + block_size;
+    }
+    void *object = slab->next;
+    slab->next += size;
+    return object;
+}
+
+void art_slab_free(art_slab_t *slab, void *object) {
+    memcpy(object, &slab->free_list, sizeof(void *));
+    slab->free_list = object;
+}
+
+void art_slab_release(art_slab_t *slab) {
+    art_slab_block_t *block = (art_slab_block_t *)slab->blocks;
+    while (block != NULL) {
+        art_slab_block_t *next = block->next;
+        roaring_free(block);
+        block = next;
+    }
+    memset(slab, 0, sizeof(art_slab_t));
+}
+
+void art_slab_iterate(const art_slab_t *slab, size_t size,
+                      art_slab_visitor_t visitor, void *context) {
+    size = art_slab_object_size(size);
+    const art_slab_block_t *block = (const art_slab_block_t *)slab->blocks;
+    // Only the most recent block has objects never handed out, from `next`.
+    const char *end = slab->next;
+    while (block != NULL) {
+        char *object = (char *)(block + 1);
+        for (; object + size <= end; object += size) {
+            visitor(object, context);
+        }
+        block = block->next;
+        if (block != NULL) {
+            end = (const char *)block + block->size;
+        }
+    }
+}
+
+size_t art_slab_size_in_bytes(const art_slab_t *slab) {
+    size_t size = 0;
+    const art_slab_block_t *block = (const art_slab_block_t *)slab->blocks;
+    while (block != NULL) {
+        size += block->size;
+        block = block->next;
+    }
+    return size;
+}
 
 // ===================== Start of node-specific functions ======================
 
-static art_node4_t *art_node4_create(const art_key_chunk_t prefix[],
+static art_node4_t *art_node4_create(art_t *art,
+                                     const art_key_chunk_t prefix[],
                                      uint8_t prefix_size);
-static art_node16_t *art_node16_create(const art_key_chunk_t prefix[],
+static art_node16_t *art_node16_create(art_t *art,
+                                       const art_key_chunk_t prefix[],
                                        uint8_t prefix_size);
-static art_node48_t *art_node48_create(const art_key_chunk_t prefix[],
+static art_node48_t *art_node48_create(art_t *art,
+                                       const art_key_chunk_t prefix[],
                                        uint8_t prefix_size);
-static art_node256_t *art_node256_create(const art_key_chunk_t prefix[],
+static art_node256_t *art_node256_create(art_t *art,
+                                         const art_key_chunk_t prefix[],
                                          uint8_t prefix_size);
 
-static art_node_t *art_node4_insert(art_node4_t *node, art_node_t *child,
-                                    uint8_t key);
-static art_node_t *art_node16_insert(art_node16_t *node, art_node_t *child,
-                                     uint8_t key);
-static art_node_t *art_node48_insert(art_node48_t *node, art_node_t *child,
-                                     uint8_t key);
+static art_node_t *art_node4_insert(art_t *art, art_node4_t *node,
+                                    art_node_t *child, uint8_t key);
+static art_node_t *art_node16_insert(art_t *art, art_node16_t *node,
+                                     art_node_t *child, uint8_t key);
+static art_node_t *art_node48_insert(art_t *art, art_node48_t *node,
+                                     art_node_t *child, uint8_t key);
 static art_node_t *art_node256_insert(art_node256_t *node, art_node_t *child,
                                       uint8_t key);
 
-static art_node4_t *art_node4_create(const art_key_chunk_t prefix[],
+static art_node4_t *art_node4_create(art_t *art,
+                                     const art_key_chunk_t prefix[],
                                      uint8_t prefix_size) {
-    art_node4_t *node = (art_node4_t *)roaring_malloc(sizeof(art_node4_t));
+    art_node4_t *node = (art_node4_t *)art_slab_alloc(
+        &art->node_slabs[ART_NODE4_TYPE], sizeof(art_node4_t));
     art_init_inner_node(&node->base, ART_NODE4_TYPE, prefix, prefix_size);
     node->count = 0;
+    // The keys are searched all at once, including the unused ones.
+    memset(node->keys, 0, sizeof(node->keys));
     return node;
 }
 
-static void art_free_node4(art_node4_t *node) {
-    for (size_t i = 0; i < node->count; ++i) {
-        art_free_node(node->children[i]);
+// Returns the index of the key, or -1 if it is not present. The four keys are
+// compared at once within a 32-bit word.
+static inline int art_node4_find_index(const art_node4_t *node,
+                                       art_key_chunk_t key) {
+    static const uint32_t used_keys[5] = {0, 0x80, 0x8080, 0x808080,
+                                          0x80808080};
+    uint32_t keys = (uint32_t)node->keys[0] | ((uint32_t)node->keys[1] << 8) |
+                    ((uint32_t)node->keys[2] << 16) |
+                    ((uint32_t)node->keys[3] << 24);
+    uint32_t x = keys ^ (UINT32_C(0x01010101) * key);
+    // The high bit of each zero byte of x is set, and possibly those of the
+    // bytes above a zero byte, which never changes the lowest one.
+    uint32_t zeroes = (x - UINT32_C(0x01010101)) & ~x & used_keys[node->count];
+    if (zeroes == 0) {
+        return -1;
     }
-    roaring_free(node);
+    return roaring_trailing_zeroes(zeroes) >> 3;
 }
 
 static inline art_node_t *art_node4_find_child(const art_node4_t *node,
                                                art_key_chunk_t key) {
-    for (size_t i = 0; i < node->count; ++i) {
-        if (node->keys[i] == key) {
-            return node->children[i];
-        }
+    int idx = art_node4_find_index(node, key);
+    if (idx < 0) {
+        return NULL;
     }
-    return NULL;
+    return node->children[idx];
 }
 
-static art_node_t *art_node4_insert(art_node4_t *node, art_node_t *child,
-                                    uint8_t key) {
+static art_node_t *art_node4_insert(art_t *art, art_node4_t *node,
+                                    art_node_t *child, uint8_t key) {
     if (node->count < 4) {
         size_t idx = 0;
         for (; idx < node->count; ++idx) {
@@ -203,24 +324,19 @@ static art_node_t *art_node4_insert(art_node4_t *node, art_node_t *child,
         return (art_node_t *)node;
     }
     art_node16_t *new_node =
-        art_node16_create(node->base.prefix, node->base.prefix_size);
+        art_node16_create(art, node->base.prefix, node->base.prefix_size);
     // Instead of calling insert, this could be specialized to 2x memcpy and
     // setting the count.
     for (size_t i = 0; i < 4; ++i) {
-        art_node16_insert(new_node, node->children[i], node->keys[i]);
+        art_node16_insert(art, new_node, node->children[i], node->keys[i]);
     }
-    roaring_free(node);
-    return art_node16_insert(new_node, child, key);
+    art_slab_free(&art->node_slabs[ART_NODE4_TYPE], node);
+    return art_node16_insert(art, new_node, child, key);
 }
 
-static inline art_node_t *art_node4_erase(art_node4_t *node,
+static inline art_node_t *art_node4_erase(art_t *art, art_node4_t *node,
                                           art_key_chunk_t key_chunk) {
-    int idx = -1;
-    for (size_t i = 0; i < node->count; ++i) {
-        if (node->keys[i] == key_chunk) {
-            idx = i;
-        }
-    }
+    int idx = art_node4_find_index(node, key_chunk);
     if (idx == -1) {
         return (art_node_t *)node;
     }
@@ -240,7 +356,7 @@ static inline art_node_t *art_node4_erase(art_node4_t *node,
             inner_node->prefix[node->base.prefix_size] = remaining_child_key;
             inner_node->prefix_size += node->base.prefix_size + 1;
         }
-        roaring_free(node);
+        art_slab_free(&art->node_slabs[ART_NODE4_TYPE], node);
         return remaining_child;
     }
     // Shift other keys to maintain sorted order.
@@ -256,11 +372,9 @@ static inline art_node_t *art_node4_erase(art_node4_t *node,
 static inline void art_node4_replace(art_node4_t *node,
                                      art_key_chunk_t key_chunk,
                                      art_node_t *new_child) {
-    for (size_t i = 0; i < node->count; ++i) {
-        if (node->keys[i] == key_chunk) {
-            node->children[i] = new_child;
-            return;
-        }
+    int idx = art_node4_find_index(node, key_chunk);
+    if (idx >= 0) {
+        node->children[idx] = new_child;
     }
 }
 
@@ -360,40 +474,101 @@ static bool art_node4_internal_validate(const art_node4_t *node,
     return true;
 }
 
-static art_node16_t *art_node16_create(const art_key_chunk_t prefix[],
+static art_node16_t *art_node16_create(art_t *art,
+                                       const art_key_chunk_t prefix[],
                                        uint8_t prefix_size) {
-    art_node16_t *node = (art_node16_t *)roaring_malloc(sizeof(art_node16_t));
+    art_node16_t *node = (art_node16_t *)art_slab_alloc(
+        &art->node_slabs[ART_NODE16_TYPE], sizeof(art_node16_t));
     art_init_inner_node(&node->base, ART_NODE16_TYPE, prefix, prefix_size);
     node->count = 0;
+    // The keys are searched all at once, including the unused ones.
+    memset(node->keys, 0, sizeof(node->keys));
     return node;
 }
 
-static void art_free_node16(art_node16_t *node) {
-    for (size_t i = 0; i < node->count; ++i) {
-        art_free_node(node->children[i]);
+// Returns the index of the key, or -1 if it is not present. The sixteen keys
+// are compared at once with SSE2 or NEON when available.
+static inline int art_node16_find_index(const art_node16_t *node,
+                                        art_key_chunk_t key) {
+#if CROARING_IS_X64
+    __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8((char)key),
+                                 _mm_loadu_si128((const __m128i *)node->keys));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(cmp) &
+                    ((UINT32_C(1) << node->count) - 1);
+    if (mask == 0) {
+        return -1;
+    }
+    return roaring_trailing_zeroes(mask);
+#elif defined(CROARING_USENEON)
+    uint8x16_t cmp = vceqq_u8(vld1q_u8(node->keys), vdupq_n_u8(key));
+    // Narrow each byte of the comparison to a nibble of a 64-bit mask.
+    uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0);
+    if (node->count < 16) {
+        mask &= (UINT64_C(1) << (4 * node->count)) - 1;
+    }
+    if (mask == 0) {
+        return -1;
+    }
+    return roaring_trailing_zeroes(mask) >> 2;
+#else
+    for (int i = 0; i < node->count; ++i) {
+        if (node->keys[i] == key) {
+            return i;
+        }
     }
-    roaring_free(node);
+    return -1;
+#endif
+}
+
+// Returns the index of the first key greater than or equal to the given key,
+// or the count of the node if there is none.
+static inline int art_node16_lower_bound_index(const art_node16_t *node,
+                                               art_key_chunk_t key) {
+#if CROARING_IS_X64
+    __m128i keys = _mm_loadu_si128((const __m128i *)node->keys);
+    // keys[i] >= key iff max(keys[i], key) == keys[i], as unsigned bytes.
+    __m128i cmp = _mm_cmpeq_epi8(_mm_max_epu8(keys, _mm_set1_epi8((char)key)),
+                                 keys);
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(cmp) &
+                    ((UINT32_C(1) << node->count) - 1);
+    if (mask == 0) {
+        return node->count;
+    }
+    return roaring_trailing_zeroes(mask);
+#elif defined(CROARING_USENEON)
+    uint8x16_t cmp = vcgeq_u8(vld1q_u8(node->keys), vdupq_n_u8(key));
+    uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0);
+    if (node->count < 16) {
+        mask &= (UINT64_C(1) << (4 * node->count)) - 1;
+    }
+    if (mask == 0) {
+        return node->count;
+    }
+    return roaring_trailing_zeroes(mask) >> 2;
+#else
+    int i = 0;
+    while (i < node->count && node->keys[i] < key) {
+        i++;
+    }
+    return i;
+#endif
 }
 
 static inline art_node_t *art_node16_find_child(const art_node16_t *node,
                                                 art_key_chunk_t key) {
-    for (size_t i = 0; i < node->count; ++i) {
-        if (node->keys[i] == key) {
-            return node->children[i];
-        }
+    int idx = art_node16_find_index(node, key);
+    if (idx < 0) {
+        return NULL;
     }
-    return NULL;
+    return node->children[idx];
 }
 
-static art_node_t *art_node16_insert(art_node16_t *node, art_node_t *child,
-                                     uint8_t key) {
+static art_node_t *art_node16_insert(art_t *art, art_node16_t *node,
+                                     art_node_t *child, uint8_t key) {
     if (node->count < 16) {
-        size_t idx = 0;
-        for (; idx < node->count; ++idx) {
-            if (node->keys[idx] > key) {
-                break;
-            }
-        }
+        size_t idx = (size_t)art_node16_lower_bound_index(node, key);
         size_t after = node->count - idx;
         // Shift other keys to maintain sorted order.
         memmove(node->keys + idx + 1, node->keys + idx,
@@ -407,50 +582,46 @@ static art_node_t *art_node16_insert(art_node16_t *node, art_node_t *child,
         return (art_node_t *)node;
     }
     art_node48_t *new_node =
-        art_node48_create(node->base.prefix, node->base.prefix_size);
+        art_node48_create(art, node->base.prefix, node->base.prefix_size);
     for (size_t i = 0; i < 16; ++i) {
-        art_node48_insert(new_node, node->children[i], node->keys[i]);
+        art_node48_insert(art, new_node, node->children[i], node->keys[i]);
     }
-    roaring_free(node);
-    return art_node48_insert(new_node, child, key);
+    art_slab_free(&art->node_slabs[ART_NODE16_TYPE], node);
+    return art_node48_insert(art, new_node, child, key);
 }
 
-static inline art_node_t *art_node16_erase(art_node16_t *node,
+static inline art_node_t *art_node16_erase(art_t *art, art_node16_t *node,
                                            uint8_t key_chunk) {
-    for (size_t i = 0; i < node->count; ++i) {
-        if (node->keys[i] == key_chunk) {
-            // Shift other keys to maintain sorted order.
-            size_t after_next = node->count - i - 1;
-            memmove(node->keys + i, node->keys + i + 1,
-                    after_next * sizeof(key_chunk));
-            memmove(node->children + i, node->children + i + 1,
-                    after_next * sizeof(art_node_t *));
-            node->count--;
-            break;
-        }
+    int idx = art_node16_find_index(node, key_chunk);
+    if (idx >= 0) {
+        // Shift other keys to maintain sorted order.
+        size_t after_next = node->count - idx - 1;
+        memmove(node->keys + idx, node->keys + idx + 1,
+                after_next * sizeof(key_chunk));
+        memmove(node->children + idx, node->children + idx + 1,
+                after_next * sizeof(art_node_t *));
+        node->count--;
     }
     if (node->count > 4) {
         return (art_node_t *)node;
     }
     art_node4_t *new_node =
-        art_node4_create(node->base.prefix, node->base.prefix_size);
+        art_node4_create(art, node->base.prefix, node->base.prefix_size);
     // Instead of calling insert, this could be specialized to 2x memcpy and
     // setting the count.
     for (size_t i = 0; i < 4; ++i) {
-        art_node4_insert(new_node, node->children[i], node->keys[i]);
+        art_node4_insert(art, new_node, node->children[i], node->keys[i]);
     }
-    roaring_free(node);
+    art_slab_free(&art->node_slabs[ART_NODE16_TYPE], node);
     return (art_node_t *)new_node;
 }
 
 static inline void art_node16_replace(art_node16_t *node,
                                       art_key_chunk_t key_chunk,
                                       art_node_t *new_child) {
-    for (uint8_t i = 0; i < node->count; ++i) {
-        if (node->keys[i] == key_chunk) {
-            node->children[i] = new_child;
-            return;
-        }
+    int idx = art_node16_find_index(node, key_chunk);
+    if (idx >= 0) {
+        node->children[idx] = new_child;
     }
 }
 
@@ -500,17 +671,8 @@ static inline art_indexed_child_t art_node16_child_at(const art_node16_t *node,
 
 static inline art_indexed_child_t art_node16_lower_bound(
     art_node16_t *node, art_key_chunk_t key_chunk) {
-    art_indexed_child_t indexed_child;
-    for (size_t i = 0; i < node->count; ++i) {
-        if (node->keys[i] >= key_chunk) {
-            indexed_child.index = i;
-            indexed_child.child = node->children[i];
-            indexed_child.key_chunk = node->keys[i];
-            return indexed_child;
-        }
-    }
-    indexed_child.child = NULL;
-    return indexed_child;
+    return art_node16_child_at(node,
+                               art_node16_lower_bound_index(node, key_chunk));
 }
 
 static bool art_node16_internal_validate(const art_node16_t *node,
@@ -543,9 +705,11 @@ static bool art_node16_internal_validate(const art_node16_t *node,
     return true;
 }
 
-static art_node48_t *art_node48_create(const art_key_chunk_t prefix[],
+static art_node48_t *art_node48_create(art_t *art,
+                                       const art_key_chunk_t prefix[],
                                        uint8_t prefix_size) {
-    art_node48_t *node = (art_node48_t *)roaring_malloc(sizeof(art_node48_t));
+    art_node48_t *node = (art_node48_t *)art_slab_alloc(
+        &art->node_slabs[ART_NODE48_TYPE], sizeof(art_node48_t));
     art_init_inner_node(&node->base, ART_NODE48_TYPE, prefix, prefix_size);
     node->count = 0;
     node->available_children = NODE48_AVAILABLE_CHILDREN_MASK;
@@ -555,18 +719,6 @@ static art_node48_t *art_node48_create(const art_key_chunk_t prefix[],
     return node;
 }
 
-static void art_free_node48(art_node48_t *node) {
-    uint64_t used_children =
-        (node->available_children) ^ NODE48_AVAILABLE_CHILDREN_MASK;
-    while (used_children != 0) {
-        // We checked above that used_children is not zero
-        uint8_t child_idx = roaring_trailing_zeroes(used_children);
-        art_free_node(node->children[child_idx]);
-        used_children &= ~(UINT64_C(1) << child_idx);
-    }
-    roaring_free(node);
-}
-
 static inline art_node_t *art_node48_find_child(const art_node48_t *node,
                                                 art_key_chunk_t key) {
     uint8_t val_idx = node->keys[key];
@@ -576,8 +728,8 @@ static inline art_node_t *art_node48_find_child(const art_node48_t *node,
     return NULL;
 }
 
-static art_node_t *art_node48_insert(art_node48_t *node, art_node_t *child,
-                                     uint8_t key) {
+static art_node_t *art_node48_insert(art_t *art, art_node48_t *node,
+                                     art_node_t *child, uint8_t key) {
     if (node->count < 48) {
         // node->available_children is only zero when the node is full (count ==
         // 48), we just checked count < 48
@@ -589,18 +741,18 @@ static art_node_t *art_node48_insert(art_node48_t *node, art_node_t *child,
         return (art_node_t *)node;
     }
     art_node256_t *new_node =
-        art_node256_create(node->base.prefix, node->base.prefix_size);
+        art_node256_create(art, node->base.prefix, node->base.prefix_size);
     for (size_t i = 0; i < 256; ++i) {
         uint8_t val_idx = node->keys[i];
         if (val_idx != ART_NODE48_EMPTY_VAL) {
             art_node256_insert(new_node, node->children[val_idx], i);
         }
     }
-    roaring_free(node);
+    art_slab_free(&art->node_slabs[ART_NODE48_TYPE], node);
     return art_node256_insert(new_node, child, key);
 }
 
-static inline art_node_t *art_node48_erase(art_node48_t *node,
+static inline art_node_t *art_node48_erase(art_t *art, art_node48_t *node,
                                            uint8_t key_chunk) {
     uint8_t val_idx = node->keys[key_chunk];
     if (val_idx == ART_NODE48_EMPTY_VAL) {
@@ -614,14 +766,14 @@ static inline art_node_t *art_node48_erase(art_node48_t *node,
     }
 
     art_node16_t *new_node =
-        art_node16_create(node->base.prefix, node->base.prefix_size);
+        art_node16_create(art, node->base.prefix, node->base.prefix_size);
     for (size_t i = 0; i < 256; ++i) {
         val_idx = node->keys[i];
         if (val_idx != ART_NODE48_EMPTY_VAL) {
-            art_node16_insert(new_node, node->children[val_idx], i);
+            art_node16_insert(art, new_node, node->children[val_idx], i);
         }
     }
-    roaring_free(node);
+    art_slab_free(&art->node_slabs[ART_NODE48_TYPE], node);
     return (art_node_t *)new_node;
 }
 
@@ -755,10 +907,11 @@ static bool art_node48_internal_validate(const art_node48_t *node,
     return true;
 }
 
-static art_node256_t *art_node256_create(const art_key_chunk_t prefix[],
+static art_node256_t *art_node256_create(art_t *art,
+                                         const art_key_chunk_t prefix[],
                                          uint8_t prefix_size) {
-    art_node256_t *node =
-        (art_node256_t *)roaring_malloc(sizeof(art_node256_t));
+    art_node256_t *node = (art_node256_t *)art_slab_alloc(
+        &art->node_slabs[ART_NODE256_TYPE], sizeof(art_node256_t));
     art_init_inner_node(&node->base, ART_NODE256_TYPE, prefix, prefix_size);
     node->count = 0;
     for (size_t i = 0; i < 256; ++i) {
@@ -767,15 +920,6 @@ static art_node256_t *art_node256_create(const art_key_chunk_t prefix[],
     return node;
 }
 
-static void art_free_node256(art_node256_t *node) {
-    for (size_t i = 0; i < 256; ++i) {
-        if (node->children[i] != NULL) {
-            art_free_node(node->children[i]);
-        }
-    }
-    roaring_free(node);
-}
-
 static inline art_node_t *art_node256_find_child(const art_node256_t *node,
                                                  art_key_chunk_t key) {
     return node->children[key];
@@ -788,7 +932,7 @@ static art_node_t *art_node256_insert(art_node256_t *node, art_node_t *child,
     return (art_node_t *)node;
 }
 
-static inline art_node_t *art_node256_erase(art_node256_t *node,
+static inline art_node_t *art_node256_erase(art_t *art, art_node256_t *node,
                                             uint8_t key_chunk) {
     node->children[key_chunk] = NULL;
     node->count--;
@@ -797,13 +941,13 @@ static inline art_node_t *art_node256_erase(art_node256_t *node,
     }
 
     art_node48_t *new_node =
-        art_node48_create(node->base.prefix, node->base.prefix_size);
+        art_node48_create(art, node->base.prefix, node->base.prefix_size);
     for (size_t i = 0; i < 256; ++i) {
         if (node->children[i] != NULL) {
-            art_node48_insert(new_node, node->children[i], i);
+            art_node48_insert(art, new_node, node->children[i], i);
         }
     }
-    roaring_free(node);
+    art_slab_free(&art->node_slabs[ART_NODE256_TYPE], node);
     return (art_node_t *)new_node;
 }
 
@@ -952,36 +1096,37 @@ static void art_replace(art_inner_node_t *node, art_key_chunk_t key_chunk,
 
 // Erases the child with the given key chunk from the inner node, returns the
 // updated node (the same as the initial node if it was not shrunk).
-static art_node_t *art_node_erase(art_inner_node_t *node,
+static art_node_t *art_node_erase(art_t *art, art_inner_node_t *node,
                                   art_key_chunk_t key_chunk) {
     switch (art_get_type(node)) {
         case ART_NODE4_TYPE:
-            return art_node4_erase((art_node4_t *)node, key_chunk);
+            return art_node4_erase(art, (art_node4_t *)node, key_chunk);
         case ART_NODE16_TYPE:
-            return art_node16_erase((art_node16_t *)node, key_chunk);
+            return art_node16_erase(art, (art_node16_t *)node, key_chunk);
         case ART_NODE48_TYPE:
-            return art_node48_erase((art_node48_t *)node, key_chunk);
+            return art_node48_erase(art, (art_node48_t *)node, key_chunk);
         case ART_NODE256_TYPE:
-            return art_node256_erase((art_node256_t *)node, key_chunk);
+            return art_node256_erase(art, (art_node256_t *)node, key_chunk);
         default:
             assert(false);
             return NULL;
     }
 }
 
-// Inserts the leaf with the given key chunk in the inner node, returns a
+// Inserts the child with the given key chunk in the inner node, returns a
 // pointer to the (possibly expanded) node.
-static art_node_t *art_node_insert_leaf(art_inner_node_t *node,
-                                        art_key_chunk_t key_chunk,
-                                        art_leaf_t *leaf) {
-    art_node_t *child = (art_node_t *)(SET_LEAF(leaf));
+static art_node_t *art_node_insert_child(art_t *art, art_inner_node_t *node,
+                                         art_key_chunk_t key_chunk,
+                                         art_node_t *child) {
     switch (art_get_type(node)) {
         case ART_NODE4_TYPE:
-            return art_node4_insert((art_node4_t *)node, child, key_chunk);
+            return art_node4_insert(art, (art_node4_t *)node, child, key_chunk);
         case ART_NODE16_TYPE:
-            return art_node16_insert((art_node16_t *)node, child, key_chunk);
+            return art_node16_insert(art, (art_node16_t *)node, child,
+                                     key_chunk);
         case ART_NODE48_TYPE:
-            return art_node48_insert((art_node48_t *)node, child, key_chunk);
+            return art_node48_insert(art, (art_node48_t *)node, child,
+                                     key_chunk);
         case ART_NODE256_TYPE:
             return art_node256_insert((art_node256_t *)node, child, key_chunk);
         default:
@@ -990,28 +1135,31 @@ static art_node_t *art_node_insert_leaf(art_inner_node_t *node,
     }
 }
 
-// Frees the node and its children. Leaves are freed by the user.
-static void art_free_node(art_node_t *node) {
-    if (art_is_leaf(node)) {
-        // We leave it up to the user to free leaves.
-        return;
+// Inserts the leaf with the given key chunk in the inner node, returns a
+// pointer to the (possibly expanded) node.
+static art_node_t *art_node_insert_leaf(art_t *art, art_inner_node_t *node,
+                                        art_key_chunk_t key_chunk,
+                                        art_leaf_t *leaf) {
+    return art_node_insert_child(art, node, key_chunk,
+                                 (art_node_t *)(SET_LEAF(leaf)));
+}
+
+// Creates the smallest inner node type that can hold the given number of
+// children.
+static art_inner_node_t *art_node_create_for(art_t *art,
+                                             const art_key_chunk_t prefix[],
+                                             uint8_t prefix_size,
+                                             size_t num_children) {
+    if (num_children <= 4) {
+        return &art_node4_create(art, prefix, prefix_size)->base;
     }
-    switch (art_get_type((art_inner_node_t *)node)) {
-        case ART_NODE4_TYPE:
-            art_free_node4((art_node4_t *)node);
-            break;
-        case ART_NODE16_TYPE:
-            art_free_node16((art_node16_t *)node);
-            break;
-        case ART_NODE48_TYPE:
-            art_free_node48((art_node48_t *)node);
-            break;
-        case ART_NODE256_TYPE:
-            art_free_node256((art_node256_t *)node);
-            break;
-        default:
-            assert(false);
+    if (num_children <= 16) {
+        return &art_node16_create(art, prefix, prefix_size)->base;
+    }
+    if (num_children <= 48) {
+        return &art_node48_create(art, prefix, prefix_size)->base;
     }
+    return &art_node256_create(art, prefix, prefix_size)->base;
 }
 
 // Returns the next child in key order, or NULL if called on a leaf.
@@ -1150,8 +1298,9 @@ static uint8_t art_common_prefix(const art_key_chunk_t key1[],
 
 // Returns a pointer to the rootmost node where the value was inserted, may not
 // be equal to `node`.
-static art_node_t *art_insert_at(art_node_t *node, const art_key_chunk_t key[],
-                                 uint8_t depth, art_leaf_t *new_leaf) {
+static art_node_t *art_insert_at(art_t *art, art_node_t *node,
+                                 const art_key_chunk_t key[], uint8_t depth,
+                                 art_leaf_t *new_leaf) {
     if (art_is_leaf(node)) {
         art_leaf_t *leaf = CAST_LEAF(node);
         uint8_t common_prefix = art_common_prefix(
@@ -1160,11 +1309,11 @@ static art_node_t *art_insert_at(art_node_t *node, const art_key_chunk_t key[],
         // Previously this was a leaf, create an inner node instead and add both
         // the existing and new leaf to it.
         art_node_t *new_node =
-            (art_node_t *)art_node4_create(key + depth, common_prefix);
+            (art_node_t *)art_node4_create(art, key + depth, common_prefix);
 
-        new_node = art_node_insert_leaf((art_inner_node_t *)new_node,
+        new_node = art_node_insert_leaf(art, (art_inner_node_t *)new_node,
                                         leaf->key[depth + common_prefix], leaf);
-        new_node = art_node_insert_leaf((art_inner_node_t *)new_node,
+        new_node = art_node_insert_leaf(art, (art_inner_node_t *)new_node,
                                         key[depth + common_prefix], new_leaf);
 
         // The new inner node is now the rootmost node.
@@ -1179,10 +1328,10 @@ static art_node_t *art_insert_at(art_node_t *node, const art_key_chunk_t key[],
         // Partial prefix match.  Create a new internal node to hold the common
         // prefix.
         art_node4_t *node4 =
-            art_node4_create(inner_node->prefix, common_prefix);
+            art_node4_create(art, inner_node->prefix, common_prefix);
 
         // Make the existing internal node a child of the new internal node.
-        node4 = (art_node4_t *)art_node4_insert(
+        node4 = (art_node4_t *)art_node4_insert(art, 
             node4, node, inner_node->prefix[common_prefix]);
 
         // Correct the prefix of the moved internal node, trimming off the chunk
@@ -1195,8 +1344,8 @@ static art_node_t *art_insert_at(art_node_t *node, const art_key_chunk_t key[],
         }
 
         // Insert the value in the new internal node.
-        return art_node_insert_leaf(&node4->base, key[common_prefix + depth],
-                                    new_leaf);
+        return art_node_insert_leaf(art, &node4->base,
+                                    key[common_prefix + depth], new_leaf);
     }
     // Prefix matches entirely or node has no prefix. Look for an existing
     // child.
@@ -1204,14 +1353,14 @@ static art_node_t *art_insert_at(art_node_t *node, const art_key_chunk_t key[],
     art_node_t *child = art_find_child(inner_node, key_chunk);
     if (child != NULL) {
         art_node_t *new_child =
-            art_insert_at(child, key, depth + common_prefix + 1, new_leaf);
+            art_insert_at(art, child, key, depth + common_prefix + 1, new_leaf);
         if (new_child != child) {
             // Node type changed.
             art_replace(inner_node, key_chunk, new_child);
         }
         return node;
     }
-    return art_node_insert_leaf(inner_node, key_chunk, new_leaf);
+    return art_node_insert_leaf(art, inner_node, key_chunk, new_leaf);
 }
 
 // Erase helper struct.
@@ -1225,7 +1374,7 @@ typedef struct art_erase_result_s {
 } art_erase_result_t;
 
 // Searches for the given key starting at `node`, erases it if found.
-static art_erase_result_t art_erase_at(art_node_t *node,
+static art_erase_result_t art_erase_at(art_t *art, art_node_t *node,
                                        const art_key_chunk_t *key,
                                        uint8_t depth) {
     art_erase_result_t result;
@@ -1260,7 +1409,7 @@ static art_erase_result_t art_erase_at(art_node_t *node,
     // Try to erase the key further down. Skip the key chunk associated with the
     // child in the node.
     art_erase_result_t child_result =
-        art_erase_at(child, key, depth + common_prefix + 1);
+        art_erase_at(art, child, key, depth + common_prefix + 1);
     if (child_result.value_erased == NULL) {
         return result;
     }
@@ -1268,7 +1417,7 @@ static art_erase_result_t art_erase_at(art_node_t *node,
     result.rootmost_node = node;
     if (child_result.rootmost_node == NULL) {
         // Child node was fully erased, erase it from this node's children.
-        result.rootmost_node = art_node_erase(inner_node, key_chunk);
+        result.rootmost_node = art_node_erase(art, inner_node, key_chunk);
     } else if (child_result.rootmost_node != child) {
         // Child node was not fully erased, update the pointer to it in this
         // node.
@@ -1341,6 +1490,35 @@ size_t art_size_in_bytes_at(const art_node_t *node) {
     return size;
 }
 
+static void art_statistics_at(const art_node_t *node, art_statistics_t *stats) {
+    if (art_is_leaf(node)) {
+        stats->n_leaves++;
+        return;
+    }
+    switch (art_get_type((art_inner_node_t *)node)) {
+        case ART_NODE4_TYPE:
+            stats->n_node4++;
+            break;
+        case ART_NODE16_TYPE:
+            stats->n_node16++;
+            break;
+        case ART_NODE48_TYPE:
+            stats->n_node48++;
+            break;
+        case ART_NODE256_TYPE:
+            stats->n_node256++;
+            break;
+        default:
+            assert(false);
+            break;
+    }
+    art_indexed_child_t indexed_child = art_node_next_child(node, -1);
+    while (indexed_child.child != NULL) {
+        art_statistics_at(indexed_child.child, stats);
+        indexed_child = art_node_next_child(node, indexed_child.index);
+    }
+}
+
 static void art_node_print_type(const art_node_t *node) {
     if (art_is_leaf(node)) {
         printf("Leaf");
@@ -1448,14 +1626,148 @@ void art_insert(art_t *art, const art_key_chunk_t *key, art_val_t *val) {
         art->root = (art_node_t *)SET_LEAF(leaf);
         return;
     }
-    art->root = art_insert_at(art->root, key, 0, leaf);
+    art->root = art_insert_at(art, art->root, key, 0, leaf);
+}
+
+// Builds the subtree holding the given leaves, whose keys are sorted, distinct,
+// and share their first `depth` chunks.
+static art_node_t *art_bulk_load_at(art_t *art, art_leaf_t **leaves,
+                                    size_t count, uint8_t depth) {
+    if (count == 1) {
+        return (art_node_t *)SET_LEAF(leaves[0]);
+    }
+    // The keys are sorted, so the common prefix of the first and last keys is
+    // common to all of them.
+    const art_key_chunk_t *first = leaves[0]->key;
+    uint8_t prefix_size =
+        art_common_prefix(first, depth, ART_KEY_BYTES, leaves[count - 1]->key,
+                          depth, ART_KEY_BYTES);
+    uint8_t chunk_depth = depth + prefix_size;
+    assert(chunk_depth < ART_KEY_BYTES);
+
+    size_t num_children = 1;
+    for (size_t i = 1; i < count; ++i) {
+        if (leaves[i]->key[chunk_depth] != leaves[i - 1]->key[chunk_depth]) {
+            num_children++;
+        }
+    }
+    art_inner_node_t *node =
+        art_node_create_for(art, first + depth, prefix_size, num_children);
+    size_t start = 0;
+    while (start < count) {
+        art_key_chunk_t key_chunk = leaves[start]->key[chunk_depth];
+        size_t end = start + 1;
+        while (end < count && leaves[end]->key[chunk_depth] == key_chunk) {
+            end++;
+        }
+        art_node_t *child =
+            art_bulk_load_at(art, leaves + start, end - start, chunk_depth + 1);
+        // The node has room for all children, so it is never replaced.
+        art_node_insert_child(art, node, key_chunk, child);
+        start = end;
+    }
+    return (art_node_t *)node;
+}
+
+void art_bulk_load(art_t *art, art_val_t **vals, size_t count) {
+    assert(art->root == NULL);
+    if (count == 0) {
+        return;
+    }
+    art->root = art_bulk_load_at(art, (art_leaf_t **)vals, count, 0);
+}
+
+void art_builder_init(art_builder_t *builder, art_t *art) {
+    assert(art->root == NULL);
+    builder->art = art;
+    builder->root = NULL;
+    builder->spine_size = 0;
+}
+
+void art_builder_append(art_builder_t *builder, const art_key_chunk_t *key,
+                        art_val_t *val) {
+    art_t *art = builder->art;
+    art_leaf_t *leaf = (art_leaf_t *)val;
+    art_leaf_populate(leaf, key);
+    if (builder->root == NULL) {
+        builder->root = (art_node_t *)SET_LEAF(leaf);
+        memcpy(builder->last_key, key, ART_KEY_BYTES);
+        return;
+    }
+    assert(art_compare_keys(builder->last_key, key) < 0);
+    uint8_t common_prefix = art_common_prefix(builder->last_key, 0,
+                                              ART_KEY_BYTES, key, 0,
+                                              ART_KEY_BYTES);
+    // Nodes indexing deeper chunks than the common prefix are complete, as
+    // all the keys to come are greater than theirs.
+    while (builder->spine_size > 0 &&
+           builder->spine_chunk_depth[builder->spine_size - 1] >
+               common_prefix) {
+        builder->spine_size--;
+    }
+    uint8_t top = builder->spine_size;  // one past the deepest node on the path
+    art_inner_node_t *parent =
+        top > 0 ? (art_inner_node_t *)builder->spine[top - 1] : NULL;
+    uint8_t depth = top > 0 ? builder->spine_chunk_depth[top - 1] + 1 : 0;
+
+    if (parent != NULL && depth - 1 == common_prefix) {
+        // The new leaf is a sibling of the last one.
+        art_node_t *node =
+            art_node_insert_leaf(art, parent, key[common_prefix], leaf);
+        if (node != (art_node_t *)parent) {
+            // The node grew.
+            builder->spine[top - 1] = node;
+            if (top > 1) {
+                uint8_t chunk_depth = builder->spine_chunk_depth[top - 2];
+                art_replace((art_inner_node_t *)builder->spine[top - 2],
+                            key[chunk_depth], node);
+            } else {
+                builder->root = node;
+            }
+        }
+    } else {
+        // Split the last child of the parent (or the root) at the common
+        // prefix with a new node holding it and the new leaf.
+        art_node_t *child =
+            parent != NULL ? art_find_child(parent, key[depth - 1])
+                           : builder->root;
+        art_node4_t *node4 =
+            art_node4_create(art, key + depth, common_prefix - depth);
+        if (!art_is_leaf(child)) {
+            // Trim the part of the prefix now held by the new node.
+            art_inner_node_t *inner_node = (art_inner_node_t *)child;
+            uint8_t trimmed = common_prefix - depth + 1;
+            inner_node->prefix_size -= trimmed;
+            memmove(inner_node->prefix, inner_node->prefix + trimmed,
+                    inner_node->prefix_size);
+        }
+        art_node4_insert(art, node4, child, builder->last_key[common_prefix]);
+        art_node4_insert(art, node4, (art_node_t *)SET_LEAF(leaf),
+                         key[common_prefix]);
+        if (parent != NULL) {
+            art_replace(parent, key[depth - 1], (art_node_t *)node4);
+        } else {
+            builder->root = (art_node_t *)node4;
+        }
+        builder->spine[top] = (art_node_t *)node4;
+        builder->spine_chunk_depth[top] = common_prefix;
+        builder->spine_size++;
+    }
+    memcpy(builder->last_key, key, ART_KEY_BYTES);
+}
+
+void art_builder_finish(art_builder_t *builder) {
+    assert(builder->art->root == NULL);
+    builder->art->root = builder->root;
+    builder->root = NULL;
+    builder->spine_size = 0;
 }
 
 art_val_t *art_erase(art_t *art, const art_key_chunk_t *key) {
     if (art->root == NULL) {
         return NULL;
     }
-    art_erase_result_t result = art_erase_at(art->root, key, 0);
+    art_erase_result_t result = art_erase_at(art, art->root, key, 0);
     if (result.value_erased == NULL) {
         return NULL;
     }
@@ -1473,10 +1785,11 @@ art_val_t *art_find(const art_t *art, const art_key_chunk_t *key) {
 bool art_is_empty(const art_t *art) { return art->root == NULL; }
 
 void art_free(art_t *art) {
-    if (art->root == NULL) {
-        return;
+    // All the nodes live in the allocators.
+    for (size_t i = 0; i < ART_NUM_TYPES; ++i) {
+        art_slab_release(&art->node_slabs[i]);
     }
-    art_free_node(art->root);
+    art->root = NULL;
 }
 
 size_t art_size_in_bytes(const art_t *art) {
@@ -1487,6 +1800,26 @@ size_t art_size_in_bytes(const art_t *art) {
     return size;
 }
 
+size_t art_allocated_size_in_bytes(const art_t *art) {
+    size_t size = sizeof(art_t);
+    for (size_t i = 0; i < ART_NUM_TYPES; ++i) {
+        size += art_slab_size_in_bytes(&art->node_slabs[i]);
+    }
+    return size;
+}
+
+void art_statistics(const art_t *art, art_statistics_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    if (art->root != NULL) {
+        art_statistics_at(art->root, stats);
+    }
+    stats->n_bytes = sizeof(art_t) + stats->n_node4 * sizeof(art_node4_t) +
+                     stats->n_node16 * sizeof(art_node16_t) +
+                     stats->n_node48 * sizeof(art_node48_t) +
+                     stats->n_node256 * sizeof(art_node256_t);
+    stats->n_bytes_allocated = art_allocated_size_in_bytes(art);
+}
+
 void art_printf(const art_t *art) {
     if (art->root == NULL) {
         return;
@@ -1771,7 +2104,7 @@ art_val_t *art_iterator_erase(art_t *art, art_iterator_t *iterator) {
     art_key_chunk_t key_chunk_in_parent =
         iterator->key[iterator->depth + parent_node->prefix_size];
     art_node_t *new_parent_node =
-        art_node_erase(parent_node, key_chunk_in_parent);
+        art_node_erase(art, parent_node, key_chunk_in_parent);
 
     if (new_parent_node != ((art_node_t *)parent_node)) {
         // Replace the pointer to the inner node we erased from in its
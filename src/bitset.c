@@ -5,13 +5,26 @@
 #include <string.h>
 
 #include <roaring/bitset/bitset.h>
+#include <roaring/bitset_util.h>
 #include <roaring/memory.h>
 #include <roaring/portability.h>
 
+#ifndef CROARING_USE_THREADS
+#define CROARING_USE_THREADS 0
+#endif
+#if CROARING_USE_THREADS
+#include <pthread.h>
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
 #ifdef __cplusplus
 extern "C" {
 namespace roaring {
-namespace internal {
+namespace api {
 #endif
 
 extern inline void bitset_print(const bitset_t *b);
@@ -27,6 +40,7 @@ extern inline bool bitset_get(const bitset_t *bitset, size_t i);
 extern inline size_t bitset_size_in_words(const bitset_t *bitset);
 extern inline size_t bitset_size_in_bits(const bitset_t *bitset);
 extern inline size_t bitset_size_in_bytes(const bitset_t *bitset);
+extern inline bool bitset_is_view(const bitset_t *bitset);
 
 /* Create a new bitset. Return NULL in case of failure. */
 bitset_t *bitset_create(void) {
@@ -78,15 +92,27 @@ bitset_t *bitset_copy(const bitset_t *bitset) {
     return copy;
 }
 
+bool bitset_view_init(bitset_t *view, const uint64_t *words, size_t nwords) {
+    if (((uintptr_t)words & (sizeof(uint64_t) - 1)) != 0) return false;
+    // a capacity no owned buffer reaches marks the view, see bitset_is_view
+    view->array = nwords == 0 ? NULL : (uint64_t *)words;
+    view->arraysize = nwords;
+    view->capacity = SIZE_MAX;
+    return true;
+}
+
 void bitset_clear(bitset_t *bitset) {
+    if (bitset_is_view(bitset)) return;
     memset(bitset->array, 0, sizeof(uint64_t) * bitset->arraysize);
 }
 
 void bitset_fill(bitset_t *bitset) {
+    if (bitset_is_view(bitset)) return;
     memset(bitset->array, 0xff, sizeof(uint64_t) * bitset->arraysize);
 }
 
 void bitset_shift_left(bitset_t *bitset, size_t s) {
+    if (bitset_is_view(bitset)) return;
     size_t extra_words = s / 64;
     int inword_shift = s % 64;
     size_t as = bitset->arraysize;
@@ -113,6 +139,7 @@ void bitset_shift_left(bitset_t *bitset, size_t s) {
 }
 
 void bitset_shift_right(bitset_t *bitset, size_t s) {
+    if (bitset_is_view(bitset)) return;
     size_t extra_words = s / 64;
     int inword_shift = s % 64;
     size_t as = bitset->arraysize;
@@ -147,6 +174,9 @@ void bitset_free(bitset_t *bitset) {
 /* Resize the bitset so that it can support newarraysize * 64 bits. Return true
  * in case of success, false for failure. */
 bool bitset_resize(bitset_t *bitset, size_t newarraysize, bool padwithzeroes) {
+    if (bitset_is_view(bitset)) {
+        return false;
+    }
     if (newarraysize > SIZE_MAX / 64) {
         return false;
     }
@@ -175,38 +205,246 @@ bool bitset_resize(bitset_t *bitset, size_t newarraysize, bool padwithzeroes) {
     return true;  // success!
 }
 
-size_t bitset_count(const bitset_t *bitset) {
+#if CROARING_IS_X64
+/*
+ * The SIMD kernels below handle the longest prefix that is a whole number of
+ * vectors and return the number of words they consumed; the scalar loops of
+ * the public functions finish the tail. Short bitsets stay scalar: below this
+ * many words the dispatch and the horizontal sums dominate.
+ */
+#define CROARING_BITSET_SIMD_MIN_WORDS 64
+
+#define CROARING_BITSET_ANDNOT256(a, b) _mm256_andnot_si256(b, a)
+#define CROARING_BITSET_ANDNOT512(a, b) _mm512_andnot_si512(b, a)
+
+/* Computes w1 = w1 OP w2 over as many whole 256-bit vectors as possible. */
+#define CROARING_BITSET_AVX2_INPLACE(opname, avx_intrinsic)                   \
+    static size_t _avx2_bitset_inplace_##opname(                              \
+        uint64_t *CBITSET_RESTRICT w1, const uint64_t *CBITSET_RESTRICT w2,   \
+        size_t length) {                                                      \
+        __m256i *v1 = (__m256i *)w1;                                          \
+        const __m256i *v2 = (const __m256i *)w2;                              \
+        const size_t vectors = length / 4;                                    \
+        size_t i = 0;                                                         \
+        for (; i + 4 <= vectors; i += 4) {                                    \
+            __m256i a1 = avx_intrinsic(_mm256_lddqu_si256(v1 + i),            \
+                                       _mm256_lddqu_si256(v2 + i));           \
+            __m256i a2 = avx_intrinsic(_mm256_lddqu_si256(v1 + i + 1),        \
+                                       _mm256_lddqu_si256(v2 + i + 1));       \
+            __m256i a3 = avx_intrinsic(_mm256_lddqu_si256(v1 + i + 2),        \
+                                       _mm256_lddqu_si256(v2 + i + 2));       \
+            __m256i a4 = avx_intrinsic(_mm256_lddqu_si256(v1 + i + 3),        \
+                                       _mm256_lddqu_si256(v2 + i + 3));       \
+            _mm256_storeu_si256(v1 + i, a1);                                  \
+            _mm256_storeu_si256(v1 + i + 1, a2);                              \
+            _mm256_storeu_si256(v1 + i + 2, a3);                              \
+            _mm256_storeu_si256(v1 + i + 3, a4);                              \
+        }                                                                     \
+        for (; i < vectors; i++) {                                            \
+            _mm256_storeu_si256(v1 + i,                                       \
+                                avx_intrinsic(_mm256_lddqu_si256(v1 + i),     \
+                                              _mm256_lddqu_si256(v2 + i)));   \
+        }                                                                     \
+        return vectors * 4;                                                   \
+    }
+
+CROARING_TARGET_AVX2
+CROARING_BITSET_AVX2_INPLACE(or, _mm256_or_si256)
+CROARING_BITSET_AVX2_INPLACE(and, _mm256_and_si256)
+CROARING_BITSET_AVX2_INPLACE(andnot, CROARING_BITSET_ANDNOT256)
+CROARING_BITSET_AVX2_INPLACE(xor, _mm256_xor_si256)
+CROARING_UNTARGET_AVX2
+
+#if CROARING_COMPILER_SUPPORTS_AVX512
+/* Computes w1 = w1 OP w2 over as many whole 512-bit vectors as possible. */
+#define CROARING_BITSET_AVX512_INPLACE(opname, avx_intrinsic)                 \
+    static size_t _avx512_bitset_inplace_##opname(                            \
+        uint64_t *CBITSET_RESTRICT w1, const uint64_t *CBITSET_RESTRICT w2,   \
+        size_t length) {                                                      \
+        __m512i *v1 = (__m512i *)w1;                                          \
+        const __m512i *v2 = (const __m512i *)w2;                              \
+        const size_t vectors = length / 8;                                    \
+        size_t i = 0;                                                         \
+        for (; i + 2 <= vectors; i += 2) {                                    \
+            __m512i a1 = avx_intrinsic(_mm512_loadu_si512(v1 + i),            \
+                                       _mm512_loadu_si512(v2 + i));           \
+            __m512i a2 = avx_intrinsic(_mm512_loadu_si512(v1 + i + 1),        \
+                                       _mm512_loadu_si512(v2 + i + 1));       \
+            _mm512_storeu_si512(v1 + i, a1);                                  \
+            _mm512_storeu_si512(v1 + i + 1, a2);                              \
+        }                                                                     \
+        for (; i < vectors; i++) {                                            \
+            _mm512_storeu_si512(v1 + i,                                       \
+                                avx_intrinsic(_mm512_loadu_si512(v1 + i),     \
+                                              _mm512_loadu_si512(v2 + i)));   \
+        }                                                                     \
+        return vectors * 8;                                                   \
+    }
+
+CROARING_TARGET_AVX512
+CROARING_BITSET_AVX512_INPLACE(or, _mm512_or_si512)
+CROARING_BITSET_AVX512_INPLACE(and, _mm512_and_si512)
+CROARING_BITSET_AVX512_INPLACE(andnot, CROARING_BITSET_ANDNOT512)
+CROARING_BITSET_AVX512_INPLACE(xor, _mm512_xor_si512)
+CROARING_UNTARGET_AVX512
+
+#define CROARING_BITSET_AVX512_DISPATCH(support, avx512_call, step, length) \
+    if ((support)&ROARING_SUPPORTS_AVX512) {                                \
+        avx512_call;                                                        \
+        return (length) / (step) * (step);                                  \
+    }
+#define CROARING_BITSET_AVX512_INPLACE_DISPATCH(support, opname, w1, w2, n) \
+    if ((support)&ROARING_SUPPORTS_AVX512) {                                \
+        return _avx512_bitset_inplace_##opname(w1, w2, n);                  \
+    }
+#else
+#define CROARING_BITSET_AVX512_DISPATCH(support, avx512_call, step, length)
+#define CROARING_BITSET_AVX512_INPLACE_DISPATCH(support, opname, w1, w2, n)
+#endif  // CROARING_COMPILER_SUPPORTS_AVX512
+
+/* Dispatches w1 = w1 OP w2; returns the number of words processed. */
+#define CROARING_BITSET_SIMD_INPLACE(opname)                                  \
+    static size_t bitset_simd_inplace_##opname(                               \
+        uint64_t *CBITSET_RESTRICT w1, const uint64_t *CBITSET_RESTRICT w2,   \
+        size_t length) {                                                      \
+        if (length < CROARING_BITSET_SIMD_MIN_WORDS) return 0;                \
+        int support = croaring_hardware_support();                            \
+        CROARING_BITSET_AVX512_INPLACE_DISPATCH(support, opname, w1, w2,      \
+                                                length)                       \
+        if (support & ROARING_SUPPORTS_AVX2) {                                \
+            return _avx2_bitset_inplace_##opname(w1, w2, length);             \
+        }                                                                     \
+        return 0;                                                             \
+    }
+
+/*
+ * Adds the population count of (w1 OP w2) to *count, without materializing
+ * the result; returns the number of words processed. As with the
+ * Harley-Seal kernels, andnot computes ~w1 & w2.
+ */
+#define CROARING_BITSET_SIMD_COUNT(opname)                                    \
+    static size_t bitset_simd_##opname##_count(                               \
+        const uint64_t *w1, const uint64_t *w2, size_t length,                \
+        size_t *count) {                                                      \
+        if (length < CROARING_BITSET_SIMD_MIN_WORDS) return 0;                \
+        int support = croaring_hardware_support();                            \
+        CROARING_BITSET_AVX512_DISPATCH(                                      \
+            support,                                                          \
+            *count += avx512_harley_seal_popcount512_##opname(                \
+                (const __m512i *)w1, (const __m512i *)w2, length / 8),        \
+            8, length)                                                        \
+        if (support & ROARING_SUPPORTS_AVX2) {                                \
+            *count += avx2_harley_seal_popcount256_##opname(                  \
+                (const __m256i *)w1, (const __m256i *)w2, length / 4);        \
+            return length / 4 * 4;                                            \
+        }                                                                     \
+        return 0;                                                             \
+    }
+
+CROARING_BITSET_SIMD_INPLACE(or)
+CROARING_BITSET_SIMD_INPLACE(and)
+CROARING_BITSET_SIMD_INPLACE(andnot)
+CROARING_BITSET_SIMD_INPLACE(xor)
+CROARING_BITSET_SIMD_COUNT(or)
+CROARING_BITSET_SIMD_COUNT(and)
+CROARING_BITSET_SIMD_COUNT(andnot)
+CROARING_BITSET_SIMD_COUNT(xor)
+
+/* Adds the population count of the words to *count; returns the number of
+ * words processed. */
+static size_t bitset_simd_count(const uint64_t *words, size_t length,
+                                size_t *count) {
+    if (length < CROARING_BITSET_SIMD_MIN_WORDS) return 0;
+    int support = croaring_hardware_support();
+    CROARING_BITSET_AVX512_DISPATCH(
+        support,
+        *count += avx512_vpopcount((const __m512i *)words, length / 8), 8,
+        length)
+    if (support & ROARING_SUPPORTS_AVX2) {
+        *count +=
+            avx2_harley_seal_popcount256((const __m256i *)words, length / 4);
+        return length / 4 * 4;
+    }
+    return 0;
+}
+#else
+#define bitset_simd_inplace_or(w1, w2, length) ((size_t)0)
+#define bitset_simd_inplace_and(w1, w2, length) ((size_t)0)
+#define bitset_simd_inplace_andnot(w1, w2, length) ((size_t)0)
+#define bitset_simd_inplace_xor(w1, w2, length) ((size_t)0)
+#define bitset_simd_or_count(w1, w2, length, count) ((size_t)0)
+#define bitset_simd_and_count(w1, w2, length, count) ((size_t)0)
+#define bitset_simd_andnot_count(w1, w2, length, count) ((size_t)0)
+#define bitset_simd_xor_count(w1, w2, length, count) ((size_t)0)
+#define bitset_simd_count(words, length, count) ((size_t)0)
+#endif  // CROARING_IS_X64
+
+/* Population count of words[0, length). */
+static size_t bitset_words_count(const uint64_t *words, size_t length) {
     size_t card = 0;
-    size_t k = 0;
-    for (; k + 7 < bitset->arraysize; k += 8) {
-        card += roaring_hamming(bitset->array[k]);
-        card += roaring_hamming(bitset->array[k + 1]);
-        card += roaring_hamming(bitset->array[k + 2]);
-        card += roaring_hamming(bitset->array[k + 3]);
-        card += roaring_hamming(bitset->array[k + 4]);
-        card += roaring_hamming(bitset->array[k + 5]);
-        card += roaring_hamming(bitset->array[k + 6]);
-        card += roaring_hamming(bitset->array[k + 7]);
-    }
-    for (; k + 3 < bitset->arraysize; k += 4) {
-        card += roaring_hamming(bitset->array[k]);
-        card += roaring_hamming(bitset->array[k + 1]);
-        card += roaring_hamming(bitset->array[k + 2]);
-        card += roaring_hamming(bitset->array[k + 3]);
-    }
-    for (; k < bitset->arraysize; k++) {
-        card += roaring_hamming(bitset->array[k]);
+    size_t k = bitset_simd_count(words, length, &card);
+    for (; k + 7 < length; k += 8) {
+        card += roaring_hamming(words[k]);
+        card += roaring_hamming(words[k + 1]);
+        card += roaring_hamming(words[k + 2]);
+        card += roaring_hamming(words[k + 3]);
+        card += roaring_hamming(words[k + 4]);
+        card += roaring_hamming(words[k + 5]);
+        card += roaring_hamming(words[k + 6]);
+        card += roaring_hamming(words[k + 7]);
+    }
+    for (; k + 3 < length; k += 4) {
+        card += roaring_hamming(words[k]);
+        card += roaring_hamming(words[k + 1]);
+        card += roaring_hamming(words[k + 2]);
+        card += roaring_hamming(words[k + 3]);
+    }
+    for (; k < length; k++) {
+        card += roaring_hamming(words[k]);
     }
     return card;
 }
 
+/* w1[k] |= w2[k] for k in [0, length). */
+static void bitset_words_or(uint64_t *CBITSET_RESTRICT w1,
+                            const uint64_t *CBITSET_RESTRICT w2,
+                            size_t length) {
+    size_t k = bitset_simd_inplace_or(w1, w2, length);
+    for (; k < length; ++k) {
+        w1[k] |= w2[k];
+    }
+}
+
+/* w1[k] &= w2[k] for k in [0, length). */
+static void bitset_words_and(uint64_t *CBITSET_RESTRICT w1,
+                             const uint64_t *CBITSET_RESTRICT w2,
+                             size_t length) {
+    size_t k = bitset_simd_inplace_and(w1, w2, length);
+    for (; k < length; ++k) {
+        w1[k] &= w2[k];
+    }
+}
+
+/* w1[k] &= ~w2[k] for k in [0, length). */
+static void bitset_words_andnot(uint64_t *CBITSET_RESTRICT w1,
+                                const uint64_t *CBITSET_RESTRICT w2,
+                                size_t length) {
+    size_t k = bitset_simd_inplace_andnot(w1, w2, length);
+    for (; k < length; ++k) {
+        w1[k] &= ~(w2[k]);
+    }
+}
+
+size_t bitset_count(const bitset_t *bitset) {
+    return bitset_words_count(bitset->array, bitset->arraysize);
+}
+
 bool bitset_inplace_union(bitset_t *CBITSET_RESTRICT b1,
                           const bitset_t *CBITSET_RESTRICT b2) {
+    if (bitset_is_view(b1)) return false;
     size_t minlength =
         b1->arraysize < b2->arraysize ? b1->arraysize : b2->arraysize;
-    for (size_t k = 0; k < minlength; ++k) {
-        b1->array[k] |= b2->array[k];
-    }
+    bitset_words_or(b1->array, b2->array, minlength);
     if (b2->arraysize > b1->arraysize) {
         size_t oldsize = b1->arraysize;
         if (!bitset_resize(b1, b2->arraysize, false)) return false;
@@ -227,6 +465,9 @@ size_t bitset_minimum(const bitset_t *bitset) {
 }
 
 bool bitset_grow(bitset_t *bitset, size_t newarraysize) {
+    if (bitset_is_view(bitset)) {
+        return false;
+    }
     if (newarraysize < bitset->arraysize) {
         return false;
     }
@@ -330,7 +571,7 @@ size_t bitset_union_count(const bitset_t *CBITSET_RESTRICT b1,
     size_t answer = 0;
     size_t minlength =
         b1->arraysize < b2->arraysize ? b1->arraysize : b2->arraysize;
-    size_t k = 0;
+    size_t k = bitset_simd_or_count(b1->array, b2->array, minlength, &answer);
     for (; k + 3 < minlength; k += 4) {
         answer += roaring_hamming(b1->array[k] | b2->array[k]);
         answer += roaring_hamming(b1->array[k + 1] | b2->array[k + 1]);
@@ -342,6 +583,7 @@ size_t bitset_union_count(const bitset_t *CBITSET_RESTRICT b1,
     }
     if (b2->arraysize > b1->arraysize) {
         // k is equal to b1->arraysize
+        k += bitset_simd_count(b2->array + k, b2->arraysize - k, &answer);
         for (; k + 3 < b2->arraysize; k += 4) {
             answer += roaring_hamming(b2->array[k]);
             answer += roaring_hamming(b2->array[k + 1]);
@@ -353,6 +595,7 @@ size_t bitset_union_count(const bitset_t *CBITSET_RESTRICT b1,
         }
     } else {
         // k is equal to b2->arraysize
+        k += bitset_simd_count(b1->array + k, b1->arraysize - k, &answer);
         for (; k + 3 < b1->arraysize; k += 4) {
             answer += roaring_hamming(b1->array[k]);
             answer += roaring_hamming(b1->array[k + 1]);
@@ -368,13 +611,11 @@ size_t bitset_union_count(const bitset_t *CBITSET_RESTRICT b1,
 
 void bitset_inplace_intersection(bitset_t *CBITSET_RESTRICT b1,
                                  const bitset_t *CBITSET_RESTRICT b2) {
+    if (bitset_is_view(b1)) return;
     size_t minlength =
         b1->arraysize < b2->arraysize ? b1->arraysize : b2->arraysize;
-    size_t k = 0;
-    for (; k < minlength; ++k) {
-        b1->array[k] &= b2->array[k];
-    }
-    for (; k < b1->arraysize; ++k) {
+    bitset_words_and(b1->array, b2->array, minlength);
+    for (size_t k = minlength; k < b1->arraysize; ++k) {
         b1->array[k] = 0;  // memset could, maybe, be a tiny bit faster
     }
 }
@@ -384,7 +625,8 @@ size_t bitset_intersection_count(const bitset_t *CBITSET_RESTRICT b1,
     size_t answer = 0;
     size_t minlength =
         b1->arraysize < b2->arraysize ? b1->arraysize : b2->arraysize;
-    for (size_t k = 0; k < minlength; ++k) {
+    size_t k = bitset_simd_and_count(b1->array, b2->array, minlength, &answer);
+    for (; k < minlength; ++k) {
         answer += roaring_hamming(b1->array[k] & b2->array[k]);
     }
     return answer;
@@ -392,23 +634,24 @@ size_t bitset_intersection_count(const bitset_t *CBITSET_RESTRICT b1,
 
 void bitset_inplace_difference(bitset_t *CBITSET_RESTRICT b1,
                                const bitset_t *CBITSET_RESTRICT b2) {
+    if (bitset_is_view(b1)) return;
     size_t minlength =
         b1->arraysize < b2->arraysize ? b1->arraysize : b2->arraysize;
-    size_t k = 0;
-    for (; k < minlength; ++k) {
-        b1->array[k] &= ~(b2->array[k]);
-    }
+    bitset_words_andnot(b1->array, b2->array, minlength);
 }
 
 size_t bitset_difference_count(const bitset_t *CBITSET_RESTRICT b1,
                                const bitset_t *CBITSET_RESTRICT b2) {
     size_t minlength =
         b1->arraysize < b2->arraysize ? b1->arraysize : b2->arraysize;
-    size_t k = 0;
     size_t answer = 0;
+    // the andnot kernels compute ~w1 & w2, hence the swapped operands
+    size_t k =
+        bitset_simd_andnot_count(b2->array, b1->array, minlength, &answer);
     for (; k < minlength; ++k) {
         answer += roaring_hamming(b1->array[k] & ~(b2->array[k]));
     }
+    k += bitset_simd_count(b1->array + k, b1->arraysize - k, &answer);
     for (; k < b1->arraysize; ++k) {
         answer += roaring_hamming(b1->array[k]);
     }
@@ -417,9 +660,10 @@ size_t bitset_difference_count(const bitset_t *CBITSET_RESTRICT b1,
 
 bool bitset_inplace_symmetric_difference(bitset_t *CBITSET_RESTRICT b1,
                                          const bitset_t *CBITSET_RESTRICT b2) {
+    if (bitset_is_view(b1)) return false;
     size_t minlength =
         b1->arraysize < b2->arraysize ? b1->arraysize : b2->arraysize;
-    size_t k = 0;
+    size_t k = bitset_simd_inplace_xor(b1->array, b2->array, minlength);
     for (; k < minlength; ++k) {
         b1->array[k] ^= b2->array[k];
     }
@@ -436,16 +680,18 @@ size_t bitset_symmetric_difference_count(const bitset_t *CBITSET_RESTRICT b1,
                                          const bitset_t *CBITSET_RESTRICT b2) {
     size_t minlength =
         b1->arraysize < b2->arraysize ? b1->arraysize : b2->arraysize;
-    size_t k = 0;
     size_t answer = 0;
+    size_t k = bitset_simd_xor_count(b1->array, b2->array, minlength, &answer);
     for (; k < minlength; ++k) {
         answer += roaring_hamming(b1->array[k] ^ b2->array[k]);
     }
     if (b2->arraysize > b1->arraysize) {
+        k += bitset_simd_count(b2->array + k, b2->arraysize - k, &answer);
         for (; k < b2->arraysize; ++k) {
             answer += roaring_hamming(b2->array[k]);
         }
     } else {
+        k += bitset_simd_count(b1->array + k, b1->arraysize - k, &answer);
         for (; k < b1->arraysize; ++k) {
             answer += roaring_hamming(b1->array[k]);
         }
@@ -454,6 +700,7 @@ size_t bitset_symmetric_difference_count(const bitset_t *CBITSET_RESTRICT b1,
 }
 
 bool bitset_trim(bitset_t *bitset) {
+    if (bitset_is_view(bitset)) return false;
     size_t newsize = bitset->arraysize;
     while (newsize > 0) {
         if (bitset->array[newsize - 1] == 0)
@@ -473,8 +720,243 @@ bool bitset_trim(bitset_t *bitset) {
     return true;
 }
 
+/*
+ * Parallel operations. The word array is cut into chunks of
+ * CROARING_BITSET_CHUNK_WORDS words (256 KiB, about a private L2 cache) that
+ * are dealt round-robin to the tasks, so that all threads stream through
+ * memory side by side. Task 0 runs on the calling thread.
+ */
+#define CROARING_BITSET_CHUNK_WORDS ((size_t)1 << 15)
+
+typedef enum {
+    BITSET_PARALLEL_OR,
+    BITSET_PARALLEL_AND,
+    BITSET_PARALLEL_ANDNOT,
+    BITSET_PARALLEL_COUNT,
+    BITSET_PARALLEL_CHUNK_COUNTS,
+    BITSET_PARALLEL_EXTRACT
+} bitset_parallel_op_t;
+
+typedef struct bitset_parallel_job_s {
+    bitset_parallel_op_t op;
+    uint64_t *w1;        // destination of the in-place operations
+    const uint64_t *w2;  // second operand, or the words to count or extract
+    size_t length;
+    size_t num_chunks;
+    size_t num_tasks;
+    size_t *offsets;  // per-chunk counts, then output offsets (num_chunks + 1)
+    uint32_t *out;
+} bitset_parallel_job_t;
+
+typedef struct bitset_parallel_task_s {
+    bitset_parallel_job_t *job;
+    size_t first_chunk;
+    size_t count;
+#if CROARING_USE_THREADS
+    pthread_t thread;
+    bool started;
+#endif
+} bitset_parallel_task_t;
+
+static void bitset_extract_chunk(const uint64_t *words, size_t length,
+                                 uint32_t *out, size_t count, uint32_t base) {
+#if CROARING_IS_X64
+    // the vectorized decoders only pay off on dense words, the same
+    // heuristic as bitset_container_to_uint32_array
+    int support = croaring_hardware_support();
+    if (count >= length * 8) {
+#if CROARING_COMPILER_SUPPORTS_AVX512
+        if (support & ROARING_SUPPORTS_AVX512) {
+            bitset_extract_setbits_avx512(words, length, out, count, base);
+            return;
+        }
+#endif
+        if (support & ROARING_SUPPORTS_AVX2) {
+            bitset_extract_setbits_avx2(words, length, out, count, base);
+            return;
+        }
+    }
+#else
+    (void)count;
+#endif
+    bitset_extract_setbits(words, length, out, base);
+}
+
+static void bitset_parallel_run_task(bitset_parallel_task_t *task) {
+    bitset_parallel_job_t *job = task->job;
+    for (size_t c = task->first_chunk; c < job->num_chunks;
+         c += job->num_tasks) {
+        size_t begin = c * CROARING_BITSET_CHUNK_WORDS;
+        size_t n = job->length - begin < CROARING_BITSET_CHUNK_WORDS
+                       ? job->length - begin
+                       : CROARING_BITSET_CHUNK_WORDS;
+        switch (job->op) {
+            case BITSET_PARALLEL_OR:
+                bitset_words_or(job->w1 + begin, job->w2 + begin, n);
+                break;
+            case BITSET_PARALLEL_AND:
+                bitset_words_and(job->w1 + begin, job->w2 + begin, n);
+                break;
+            case BITSET_PARALLEL_ANDNOT:
+                bitset_words_andnot(job->w1 + begin, job->w2 + begin, n);
+                break;
+            case BITSET_PARALLEL_COUNT:
+                task->count += bitset_words_count(job->w2 + begin, n);
+                break;
+            case BITSET_PARALLEL_CHUNK_COUNTS:
+                job->offsets[c] = bitset_words_count(job->w2 + begin, n);
+                break;
+            case BITSET_PARALLEL_EXTRACT:
+                bitset_extract_chunk(job->w2 + begin, n,
+                                     job->out + job->offsets[c],
+                                     job->offsets[c + 1] - job->offsets[c],
+                                     (uint32_t)(begin * 64));
+                break;
+        }
+    }
+}
+
+#if CROARING_USE_THREADS
+static void *bitset_parallel_thread(void *arg) {
+    bitset_parallel_run_task((bitset_parallel_task_t *)arg);
+    return NULL;
+}
+#endif
+
+/* Runs the job over its tasks and returns the sum of the task counts. If
+ * threads or memory are unavailable, the work is done on the calling thread.
+ */
+static size_t bitset_parallel_run(bitset_parallel_job_t *job,
+                                  size_t num_threads) {
+    job->num_chunks = (job->length + CROARING_BITSET_CHUNK_WORDS - 1) /
+                      CROARING_BITSET_CHUNK_WORDS;
+    bitset_parallel_task_t single;
+    bitset_parallel_task_t *tasks = &single;
+    size_t num_tasks = 1;
+#if CROARING_USE_THREADS
+    if (num_threads > 1 && job->num_chunks > 1) {
+        num_tasks =
+            num_threads < job->num_chunks ? num_threads : job->num_chunks;
+        tasks = (bitset_parallel_task_t *)roaring_malloc(
+            num_tasks * sizeof(bitset_parallel_task_t));
+        if (tasks == NULL) {
+            tasks = &single;
+            num_tasks = 1;
+        }
+    }
+#else
+    (void)num_threads;
+#endif
+    job->num_tasks = num_tasks;
+    for (size_t t = 0; t < num_tasks; t++) {
+        tasks[t].job = job;
+        tasks[t].first_chunk = t;
+        tasks[t].count = 0;
+    }
+#if CROARING_USE_THREADS
+    for (size_t t = 1; t < num_tasks; t++) {
+        tasks[t].started = pthread_create(&tasks[t].thread, NULL,
+                                          bitset_parallel_thread,
+                                          &tasks[t]) == 0;
+    }
+    bitset_parallel_run_task(&tasks[0]);
+    for (size_t t = 1; t < num_tasks; t++) {
+        if (tasks[t].started) {
+            pthread_join(tasks[t].thread, NULL);
+        } else {
+            bitset_parallel_run_task(&tasks[t]);
+        }
+    }
+#else
+    bitset_parallel_run_task(&tasks[0]);
+#endif
+    size_t count = 0;
+    for (size_t t = 0; t < num_tasks; t++) {
+        count += tasks[t].count;
+    }
+    if (tasks != &single) roaring_free(tasks);
+    return count;
+}
+
+bool bitset_inplace_union_parallel(bitset_t *CBITSET_RESTRICT b1,
+                                   const bitset_t *CBITSET_RESTRICT b2,
+                                   size_t num_threads) {
+    if (bitset_is_view(b1)) return false;
+    if (b2->arraysize > b1->arraysize) {
+        if (!bitset_resize(b1, b2->arraysize, true)) return false;
+    }
+    bitset_parallel_job_t job = {BITSET_PARALLEL_OR, b1->array, b2->array,
+                                 b2->arraysize, 0, 0, NULL, NULL};
+    bitset_parallel_run(&job, num_threads);
+    return true;
+}
+
+void bitset_inplace_intersection_parallel(bitset_t *CBITSET_RESTRICT b1,
+                                          const bitset_t *CBITSET_RESTRICT b2,
+                                          size_t num_threads) {
+    if (bitset_is_view(b1)) return;
+    size_t minlength =
+        b1->arraysize < b2->arraysize ? b1->arraysize : b2->arraysize;
+    bitset_parallel_job_t job = {BITSET_PARALLEL_AND, b1->array, b2->array,
+                                 minlength, 0, 0, NULL, NULL};
+    bitset_parallel_run(&job, num_threads);
+    memset(b1->array + minlength, 0,
+           (b1->arraysize - minlength) * sizeof(uint64_t));
+}
+
+void bitset_inplace_difference_parallel(bitset_t *CBITSET_RESTRICT b1,
+                                        const bitset_t *CBITSET_RESTRICT b2,
+                                        size_t num_threads) {
+    if (bitset_is_view(b1)) return;
+    size_t minlength =
+        b1->arraysize < b2->arraysize ? b1->arraysize : b2->arraysize;
+    bitset_parallel_job_t job = {BITSET_PARALLEL_ANDNOT, b1->array, b2->array,
+                                 minlength, 0, 0, NULL, NULL};
+    bitset_parallel_run(&job, num_threads);
+}
+
+size_t bitset_count_parallel(const bitset_t *bitset, size_t num_threads) {
+    bitset_parallel_job_t job = {BITSET_PARALLEL_COUNT, NULL, bitset->array,
+                                 bitset->arraysize, 0, 0, NULL, NULL};
+    return bitset_parallel_run(&job, num_threads);
+}
+
+size_t bitset_extract_setbits_parallel(const bitset_t *bitset, uint32_t *out,
+                                       size_t num_threads) {
+    // 2^26 words hold 2^32 bits
+    if (bitset->arraysize > ((size_t)1 << 26)) return 0;
+    size_t num_chunks = (bitset->arraysize + CROARING_BITSET_CHUNK_WORDS - 1) /
+                        CROARING_BITSET_CHUNK_WORDS;
+    size_t *offsets =
+        (size_t *)roaring_malloc((num_chunks + 1) * sizeof(size_t));
+    if (offsets == NULL) return 0;
+    bitset_parallel_job_t job = {BITSET_PARALLEL_CHUNK_COUNTS,
+                                 NULL,
+                                 bitset->array,
+                                 bitset->arraysize,
+                                 0,
+                                 0,
+                                 offsets,
+                                 out};
+    bitset_parallel_run(&job, num_threads);
+    size_t total = 0;
+    for (size_t c = 0; c < num_chunks; c++) {
+        size_t n = offsets[c];
+        offsets[c] = total;
+        total += n;
+    }
+    offsets[num_chunks] = total;
+    job.op = BITSET_PARALLEL_EXTRACT;
+    bitset_parallel_run(&job, num_threads);
+    roaring_free(offsets);
+    return total;
+}
+
 #ifdef __cplusplus
 }
 }
-}  // extern "C" { namespace roaring { namespace internal {
+}  // extern "C" { namespace roaring { namespace api {
+#endif
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
 #endif
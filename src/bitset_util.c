@@ -682,6 +682,74 @@ size_t bitset_extract_setbits_avx512_uint16(const uint64_t *array,
 
     return out - initout;
 }
+
+// Loads list[0, 16) as 32-bit integers.
+static inline __m512i _avx512_load_list16(const uint16_t *list) {
+    return _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i *)list));
+}
+
+// Gathers the 32-bit words holding the bits of the sixteen values and returns
+// the mask of the values whose bit is set.
+static inline __mmask16 _avx512_bitset_list_mask(const uint64_t *words,
+                                                 __m512i values) {
+    const __m512i w = _mm512_i32gather_epi32(_mm512_srli_epi32(values, 5),
+                                             (const void *)words, 4);
+    const __m512i bits = _mm512_srlv_epi32(
+        w, _mm512_and_si512(values, _mm512_set1_epi32(31)));
+    return _mm512_test_epi32_mask(bits, _mm512_set1_epi32(1));
+}
+
+size_t bitset_filter_list_avx512(const uint64_t *words, const uint16_t *list,
+                                 uint64_t length, uint16_t *out,
+                                 bool complement) {
+    const __mmask16 flip = complement ? 0xFFFF : 0;
+    size_t outpos = 0;
+    uint64_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m512i values = _avx512_load_list16(list + i);
+        const __mmask16 m = _avx512_bitset_list_mask(words, values) ^ flip;
+        const __m512i kept = _mm512_maskz_compress_epi32(m, values);
+        const int count = roaring_hamming(m);
+        // out may be list: the values are loaded before they are overwritten
+        _mm512_mask_cvtepi32_storeu_epi16(
+            out + outpos, (__mmask16)((1u << count) - 1), kept);
+        outpos += count;
+    }
+    for (; i < length; i++) {
+        const uint16_t key = list[i];
+        out[outpos] = key;
+        outpos += ((words[key >> 6] >> (key & 63)) & 1) ^ complement;
+    }
+    return outpos;
+}
+
+uint64_t bitset_count_list_avx512(const uint64_t *words, const uint16_t *list,
+                                  uint64_t length) {
+    uint64_t card = 0;
+    uint64_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        card += roaring_hamming(
+            _avx512_bitset_list_mask(words, _avx512_load_list16(list + i)));
+    }
+    for (; i < length; i++) {
+        card += (words[list[i] >> 6] >> (list[i] & 63)) & 1;
+    }
+    return card;
+}
+
+bool bitset_intersects_list_avx512(const uint64_t *words, const uint16_t *list,
+                                   uint64_t length) {
+    uint64_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        if (_avx512_bitset_list_mask(words, _avx512_load_list16(list + i))) {
+            return true;
+        }
+    }
+    for (; i < length; i++) {
+        if ((words[list[i] >> 6] >> (list[i] & 63)) & 1) return true;
+    }
+    return false;
+}
 CROARING_UNTARGET_AVX512
 #endif
 
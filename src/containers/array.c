@@ -126,6 +126,28 @@ void array_container_offset(const array_container_t *c, container_t **loc,
     }
 }
 
+void array_container_contains_many(const array_container_t *arr,
+                                   const uint32_t *vals, size_t begin,
+                                   size_t end, uint64_t *out_bits) {
+    const uint16_t *carr = arr->array;
+    const int32_t card = arr->cardinality;
+    int32_t pos = 0;  // first index holding a value >= the previous probe
+    uint16_t previous = 0;
+    size_t i = begin;
+    while (i < end) {
+        const size_t word_end = (i | 63) + 1 < end ? (i | 63) + 1 : end;
+        uint64_t answer = 0;
+        for (; i < word_end; i++) {
+            const uint16_t v = (uint16_t)vals[i];
+            if (v < previous) pos = 0;  // out of order, restart the search
+            pos = advanceUntil(carr, pos - 1, card, v);
+            previous = v;
+            answer |= (uint64_t)(pos < card && carr[pos] == v) << (i & 63);
+        }
+        out_bits[(i - 1) >> 6] |= answer;
+    }
+}
+
 int array_container_shrink_to_fit(array_container_t *src) {
     if (src->cardinality == src->capacity) return 0;  // nothing to do
     int savings = src->capacity - src->cardinality;
@@ -265,6 +287,14 @@ void array_container_xor(const array_container_t *array_1,
     }
 
 #if CROARING_IS_X64
+#if CROARING_COMPILER_SUPPORTS_AVX512
+    if (croaring_hardware_support() & ROARING_SUPPORTS_AVX512) {
+        out->cardinality = avx512_xor_vector16(
+            array_1->array, array_1->cardinality, array_2->array,
+            array_2->cardinality, out->array);
+        return;
+    }
+#endif  // CROARING_COMPILER_SUPPORTS_AVX512
     if (croaring_hardware_support() & ROARING_SUPPORTS_AVX2) {
         out->cardinality =
             xor_vector16(array_1->array, array_1->cardinality, array_2->array,
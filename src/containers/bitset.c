@@ -233,6 +233,23 @@ void bitset_container_offset(const bitset_container_t *c, container_t **loc,
     *hic = bc;
 }
 
+void bitset_container_contains_many(const bitset_container_t *bitset,
+                                    const uint32_t *vals, size_t begin,
+                                    size_t end, uint64_t *out_bits) {
+    const uint64_t *words = bitset->words;
+    // accumulate whole output words to avoid a read-modify-write per probe
+    size_t i = begin;
+    while (i < end) {
+        const size_t word_end = (i | 63) + 1 < end ? (i | 63) + 1 : end;
+        uint64_t answer = 0;
+        for (; i < word_end; i++) {
+            const uint16_t v = (uint16_t)vals[i];
+            answer |= ((words[v >> 6] >> (v & 63)) & 1) << (i & 63);
+        }
+        out_bits[(i - 1) >> 6] |= answer;
+    }
+}
+
 void bitset_container_set_range(bitset_container_t *bitset, uint32_t begin,
                                 uint32_t end) {
     bitset_set_range(bitset->words, begin, end);
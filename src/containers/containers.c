@@ -18,6 +18,15 @@ static inline uint32_t minimum_uint32(uint32_t a, uint32_t b) {
     return (a < b) ? a : b;
 }
 
+// value of rank index of a packed container, given the value of rank index - 1
+static inline uint16_t packed_iterator_value(const packed_container_t *pc,
+                                             int32_t index, uint16_t previous) {
+    if (index % PACKED_BLOCK_SIZE == 0) {
+        return packed_container_firsts(pc)[index / PACKED_BLOCK_SIZE];
+    }
+    return (uint16_t)(previous + packed_container_delta(pc, index));
+}
+
 extern inline const container_t *container_unwrap_shared(
     const container_t *candidate_shared_container, uint8_t *type);
 
@@ -55,6 +64,9 @@ void container_free(container_t *c, uint8_t type) {
         case RUN_CONTAINER_TYPE:
             run_container_free(CAST_run(c));
             break;
+        case PACKED_CONTAINER_TYPE:
+            packed_container_free(CAST_packed(c));
+            break;
         case SHARED_CONTAINER_TYPE:
             shared_container_free(CAST_shared(c));
             break;
@@ -76,6 +88,9 @@ void container_printf(const container_t *c, uint8_t type) {
         case RUN_CONTAINER_TYPE:
             run_container_printf(const_CAST_run(c));
             return;
+        case PACKED_CONTAINER_TYPE:
+            packed_container_printf(const_CAST_packed(c));
+            return;
         default:
             roaring_unreachable;
     }
@@ -94,6 +109,9 @@ void container_printf_as_uint32_array(const container_t *c, uint8_t typecode,
         case RUN_CONTAINER_TYPE:
             run_container_printf_as_uint32_array(const_CAST_run(c), base);
             return;
+        case PACKED_CONTAINER_TYPE:
+            packed_container_printf_as_uint32_array(const_CAST_packed(c), base);
+            return;
         default:
             roaring_unreachable;
     }
@@ -134,6 +152,9 @@ bool container_internal_validate(const container_t *container, uint8_t typecode,
                                             reason);
         case RUN_CONTAINER_TYPE:
             return run_container_validate(const_CAST_run(container), reason);
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_validate(const_CAST_packed(container),
+                                             reason);
         default:
             *reason = "invalid typecode";
             return false;
@@ -166,8 +187,43 @@ extern inline container_t *container_xor(const container_t *c1, uint8_t type1,
                                          const container_t *c2, uint8_t type2,
                                          uint8_t *result_type);
 
+static rle16_t full_container_run = {0, UINT16_MAX};
+
+#ifdef __cplusplus
+// In C++, the containers derive from container_t and cannot be
+// aggregate-initialized. The singleton is set up on first use rather than by a
+// static constructor, which the static initializers of other translation units
+// may run before.
+static run_container_t full_run_container;
+shared_container_t container_full_singleton;
+
+static bool full_container_singleton_setup() {
+    full_run_container.n_runs = 1;
+    full_run_container.capacity = 1;
+    full_run_container.runs = &full_container_run;
+    full_run_container.cardinality = 1 << 16;
+    container_full_singleton.container = &full_run_container;
+    container_full_singleton.typecode = RUN_CONTAINER_TYPE;
+    container_full_singleton.counter = 1;
+    return true;
+}
+
+void container_full_singleton_init(void) {
+    static bool ready = full_container_singleton_setup();  // thread-safe
+    (void)ready;
+}
+#else
+static run_container_t full_run_container = {1, 1, &full_container_run,
+                                             1 << 16};
+shared_container_t container_full_singleton = {&full_run_container,
+                                               RUN_CONTAINER_TYPE, 1};
+#endif
+
 container_t *get_copy_of_container(container_t *c, uint8_t *typecode,
                                    bool copy_on_write) {
+    if (container_is_full_singleton(c)) {
+        return c;  // immutable, so every bitmap can reference it
+    }
     if (copy_on_write) {
         shared_container_t *shared_container;
         if (*typecode == SHARED_CONTAINER_TYPE) {
@@ -213,7 +269,12 @@ container_t *container_clone(const container_t *c, uint8_t typecode) {
             return array_container_clone(const_CAST_array(c));
         case RUN_CONTAINER_TYPE:
             return run_container_clone(const_CAST_run(c));
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_clone(const_CAST_packed(c));
         case SHARED_CONTAINER_TYPE:
+            if (container_is_full_singleton(c)) {
+                return &container_full_singleton;  // see get_copy_of_container
+            }
             // Shared containers are not cloneable. Are you mixing COW and
             // non-COW bitmaps?
             return NULL;
@@ -229,7 +290,8 @@ container_t *shared_container_extract_copy(shared_container_t *sc,
     assert(sc->typecode != SHARED_CONTAINER_TYPE);
     *typecode = sc->typecode;
     container_t *answer;
-    if (croaring_refcount_dec(&sc->counter)) {
+    if (!container_is_full_singleton(sc) &&
+        croaring_refcount_dec(&sc->counter)) {
         answer = sc->container;
         sc->container = NULL;  // paranoid
         roaring_free(sc);
@@ -241,7 +303,8 @@ container_t *shared_container_extract_copy(shared_container_t *sc,
 }
 
 void shared_container_free(shared_container_t *container) {
-    if (croaring_refcount_dec(&container->counter)) {
+    if (!container_is_full_singleton(container) &&
+        croaring_refcount_dec(&container->counter)) {
         assert(container->typecode != SHARED_CONTAINER_TYPE);
         container_free(container->container, container->typecode);
         container->container = NULL;  // paranoid
@@ -320,6 +383,13 @@ roaring_container_iterator_t container_init_iterator(const container_t *c,
                 .index = 0,
             };
         }
+        case PACKED_CONTAINER_TYPE: {
+            const packed_container_t *pc = const_CAST_packed(c);
+            *value = packed_container_minimum(pc);
+            return ROARING_INIT_ROARING_CONTAINER_ITERATOR_T{
+                .index = 0,
+            };
+        }
         default:
             assert(false);
             roaring_unreachable;
@@ -363,6 +433,14 @@ roaring_container_iterator_t container_init_iterator_last(const container_t *c,
                 .index = run_index,
             };
         }
+        case PACKED_CONTAINER_TYPE: {
+            const packed_container_t *pc = const_CAST_packed(c);
+            int32_t index = pc->cardinality - 1;
+            *value = packed_container_get(pc, index);
+            return ROARING_INIT_ROARING_CONTAINER_ITERATOR_T{
+                .index = index,
+            };
+        }
         default:
             assert(false);
             roaring_unreachable;
@@ -427,6 +505,15 @@ bool container_iterator_next(const container_t *c, uint8_t typecode,
             }
             return false;
         }
+        case PACKED_CONTAINER_TYPE: {
+            const packed_container_t *pc = const_CAST_packed(c);
+            it->index++;
+            if (it->index < pc->cardinality) {
+                *value = packed_iterator_value(pc, it->index, *value);
+                return true;
+            }
+            return false;
+        }
         default:
             assert(false);
             roaring_unreachable;
@@ -485,6 +572,19 @@ bool container_iterator_prev(const container_t *c, uint8_t typecode,
             *value = rc->runs[it->index].value + rc->runs[it->index].length;
             return true;
         }
+        case PACKED_CONTAINER_TYPE: {
+            if (--it->index < 0) {
+                return false;
+            }
+            const packed_container_t *pc = const_CAST_packed(c);
+            if ((it->index + 1) % PACKED_BLOCK_SIZE == 0) {
+                // we left a block: walk the previous one from its start
+                *value = packed_container_get(pc, it->index);
+            } else {
+                *value -= packed_container_delta(pc, it->index + 1);
+            }
+            return true;
+        }
         default:
             assert(false);
             roaring_unreachable;
@@ -521,6 +621,102 @@ bool container_iterator_lower_bound(const container_t *c, uint8_t typecode,
             }
             return true;
         }
+        case PACKED_CONTAINER_TYPE: {
+            const packed_container_t *pc = const_CAST_packed(c);
+            it->index = packed_container_index_equalorlarger(pc, val);
+            *value_out = packed_container_get(pc, it->index);
+            return true;
+        }
+        default:
+            assert(false);
+            roaring_unreachable;
+            return false;
+    }
+}
+
+bool container_iterator_read_range(const container_t *c, uint8_t typecode,
+                                   roaring_container_iterator_t *it,
+                                   uint16_t *value, uint16_t *range_end) {
+    switch (typecode) {
+        case BITSET_CONTAINER_TYPE: {
+            const bitset_container_t *bc = const_CAST_bitset(c);
+            // Find the first unset bit after the current one.
+            int32_t wordindex = it->index / 64;
+            uint64_t word =
+                ~bc->words[wordindex] & (UINT64_MAX << (it->index % 64));
+            while (word == 0 &&
+                   wordindex + 1 < BITSET_CONTAINER_SIZE_IN_WORDS) {
+                wordindex++;
+                word = ~bc->words[wordindex];
+            }
+            if (word == 0) {
+                *range_end = UINT16_MAX;
+                return false;
+            }
+            int32_t end = wordindex * 64 + roaring_trailing_zeroes(word);
+            *range_end = (uint16_t)(end - 1);
+            // Find the next set bit, which comes after that unset bit.
+            word = bc->words[wordindex] & (UINT64_MAX << (end % 64));
+            while (word == 0 &&
+                   wordindex + 1 < BITSET_CONTAINER_SIZE_IN_WORDS) {
+                wordindex++;
+                word = bc->words[wordindex];
+            }
+            if (word == 0) {
+                return false;
+            }
+            it->index = wordindex * 64 + roaring_trailing_zeroes(word);
+            *value = it->index;
+            return true;
+        }
+        case ARRAY_CONTAINER_TYPE: {
+            const array_container_t *ac = const_CAST_array(c);
+            int32_t index = it->index;
+            while (index + 1 < ac->cardinality &&
+                   ac->array[index + 1] == ac->array[index] + 1) {
+                index++;
+            }
+            *range_end = ac->array[index];
+            it->index = index + 1;
+            if (it->index < ac->cardinality) {
+                *value = ac->array[it->index];
+                return true;
+            }
+            return false;
+        }
+        case RUN_CONTAINER_TYPE: {
+            const run_container_t *rc = const_CAST_run(c);
+            uint32_t end =
+                rc->runs[it->index].value + rc->runs[it->index].length;
+            // Runs are not supposed to touch, but merge them if they do.
+            while (it->index + 1 < rc->n_runs &&
+                   rc->runs[it->index + 1].value == end + 1) {
+                it->index++;
+                end = rc->runs[it->index].value + rc->runs[it->index].length;
+            }
+            *range_end = (uint16_t)end;
+            it->index++;
+            if (it->index < rc->n_runs) {
+                *value = rc->runs[it->index].value;
+                return true;
+            }
+            return false;
+        }
+        case PACKED_CONTAINER_TYPE: {
+            const packed_container_t *pc = const_CAST_packed(c);
+            uint16_t end = *value;
+            while (++it->index < pc->cardinality) {
+                uint16_t next = packed_iterator_value(pc, it->index, end);
+                if (next != end + 1) {
+                    *range_end = end;
+                    *value = next;
+                    return true;
+                }
+                end = next;
+            }
+            *range_end = end;
+            return false;
+        }
         default:
             assert(false);
             roaring_unreachable;
@@ -610,6 +806,20 @@ bool container_iterator_read_into_uint32(const container_t *c, uint8_t typecode,
             } while (*consumed < count);
             return true;
         }
+        case PACKED_CONTAINER_TYPE: {
+            const packed_container_t *pc = const_CAST_packed(c);
+            uint16_t v = *value_out;
+            do {
+                *buf++ = high16 | v;
+                (*consumed)++;
+                if (++it->index >= pc->cardinality) {
+                    return false;
+                }
+                v = packed_iterator_value(pc, it->index, v);
+            } while (*consumed < count);
+            *value_out = v;
+            return true;
+        }
         default:
             assert(false);
             roaring_unreachable;
@@ -699,6 +909,20 @@ bool container_iterator_read_into_uint64(const container_t *c, uint8_t typecode,
             } while (*consumed < count);
             return true;
         }
+        case PACKED_CONTAINER_TYPE: {
+            const packed_container_t *pc = const_CAST_packed(c);
+            uint16_t v = *value_out;
+            do {
+                *buf++ = high48 | v;
+                (*consumed)++;
+                if (++it->index >= pc->cardinality) {
+                    return false;
+                }
+                v = packed_iterator_value(pc, it->index, v);
+            } while (*consumed < count);
+            *value_out = v;
+            return true;
+        }
         default:
             assert(false);
             roaring_unreachable;
@@ -706,6 +930,394 @@ bool container_iterator_read_into_uint64(const container_t *c, uint8_t typecode,
     }
 }
 
+/*
+ * Packed containers only implement the queries natively. The other operations
+ * decode them into array containers first.
+ */
+
+// If *c is a packed container, makes *c an array copy of it and returns the
+// copy (to be freed by the caller); otherwise returns NULL. *c is set to NULL
+// if the copy cannot be allocated, and the caller then fails.
+static array_container_t *container_unpack(const container_t **c,
+                                           uint8_t *type) {
+    if (*type != PACKED_CONTAINER_TYPE) return NULL;
+    array_container_t *array =
+        array_container_from_packed(const_CAST_packed(*c));
+    *c = array;
+    *type = ARRAY_CONTAINER_TYPE;
+    return array;
+}
+
+static inline void container_free_unpacked(array_container_t *array) {
+    if (array != NULL) array_container_free(array);
+}
+
+bool container_equals_unpacked(const container_t *c1, uint8_t type1,
+                               const container_t *c2, uint8_t type2) {
+    if (type1 == PACKED_CONTAINER_TYPE && type2 == PACKED_CONTAINER_TYPE) {
+        return packed_container_equals(const_CAST_packed(c1),
+                                       const_CAST_packed(c2));
+    }
+    array_container_t *a1 = container_unpack(&c1, &type1);
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    bool answer =
+        c1 != NULL && c2 != NULL && container_equals(c1, type1, c2, type2);
+    container_free_unpacked(a1);
+    container_free_unpacked(a2);
+    return answer;
+}
+
+bool container_is_subset_unpacked(const container_t *c1, uint8_t type1,
+                                  const container_t *c2, uint8_t type2) {
+    array_container_t *a1 = container_unpack(&c1, &type1);
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    bool answer =
+        c1 != NULL && c2 != NULL && container_is_subset(c1, type1, c2, type2);
+    container_free_unpacked(a1);
+    container_free_unpacked(a2);
+    return answer;
+}
+
+container_t *container_and_unpacked(const container_t *c1, uint8_t type1,
+                                    const container_t *c2, uint8_t type2,
+                                    uint8_t *result_type) {
+    array_container_t *a1 = container_unpack(&c1, &type1);
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    container_t *result = NULL;
+    if (c1 != NULL && c2 != NULL) {
+        result = container_and(c1, type1, c2, type2, result_type);
+    }
+    container_free_unpacked(a1);
+    container_free_unpacked(a2);
+    return result;
+}
+
+int container_and_cardinality_unpacked(const container_t *c1, uint8_t type1,
+                                       const container_t *c2, uint8_t type2) {
+    array_container_t *a1 = container_unpack(&c1, &type1);
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    int answer = (c1 == NULL || c2 == NULL)
+                     ? 0
+                     : container_and_cardinality(c1, type1, c2, type2);
+    container_free_unpacked(a1);
+    container_free_unpacked(a2);
+    return answer;
+}
+
+bool container_intersect_unpacked(const container_t *c1, uint8_t type1,
+                                  const container_t *c2, uint8_t type2) {
+    array_container_t *a1 = container_unpack(&c1, &type1);
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    bool answer =
+        c1 != NULL && c2 != NULL && container_intersect(c1, type1, c2, type2);
+    container_free_unpacked(a1);
+    container_free_unpacked(a2);
+    return answer;
+}
+
+container_t *container_or_unpacked(const container_t *c1, uint8_t type1,
+                                   const container_t *c2, uint8_t type2,
+                                   uint8_t *result_type) {
+    array_container_t *a1 = container_unpack(&c1, &type1);
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    container_t *result = NULL;
+    if (c1 != NULL && c2 != NULL) {
+        result = container_or(c1, type1, c2, type2, result_type);
+    }
+    container_free_unpacked(a1);
+    container_free_unpacked(a2);
+    return result;
+}
+
+container_t *container_lazy_or_unpacked(const container_t *c1, uint8_t type1,
+                                        const container_t *c2, uint8_t type2,
+                                        uint8_t *result_type) {
+    array_container_t *a1 = container_unpack(&c1, &type1);
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    container_t *result = NULL;
+    if (c1 != NULL && c2 != NULL) {
+        result = container_lazy_or(c1, type1, c2, type2, result_type);
+    }
+    container_free_unpacked(a1);
+    container_free_unpacked(a2);
+    return result;
+}
+
+container_t *container_xor_unpacked(const container_t *c1, uint8_t type1,
+                                    const container_t *c2, uint8_t type2,
+                                    uint8_t *result_type) {
+    array_container_t *a1 = container_unpack(&c1, &type1);
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    container_t *result = NULL;
+    if (c1 != NULL && c2 != NULL) {
+        result = container_xor(c1, type1, c2, type2, result_type);
+    }
+    container_free_unpacked(a1);
+    container_free_unpacked(a2);
+    return result;
+}
+
+container_t *container_lazy_xor_unpacked(const container_t *c1, uint8_t type1,
+                                         const container_t *c2, uint8_t type2,
+                                         uint8_t *result_type) {
+    array_container_t *a1 = container_unpack(&c1, &type1);
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    container_t *result = NULL;
+    if (c1 != NULL && c2 != NULL) {
+        result = container_lazy_xor(c1, type1, c2, type2, result_type);
+    }
+    container_free_unpacked(a1);
+    container_free_unpacked(a2);
+    return result;
+}
+
+container_t *container_andnot_unpacked(const container_t *c1, uint8_t type1,
+                                       const container_t *c2, uint8_t type2,
+                                       uint8_t *result_type) {
+    array_container_t *a1 = container_unpack(&c1, &type1);
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    container_t *result = NULL;
+    if (c1 != NULL && c2 != NULL) {
+        result = container_andnot(c1, type1, c2, type2, result_type);
+    }
+    container_free_unpacked(a1);
+    container_free_unpacked(a2);
+    return result;
+}
+
+container_t *container_not_unpacked(const container_t *c,
+                                    uint8_t *result_type) {
+    uint8_t type = PACKED_CONTAINER_TYPE;
+    array_container_t *a = container_unpack(&c, &type);
+    if (c == NULL) return NULL;
+    container_t *result = container_not(c, type, result_type);
+    container_free_unpacked(a);
+    return result;
+}
+
+container_t *container_not_range_unpacked(const container_t *c,
+                                          uint32_t range_start,
+                                          uint32_t range_end,
+                                          uint8_t *result_type) {
+    uint8_t type = PACKED_CONTAINER_TYPE;
+    array_container_t *a = container_unpack(&c, &type);
+    if (c == NULL) return NULL;
+    container_t *result =
+        container_not_range(c, type, range_start, range_end, result_type);
+    container_free_unpacked(a);
+    return result;
+}
+
+void container_contains_many_unpacked(const container_t *c,
+                                      const uint32_t *vals, size_t begin,
+                                      size_t end, uint64_t *out_bits) {
+    uint8_t type = PACKED_CONTAINER_TYPE;
+    array_container_t *a = container_unpack(&c, &type);
+    if (c == NULL) return;
+    container_contains_many(c, type, vals, begin, end, out_bits);
+    container_free_unpacked(a);
+}
+
+void container_add_offset_unpacked(const container_t *c, container_t **lo,
+                                   container_t **hi, uint16_t offset) {
+    uint8_t type = PACKED_CONTAINER_TYPE;
+    array_container_t *a = container_unpack(&c, &type);
+    if (c == NULL) return;  // *lo and *hi stay NULL
+    container_add_offset(c, type, lo, hi, offset);
+    container_free_unpacked(a);
+}
+
+/*
+ * In-place operations where the caller frees c1 if the result differs from
+ * it: a packed c1 is replaced by an array copy, which is freed here unless
+ * it is the result.
+ */
+
+container_t *container_iand_unpacked(container_t *c1, uint8_t type1,
+                                     const container_t *c2, uint8_t type2,
+                                     uint8_t *result_type) {
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    container_t *result = NULL;
+    if (c2 == NULL) {
+        // allocation failure, result stays NULL
+    } else if (type1 == PACKED_CONTAINER_TYPE) {
+        array_container_t *a1 = array_container_from_packed(CAST_packed(c1));
+        if (a1 != NULL) {
+            result = container_iand(a1, ARRAY_CONTAINER_TYPE, c2, type2,
+                                    result_type);
+            if (result != a1) array_container_free(a1);
+        }
+    } else {
+        result = container_iand(c1, type1, c2, type2, result_type);
+    }
+    container_free_unpacked(a2);
+    return result;
+}
+
+container_t *container_ior_unpacked(container_t *c1, uint8_t type1,
+                                    const container_t *c2, uint8_t type2,
+                                    uint8_t *result_type) {
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    container_t *result = NULL;
+    if (c2 == NULL) {
+        // allocation failure, result stays NULL
+    } else if (type1 == PACKED_CONTAINER_TYPE) {
+        array_container_t *a1 = array_container_from_packed(CAST_packed(c1));
+        if (a1 != NULL) {
+            result =
+                container_ior(a1, ARRAY_CONTAINER_TYPE, c2, type2, result_type);
+            if (result != a1) array_container_free(a1);
+        }
+    } else {
+        result = container_ior(c1, type1, c2, type2, result_type);
+    }
+    container_free_unpacked(a2);
+    return result;
+}
+
+container_t *container_lazy_ior_unpacked(container_t *c1, uint8_t type1,
+                                         const container_t *c2, uint8_t type2,
+                                         uint8_t *result_type) {
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    container_t *result = NULL;
+    if (c2 == NULL) {
+        // allocation failure, result stays NULL
+    } else if (type1 == PACKED_CONTAINER_TYPE) {
+        array_container_t *a1 = array_container_from_packed(CAST_packed(c1));
+        if (a1 != NULL) {
+            result = container_lazy_ior(a1, ARRAY_CONTAINER_TYPE, c2, type2,
+                                        result_type);
+            if (result != a1) array_container_free(a1);
+        }
+    } else {
+        result = container_lazy_ior(c1, type1, c2, type2, result_type);
+    }
+    container_free_unpacked(a2);
+    return result;
+}
+
+container_t *container_add_unpacked(container_t *c, uint16_t val,
+                                    uint8_t *new_typecode) {
+    array_container_t *a = array_container_from_packed(CAST_packed(c));
+    if (a == NULL) return NULL;
+    container_t *result =
+        container_add(a, val, ARRAY_CONTAINER_TYPE, new_typecode);
+    if (result != a) array_container_free(a);
+    return result;
+}
+
+container_t *container_remove_unpacked(container_t *c, uint16_t val,
+                                       uint8_t *new_typecode) {
+    array_container_t *a = array_container_from_packed(CAST_packed(c));
+    if (a == NULL) return NULL;
+    container_t *result =
+        container_remove(a, val, ARRAY_CONTAINER_TYPE, new_typecode);
+    if (result != a) array_container_free(a);
+    return result;
+}
+
+container_t *container_add_range_unpacked(container_t *c, uint32_t min,
+                                          uint32_t max, uint8_t *result_type) {
+    array_container_t *a = array_container_from_packed(CAST_packed(c));
+    if (a == NULL) return NULL;
+    container_t *result =
+        container_add_range(a, ARRAY_CONTAINER_TYPE, min, max, result_type);
+    if (result != a) array_container_free(a);
+    return result;
+}
+
+container_t *container_remove_range_unpacked(container_t *c, uint32_t min,
+                                             uint32_t max,
+                                             uint8_t *result_type) {
+    array_container_t *a = array_container_from_packed(CAST_packed(c));
+    if (a == NULL) return NULL;
+    container_t *result =
+        container_remove_range(a, ARRAY_CONTAINER_TYPE, min, max, result_type);
+    if (result != a) array_container_free(a);
+    return result;
+}
+
+/*
+ * In-place operations that consume c1: a packed c1 is freed and replaced by
+ * an array copy, which the operation then consumes.
+ */
+
+// Replaces a packed container by an array container holding the same values.
+// The packed container is freed even if the copy cannot be allocated, in which
+// case this returns NULL.
+static container_t *container_unpack_and_free(container_t *c, uint8_t *type) {
+    if (*type != PACKED_CONTAINER_TYPE) return c;
+    array_container_t *array = array_container_from_packed(CAST_packed(c));
+    packed_container_free(CAST_packed(c));
+    *type = ARRAY_CONTAINER_TYPE;
+    return array;
+}
+
+container_t *container_ixor_unpacked(container_t *c1, uint8_t type1,
+                                     const container_t *c2, uint8_t type2,
+                                     uint8_t *result_type) {
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    c1 = container_unpack_and_free(c1, &type1);
+    if (c1 == NULL || c2 == NULL) {
+        // c1 is consumed either way
+        if (c1 != NULL) container_free(c1, type1);
+        container_free_unpacked(a2);
+        return NULL;
+    }
+    container_t *result = container_ixor(c1, type1, c2, type2, result_type);
+    container_free_unpacked(a2);
+    return result;
+}
+
+container_t *container_lazy_ixor_unpacked(container_t *c1, uint8_t type1,
+                                          const container_t *c2, uint8_t type2,
+                                          uint8_t *result_type) {
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    c1 = container_unpack_and_free(c1, &type1);
+    if (c1 == NULL || c2 == NULL) {
+        // c1 is consumed either way
+        if (c1 != NULL) container_free(c1, type1);
+        container_free_unpacked(a2);
+        return NULL;
+    }
+    container_t *result =
+        container_lazy_ixor(c1, type1, c2, type2, result_type);
+    container_free_unpacked(a2);
+    return result;
+}
+
+container_t *container_iandnot_unpacked(container_t *c1, uint8_t type1,
+                                        const container_t *c2, uint8_t type2,
+                                        uint8_t *result_type) {
+    array_container_t *a2 = container_unpack(&c2, &type2);
+    c1 = container_unpack_and_free(c1, &type1);
+    if (c1 == NULL || c2 == NULL) {
+        // c1 is consumed either way
+        if (c1 != NULL) container_free(c1, type1);
+        container_free_unpacked(a2);
+        return NULL;
+    }
+    container_t *result = container_iandnot(c1, type1, c2, type2, result_type);
+    container_free_unpacked(a2);
+    return result;
+}
+
+container_t *container_inot_unpacked(container_t *c, uint8_t *result_type) {
+    uint8_t type = PACKED_CONTAINER_TYPE;
+    c = container_unpack_and_free(c, &type);
+    if (c == NULL) return NULL;
+    return container_inot(c, type, result_type);
+}
+
+container_t *container_inot_range_unpacked(container_t *c, uint32_t range_start,
+                                           uint32_t range_end,
+                                           uint8_t *result_type) {
+    uint8_t type = PACKED_CONTAINER_TYPE;
+    c = container_unpack_and_free(c, &type);
+    if (c == NULL) return NULL;
+    return container_inot_range(c, type, range_start, range_end, result_type);
+}
+
 #ifdef __cplusplus
 }
 }
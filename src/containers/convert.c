@@ -85,6 +85,7 @@ static void add_run(run_container_t *rc, int s, int e) {
     rc->runs[rc->n_runs].value = s;
     rc->runs[rc->n_runs].length = e - s;
     rc->n_runs++;
+    rc->cardinality += e - s + 1;
 }
 
 run_container_t *run_container_from_array(const array_container_t *c) {
@@ -313,6 +314,26 @@ container_t *convert_run_optimize(container_t *c, uint8_t typecode_original,
             cur_word = cur_word_with_1s & (cur_word_with_1s + 1);
         }
         return answer;
+    } else if (typecode_original == PACKED_CONTAINER_TYPE) {
+        // runs are only worth it if they beat the packed form
+        packed_container_t *c_qua_packed = CAST_packed(c);
+        int32_t n_runs = packed_container_number_of_runs(c_qua_packed);
+        int32_t size_as_run_container =
+            run_container_serialized_size_in_bytes(n_runs);
+        int32_t size_as_packed_container =
+            packed_container_memory_size_in_bytes(c_qua_packed) -
+            (int32_t)sizeof(packed_container_t);
+
+        if (size_as_run_container >= size_as_packed_container) {
+            *typecode_after = PACKED_CONTAINER_TYPE;
+            return c;
+        }
+        array_container_t *array = array_container_from_packed(c_qua_packed);
+        run_container_t *answer = run_container_from_array(array);
+        array_container_free(array);
+        packed_container_free(c_qua_packed);
+        *typecode_after = RUN_CONTAINER_TYPE;
+        return answer;
     } else {
         assert(false);
         roaring_unreachable;
@@ -320,6 +341,46 @@ container_t *convert_run_optimize(container_t *c, uint8_t typecode_original,
     }
 }
 
+packed_container_t *packed_container_from_array(const array_container_t *arr) {
+    return packed_container_create_from_values(arr->array, arr->cardinality);
+}
+
+bitset_container_t *bitset_container_from_packed(const packed_container_t *p) {
+    uint16_t values[PACKED_BLOCK_SIZE];
+    bitset_container_t *ans = bitset_container_create();
+    for (int32_t block = 0; block < p->n_blocks; block++) {
+        int32_t length = packed_container_decode_block(p, block, values);
+        for (int32_t i = 0; i < length; i++) {
+            bitset_container_set(ans, values[i]);
+        }
+    }
+    return ans;
+}
+
+array_container_t *array_container_from_packed(const packed_container_t *p) {
+    array_container_t *answer =
+        array_container_create_given_capacity(packed_container_cardinality(p));
+    if (answer == NULL) return NULL;
+    packed_container_decode(p, answer->array);
+    answer->cardinality = packed_container_cardinality(p);
+    return answer;
+}
+
+container_t *convert_array_to_packed_if_smaller(array_container_t *arr,
+                                                uint8_t *typecode_after) {
+    *typecode_after = ARRAY_CONTAINER_TYPE;
+    if (arr->cardinality == 0 ||
+        packed_container_data_size(arr->array, arr->cardinality) >=
+            array_container_size_in_bytes(arr)) {
+        return arr;
+    }
+    packed_container_t *answer = packed_container_from_array(arr);
+    if (answer == NULL) return arr;
+    array_container_free(arr);
+    *typecode_after = PACKED_CONTAINER_TYPE;
+    return answer;
+}
+
 container_t *container_from_run_range(const run_container_t *run, uint32_t min,
                                       uint32_t max, uint8_t *typecode_after) {
     // We expect most of the time to end up with a bitset container
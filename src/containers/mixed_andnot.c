@@ -30,6 +30,14 @@ void array_bitset_container_andnot(const array_container_t *src_1,
     }
     int32_t newcard = 0;
     const int32_t origcard = src_1->cardinality;
+#if CROARING_IS_X64 && CROARING_COMPILER_SUPPORTS_AVX512
+    if ((origcard >= ARRAY_BITSET_GATHER_THRESHOLD) &&
+        (croaring_hardware_support() & ROARING_SUPPORTS_AVX512)) {
+        dst->cardinality = (int32_t)bitset_filter_list_avx512(
+            src_2->words, src_1->array, origcard, dst->array, true);
+        return;
+    }
+#endif
     for (int i = 0; i < origcard; ++i) {
         uint16_t key = src_1->array[i];
         dst->array[newcard] = key;
@@ -112,6 +120,12 @@ bool run_bitset_container_andnot(const run_container_t *src_1,
         answer->cardinality = 0;
         for (int32_t rlepos = 0; rlepos < src_1->n_runs; ++rlepos) {
             rle16_t rle = src_1->runs[rlepos];
+            if (rle.length >= RUN_BITSET_DECODE_THRESHOLD) {
+                answer->cardinality += bitset_lenrange_extract_uint16(
+                    src_2->words, rle.value, rle.length, true,
+                    answer->array + answer->cardinality);
+                continue;
+            }
             for (int run_value = rle.value; run_value <= rle.value + rle.length;
                  ++run_value) {
                 if (!bitset_container_get(src_2, (uint16_t)run_value)) {
@@ -339,6 +353,7 @@ int run_array_container_andnot(const run_container_t *src_1,
                 answer->n_runs += (src_1->n_runs - rlepos);
             }
         }
+        answer->cardinality = run_container_compute_cardinality(answer);
         uint8_t return_type;
         *dst = convert_run_to_efficient_container(answer, &return_type);
         if (answer != *dst) run_container_free(answer);
@@ -391,6 +406,31 @@ void array_run_container_andnot(const array_container_t *src_1,
         dst->cardinality = src_1->cardinality;
         return;
     }
+    if (src_1->cardinality >= ARRAY_RUN_GALLOP_RATIO * src_2->n_runs) {
+        // many values per run: we gallop over the array to each run, and copy
+        // the values between the runs as blocks
+        const int32_t card = src_1->cardinality;
+        int32_t dest_card = 0;
+        int32_t arraypos = 0;  // the first value that we have not yet handled
+        for (int32_t rlepos = 0; rlepos < src_2->n_runs; ++rlepos) {
+            const rle16_t rle = src_2->runs[rlepos];
+            const int32_t first =
+                advanceUntil(src_1->array, arraypos - 1, card, rle.value);
+            memmove(dst->array + dest_card, src_1->array + arraypos,
+                    (first - arraypos) * sizeof(uint16_t));
+            dest_card += first - arraypos;
+            const uint32_t end = (uint32_t)rle.value + rle.length;
+            arraypos = (end == UINT16_MAX)
+                           ? card
+                           : advanceUntil(src_1->array, first - 1, card,
+                                          (uint16_t)(end + 1));
+            if (arraypos == card) break;
+        }
+        memmove(dst->array + dest_card, src_1->array + arraypos,
+                (card - arraypos) * sizeof(uint16_t));
+        dst->cardinality = dest_card + card - arraypos;
+        return;
+    }
     int32_t run_start = src_2->runs[0].value;
     int32_t run_end = run_start + src_2->runs[0].length;
     int which_run = 0;
@@ -405,8 +445,9 @@ void array_run_container_andnot(const array_container_t *src_1,
             ;  // omitted item
         } else {
             do {
-                if (which_run + 1 < src_2->n_runs) {
-                    ++which_run;
+                which_run = run_skip_until_end(src_2->runs, which_run + 1,
+                                               src_2->n_runs, val);
+                if (which_run < src_2->n_runs) {
                     run_start = src_2->runs[which_run].value;
                     run_end = run_start + src_2->runs[which_run].length;
 
@@ -3,10 +3,13 @@
  *
  */
 
+#include <string.h>
+
 #include <roaring/array_util.h>
 #include <roaring/bitset_util.h>
 #include <roaring/containers/convert.h>
 #include <roaring/containers/mixed_intersection.h>
+#include <roaring/containers/perfparameters.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -24,6 +27,14 @@ void array_bitset_container_intersection(const array_container_t *src_1,
     }
     int32_t newcard = 0;  // dst could be src_1
     const int32_t origcard = src_1->cardinality;
+#if CROARING_IS_X64 && CROARING_COMPILER_SUPPORTS_AVX512
+    if ((origcard >= ARRAY_BITSET_GATHER_THRESHOLD) &&
+        (croaring_hardware_support() & ROARING_SUPPORTS_AVX512)) {
+        dst->cardinality = (int32_t)bitset_filter_list_avx512(
+            src_2->words, src_1->array, origcard, dst->array, false);
+        return;
+    }
+#endif
     for (int i = 0; i < origcard; ++i) {
         uint16_t key = src_1->array[i];
         // this branchless approach is much faster...
@@ -50,6 +61,13 @@ int array_bitset_container_intersection_cardinality(
     const array_container_t *src_1, const bitset_container_t *src_2) {
     int32_t newcard = 0;
     const int32_t origcard = src_1->cardinality;
+#if CROARING_IS_X64 && CROARING_COMPILER_SUPPORTS_AVX512
+    if ((origcard >= ARRAY_BITSET_GATHER_THRESHOLD) &&
+        (croaring_hardware_support() & ROARING_SUPPORTS_AVX512)) {
+        return (int)bitset_count_list_avx512(src_2->words, src_1->array,
+                                             origcard);
+    }
+#endif
     for (int i = 0; i < origcard; ++i) {
         uint16_t key = src_1->array[i];
         newcard += bitset_container_contains(src_2, key);
@@ -60,6 +78,13 @@ int array_bitset_container_intersection_cardinality(
 bool array_bitset_container_intersect(const array_container_t *src_1,
                                       const bitset_container_t *src_2) {
     const int32_t origcard = src_1->cardinality;
+#if CROARING_IS_X64 && CROARING_COMPILER_SUPPORTS_AVX512
+    if ((origcard >= ARRAY_BITSET_GATHER_THRESHOLD) &&
+        (croaring_hardware_support() & ROARING_SUPPORTS_AVX512)) {
+        return bitset_intersects_list_avx512(src_2->words, src_1->array,
+                                             origcard);
+    }
+#endif
     for (int i = 0; i < origcard; ++i) {
         uint16_t key = src_1->array[i];
         if (bitset_container_contains(src_2, key)) return true;
@@ -67,6 +92,37 @@ bool array_bitset_container_intersect(const array_container_t *src_1,
     return false;
 }
 
+/* Intersects an array having many values per run with the runs: for each
+ * run, we gallop over the array to the values that the run covers, and copy
+ * them to out as a block (unless out is NULL). Returns the cardinality of the
+ * intersection. out may be the array of src_1. */
+static int32_t array_run_intersection_by_runs(const array_container_t *src_1,
+                                              const run_container_t *src_2,
+                                              uint16_t *out) {
+    const int32_t card = src_1->cardinality;
+    int32_t newcard = 0;
+    int32_t arraypos = -1;  // advanceUntil searches after arraypos
+    for (int32_t rlepos = 0; rlepos < src_2->n_runs; ++rlepos) {
+        const rle16_t rle = src_2->runs[rlepos];
+        const int32_t first =
+            advanceUntil(src_1->array, arraypos, card, rle.value);
+        if (first == card) break;
+        const uint32_t end = (uint32_t)rle.value + rle.length;
+        const int32_t last =
+            (end == UINT16_MAX)
+                ? card
+                : advanceUntil(src_1->array, first - 1, card,
+                               (uint16_t)(end + 1));
+        if (out != NULL) {
+            memmove(out + newcard, src_1->array + first,
+                    (last - first) * sizeof(uint16_t));
+        }
+        newcard += last - first;
+        arraypos = last - 1;
+    }
+    return newcard;
+}
+
 /* Compute the intersection of src_1 and src_2 and write the result to
  * dst. It is allowed for dst to be equal to src_1. We assume that dst is a
  * valid container. */
@@ -83,6 +139,11 @@ void array_run_container_intersection(const array_container_t *src_1,
     if (src_2->n_runs == 0) {
         return;
     }
+    if (src_1->cardinality >= ARRAY_RUN_GALLOP_RATIO * src_2->n_runs) {
+        dst->cardinality =
+            array_run_intersection_by_runs(src_1, src_2, dst->array);
+        return;
+    }
     int32_t rlepos = 0;
     int32_t arraypos = 0;
     rle16_t rle = src_2->runs[rlepos];
@@ -91,7 +152,8 @@ void array_run_container_intersection(const array_container_t *src_1,
         const uint16_t arrayval = src_1->array[arraypos];
         while (rle.value + rle.length <
                arrayval) {  // this will frequently be false
-            ++rlepos;
+            rlepos = run_skip_until_end(src_2->runs, rlepos + 1,
+                                        src_2->n_runs, arrayval);
             if (rlepos == src_2->n_runs) {
                 dst->cardinality = newcard;
                 return;  // we are done
@@ -135,6 +197,12 @@ bool run_bitset_container_intersection(const run_container_t *src_1,
         }
         for (int32_t rlepos = 0; rlepos < src_1->n_runs; ++rlepos) {
             rle16_t rle = src_1->runs[rlepos];
+            if (rle.length >= RUN_BITSET_DECODE_THRESHOLD) {
+                answer->cardinality += bitset_lenrange_extract_uint16(
+                    src_2->words, rle.value, rle.length, false,
+                    answer->array + answer->cardinality);
+                continue;
+            }
             uint32_t endofrun = (uint32_t)rle.value + rle.length;
             for (uint32_t runValue = rle.value; runValue <= endofrun;
                  ++runValue) {
@@ -210,6 +278,9 @@ int array_run_container_intersection_cardinality(const array_container_t *src_1,
     if (src_2->n_runs == 0) {
         return 0;
     }
+    if (src_1->cardinality >= ARRAY_RUN_GALLOP_RATIO * src_2->n_runs) {
+        return array_run_intersection_by_runs(src_1, src_2, NULL);
+    }
     int32_t rlepos = 0;
     int32_t arraypos = 0;
     rle16_t rle = src_2->runs[rlepos];
@@ -218,7 +289,8 @@ int array_run_container_intersection_cardinality(const array_container_t *src_1,
         const uint16_t arrayval = src_1->array[arraypos];
         while (rle.value + rle.length <
                arrayval) {  // this will frequently be false
-            ++rlepos;
+            rlepos = run_skip_until_end(src_2->runs, rlepos + 1,
+                                        src_2->n_runs, arrayval);
             if (rlepos == src_2->n_runs) {
                 return newcard;  // we are done
             }
@@ -259,6 +331,19 @@ bool array_run_container_intersect(const array_container_t *src_1,
     if (src_2->n_runs == 0) {
         return false;
     }
+    if (src_1->cardinality >= ARRAY_RUN_GALLOP_RATIO * src_2->n_runs) {
+        // the first run that covers an array value settles it
+        int32_t arraypos = -1;
+        for (int32_t rlepos = 0; rlepos < src_2->n_runs; ++rlepos) {
+            const rle16_t rle = src_2->runs[rlepos];
+            arraypos = advanceUntil(src_1->array, arraypos,
+                                    src_1->cardinality, rle.value);
+            if (arraypos == src_1->cardinality) return false;
+            if (src_1->array[arraypos] <= rle.value + rle.length) return true;
+            arraypos--;  // advanceUntil searches after arraypos
+        }
+        return false;
+    }
     int32_t rlepos = 0;
     int32_t arraypos = 0;
     rle16_t rle = src_2->runs[rlepos];
@@ -266,7 +351,8 @@ bool array_run_container_intersect(const array_container_t *src_1,
         const uint16_t arrayval = src_1->array[arraypos];
         while (rle.value + rle.length <
                arrayval) {  // this will frequently be false
-            ++rlepos;
+            rlepos = run_skip_until_end(src_2->runs, rlepos + 1,
+                                        src_2->n_runs, arrayval);
             if (rlepos == src_2->n_runs) {
                 return false;  // we are done
             }
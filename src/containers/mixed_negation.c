@@ -249,6 +249,7 @@ int run_container_negation_range(const run_container_t *src,
     for (; k < src->n_runs && src->runs[k].value < range_start; ++k) {
         ans->runs[k] = src->runs[k];
         ans->n_runs++;
+        ans->cardinality += src->runs[k].length + 1;
     }
 
     run_container_smart_append_exclusive(
@@ -319,10 +320,12 @@ int run_container_negation_range_inplace(run_container_t *src,
     int my_nbr_runs = src->n_runs;
 
     ans->n_runs = 0;
+    ans->cardinality = 0;
     int k = 0;
     for (; (k < my_nbr_runs) && (src->runs[k].value < range_start); ++k) {
         // ans->runs[k] = src->runs[k]; (would be self-copy)
         ans->n_runs++;
+        ans->cardinality += src->runs[k].length + 1;
     }
 
     // as with Java implementation, use locals to give self a buffer of depth 1
@@ -123,6 +123,7 @@ void array_run_container_inplace_union(const array_container_t *src_1,
     int32_t arraypos = 0;
     int src2nruns = src_2->n_runs;
     src_2->n_runs = 0;
+    src_2->cardinality = 0;
 
     rle16_t previousrle;
 
@@ -149,6 +149,7 @@ void array_run_container_lazy_xor(const array_container_t *src_1,
     int32_t rlepos = 0;
     int32_t arraypos = 0;
     dst->n_runs = 0;
+    dst->cardinality = 0;
 
     while ((rlepos < src_2->n_runs) && (arraypos < src_1->cardinality)) {
         if (src_2->runs[rlepos].value <= src_1->array[arraypos]) {
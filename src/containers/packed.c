@@ -0,0 +1,500 @@
+/*
+ * packed.c
+ *
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <roaring/containers/array.h>
+#include <roaring/containers/packed.h>
+#include <roaring/memory.h>
+#include <roaring/portability.h>
+
+#ifdef __cplusplus
+extern "C" {
+namespace roaring {
+namespace internal {
+#endif
+
+// number of bytes holding the gaps of a block of `length' values
+static inline int32_t packed_block_bytes(int32_t length, uint32_t width) {
+    return (int32_t)(((uint32_t)(length - 1) * width + 7) / 8);
+}
+
+// number of bits needed by the largest gap of a block
+static inline uint32_t packed_block_width(const uint16_t *values,
+                                          int32_t length) {
+    uint32_t max_gap = 0;
+    for (int32_t i = 1; i < length; i++) {
+        uint32_t gap = (uint32_t)(values[i] - values[i - 1] - 1);
+        if (gap > max_gap) max_gap = gap;
+    }
+    return max_gap == 0 ? 0 : 64 - roaring_leading_zeroes(max_gap);
+}
+
+int32_t packed_container_data_size(const uint16_t *values,
+                                   int32_t cardinality) {
+    int32_t n_blocks =
+        (cardinality + PACKED_BLOCK_SIZE - 1) / PACKED_BLOCK_SIZE;
+    int32_t size = 5 * n_blocks + PACKED_PADDING;
+    for (int32_t start = 0; start < cardinality; start += PACKED_BLOCK_SIZE) {
+        int32_t length = cardinality - start < PACKED_BLOCK_SIZE
+                             ? cardinality - start
+                             : PACKED_BLOCK_SIZE;
+        size += packed_block_bytes(length,
+                                   packed_block_width(values + start, length));
+    }
+    return size;
+}
+
+packed_container_t *packed_container_create_from_values(const uint16_t *values,
+                                                        int32_t cardinality) {
+    packed_container_t *packed;
+    if ((packed = (packed_container_t *)roaring_malloc(
+             sizeof(packed_container_t))) == NULL) {
+        return NULL;
+    }
+    int32_t size = packed_container_data_size(values, cardinality);
+    // the gaps are or-ed in place, and the padding must be deterministic
+    // for packed_container_equals
+    if ((packed->data = (uint8_t *)roaring_calloc(size, 1)) == NULL) {
+        roaring_free(packed);
+        return NULL;
+    }
+    packed->cardinality = cardinality;
+    packed->n_blocks =
+        (cardinality + PACKED_BLOCK_SIZE - 1) / PACKED_BLOCK_SIZE;
+    uint16_t *firsts = (uint16_t *)packed->data;
+    uint16_t *offsets = firsts + packed->n_blocks;
+    uint8_t *widths = packed->data + 4 * packed->n_blocks;
+    uint8_t *gaps = packed->data + 5 * packed->n_blocks;
+    int32_t offset = 0;
+    for (int32_t block = 0; block < packed->n_blocks; block++) {
+        const uint16_t *v = values + block * PACKED_BLOCK_SIZE;
+        int32_t length = packed_container_block_length(packed, block);
+        uint32_t width = packed_block_width(v, length);
+        firsts[block] = v[0];
+        offsets[block] = (uint16_t)offset;
+        widths[block] = (uint8_t)width;
+        uint8_t *out = gaps + offset;
+        for (int32_t i = 1; i < length; i++) {
+            uint32_t bit = (uint32_t)(i - 1) * width;
+            uint32_t word = (uint32_t)(v[i] - v[i - 1] - 1) << (bit & 7);
+            uint8_t *p = out + (bit >> 3);
+            p[0] |= (uint8_t)word;
+            p[1] |= (uint8_t)(word >> 8);
+            p[2] |= (uint8_t)(word >> 16);
+        }
+        offset += packed_block_bytes(length, width);
+    }
+    return packed;
+}
+
+// bytes used by the gaps of all blocks
+static int32_t packed_gaps_size(const packed_container_t *packed) {
+    if (packed->n_blocks == 0) return 0;
+    int32_t last = packed->n_blocks - 1;
+    return packed_container_offsets(packed)[last] +
+           packed_block_bytes(packed_container_block_length(packed, last),
+                              packed_container_widths(packed)[last]);
+}
+
+static inline int32_t packed_data_size(const packed_container_t *packed) {
+    return 5 * packed->n_blocks + packed_gaps_size(packed) + PACKED_PADDING;
+}
+
+int32_t packed_container_memory_size_in_bytes(
+    const packed_container_t *packed) {
+    return (int32_t)sizeof(packed_container_t) + packed_data_size(packed);
+}
+
+void packed_container_free(packed_container_t *packed) {
+    if (packed == NULL) return;
+    roaring_free(packed->data);
+    roaring_free(packed);
+}
+
+packed_container_t *packed_container_clone(const packed_container_t *src) {
+    packed_container_t *packed;
+    if ((packed = (packed_container_t *)roaring_malloc(
+             sizeof(packed_container_t))) == NULL) {
+        return NULL;
+    }
+    int32_t size = packed_data_size(src);
+    if ((packed->data = (uint8_t *)roaring_malloc(size)) == NULL) {
+        roaring_free(packed);
+        return NULL;
+    }
+    memcpy(packed->data, src->data, size);
+    packed->cardinality = src->cardinality;
+    packed->n_blocks = src->n_blocks;
+    return packed;
+}
+
+static inline void packed_decode_block_scalar(const uint8_t *gaps,
+                                              uint32_t width, uint16_t first,
+                                              int32_t length, uint16_t *out) {
+    uint32_t value = first;
+    out[0] = first;
+    for (int32_t i = 1; i < length; i++) {
+        value += packed_read_gap(gaps, width, (uint32_t)(i - 1)) + 1;
+        out[i] = (uint16_t)value;
+    }
+}
+
+#if CROARING_IS_X64
+CROARING_TARGET_AVX2
+ALLOW_UNALIGNED
+static void _avx2_packed_decode_block(const uint8_t *gaps, uint32_t width,
+                                      uint16_t first, int32_t length,
+                                      uint16_t *out) {
+    // Groups of 8 gaps start on a byte boundary and span at most 16 bytes, so
+    // each group is one 16-byte load: a shuffle brings the three bytes of
+    // each gap into a 32-bit lane, where a shift and a mask extract it.
+    const __m256i bits = _mm256_mullo_epi32(
+        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(width));
+    const __m256i shifts = _mm256_and_si256(bits, _mm256_set1_epi32(7));
+    const __m256i shuffle = _mm256_or_si256(
+        _mm256_add_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(bits, 3),
+                                            _mm256_set1_epi32(0x010101)),
+                         _mm256_set1_epi32(0x020100)),
+        _mm256_set1_epi32((int32_t)0x80000000));
+    const __m256i mask = _mm256_set1_epi32((int32_t)((1u << width) - 1));
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i previous = _mm256_set1_epi32(first);
+    out[0] = first;
+    for (int32_t i = 0; i + 1 < length; i += 8) {
+        __m256i x = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128((const __m128i *)(gaps + (i / 8) * width)));
+        x = _mm256_shuffle_epi8(x, shuffle);
+        x = _mm256_and_si256(_mm256_srlv_epi32(x, shifts), mask);
+        x = _mm256_add_epi32(x, one);
+        // prefix sums of the 8 increments
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+        x = _mm256_add_epi32(
+            x,
+            _mm256_shuffle_epi32(_mm256_permute2x128_si256(x, x, 0x08), 0xFF));
+        x = _mm256_add_epi32(x, previous);
+        previous = _mm256_permutevar8x32_epi32(x, _mm256_set1_epi32(7));
+        const __m128i values = _mm_packus_epi32(_mm256_castsi256_si128(x),
+                                                _mm256_extracti128_si256(x, 1));
+        int32_t count = length - 1 - i;
+        if (count >= 8) {
+            _mm_storeu_si128((__m128i *)(out + 1 + i), values);
+        } else {
+            uint16_t buffer[8];
+            _mm_storeu_si128((__m128i *)buffer, values);
+            memcpy(out + 1 + i, buffer, count * sizeof(uint16_t));
+        }
+    }
+}
+CROARING_UNTARGET_AVX2
+#endif  // CROARING_IS_X64
+
+int32_t packed_container_decode_block(const packed_container_t *packed,
+                                      int32_t block, uint16_t *out) {
+    const uint8_t *gaps =
+        packed_container_gaps(packed) + packed_container_offsets(packed)[block];
+    uint32_t width = packed_container_widths(packed)[block];
+    uint16_t first = packed_container_firsts(packed)[block];
+    int32_t length = packed_container_block_length(packed, block);
+#if CROARING_IS_X64
+    if (croaring_hardware_support() & ROARING_SUPPORTS_AVX2) {
+        _avx2_packed_decode_block(gaps, width, first, length, out);
+        return length;
+    }
+#endif
+    packed_decode_block_scalar(gaps, width, first, length, out);
+    return length;
+}
+
+void packed_container_decode(const packed_container_t *packed, uint16_t *out) {
+    for (int32_t block = 0; block < packed->n_blocks; block++) {
+        out += packed_container_decode_block(packed, block, out);
+    }
+}
+
+// index of the last block whose first value is at most x, or -1
+static inline int32_t packed_find_block(const packed_container_t *packed,
+                                        uint16_t x) {
+    const uint16_t *firsts = packed_container_firsts(packed);
+    int32_t low = 0;
+    int32_t high = packed->n_blocks - 1;
+    while (low <= high) {
+        int32_t middle = (low + high) >> 1;
+        if (firsts[middle] <= x) {
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return high;
+}
+
+// index within `block' of the first value at least x, or the block length
+// if there is none; the value found is written to *value
+static inline int32_t packed_scan_block(const packed_container_t *packed,
+                                        int32_t block, uint16_t x,
+                                        uint32_t *value) {
+    const uint8_t *gaps =
+        packed_container_gaps(packed) + packed_container_offsets(packed)[block];
+    uint32_t width = packed_container_widths(packed)[block];
+    int32_t length = packed_container_block_length(packed, block);
+    uint32_t v = packed_container_firsts(packed)[block];
+    int32_t i = 0;
+    while (v < x && ++i < length) {
+        v += packed_read_gap(gaps, width, (uint32_t)(i - 1)) + 1;
+    }
+    *value = v;
+    return i;
+}
+
+bool packed_container_contains(const packed_container_t *packed,
+                               uint16_t pos) {
+    return packed_container_get_index(packed, pos) >= 0;
+}
+
+uint16_t packed_container_get(const packed_container_t *packed,
+                              int32_t index) {
+    int32_t block = index / PACKED_BLOCK_SIZE;
+    const uint8_t *gaps =
+        packed_container_gaps(packed) + packed_container_offsets(packed)[block];
+    uint32_t width = packed_container_widths(packed)[block];
+    uint32_t value = packed_container_firsts(packed)[block];
+    for (int32_t i = 0; i < index % PACKED_BLOCK_SIZE; i++) {
+        value += packed_read_gap(gaps, width, (uint32_t)i) + 1;
+    }
+    return (uint16_t)value;
+}
+
+uint16_t packed_container_maximum(const packed_container_t *packed) {
+    if (packed->cardinality == 0) return 0;
+    return packed_container_get(packed, packed->cardinality - 1);
+}
+
+int packed_container_rank(const packed_container_t *packed, uint16_t x) {
+    int32_t block = packed_find_block(packed, x);
+    if (block < 0) return 0;
+    uint32_t value;
+    int32_t i = packed_scan_block(packed, block, x, &value);
+    if (i < packed_container_block_length(packed, block) && value == x) i++;
+    return block * PACKED_BLOCK_SIZE + i;
+}
+
+int packed_container_get_index(const packed_container_t *packed, uint16_t x) {
+    int32_t block = packed_find_block(packed, x);
+    if (block < 0) return -1;
+    uint32_t value;
+    int32_t i = packed_scan_block(packed, block, x, &value);
+    if (i < packed_container_block_length(packed, block) && value == x) {
+        return block * PACKED_BLOCK_SIZE + i;
+    }
+    return -1;
+}
+
+int packed_container_index_equalorlarger(const packed_container_t *packed,
+                                         uint16_t x) {
+    int32_t block = packed_find_block(packed, x);
+    if (block < 0) return packed->cardinality > 0 ? 0 : -1;
+    uint32_t value;
+    int32_t i = packed_scan_block(packed, block, x, &value);
+    int32_t index = block * PACKED_BLOCK_SIZE + i;
+    return index < packed->cardinality ? index : -1;
+}
+
+bool packed_container_contains_range(const packed_container_t *packed,
+                                     uint32_t range_start, uint32_t range_end) {
+    const int32_t range_count = range_end - range_start;
+    if (range_count <= 0) return true;
+    if (range_count > packed->cardinality) return false;
+    const int start = packed_container_get_index(packed, (uint16_t)range_start);
+    // values are distinct, so the range is present iff its last value sits
+    // range_count - 1 positions after its first one
+    return start >= 0 && start + range_count <= packed->cardinality &&
+           packed_container_get(packed, start + range_count - 1) ==
+               (uint16_t)(range_end - 1);
+}
+
+uint32_t packed_container_rank_many(const packed_container_t *packed,
+                                    uint64_t start_rank, const uint32_t *begin,
+                                    const uint32_t *end, uint64_t *ans) {
+    const uint16_t high = (uint16_t)((*begin) >> 16);
+    const uint32_t *iter = begin;
+    for (; iter != end; iter++) {
+        uint32_t x = *iter;
+        uint16_t xhigh = (uint16_t)(x >> 16);
+        if (xhigh != high) return iter - begin;  // stop at next container
+        *(ans++) = start_rank + packed_container_rank(packed, (uint16_t)x);
+    }
+    return iter - begin;
+}
+
+int32_t packed_container_number_of_runs(const packed_container_t *packed) {
+    uint16_t values[PACKED_BLOCK_SIZE];
+    int32_t nr_runs = 0;
+    int32_t prev = -2;
+    for (int32_t block = 0; block < packed->n_blocks; block++) {
+        int32_t length = packed_container_decode_block(packed, block, values);
+        for (int32_t i = 0; i < length; i++) {
+            if (values[i] != prev + 1) nr_runs++;
+            prev = values[i];
+        }
+    }
+    return nr_runs;
+}
+
+int packed_container_to_uint32_array(void *vout,
+                                     const packed_container_t *packed,
+                                     uint32_t base) {
+    uint16_t values[PACKED_BLOCK_SIZE];
+    uint32_t *out = (uint32_t *)vout;
+    int outpos = 0;
+    for (int32_t block = 0; block < packed->n_blocks; block++) {
+        int32_t length = packed_container_decode_block(packed, block, values);
+        for (int32_t i = 0; i < length; i++) {
+            const uint32_t val = base + values[i];
+            memcpy(out + outpos, &val, sizeof(uint32_t));
+            outpos++;
+        }
+    }
+    return outpos;
+}
+
+bool packed_container_iterate(const packed_container_t *packed, uint32_t base,
+                              roaring_iterator iterator, void *ptr) {
+    uint16_t values[PACKED_BLOCK_SIZE];
+    for (int32_t block = 0; block < packed->n_blocks; block++) {
+        int32_t length = packed_container_decode_block(packed, block, values);
+        for (int32_t i = 0; i < length; i++)
+            if (!iterator(values[i] + base, ptr)) return false;
+    }
+    return true;
+}
+
+bool packed_container_iterate64(const packed_container_t *packed,
+                                uint32_t base, roaring_iterator64 iterator,
+                                uint64_t high_bits, void *ptr) {
+    uint16_t values[PACKED_BLOCK_SIZE];
+    for (int32_t block = 0; block < packed->n_blocks; block++) {
+        int32_t length = packed_container_decode_block(packed, block, values);
+        for (int32_t i = 0; i < length; i++)
+            if (!iterator(high_bits | (uint64_t)(values[i] + base), ptr))
+                return false;
+    }
+    return true;
+}
+
+void packed_container_printf(const packed_container_t *packed) {
+    if (packed->cardinality == 0) {
+        printf("{}");
+        return;
+    }
+    uint16_t values[PACKED_BLOCK_SIZE];
+    printf("{");
+    for (int32_t block = 0; block < packed->n_blocks; block++) {
+        int32_t length = packed_container_decode_block(packed, block, values);
+        for (int32_t i = 0; i < length; i++) {
+            printf(block == 0 && i == 0 ? "%d" : ",%d", values[i]);
+        }
+    }
+    printf("}");
+}
+
+void packed_container_printf_as_uint32_array(const packed_container_t *packed,
+                                             uint32_t base) {
+    uint16_t values[PACKED_BLOCK_SIZE];
+    for (int32_t block = 0; block < packed->n_blocks; block++) {
+        int32_t length = packed_container_decode_block(packed, block, values);
+        for (int32_t i = 0; i < length; i++) {
+            printf(block == 0 && i == 0 ? "%u" : ",%u", values[i] + base);
+        }
+    }
+}
+
+/*
+ * Validate the container. Returns true if valid.
+ */
+bool packed_container_validate(const packed_container_t *packed,
+                               const char **reason) {
+    if (packed->cardinality <= 0) {
+        *reason = "zero cardinality";
+        return false;
+    }
+    if (packed->cardinality > DEFAULT_MAX_SIZE) {
+        *reason = "cardinality exceeds DEFAULT_MAX_SIZE";
+        return false;
+    }
+    if (packed->n_blocks !=
+        (packed->cardinality + PACKED_BLOCK_SIZE - 1) / PACKED_BLOCK_SIZE) {
+        *reason = "number of blocks does not match the cardinality";
+        return false;
+    }
+    if (packed->data == NULL) {
+        *reason = "NULL data pointer";
+        return false;
+    }
+    const uint16_t *firsts = packed_container_firsts(packed);
+    const uint16_t *offsets = packed_container_offsets(packed);
+    const uint8_t *widths = packed_container_widths(packed);
+    int32_t offset = 0;
+    uint32_t previous = 0;
+    for (int32_t block = 0; block < packed->n_blocks; block++) {
+        int32_t length = packed_container_block_length(packed, block);
+        if (widths[block] > 16) {
+            *reason = "gap width exceeds 16 bits";
+            return false;
+        }
+        if (offsets[block] != offset) {
+            *reason = "block offsets are inconsistent";
+            return false;
+        }
+        if (block > 0 && firsts[block] <= previous) {
+            *reason = "blocks are not strictly increasing";
+            return false;
+        }
+        const uint8_t *gaps = packed_container_gaps(packed) + offset;
+        uint32_t value = firsts[block];
+        for (int32_t i = 1; i < length; i++) {
+            value +=
+                packed_read_gap(gaps, widths[block], (uint32_t)(i - 1)) + 1;
+        }
+        if (value > UINT16_MAX) {
+            *reason = "values overflow 16 bits";
+            return false;
+        }
+        previous = value;
+        offset += packed_block_bytes(length, widths[block]);
+    }
+    return true;
+}
+
+int32_t packed_container_write(const packed_container_t *packed, char *buf) {
+    uint16_t values[PACKED_BLOCK_SIZE];
+    char *out = buf;
+    for (int32_t block = 0; block < packed->n_blocks; block++) {
+        int32_t length = packed_container_decode_block(packed, block, values);
+        memcpy(out, values, length * sizeof(uint16_t));
+        out += length * sizeof(uint16_t);
+    }
+    return packed_container_size_in_bytes(packed);
+}
+
+bool packed_container_equals(const packed_container_t *packed1,
+                             const packed_container_t *packed2) {
+    // the encoding of a set of values is unique
+    if (packed1->cardinality != packed2->cardinality) {
+        return false;
+    }
+    return memcmp(packed1->data, packed2->data, packed_data_size(packed1)) ==
+           0;
+}
+
+#ifdef __cplusplus
+}
+}
+}  // extern "C" { namespace roaring { namespace internal {
+#endif
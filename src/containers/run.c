@@ -53,10 +53,12 @@ bool run_container_add(run_container_t *run, uint16_t pos) {
                                               run->runs[index + 1].length -
                                               run->runs[index].value;
                     recoverRoomAtIndex(run, (uint16_t)(index + 1));
+                    run->cardinality++;
                     return true;
                 }
             }
             run->runs[index].length++;
+            run->cardinality++;
             return true;
         }
         if (index + 1 < run->n_runs) {
@@ -65,6 +67,7 @@ bool run_container_add(run_container_t *run, uint16_t pos) {
                 // indeed fusion is needed
                 run->runs[index + 1].value = pos;
                 run->runs[index + 1].length = run->runs[index + 1].length + 1;
+                run->cardinality++;
                 return true;
             }
         }
@@ -75,6 +78,7 @@ bool run_container_add(run_container_t *run, uint16_t pos) {
             if (run->runs[0].value == pos + 1) {
                 run->runs[0].length++;
                 run->runs[0].value--;
+                run->cardinality++;
                 return true;
             }
         }
@@ -82,6 +86,7 @@ bool run_container_add(run_container_t *run, uint16_t pos) {
     makeRoomAtIndex(run, (uint16_t)(index + 1));
     run->runs[index + 1].value = pos;
     run->runs[index + 1].length = 0;
+    run->cardinality++;
     return true;
 }
 
@@ -102,6 +107,7 @@ run_container_t *run_container_create_given_capacity(int32_t size) {
     }
     run->capacity = size;
     run->n_runs = 0;
+    run->cardinality = 0;
     return run;
 }
 
@@ -126,6 +132,7 @@ run_container_t *run_container_clone(const run_container_t *src) {
     if (run == NULL) return NULL;
     run->capacity = src->capacity;
     run->n_runs = src->n_runs;
+    run->cardinality = src->cardinality;
     memcpy(run->runs, src->runs, src->n_runs * sizeof(rle16_t));
     return run;
 }
@@ -185,6 +192,51 @@ void run_container_offset(const run_container_t *c, container_t **loc,
             hi->runs[0].value = 0;
         }
     }
+    if (lo != NULL) lo->cardinality = run_container_compute_cardinality(lo);
+    if (hi != NULL) hi->cardinality = run_container_compute_cardinality(hi);
+}
+
+void run_container_contains_many(const run_container_t *run,
+                                 const uint32_t *vals, size_t begin, size_t end,
+                                 uint64_t *out_bits) {
+    const rle16_t *runs = run->runs;
+    const int32_t n_runs = run->n_runs;
+    int32_t r = 0;  // first run ending at or after the previous probe
+    uint16_t previous = 0;
+    uint64_t answer = 0;
+    for (size_t i = begin; i < end; i++) {
+        if (i != begin && (i & 63) == 0) {
+            out_bits[(i - 1) >> 6] |= answer;
+            answer = 0;
+        }
+        const uint16_t v = (uint16_t)vals[i];
+        if (v < previous) r = 0;  // out of order, search from the start
+        previous = v;
+        if (r < n_runs &&
+            (uint32_t)runs[r].value + runs[r].length < (uint32_t)v) {
+            // gallop: runs[lo] ends before v, runs[hi] (if any) does not
+            int32_t lo = r, hi = r + 1, step = 1;
+            while (hi < n_runs &&
+                   (uint32_t)runs[hi].value + runs[hi].length < (uint32_t)v) {
+                lo = hi;
+                step <<= 1;
+                hi = lo + step;
+            }
+            if (hi > n_runs) hi = n_runs;
+            while (lo + 1 < hi) {
+                const int32_t mid = (lo + hi) >> 1;
+                if ((uint32_t)runs[mid].value + runs[mid].length <
+                    (uint32_t)v) {
+                    lo = mid;
+                } else {
+                    hi = mid;
+                }
+            }
+            r = hi;
+        }
+        answer |= (uint64_t)(r < n_runs && runs[r].value <= v) << (i & 63);
+    }
+    if (end > begin) out_bits[(end - 1) >> 6] |= answer;
 }
 
 /* Free memory. */
@@ -227,9 +279,55 @@ void run_container_copy(const run_container_t *src, run_container_t *dst) {
         run_container_grow(dst, n_runs, false);
     }
     dst->n_runs = n_runs;
+    dst->cardinality = src->cardinality;
     memcpy(dst->runs, src->runs, sizeof(rle16_t) * n_runs);
 }
 
+/* Appends runs[pos, end) to `dst' as run_container_append does. The runs of
+ * a valid container are neither adjacent nor overlapping, so once one of
+ * them starts past the end of `previousrle', the others are copied as is. */
+static inline void run_container_append_many(run_container_t *dst,
+                                             const rle16_t *runs, int32_t pos,
+                                             int32_t end,
+                                             rle16_t *previousrle) {
+    while ((pos < end) &&
+           ((uint32_t)runs[pos].value <=
+            (uint32_t)previousrle->value + previousrle->length + 1)) {
+        run_container_append(dst, runs[pos], previousrle);
+        pos++;
+    }
+    if (pos + 1 == end) {  // the common case, when the runs interleave
+        dst->runs[dst->n_runs++] = runs[pos];
+        *previousrle = runs[pos];
+    } else if (pos < end) {
+        memcpy(dst->runs + dst->n_runs, runs + pos,
+               sizeof(rle16_t) * (end - pos));
+        dst->n_runs += end - pos;
+        *previousrle = runs[end - 1];
+    }
+}
+
+/* Appends runs[pos, end) to `dst' as run_container_smart_append_exclusive
+ * does, copying them as is once they start past the end of `dst'. */
+static inline void run_container_smart_append_exclusive_many(
+    run_container_t *dst, const rle16_t *runs, int32_t pos, int32_t end) {
+    while ((pos < end) && (dst->n_runs > 0) &&
+           ((uint32_t)runs[pos].value <=
+            (uint32_t)dst->runs[dst->n_runs - 1].value +
+                dst->runs[dst->n_runs - 1].length + 1)) {
+        run_container_smart_append_exclusive(dst, runs[pos].value,
+                                             runs[pos].length);
+        pos++;
+    }
+    if (pos + 1 == end) {  // the common case, when the runs interleave
+        dst->runs[dst->n_runs++] = runs[pos];
+    } else if (pos < end) {
+        memcpy(dst->runs + dst->n_runs, runs + pos,
+               sizeof(rle16_t) * (end - pos));
+        dst->n_runs += end - pos;
+    }
+}
+
 /* Compute the union of `src_1' and `src_2' and write the result to `dst'
  * It is assumed that `dst' is distinct from both `src_1' and `src_2'. */
 void run_container_union(const run_container_t *src_1,
@@ -266,24 +364,30 @@ void run_container_union(const run_container_t *src_1,
     }
 
     while ((xrlepos < src_2->n_runs) && (rlepos < src_1->n_runs)) {
-        rle16_t newrl;
+        // we append together all the runs that start before the current run
+        // of the other input
+        int32_t next;
         if (src_1->runs[rlepos].value <= src_2->runs[xrlepos].value) {
-            newrl = src_1->runs[rlepos];
-            rlepos++;
+            next = run_skip_until_start(
+                src_1->runs, rlepos + 1, src_1->n_runs,
+                (uint32_t)src_2->runs[xrlepos].value + 1);
+            run_container_append_many(dst, src_1->runs, rlepos, next,
+                                      &previousrle);
+            rlepos = next;
         } else {
-            newrl = src_2->runs[xrlepos];
-            xrlepos++;
+            next = run_skip_until_start(src_2->runs, xrlepos + 1,
+                                       src_2->n_runs,
+                                       src_1->runs[rlepos].value);
+            run_container_append_many(dst, src_2->runs, xrlepos, next,
+                                      &previousrle);
+            xrlepos = next;
         }
-        run_container_append(dst, newrl, &previousrle);
-    }
-    while (xrlepos < src_2->n_runs) {
-        run_container_append(dst, src_2->runs[xrlepos], &previousrle);
-        xrlepos++;
-    }
-    while (rlepos < src_1->n_runs) {
-        run_container_append(dst, src_1->runs[rlepos], &previousrle);
-        rlepos++;
     }
+    run_container_append_many(dst, src_2->runs, xrlepos, src_2->n_runs,
+                              &previousrle);
+    run_container_append_many(dst, src_1->runs, rlepos, src_1->n_runs,
+                              &previousrle);
+    dst->cardinality = run_container_compute_cardinality(dst);
 }
 
 /* Compute the union of `src_1' and `src_2' and write the result to `src_1'
@@ -325,25 +429,31 @@ void run_container_union_inplace(run_container_t *src_1,
         previousrle = run_container_append_first(src_1, src_2->runs[xrlepos]);
         xrlepos++;
     }
+    // the output never catches up with inputsrc1, so the copies made by
+    // run_container_append_many do not overlap
     while ((xrlepos < src_2->n_runs) && (rlepos < input1nruns)) {
-        rle16_t newrl;
+        int32_t next;
         if (inputsrc1[rlepos].value <= src_2->runs[xrlepos].value) {
-            newrl = inputsrc1[rlepos];
-            rlepos++;
+            next = run_skip_until_start(
+                inputsrc1, rlepos + 1, input1nruns,
+                (uint32_t)src_2->runs[xrlepos].value + 1);
+            run_container_append_many(src_1, inputsrc1, rlepos, next,
+                                      &previousrle);
+            rlepos = next;
         } else {
-            newrl = src_2->runs[xrlepos];
-            xrlepos++;
+            next = run_skip_until_start(src_2->runs, xrlepos + 1,
+                                       src_2->n_runs,
+                                       inputsrc1[rlepos].value);
+            run_container_append_many(src_1, src_2->runs, xrlepos, next,
+                                      &previousrle);
+            xrlepos = next;
         }
-        run_container_append(src_1, newrl, &previousrle);
-    }
-    while (xrlepos < src_2->n_runs) {
-        run_container_append(src_1, src_2->runs[xrlepos], &previousrle);
-        xrlepos++;
-    }
-    while (rlepos < input1nruns) {
-        run_container_append(src_1, inputsrc1[rlepos], &previousrle);
-        rlepos++;
     }
+    run_container_append_many(src_1, src_2->runs, xrlepos, src_2->n_runs,
+                              &previousrle);
+    run_container_append_many(src_1, inputsrc1, rlepos, input1nruns,
+                              &previousrle);
+    src_1->cardinality = run_container_compute_cardinality(src_1);
 }
 
 /* Compute the symmetric difference of `src_1' and `src_2' and write the result
@@ -363,27 +473,30 @@ void run_container_xor(const run_container_t *src_1,
     dst->n_runs = 0;
 
     while ((pos1 < src_1->n_runs) && (pos2 < src_2->n_runs)) {
+        // we append together all the runs that start before the current run
+        // of the other input
+        int32_t next;
         if (src_1->runs[pos1].value <= src_2->runs[pos2].value) {
-            run_container_smart_append_exclusive(dst, src_1->runs[pos1].value,
-                                                 src_1->runs[pos1].length);
-            pos1++;
+            next = run_skip_until_start(
+                src_1->runs, pos1 + 1, src_1->n_runs,
+                (uint32_t)src_2->runs[pos2].value + 1);
+            run_container_smart_append_exclusive_many(dst, src_1->runs, pos1,
+                                                      next);
+            pos1 = next;
         } else {
-            run_container_smart_append_exclusive(dst, src_2->runs[pos2].value,
-                                                 src_2->runs[pos2].length);
-            pos2++;
+            next = run_skip_until_start(src_2->runs, pos2 + 1,
+                                       src_2->n_runs,
+                                       src_1->runs[pos1].value);
+            run_container_smart_append_exclusive_many(dst, src_2->runs, pos2,
+                                                      next);
+            pos2 = next;
         }
     }
-    while (pos1 < src_1->n_runs) {
-        run_container_smart_append_exclusive(dst, src_1->runs[pos1].value,
-                                             src_1->runs[pos1].length);
-        pos1++;
-    }
-
-    while (pos2 < src_2->n_runs) {
-        run_container_smart_append_exclusive(dst, src_2->runs[pos2].value,
-                                             src_2->runs[pos2].length);
-        pos2++;
-    }
+    run_container_smart_append_exclusive_many(dst, src_1->runs, pos1,
+                                              src_1->n_runs);
+    run_container_smart_append_exclusive_many(dst, src_2->runs, pos2,
+                                              src_2->n_runs);
+    dst->cardinality = run_container_compute_cardinality(dst);
 }
 
 /* Compute the intersection of src_1 and src_2 and write the result to
@@ -408,6 +521,7 @@ void run_container_intersection(const run_container_t *src_1,
     if (dst->capacity < neededcapacity)
         run_container_grow(dst, neededcapacity, false);
     dst->n_runs = 0;
+    dst->cardinality = 0;
     int32_t rlepos = 0;
     int32_t xrlepos = 0;
     int32_t start = src_1->runs[rlepos].value;
@@ -416,13 +530,15 @@ void run_container_intersection(const run_container_t *src_1,
     int32_t xend = xstart + src_2->runs[xrlepos].length + 1;
     while ((rlepos < src_1->n_runs) && (xrlepos < src_2->n_runs)) {
         if (end <= xstart) {
-            ++rlepos;
+            rlepos = run_skip_until_end(src_1->runs, rlepos + 1,
+                                        src_1->n_runs, (uint32_t)xstart);
             if (rlepos < src_1->n_runs) {
                 start = src_1->runs[rlepos].value;
                 end = start + src_1->runs[rlepos].length + 1;
             }
         } else if (xend <= start) {
-            ++xrlepos;
+            xrlepos = run_skip_until_end(src_2->runs, xrlepos + 1,
+                                         src_2->n_runs, (uint32_t)start);
             if (xrlepos < src_2->n_runs) {
                 xstart = src_2->runs[xrlepos].value;
                 xend = xstart + src_2->runs[xrlepos].length + 1;
@@ -462,6 +578,7 @@ void run_container_intersection(const run_container_t *src_1,
             dst->runs[dst->n_runs].length =
                 (uint16_t)(earliestend - lateststart - 1);
             dst->n_runs++;
+            dst->cardinality += earliestend - lateststart;
         }
     }
 }
@@ -488,13 +605,15 @@ int run_container_intersection_cardinality(const run_container_t *src_1,
     int32_t xend = xstart + src_2->runs[xrlepos].length + 1;
     while ((rlepos < src_1->n_runs) && (xrlepos < src_2->n_runs)) {
         if (end <= xstart) {
-            ++rlepos;
+            rlepos = run_skip_until_end(src_1->runs, rlepos + 1,
+                                        src_1->n_runs, (uint32_t)xstart);
             if (rlepos < src_1->n_runs) {
                 start = src_1->runs[rlepos].value;
                 end = start + src_1->runs[rlepos].length + 1;
             }
         } else if (xend <= start) {
-            ++xrlepos;
+            xrlepos = run_skip_until_end(src_2->runs, xrlepos + 1,
+                                         src_2->n_runs, (uint32_t)start);
             if (xrlepos < src_2->n_runs) {
                 xstart = src_2->runs[xrlepos].value;
                 xend = xstart + src_2->runs[xrlepos].length + 1;
@@ -556,13 +675,15 @@ bool run_container_intersect(const run_container_t *src_1,
     int32_t xend = xstart + src_2->runs[xrlepos].length + 1;
     while ((rlepos < src_1->n_runs) && (xrlepos < src_2->n_runs)) {
         if (end <= xstart) {
-            ++rlepos;
+            rlepos = run_skip_until_end(src_1->runs, rlepos + 1,
+                                        src_1->n_runs, (uint32_t)xstart);
             if (rlepos < src_1->n_runs) {
                 start = src_1->runs[rlepos].value;
                 end = start + src_1->runs[rlepos].length + 1;
             }
         } else if (xend <= start) {
-            ++xrlepos;
+            xrlepos = run_skip_until_end(src_2->runs, xrlepos + 1,
+                                         src_2->n_runs, (uint32_t)start);
             if (xrlepos < src_2->n_runs) {
                 xstart = src_2->runs[xrlepos].value;
                 xend = xstart + src_2->runs[xrlepos].length + 1;
@@ -594,16 +715,26 @@ void run_container_andnot(const run_container_t *src_1,
 
     while ((rlepos1 < src_1->n_runs) && (rlepos2 < src_2->n_runs)) {
         if (end <= start2) {
-            // output the first run
+            // output the first run, and the following ones that also end
+            // before the second run
             dst->runs[dst->n_runs++] = MAKE_RLE16(start, end - start - 1);
-            rlepos1++;
+            const int32_t next = run_skip_until_end(
+                src_1->runs, rlepos1 + 1, src_1->n_runs, (uint32_t)start2);
+            if (next > rlepos1 + 1) {
+                memcpy(dst->runs + dst->n_runs, src_1->runs + rlepos1 + 1,
+                       sizeof(rle16_t) * (next - rlepos1 - 1));
+                dst->n_runs += next - rlepos1 - 1;
+            }
+            rlepos1 = next;
             if (rlepos1 < src_1->n_runs) {
                 start = src_1->runs[rlepos1].value;
                 end = start + src_1->runs[rlepos1].length + 1;
             }
         } else if (end2 <= start) {
-            // exit the second run
-            rlepos2++;
+            // exit the second run, and the following ones that also end
+            // before the first run
+            rlepos2 = run_skip_until_end(src_2->runs, rlepos2 + 1,
+                                         src_2->n_runs, (uint32_t)start);
             if (rlepos2 < src_2->n_runs) {
                 start2 = src_2->runs[rlepos2].value;
                 end2 = start2 + src_2->runs[rlepos2].length + 1;
@@ -633,6 +764,7 @@ void run_container_andnot(const run_container_t *src_1,
             dst->n_runs += src_1->n_runs - rlepos1;
         }
     }
+    dst->cardinality = run_container_compute_cardinality(dst);
 }
 
 ALLOW_UNALIGNED
@@ -733,6 +865,10 @@ bool run_container_validate(const run_container_t *run, const char **reason) {
         }
         last_end = end;
     }
+    if (run->cardinality != run_container_compute_cardinality(run)) {
+        *reason = "cardinality is incorrect";
+        return false;
+    }
     return true;
 }
 
@@ -756,6 +892,7 @@ int32_t run_container_read(int32_t cardinality, run_container_t *container,
         memcpy(container->runs, buf + sizeof(uint16_t),
                container->n_runs * sizeof(rle16_t));
     }
+    container->cardinality = run_container_compute_cardinality(container);
     return run_container_size_in_bytes(container);
 }
 
@@ -829,14 +966,19 @@ void run_container_smart_append_exclusive(run_container_t *src,
         (start > (old_end = last_run->value + last_run->length + 1))) {
         *appended_last_run = MAKE_RLE16(start, length);
         src->n_runs++;
+        src->cardinality += length + 1;
         return;
     }
+    int new_end = start + length + 1;
+    // the values of [start, new_end) that the last run holds leave it, the
+    // others join (start is never before the last run)
+    const int overlap = ((new_end < old_end) ? new_end : old_end) - start;
+    src->cardinality += length + 1 - 2 * overlap;
     if (old_end == start) {
         // we merge
         last_run->length += (length + 1);
         return;
     }
-    int new_end = start + length + 1;
 
     if (start == last_run->value) {
         // wipe out previous
@@ -948,6 +1090,197 @@ int run_container_get_index(const run_container_t *container, uint16_t x) {
     }
 }
 
+#if CROARING_IS_X64
+
+#if CROARING_COMPILER_SUPPORTS_AVX512
+CROARING_TARGET_AVX512
+ALLOW_UNALIGNED
+static bool _avx512_run_container_contains(const run_container_t *run,
+                                           uint16_t pos) {
+    const int32_t lanes = sizeof(__m512i) / sizeof(rle16_t);
+    const rle16_t *runs = run->runs;
+    const rle16_t *base = runs;
+    int32_t n = run->n_runs;
+    while (n > lanes) {
+        const int32_t half = n >> 1;
+        base = (base[half].value <= pos) ? base + half : base;
+        n -= half;
+    }
+    // the last run starting at or before pos is within base[0, n)
+    if (base + lanes > runs + run->n_runs) base = runs + run->n_runs - lanes;
+    const __m512i v = _mm512_loadu_si512((const void *)base);
+    // pos - value (wrapping) <= length, in the low half of each 32-bit lane
+    const __m512i offsets = _mm512_sub_epi16(_mm512_set1_epi16((short)pos), v);
+    const __m512i lengths = _mm512_srli_epi32(v, 16);
+    return (_mm512_cmple_epu16_mask(offsets, lengths) & 0x55555555) != 0;
+}
+CROARING_UNTARGET_AVX512
+#endif  // CROARING_COMPILER_SUPPORTS_AVX512
+
+CROARING_TARGET_AVX2
+ALLOW_UNALIGNED
+static bool _avx2_run_container_contains(const run_container_t *run,
+                                         uint16_t pos) {
+    const int32_t lanes = sizeof(__m256i) / sizeof(rle16_t);
+    const rle16_t *runs = run->runs;
+    const rle16_t *base = runs;
+    int32_t n = run->n_runs;
+    while (n > lanes) {
+        const int32_t half = n >> 1;
+        base = (base[half].value <= pos) ? base + half : base;
+        n -= half;
+    }
+    // the last run starting at or before pos is within base[0, n)
+    if (base + lanes > runs + run->n_runs) base = runs + run->n_runs - lanes;
+    const __m256i v = _mm256_loadu_si256((const __m256i *)base);
+    // pos - value (wrapping) <= length, in the low half of each 32-bit lane
+    const __m256i offsets = _mm256_sub_epi16(_mm256_set1_epi16((short)pos), v);
+    const __m256i lengths = _mm256_srli_epi32(v, 16);
+    const __m256i inside =
+        _mm256_cmpeq_epi16(_mm256_max_epu16(offsets, lengths), lengths);
+    return (_mm256_movemask_epi8(inside) & 0x33333333) != 0;
+}
+CROARING_UNTARGET_AVX2
+
+bool run_container_contains_vector(const run_container_t *run, uint16_t pos) {
+#if CROARING_COMPILER_SUPPORTS_AVX512
+    if (run->n_runs >= 16 &&
+        (croaring_hardware_support() & ROARING_SUPPORTS_AVX512)) {
+        return _avx512_run_container_contains(run, pos);
+    }
+#endif
+    return _avx2_run_container_contains(run, pos);
+}
+
+#endif  // CROARING_IS_X64
+
+/*
+ * The bound of a run is its last value when `ends' is set, and its first
+ * value otherwise. Both increase along a valid container, so the merges can
+ * skip to the first run whose bound reaches some value.
+ */
+static inline uint32_t run_bound(const rle16_t *runs, int32_t i, bool ends) {
+    return ends ? (uint32_t)runs[i].value + runs[i].length : runs[i].value;
+}
+
+#if CROARING_IS_X64
+
+#if CROARING_COMPILER_SUPPORTS_AVX512
+CROARING_TARGET_AVX512
+ALLOW_UNALIGNED
+static int32_t _avx512_run_scan_bound(const rle16_t *runs, int32_t pos,
+                                      int32_t end, uint32_t min, bool ends) {
+    const int32_t lanes = sizeof(__m512i) / sizeof(rle16_t);
+    const __m512i lengthmask = _mm512_set1_epi32(ends ? 0xFFFF : 0);
+    const __m512i valuemask = _mm512_set1_epi32(0xFFFF);
+    const __m512i vmin = _mm512_set1_epi32((int)min);
+    for (; pos < end; pos += lanes) {
+        const __mmask16 valid =
+            (end - pos >= lanes) ? 0xFFFF
+                                 : (__mmask16)_bzhi_u32(0xFFFF, end - pos);
+        // each 32-bit lane holds a value in its low half, a length above
+        const __m512i v = _mm512_maskz_loadu_epi32(valid, runs + pos);
+        const __m512i bounds =
+            _mm512_add_epi32(_mm512_and_si512(v, valuemask),
+                             _mm512_and_si512(_mm512_srli_epi32(v, 16),
+                                              lengthmask));
+        const __mmask16 reached =
+            _mm512_mask_cmpge_epu32_mask(valid, bounds, vmin);
+        if (reached != 0) {
+            return pos + (int32_t)_tzcnt_u32(reached);
+        }
+    }
+    return end;
+}
+CROARING_UNTARGET_AVX512
+#endif  // CROARING_COMPILER_SUPPORTS_AVX512
+
+CROARING_TARGET_AVX2
+ALLOW_UNALIGNED
+static int32_t _avx2_run_scan_bound(const rle16_t *runs, int32_t pos,
+                                    int32_t end, uint32_t min, bool ends) {
+    const int32_t lanes = sizeof(__m256i) / sizeof(rle16_t);
+    const __m256i lengthmask = _mm256_set1_epi32(ends ? 0xFFFF : 0);
+    const __m256i valuemask = _mm256_set1_epi32(0xFFFF);
+    // bounds and min fit in 17 bits, so signed comparisons are fine
+    const __m256i vbelow = _mm256_set1_epi32((int)min - 1);
+    for (; pos + lanes <= end; pos += lanes) {
+        const __m256i v = _mm256_loadu_si256((const __m256i *)(runs + pos));
+        const __m256i bounds =
+            _mm256_add_epi32(_mm256_and_si256(v, valuemask),
+                             _mm256_and_si256(_mm256_srli_epi32(v, 16),
+                                              lengthmask));
+        const int reached = _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(bounds, vbelow)));
+        if (reached != 0) {
+            return pos + (int32_t)_tzcnt_u32((uint32_t)reached);
+        }
+    }
+    for (; pos < end; pos++) {
+        if (run_bound(runs, pos, ends) >= min) return pos;
+    }
+    return end;
+}
+CROARING_UNTARGET_AVX2
+
+#endif  // CROARING_IS_X64
+
+// index of the first run in runs[pos, end) whose bound is at least min, or
+// end if there is none
+static inline int32_t run_scan_bound(const rle16_t *runs, int32_t pos,
+                                     int32_t end, uint32_t min, bool ends) {
+#if CROARING_IS_X64
+#if CROARING_COMPILER_SUPPORTS_AVX512
+    if (croaring_hardware_support() & ROARING_SUPPORTS_AVX512) {
+        return _avx512_run_scan_bound(runs, pos, end, min, ends);
+    }
+#endif
+    if (croaring_hardware_support() & ROARING_SUPPORTS_AVX2) {
+        return _avx2_run_scan_bound(runs, pos, end, min, ends);
+    }
+#endif
+    for (; pos < end; pos++) {
+        if (run_bound(runs, pos, ends) >= min) return pos;
+    }
+    return end;
+}
+
+// like advanceUntil: gallops from runs[pos], whose bound is below min, then
+// narrows the last span down to a few blocks that are scanned
+static inline int32_t run_gallop_bound(const rle16_t *runs, int32_t pos,
+                                       int32_t n_runs, uint32_t min,
+                                       bool ends) {
+    int32_t lower = pos;
+    int32_t span = 16;
+    while ((n_runs - lower > span) &&
+           (run_bound(runs, lower + span, ends) < min)) {
+        lower += span;
+        span *= 2;
+    }
+    int32_t upper = (n_runs - lower > span) ? lower + span : n_runs;
+    // the bound of runs[lower] is below min; upper is n_runs or its bound
+    // is at least min
+    while (upper - lower > 64) {
+        const int32_t mid = lower + (upper - lower) / 2;
+        if (run_bound(runs, mid, ends) < min) {
+            lower = mid;
+        } else {
+            upper = mid;
+        }
+    }
+    return run_scan_bound(runs, lower + 1, upper, min, ends);
+}
+
+int32_t run_gallop_end(const rle16_t *runs, int32_t pos, int32_t n_runs,
+                       uint32_t min) {
+    return run_gallop_bound(runs, pos, n_runs, min, true);
+}
+
+int32_t run_gallop_start(const rle16_t *runs, int32_t pos, int32_t n_runs,
+                         uint32_t min) {
+    return run_gallop_bound(runs, pos, n_runs, min, false);
+}
+
 #if defined(CROARING_IS_X64) && CROARING_COMPILER_SUPPORTS_AVX512
 
 CROARING_TARGET_AVX512
@@ -1040,7 +1373,7 @@ static inline int _scalar_run_container_cardinality(
     return sum;
 }
 
-int run_container_cardinality(const run_container_t *run) {
+int run_container_compute_cardinality(const run_container_t *run) {
 #if CROARING_COMPILER_SUPPORTS_AVX512
     if (croaring_hardware_support() & ROARING_SUPPORTS_AVX512) {
         return _avx512_run_container_cardinality(run);
@@ -1056,7 +1389,7 @@ int run_container_cardinality(const run_container_t *run) {
 
 /* Get the cardinality of `run'. Requires an actual computation. */
 ALLOW_UNALIGNED
-int run_container_cardinality(const run_container_t *run) {
+int run_container_compute_cardinality(const run_container_t *run) {
     const int32_t n_runs = run->n_runs;
     const rle16_t *runs = run->runs;
 
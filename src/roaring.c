@@ -42,6 +42,22 @@ static inline bool is_frozen(const roaring_bitmap_t *r) {
     return r->high_low_container.flags & ROARING_FLAG_FROZEN;
 }
 
+// Returns a copy of the container at index i of ra, shared with ra when
+// copy_on_write is set (see ra_append_copy).
+static inline container_t *copy_container_at_index(const roaring_array_t *ra,
+                                                   uint16_t i,
+                                                   bool copy_on_write,
+                                                   uint8_t *type) {
+    *type = ra->typecodes[i];
+    container_t *c = get_copy_of_container(ra->containers[i], type,
+                                           copy_on_write);
+    if (copy_on_write) {
+        ra->containers[i] = c;
+        ra->typecodes[i] = *type;
+    }
+    return c;
+}
+
 // this is like roaring_bitmap_add, but it populates pointer arguments in such a
 // way
 // that we can recover the container touched, which, in turn can be used to
@@ -163,6 +179,9 @@ bool roaring_bitmap_contains_bulk(const roaring_bitmap_t *r,
                                   uint32_t val) {
     uint16_t key = val >> 16;
     if (context->container == NULL || context->key != key) {
+        if (!ra_may_contain_key(&r->high_low_container, key)) {
+            return false;
+        }
         int32_t start_idx = -1;
         if (context->container != NULL && context->key < key) {
             start_idx = context->idx;
@@ -189,6 +208,36 @@ bool roaring_bitmap_contains_bulk(const roaring_bitmap_t *r,
                               context->typecode);
 }
 
+void roaring_bitmap_contains_many(const roaring_bitmap_t *r,
+                                  const uint32_t *vals, size_t n,
+                                  uint64_t *out_bits) {
+    if (n == 0) return;
+    const roaring_array_t *ra = &r->high_low_container;
+    memset(out_bits, 0, ((n + 63) / 64) * sizeof(uint64_t));
+    int32_t pos = 0;  // first index holding a key >= the previous key
+    uint16_t previous = 0;
+    size_t begin = 0;
+    while (begin < n) {
+        const uint16_t key = vals[begin] >> 16;
+        size_t end = begin + 1;
+        while (end < n && (vals[end] >> 16) == key) end++;
+        if (ra_may_contain_key(ra, key)) {
+            if (key < previous) pos = 0;  // out of order, search from start
+            pos = ra_advance_until(ra, key, pos - 1);
+            previous = key;
+            if (pos < ra->size && ra->keys[pos] == key) {
+                if (pos + 1 < ra->size) {
+                    croaring_prefetch(ra->containers[pos + 1]);
+                }
+                container_contains_many(ra->containers[pos],
+                                        ra->typecodes[pos], vals, begin, end,
+                                        out_bits);
+            }
+        }
+        begin = end;
+    }
+}
+
 roaring_bitmap_t *roaring_bitmap_of_ptr(size_t n_args, const uint32_t *vals) {
     roaring_bitmap_t *answer = roaring_bitmap_create();
     roaring_bitmap_add_many(answer, n_args, vals);
@@ -235,8 +284,13 @@ roaring_bitmap_t *roaring_bitmap_from_range(uint64_t min, uint64_t max,
         uint32_t container_max =
             (uint32_t)minimum_uint64(max - (key << 16), 1 << 16);
         uint8_t type;
-        container_t *container = container_from_range(
-            &type, container_min, container_max, (uint16_t)step);
+        container_t *container;
+        if (step == 1 && container_min == 0 && container_max == (1 << 16)) {
+            container = container_get_full_singleton(&type);
+        } else {
+            container = container_from_range(&type, container_min,
+                                             container_max, (uint16_t)step);
+        }
         ra_append(&answer->high_low_container, (uint16_t)key, container, type);
         uint32_t gap = container_max - container_min + step - 1;
         min_tmp += gap - (gap % step);
@@ -277,7 +331,13 @@ void roaring_bitmap_add_range_closed(roaring_bitmap_t *r, uint32_t min,
         container_t *new_container;
         uint8_t new_type;
 
-        if (src >= 0 && ra->keys[src] == key) {
+        if (container_min == 0 && container_max == 0xffff) {
+            if (src >= 0 && ra->keys[src] == key) {
+                container_free(ra->containers[src], ra->typecodes[src]);
+                src--;
+            }
+            new_container = container_get_full_singleton(&new_type);
+        } else if (src >= 0 && ra->keys[src] == key) {
             ra_unshare_container_at_index(ra, (uint16_t)src);
             new_container =
                 container_add_range(ra->containers[src], ra->typecodes[src],
@@ -285,6 +345,7 @@ void roaring_bitmap_add_range_closed(roaring_bitmap_t *r, uint32_t min,
             if (new_container != ra->containers[src]) {
                 container_free(ra->containers[src], ra->typecodes[src]);
             }
+            new_container = container_share_if_full(new_container, &new_type);
             src--;
         } else {
             new_container = container_from_range(&new_type, container_min,
@@ -327,6 +388,8 @@ void roaring_bitmap_remove_range_closed(roaring_bitmap_t *r, uint32_t min,
             ra_replace_key_and_container_at_index(ra, dst, ra->keys[src],
                                                   new_container, new_type);
             dst++;
+        } else {
+            ra_summary_remove_key(ra, ra->keys[src]);
         }
         src++;
     }
@@ -428,6 +491,11 @@ void roaring_bitmap_statistics(const roaring_bitmap_t *r,
                 stat->n_values_run_containers += card;
                 stat->n_bytes_run_containers += sbytes;
                 break;
+            case PACKED_CONTAINER_TYPE:  // serialized as an array
+                stat->n_array_containers++;
+                stat->n_values_array_containers += card;
+                stat->n_bytes_array_containers += sbytes;
+                break;
             default:
                 assert(false);
                 roaring_unreachable;
@@ -549,6 +617,20 @@ void roaring_bitmap_clear(roaring_bitmap_t *r) {
     ra_reset(&r->high_low_container);
 }
 
+bool roaring_bitmap_enable_key_summary(roaring_bitmap_t *r) {
+    if (is_frozen(r)) return false;
+    return ra_enable_key_summary(&r->high_low_container);
+}
+
+void roaring_bitmap_disable_key_summary(roaring_bitmap_t *r) {
+    if (is_frozen(r)) return;
+    ra_disable_key_summary(&r->high_low_container);
+}
+
+bool roaring_bitmap_has_key_summary(const roaring_bitmap_t *r) {
+    return r->high_low_container.key_summary != NULL;
+}
+
 void roaring_bitmap_add(roaring_bitmap_t *r, uint32_t val) {
     roaring_array_t *ra = &r->high_low_container;
 
@@ -556,6 +638,7 @@ void roaring_bitmap_add(roaring_bitmap_t *r, uint32_t val) {
     const int i = ra_get_index(ra, hb);
     uint8_t typecode;
     if (i >= 0) {
+        if (container_is_full_singleton(ra->containers[i])) return;
         ra_unshare_container_at_index(ra, (uint16_t)i);
         container_t *container =
             ra_get_container_at_index(ra, (uint16_t)i, &typecode);
@@ -583,6 +666,9 @@ bool roaring_bitmap_add_checked(roaring_bitmap_t *r, uint32_t val) {
     uint8_t typecode;
     bool result = false;
     if (i >= 0) {
+        if (container_is_full_singleton(r->high_low_container.containers[i])) {
+            return false;
+        }
         ra_unshare_container_at_index(&r->high_low_container, (uint16_t)i);
         container_t *container = ra_get_container_at_index(
             &r->high_low_container, (uint16_t)i, &typecode);
@@ -713,7 +799,9 @@ void roaring_bitmap_remove_many(roaring_bitmap_t *r, size_t n_args,
     }
 }
 
-// there should be some SIMD optimizations possible here
+// Number of matching keys gathered per call to ra_intersect_keys.
+#define KEY_MATCH_BATCH 64
+
 roaring_bitmap_t *roaring_bitmap_and(const roaring_bitmap_t *x1,
                                      const roaring_bitmap_t *x2) {
     uint8_t result_type = 0;
@@ -723,33 +811,37 @@ roaring_bitmap_t *roaring_bitmap_and(const roaring_bitmap_t *x1,
     roaring_bitmap_t *answer = roaring_bitmap_create_with_capacity(neededcap);
     roaring_bitmap_set_copy_on_write(answer, is_cow(x1) || is_cow(x2));
 
-    int pos1 = 0, pos2 = 0;
-
-    while (pos1 < length1 && pos2 < length2) {
-        const uint16_t s1 =
-            ra_get_key_at_index(&x1->high_low_container, (uint16_t)pos1);
-        const uint16_t s2 =
-            ra_get_key_at_index(&x2->high_low_container, (uint16_t)pos2);
-
-        if (s1 == s2) {
+    int32_t pos1 = 0, pos2 = 0;
+    uint16_t index1[KEY_MATCH_BATCH], index2[KEY_MATCH_BATCH];
+    int32_t matched;
+    while ((matched = ra_intersect_keys(&x1->high_low_container, &pos1,
+                                        &x2->high_low_container, &pos2, index1,
+                                        index2, KEY_MATCH_BATCH)) > 0) {
+        for (int32_t i = 0; i < matched; i++) {
             uint8_t type1, type2;
-            container_t *c1 = ra_get_container_at_index(&x1->high_low_container,
-                                                        (uint16_t)pos1, &type1);
-            container_t *c2 = ra_get_container_at_index(&x2->high_low_container,
-                                                        (uint16_t)pos2, &type2);
-            container_t *c = container_and(c1, type1, c2, type2, &result_type);
+            container_t *c1 = ra_get_container_at_index(
+                &x1->high_low_container, index1[i], &type1);
+            container_t *c2 = ra_get_container_at_index(
+                &x2->high_low_container, index2[i], &type2);
+            container_t *c;
+            if (container_is_full(c1, type1)) {  // identity
+                c = copy_container_at_index(&x2->high_low_container, index2[i],
+                                            is_cow(x2), &result_type);
+            } else if (container_is_full(c2, type2)) {
+                c = copy_container_at_index(&x1->high_low_container, index1[i],
+                                            is_cow(x1), &result_type);
+            } else {
+                c = container_and(c1, type1, c2, type2, &result_type);
+            }
 
             if (container_nonzero_cardinality(c, result_type)) {
-                ra_append(&answer->high_low_container, s1, c, result_type);
+                ra_append(&answer->high_low_container,
+                          ra_get_key_at_index(&x1->high_low_container,
+                                              index1[i]),
+                          c, result_type);
             } else {
                 container_free(c, result_type);  // otherwise: memory leak!
             }
-            ++pos1;
-            ++pos2;
-        } else if (s1 < s2) {  // s1 < s2
-            pos1 = ra_advance_until(&x1->high_low_container, s2, pos1);
-        } else {  // s1 > s2
-            pos2 = ra_advance_until(&x2->high_low_container, s1, pos2);
         }
     }
     return answer;
@@ -822,10 +914,19 @@ void roaring_bitmap_and_inplace(roaring_bitmap_t *x1,
             // place computation would require making a copy and then doing the
             // computation in place which is likely less efficient than avoiding
             // in place entirely and always generating a new container.
-            container_t *c =
-                (type1 == SHARED_CONTAINER_TYPE)
-                    ? container_and(c1, type1, c2, type2, &result_type)
-                    : container_iand(c1, type1, c2, type2, &result_type);
+            container_t *c;
+            if (container_is_full(c2, type2)) {  // identity
+                c = c1;
+                result_type = type1;
+            } else if (container_is_full(c1, type1)) {
+                c = copy_container_at_index(&x2->high_low_container,
+                                            (uint16_t)pos2, is_cow(x2),
+                                            &result_type);
+            } else if (type1 == SHARED_CONTAINER_TYPE) {
+                c = container_and(c1, type1, c2, type2, &result_type);
+            } else {
+                c = container_iand(c1, type1, c2, type2, &result_type);
+            }
 
             if (c != c1) {  // in this instance a new container was created, and
                             // we need to free the old one
@@ -838,6 +939,7 @@ void roaring_bitmap_and_inplace(roaring_bitmap_t *x1,
                 intersection_size++;
             } else {
                 container_free(c, result_type);
+                ra_summary_remove_key(&x1->high_low_container, s1);
             }
             ++pos1;
             ++pos2;
@@ -853,6 +955,8 @@ void roaring_bitmap_and_inplace(roaring_bitmap_t *x1,
     while (pos1 < length1) {
         container_free(x1->high_low_container.containers[pos1],
                        x1->high_low_container.typecodes[pos1]);
+        ra_summary_remove_key(&x1->high_low_container,
+                              x1->high_low_container.keys[pos1]);
         ++pos1;
     }
 
@@ -884,7 +988,13 @@ roaring_bitmap_t *roaring_bitmap_or(const roaring_bitmap_t *x1,
                                                         (uint16_t)pos1, &type1);
             container_t *c2 = ra_get_container_at_index(&x2->high_low_container,
                                                         (uint16_t)pos2, &type2);
-            container_t *c = container_or(c1, type1, c2, type2, &result_type);
+            container_t *c;
+            if (container_is_full(c1, type1) || container_is_full(c2, type2)) {
+                c = container_get_full_singleton(&result_type);
+            } else {
+                c = container_or(c1, type1, c2, type2, &result_type);
+                c = container_share_if_full(c, &result_type);
+            }
 
             // since we assume that the initial containers are non-empty, the
             // result here
@@ -959,18 +1069,24 @@ void roaring_bitmap_or_inplace(roaring_bitmap_t *x1,
         if (s1 == s2) {
             container_t *c1 = ra_get_container_at_index(&x1->high_low_container,
                                                         (uint16_t)pos1, &type1);
-            if (!container_is_full(c1, type1)) {
+            if (!container_is_full_singleton(c1)) {
                 container_t *c2 = ra_get_container_at_index(
                     &x2->high_low_container, (uint16_t)pos2, &type2);
-                container_t *c =
-                    (type1 == SHARED_CONTAINER_TYPE)
-                        ? container_or(c1, type1, c2, type2, &result_type)
-                        : container_ior(c1, type1, c2, type2, &result_type);
+                container_t *c;
+                if (container_is_full(c1, type1) ||
+                    container_is_full(c2, type2)) {
+                    c = container_get_full_singleton(&result_type);
+                } else if (type1 == SHARED_CONTAINER_TYPE) {
+                    c = container_or(c1, type1, c2, type2, &result_type);
+                } else {
+                    c = container_ior(c1, type1, c2, type2, &result_type);
+                }
 
                 if (c != c1) {  // in this instance a new container was created,
                                 // and we need to free the old one
                     container_free(c1, type1);
                 }
+                c = container_share_if_full(c, &result_type);
                 ra_set_container_at_index(&x1->high_low_container, pos1, c,
                                           result_type);
             }
@@ -1194,49 +1310,49 @@ roaring_bitmap_t *roaring_bitmap_andnot(const roaring_bitmap_t *x1,
     roaring_bitmap_t *answer = roaring_bitmap_create_with_capacity(length1);
     roaring_bitmap_set_copy_on_write(answer, is_cow(x1) || is_cow(x2));
 
-    int pos1 = 0, pos2 = 0;
-    uint8_t type1, type2;
-    uint16_t s1 = 0;
-    uint16_t s2 = 0;
-    while (true) {
-        s1 = ra_get_key_at_index(&x1->high_low_container, (uint16_t)pos1);
-        s2 = ra_get_key_at_index(&x2->high_low_container, (uint16_t)pos2);
-
-        if (s1 == s2) {
-            container_t *c1 = ra_get_container_at_index(&x1->high_low_container,
-                                                        (uint16_t)pos1, &type1);
-            container_t *c2 = ra_get_container_at_index(&x2->high_low_container,
-                                                        (uint16_t)pos2, &type2);
+    int32_t pos1 = 0, pos2 = 0;
+    // containers of x1 before this index have been carried over
+    int32_t copied = 0;
+    uint16_t index1[KEY_MATCH_BATCH], index2[KEY_MATCH_BATCH];
+    int32_t matched;
+    while ((matched = ra_intersect_keys(&x1->high_low_container, &pos1,
+                                        &x2->high_low_container, &pos2, index1,
+                                        index2, KEY_MATCH_BATCH)) > 0) {
+        for (int32_t i = 0; i < matched; i++) {
+            if (copied < index1[i]) {
+                // TODO : perhaps some of the copy_on_write should be based on
+                // answer rather than x1 (more stringent?).  Many similar cases
+                ra_append_copy_range(&answer->high_low_container,
+                                     &x1->high_low_container, copied,
+                                     index1[i], is_cow(x1));
+            }
+            copied = index1[i] + 1;
+            uint8_t type1, type2;
+            container_t *c1 = ra_get_container_at_index(
+                &x1->high_low_container, index1[i], &type1);
+            container_t *c2 = ra_get_container_at_index(
+                &x2->high_low_container, index2[i], &type2);
+            if (container_is_full(c2, type2)) {
+                continue;  // nothing left
+            }
             container_t *c =
-                container_andnot(c1, type1, c2, type2, &result_type);
+                container_is_full(c1, type1)
+                    ? container_not(c2, type2, &result_type)  // complement
+                    : container_andnot(c1, type1, c2, type2, &result_type);
 
             if (container_nonzero_cardinality(c, result_type)) {
-                ra_append(&answer->high_low_container, s1, c, result_type);
+                ra_append(&answer->high_low_container,
+                          ra_get_key_at_index(&x1->high_low_container,
+                                              index1[i]),
+                          c, result_type);
             } else {
                 container_free(c, result_type);
             }
-            ++pos1;
-            ++pos2;
-            if (pos1 == length1) break;
-            if (pos2 == length2) break;
-        } else if (s1 < s2) {  // s1 < s2
-            const int next_pos1 =
-                ra_advance_until(&x1->high_low_container, s2, pos1);
-            ra_append_copy_range(&answer->high_low_container,
-                                 &x1->high_low_container, pos1, next_pos1,
-                                 is_cow(x1));
-            // TODO : perhaps some of the copy_on_write should be based on
-            // answer rather than x1 (more stringent?).  Many similar cases
-            pos1 = next_pos1;
-            if (pos1 == length1) break;
-        } else {  // s1 > s2
-            pos2 = ra_advance_until(&x2->high_low_container, s1, pos2);
-            if (pos2 == length2) break;
         }
     }
-    if (pos2 == length2) {
+    if (copied < length1) {
         ra_append_copy_range(&answer->high_low_container,
-                             &x1->high_low_container, pos1, length1,
+                             &x1->high_low_container, copied, length1,
                              is_cow(x1));
     }
     return answer;
@@ -1255,10 +1371,7 @@ void roaring_bitmap_andnot_inplace(roaring_bitmap_t *x1,
 
     if (0 == length2) return;
 
-    if (0 == length1) {
-        roaring_bitmap_clear(x1);
-        return;
-    }
+    if (0 == length1) return;  // clearing x1 would drop its key summary
 
     int pos1 = 0, pos2 = 0;
     uint8_t type1, type2;
@@ -1278,19 +1391,26 @@ void roaring_bitmap_andnot_inplace(roaring_bitmap_t *x1,
             // in place entirely and always generating a new container.
 
             container_t *c;
-            if (type1 == SHARED_CONTAINER_TYPE) {
+            if (container_is_full(c2, type2)) {
+                container_free(c1, type1);  // nothing left
+                c = NULL;
+            } else if (container_is_full(c1, type1)) {
+                c = container_not(c2, type2, &result_type);  // complement
+                container_free(c1, type1);
+            } else if (type1 == SHARED_CONTAINER_TYPE) {
                 c = container_andnot(c1, type1, c2, type2, &result_type);
                 shared_container_free(CAST_shared(c1));  // release
             } else {
                 c = container_iandnot(c1, type1, c2, type2, &result_type);
             }
 
-            if (container_nonzero_cardinality(c, result_type)) {
+            if (c != NULL && container_nonzero_cardinality(c, result_type)) {
                 ra_replace_key_and_container_at_index(&x1->high_low_container,
                                                       intersection_size++, s1,
                                                       c, result_type);
             } else {
-                container_free(c, result_type);
+                if (c != NULL) container_free(c, result_type);
+                ra_summary_remove_key(&x1->high_low_container, s1);
             }
 
             ++pos1;
@@ -1423,6 +1543,10 @@ bool roaring_bitmap_run_optimize(roaring_bitmap_t *r) {
     bool answer = false;
     for (int i = 0; i < r->high_low_container.size; i++) {
         uint8_t type_original, type_after;
+        if (container_is_full_singleton(r->high_low_container.containers[i])) {
+            answer = true;  // a single run already
+            continue;
+        }
         ra_unshare_container_at_index(
             &r->high_low_container,
             (uint16_t)i);  // TODO: this introduces extra cloning!
@@ -1432,11 +1556,38 @@ bool roaring_bitmap_run_optimize(roaring_bitmap_t *r) {
         if (type_after == RUN_CONTAINER_TYPE) {
             answer = true;
         }
+        c1 = container_share_if_full(c1, &type_after);
         ra_set_container_at_index(&r->high_low_container, i, c1, type_after);
     }
     return answer;
 }
 
+/** convert array containers to packed containers when it takes less
+ * memory. Returns true if the result has at least one packed container.
+ */
+bool roaring_bitmap_pack_optimize(roaring_bitmap_t *r) {
+    bool answer = false;
+    for (int i = 0; i < r->high_low_container.size; i++) {
+        uint8_t type_original, type_after;
+        container_t *c = ra_get_container_at_index(&r->high_low_container,
+                                                   (uint16_t)i, &type_original);
+        type_after = get_container_type(c, type_original);
+        if (type_after == ARRAY_CONTAINER_TYPE) {
+            ra_unshare_container_at_index(&r->high_low_container, (uint16_t)i);
+            c = ra_get_container_at_index(&r->high_low_container, (uint16_t)i,
+                                          &type_original);
+            container_t *c1 =
+                convert_array_to_packed_if_smaller(CAST_array(c), &type_after);
+            ra_set_container_at_index(&r->high_low_container, i, c1,
+                                      type_after);
+        }
+        if (type_after == PACKED_CONTAINER_TYPE) {
+            answer = true;
+        }
+    }
+    return answer;
+}
+
 size_t roaring_bitmap_shrink_to_fit(roaring_bitmap_t *r) {
     size_t answer = 0;
     for (int i = 0; i < r->high_low_container.size; i++) {
@@ -1645,6 +1796,66 @@ bool roaring_iterate64(const roaring_bitmap_t *r, roaring_iterator64 iterator,
     return true;
 }
 
+static void container_view_init(const roaring_array_t *ra, int32_t i,
+                                roaring_container_view_t *view) {
+    uint8_t typecode = ra->typecodes[i];
+    const container_t *c =
+        container_unwrap_shared(ra->containers[i], &typecode);
+    view->key = ra->keys[i];
+    view->typecode = typecode;
+    view->cardinality = container_get_cardinality(c, typecode);
+    switch (typecode) {
+        case BITSET_CONTAINER_TYPE:
+            view->length = BITSET_CONTAINER_SIZE_IN_WORDS;
+            view->data = const_CAST_bitset(c)->words;
+            break;
+        case ARRAY_CONTAINER_TYPE:
+            view->length = const_CAST_array(c)->cardinality;
+            view->data = const_CAST_array(c)->array;
+            break;
+        case RUN_CONTAINER_TYPE:
+            view->length = const_CAST_run(c)->n_runs;
+            view->data = const_CAST_run(c)->runs;
+            break;
+        case PACKED_CONTAINER_TYPE:  // without the padding
+            view->length =
+                packed_container_memory_size_in_bytes(const_CAST_packed(c)) -
+                (int32_t)sizeof(packed_container_t) - PACKED_PADDING;
+            view->data = const_CAST_packed(c)->data;
+            break;
+        default:
+            roaring_unreachable;
+    }
+}
+
+bool roaring_iterate_containers(const roaring_bitmap_t *r,
+                                roaring_container_visitor visitor, void *ptr) {
+    const roaring_array_t *ra = &r->high_low_container;
+    roaring_container_view_t view;
+
+    for (int i = 0; i < ra->size; ++i) {
+        container_view_init(ra, i, &view);
+        if (!visitor(&view, ptr)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t roaring_bitmap_container_count(const roaring_bitmap_t *r) {
+    return (uint32_t)r->high_low_container.size;
+}
+
+bool roaring_bitmap_container_view(const roaring_bitmap_t *r, uint32_t i,
+                                   roaring_container_view_t *view) {
+    const roaring_array_t *ra = &r->high_low_container;
+    if (i >= (uint32_t)ra->size) {
+        return false;
+    }
+    container_view_init(ra, (int32_t)i, view);
+    return true;
+}
+
 /****
  * begin roaring_uint32_iterator_t
  *****/
@@ -1861,6 +2072,664 @@ void roaring_uint32_iterator_free(roaring_uint32_iterator_t *it) {
  * end of roaring_uint32_iterator_t
  *****/
 
+/****
+ * begin roaring_many_iterator_t
+ *****/
+
+enum {
+    MANY_ITERATOR_OR,
+    MANY_ITERATOR_AND,
+    MANY_ITERATOR_XOR,
+    MANY_ITERATOR_ANDNOT
+};
+
+typedef struct roaring_many_iterator_s {
+    const roaring_bitmap_t **inputs;
+    int32_t *indexes;  // Next container to consume within each input
+    size_t number;
+    uint8_t op;
+
+    // Containers of the inputs sharing the current key.
+    const container_t **gathered;
+    uint8_t *gathered_typecodes;
+
+    // Scratch containers, reused for every key.
+    bitset_container_t *scratch_bitset;
+    array_container_t *scratch_arrays[2];
+    // Decoded copies of the packed containers gathered, allocated on demand.
+    array_container_t **unpacked;
+
+    const container_t *container;  // Result for the current key
+    uint8_t typecode;
+    uint32_t highbits;
+    roaring_container_iterator_t container_it;
+
+    uint32_t current_value;
+    bool has_value;
+} roaring_many_iterator_t;
+
+// Returns false if a packed container cannot be decoded for lack of memory.
+static inline bool many_iterator_gather_at(roaring_many_iterator_t *it,
+                                           size_t n, const roaring_array_t *ra,
+                                           int32_t index) {
+    uint8_t typecode = ra->typecodes[index];
+    const container_t *c =
+        container_unwrap_shared(ra->containers[index], &typecode);
+    if (typecode == PACKED_CONTAINER_TYPE) {
+        // the merges below only know about bitsets, arrays and runs
+        const packed_container_t *pc = const_CAST_packed(c);
+        if (it->unpacked[n] == NULL) {
+            it->unpacked[n] =
+                array_container_create_given_capacity(DEFAULT_MAX_SIZE);
+            if (it->unpacked[n] == NULL) return false;
+        }
+        packed_container_decode(pc, it->unpacked[n]->array);
+        it->unpacked[n]->cardinality = pc->cardinality;
+        c = it->unpacked[n];
+        typecode = ARRAY_CONTAINER_TYPE;
+    }
+    it->gathered[n] = c;
+    it->gathered_typecodes[n] = typecode;
+    return true;
+}
+
+/**
+ * Finds the next key that may be present in the result and collects the
+ * containers of the inputs sharing that key. Returns the number of containers
+ * collected, or 0 once there are no more keys or on allocation failure.
+ */
+static size_t many_iterator_gather(roaring_many_iterator_t *it,
+                                   uint16_t *key) {
+    size_t n = 0;
+    switch (it->op) {
+        case MANY_ITERATOR_OR:
+        case MANY_ITERATOR_XOR: {
+            bool found = false;
+            for (size_t i = 0; i < it->number; i++) {
+                const roaring_array_t *ra = &it->inputs[i]->high_low_container;
+                if (it->indexes[i] < ra->size &&
+                    (!found || ra->keys[it->indexes[i]] < *key)) {
+                    *key = ra->keys[it->indexes[i]];
+                    found = true;
+                }
+            }
+            if (!found) return 0;
+            for (size_t i = 0; i < it->number; i++) {
+                const roaring_array_t *ra = &it->inputs[i]->high_low_container;
+                if (it->indexes[i] < ra->size &&
+                    ra->keys[it->indexes[i]] == *key &&
+                    !many_iterator_gather_at(it, n++, ra, it->indexes[i]++)) {
+                    return 0;
+                }
+            }
+            return n;
+        }
+        case MANY_ITERATOR_AND: {
+            if (it->number == 0) return 0;
+            bool aligned = false;
+            while (!aligned) {
+                *key = 0;
+                for (size_t i = 0; i < it->number; i++) {
+                    const roaring_array_t *ra =
+                        &it->inputs[i]->high_low_container;
+                    if (it->indexes[i] >= ra->size) return 0;
+                    if (ra->keys[it->indexes[i]] > *key) {
+                        *key = ra->keys[it->indexes[i]];
+                    }
+                }
+                aligned = true;
+                for (size_t i = 0; i < it->number; i++) {
+                    const roaring_array_t *ra =
+                        &it->inputs[i]->high_low_container;
+                    if (ra->keys[it->indexes[i]] < *key) {
+                        it->indexes[i] =
+                            ra_advance_until(ra, *key, it->indexes[i]);
+                        if (it->indexes[i] >= ra->size) return 0;
+                        aligned &= (ra->keys[it->indexes[i]] == *key);
+                    }
+                }
+            }
+            for (size_t i = 0; i < it->number; i++) {
+                const roaring_array_t *ra = &it->inputs[i]->high_low_container;
+                if (!many_iterator_gather_at(it, n++, ra, it->indexes[i]++)) {
+                    return 0;
+                }
+            }
+            return n;
+        }
+        case MANY_ITERATOR_ANDNOT: {
+            if (it->number == 0) return 0;
+            const roaring_array_t *ra0 = &it->inputs[0]->high_low_container;
+            if (it->indexes[0] >= ra0->size) return 0;
+            *key = ra0->keys[it->indexes[0]];
+            if (!many_iterator_gather_at(it, n++, ra0, it->indexes[0]++)) {
+                return 0;
+            }
+            // The containers subtracted are not consumed: the next key of
+            // the first input is larger anyway.
+            for (size_t i = 1; i < it->number; i++) {
+                const roaring_array_t *ra = &it->inputs[i]->high_low_container;
+                if (it->indexes[i] < ra->size &&
+                    ra->keys[it->indexes[i]] < *key) {
+                    it->indexes[i] = ra_advance_until(ra, *key, it->indexes[i]);
+                }
+                if (it->indexes[i] < ra->size &&
+                    ra->keys[it->indexes[i]] == *key &&
+                    !many_iterator_gather_at(it, n++, ra, it->indexes[i])) {
+                    return 0;
+                }
+            }
+            return n;
+        }
+        default:
+            roaring_unreachable;
+            return 0;
+    }
+}
+
+/**
+ * Copies the given container into the scratch bitset.
+ */
+static void many_iterator_load_bitset(bitset_container_t *dst,
+                                      const container_t *c, uint8_t typecode) {
+    switch (typecode) {
+        case BITSET_CONTAINER_TYPE:
+            bitset_container_copy(const_CAST_bitset(c), dst);
+            return;
+        case ARRAY_CONTAINER_TYPE: {
+            const array_container_t *ac = const_CAST_array(c);
+            bitset_container_clear(dst);
+            bitset_set_list(dst->words, ac->array, ac->cardinality);
+            return;
+        }
+        case RUN_CONTAINER_TYPE: {
+            const run_container_t *rc = const_CAST_run(c);
+            bitset_container_clear(dst);
+            for (int32_t i = 0; i < rc->n_runs; i++) {
+                bitset_set_lenrange(dst->words, rc->runs[i].value,
+                                    rc->runs[i].length);
+            }
+            return;
+        }
+        default:
+            roaring_unreachable;
+    }
+}
+
+/**
+ * Applies `dst = dst op c` on the scratch bitset, without maintaining the
+ * cardinality.
+ */
+static void many_iterator_apply_bitset(uint8_t op, bitset_container_t *dst,
+                                       const container_t *c,
+                                       uint8_t typecode) {
+    uint64_t *words = dst->words;
+    switch (typecode) {
+        case BITSET_CONTAINER_TYPE: {
+            const bitset_container_t *bc = const_CAST_bitset(c);
+            switch (op) {
+                case MANY_ITERATOR_OR:
+                    bitset_container_or_nocard(dst, bc, dst);
+                    return;
+                case MANY_ITERATOR_AND:
+                    bitset_container_and_nocard(dst, bc, dst);
+                    return;
+                case MANY_ITERATOR_XOR:
+                    bitset_container_xor_nocard(dst, bc, dst);
+                    return;
+                default:
+                    bitset_container_andnot_nocard(dst, bc, dst);
+                    return;
+            }
+        }
+        case ARRAY_CONTAINER_TYPE: {
+            // Intersections with arrays never reach the scratch bitset.
+            const array_container_t *ac = const_CAST_array(c);
+            switch (op) {
+                case MANY_ITERATOR_OR:
+                    bitset_set_list(words, ac->array, ac->cardinality);
+                    return;
+                case MANY_ITERATOR_XOR:
+                    bitset_flip_list(words, ac->array, ac->cardinality);
+                    return;
+                default:
+                    bitset_clear_list(words, 0, ac->array, ac->cardinality);
+                    return;
+            }
+        }
+        case RUN_CONTAINER_TYPE: {
+            const run_container_t *rc = const_CAST_run(c);
+            uint32_t previous_end = 0;
+            for (int32_t i = 0; i < rc->n_runs; i++) {
+                uint32_t start = rc->runs[i].value;
+                uint32_t end = start + rc->runs[i].length + 1;
+                switch (op) {
+                    case MANY_ITERATOR_OR:
+                        bitset_set_lenrange(words, start, rc->runs[i].length);
+                        break;
+                    case MANY_ITERATOR_AND:
+                        bitset_reset_range(words, previous_end, start);
+                        break;
+                    case MANY_ITERATOR_XOR:
+                        bitset_flip_range(words, start, end);
+                        break;
+                    default:
+                        bitset_reset_range(words, start, end);
+                        break;
+                }
+                previous_end = end;
+            }
+            if (op == MANY_ITERATOR_AND) {
+                bitset_reset_range(words, previous_end, 1 << 16);
+            }
+            return;
+        }
+        default:
+            roaring_unreachable;
+    }
+}
+
+/**
+ * Merges the gathered containers into the result container for the current
+ * key, borrowing an input container when there is nothing to merge. Returns
+ * false if the result is empty.
+ */
+static bool many_iterator_merge(roaring_many_iterator_t *it, size_t n) {
+    if (n == 1) {
+        it->container = it->gathered[0];
+        it->typecode = it->gathered_typecodes[0];
+        return true;
+    }
+    size_t base = 0;
+    bool all_arrays = true;
+    int32_t sum_cardinality = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (it->gathered_typecodes[i] != ARRAY_CONTAINER_TYPE) {
+            all_arrays = false;
+            continue;
+        }
+        const array_container_t *ac = const_CAST_array(it->gathered[i]);
+        sum_cardinality += ac->cardinality;
+        if (it->gathered_typecodes[base] != ARRAY_CONTAINER_TYPE ||
+            ac->cardinality <
+                const_CAST_array(it->gathered[base])->cardinality) {
+            base = i;
+        }
+    }
+    // An intersection involving an array is an array no larger than the
+    // smallest one, and so is a difference from an array.
+    bool array_result =
+        (it->op == MANY_ITERATOR_AND &&
+         it->gathered_typecodes[base] == ARRAY_CONTAINER_TYPE) ||
+        (it->op == MANY_ITERATOR_ANDNOT &&
+         it->gathered_typecodes[0] == ARRAY_CONTAINER_TYPE) ||
+        (all_arrays && sum_cardinality <= DEFAULT_MAX_SIZE);
+    if (array_result) {
+        if (it->op != MANY_ITERATOR_AND) base = 0;
+        const array_container_t *src = const_CAST_array(it->gathered[base]);
+        int toggle = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (i == base) continue;
+            array_container_t *dst = it->scratch_arrays[toggle];
+            const container_t *c = it->gathered[i];
+            switch (it->op) {
+                case MANY_ITERATOR_OR:
+                    array_container_union(src, const_CAST_array(c), dst);
+                    break;
+                case MANY_ITERATOR_XOR:
+                    array_container_xor(src, const_CAST_array(c), dst);
+                    break;
+                case MANY_ITERATOR_ANDNOT:
+                    switch (it->gathered_typecodes[i]) {
+                        case ARRAY_CONTAINER_TYPE:
+                            array_container_andnot(src, const_CAST_array(c),
+                                                   dst);
+                            break;
+                        case BITSET_CONTAINER_TYPE:
+                            array_bitset_container_andnot(
+                                src, const_CAST_bitset(c), dst);
+                            break;
+                        default:
+                            array_run_container_andnot(src, const_CAST_run(c),
+                                                       dst);
+                            break;
+                    }
+                    break;
+                default:
+                    switch (it->gathered_typecodes[i]) {
+                        case ARRAY_CONTAINER_TYPE:
+                            array_container_intersection(
+                                src, const_CAST_array(c), dst);
+                            break;
+                        case BITSET_CONTAINER_TYPE:
+                            array_bitset_container_intersection(
+                                src, const_CAST_bitset(c), dst);
+                            break;
+                        default:
+                            array_run_container_intersection(
+                                src, const_CAST_run(c), dst);
+                            break;
+                    }
+                    break;
+            }
+            src = dst;
+            toggle ^= 1;
+            if (src->cardinality == 0 && it->op != MANY_ITERATOR_XOR) {
+                return false;
+            }
+        }
+        it->container = src;
+        it->typecode = ARRAY_CONTAINER_TYPE;
+        return src->cardinality > 0;
+    }
+    bitset_container_t *bc = it->scratch_bitset;
+    many_iterator_load_bitset(bc, it->gathered[0], it->gathered_typecodes[0]);
+    for (size_t i = 1; i < n; i++) {
+        many_iterator_apply_bitset(it->op, bc, it->gathered[i],
+                                   it->gathered_typecodes[i]);
+    }
+    bc->cardinality = bitset_container_compute_cardinality(bc);
+    it->container = bc;
+    it->typecode = BITSET_CONTAINER_TYPE;
+    return bc->cardinality > 0;
+}
+
+/**
+ * Positions the iterator at the first value of the next key having a
+ * non-empty result, if available.
+ */
+static bool many_iterator_load_next(roaring_many_iterator_t *it) {
+    uint16_t key = 0;
+    size_t n;
+    while ((n = many_iterator_gather(it, &key)) > 0) {
+        if (many_iterator_merge(it, n)) {
+            uint16_t value = 0;
+            it->highbits = ((uint32_t)key) << 16;
+            it->container_it =
+                container_init_iterator(it->container, it->typecode, &value);
+            it->current_value = it->highbits | value;
+            return (it->has_value = true);
+        }
+    }
+    it->container = NULL;
+    return (it->has_value = false);
+}
+
+static roaring_many_iterator_t *many_iterator_create(
+    size_t number, const roaring_bitmap_t **x, uint8_t op) {
+    roaring_many_iterator_t *it = (roaring_many_iterator_t *)roaring_calloc(
+        1, sizeof(roaring_many_iterator_t));
+    if (it == NULL) return NULL;
+    it->number = number;
+    it->op = op;
+    it->inputs = (const roaring_bitmap_t **)roaring_malloc(
+        (number + 1) * sizeof(const roaring_bitmap_t *));
+    it->indexes = (int32_t *)roaring_calloc(number + 1, sizeof(int32_t));
+    it->gathered = (const container_t **)roaring_malloc(
+        (number + 1) * sizeof(const container_t *));
+    it->gathered_typecodes = (uint8_t *)roaring_malloc(number + 1);
+    it->unpacked = (array_container_t **)roaring_calloc(
+        number + 1, sizeof(array_container_t *));
+    it->scratch_bitset = bitset_container_create();
+    it->scratch_arrays[0] =
+        array_container_create_given_capacity(DEFAULT_MAX_SIZE);
+    it->scratch_arrays[1] =
+        array_container_create_given_capacity(DEFAULT_MAX_SIZE);
+    if (it->inputs == NULL || it->indexes == NULL || it->gathered == NULL ||
+        it->gathered_typecodes == NULL || it->unpacked == NULL ||
+        it->scratch_bitset == NULL ||
+        it->scratch_arrays[0] == NULL || it->scratch_arrays[1] == NULL) {
+        roaring_many_iterator_free(it);
+        return NULL;
+    }
+    if (number > 0) {
+        memcpy(it->inputs, x, number * sizeof(const roaring_bitmap_t *));
+    }
+    many_iterator_load_next(it);
+    return it;
+}
+
+roaring_many_iterator_t *roaring_or_many_iterator_create(
+    size_t number, const roaring_bitmap_t **x) {
+    return many_iterator_create(number, x, MANY_ITERATOR_OR);
+}
+
+roaring_many_iterator_t *roaring_and_many_iterator_create(
+    size_t number, const roaring_bitmap_t **x) {
+    return many_iterator_create(number, x, MANY_ITERATOR_AND);
+}
+
+roaring_many_iterator_t *roaring_xor_many_iterator_create(
+    size_t number, const roaring_bitmap_t **x) {
+    return many_iterator_create(number, x, MANY_ITERATOR_XOR);
+}
+
+roaring_many_iterator_t *roaring_andnot_many_iterator_create(
+    size_t number, const roaring_bitmap_t **x) {
+    return many_iterator_create(number, x, MANY_ITERATOR_ANDNOT);
+}
+
+void roaring_many_iterator_free(roaring_many_iterator_t *it) {
+    if (it == NULL) {
+        return;
+    }
+    if (it->scratch_bitset != NULL) {
+        bitset_container_free(it->scratch_bitset);
+    }
+    for (int i = 0; i < 2; i++) {
+        if (it->scratch_arrays[i] != NULL) {
+            array_container_free(it->scratch_arrays[i]);
+        }
+    }
+    if (it->unpacked != NULL) {
+        for (size_t i = 0; i <= it->number; i++) {
+            if (it->unpacked[i] != NULL) {
+                array_container_free(it->unpacked[i]);
+            }
+        }
+        roaring_free(it->unpacked);
+    }
+    roaring_free(it->gathered_typecodes);
+    roaring_free((void *)it->gathered);
+    roaring_free(it->indexes);
+    roaring_free((void *)it->inputs);
+    roaring_free(it);
+}
+
+bool roaring_many_iterator_has_value(const roaring_many_iterator_t *it) {
+    return it->has_value;
+}
+
+uint32_t roaring_many_iterator_value(const roaring_many_iterator_t *it) {
+    return it->current_value;
+}
+
+bool roaring_many_iterator_advance(roaring_many_iterator_t *it) {
+    if (!it->has_value) {
+        return false;
+    }
+    uint16_t low16 = (uint16_t)it->current_value;
+    if (container_iterator_next(it->container, it->typecode, &it->container_it,
+                                &low16)) {
+        it->current_value = it->highbits | low16;
+        return true;
+    }
+    return many_iterator_load_next(it);
+}
+
+bool roaring_many_iterator_move_equalorlarger(roaring_many_iterator_t *it,
+                                              uint32_t val) {
+    if (!it->has_value || it->current_value >= val) {
+        return it->has_value;
+    }
+    uint16_t hb = val >> 16;
+    if ((it->highbits >> 16) != hb) {
+        // Skip the keys smaller than `hb` without merging them.
+        for (size_t i = 0; i < it->number; i++) {
+            const roaring_array_t *ra = &it->inputs[i]->high_low_container;
+            if (it->indexes[i] < ra->size && ra->keys[it->indexes[i]] < hb) {
+                it->indexes[i] = ra_advance_until(ra, hb, it->indexes[i]);
+            }
+        }
+        if (!many_iterator_load_next(it) || (it->highbits >> 16) != hb) {
+            return it->has_value;
+        }
+    }
+    uint16_t low16 = (uint16_t)it->current_value;
+    if (container_iterator_lower_bound(it->container, it->typecode,
+                                       &it->container_it, &low16,
+                                       val & 0xFFFF)) {
+        it->current_value = it->highbits | low16;
+        return true;
+    }
+    return many_iterator_load_next(it);
+}
+
+uint32_t roaring_many_iterator_read(roaring_many_iterator_t *it, uint32_t *buf,
+                                    uint32_t count) {
+    uint32_t ret = 0;
+    while (it->has_value && ret < count) {
+        uint32_t consumed;
+        uint16_t low16 = (uint16_t)it->current_value;
+        bool has_value = container_iterator_read_into_uint32(
+            it->container, it->typecode, &it->container_it, it->highbits, buf,
+            count - ret, &consumed, &low16);
+        ret += consumed;
+        buf += consumed;
+        if (has_value) {
+            it->current_value = it->highbits | low16;
+            assert(ret == count);
+            return ret;
+        }
+        many_iterator_load_next(it);
+    }
+    return ret;
+}
+
+/****
+ * end of roaring_many_iterator_t
+ *****/
+
+/****
+ * begin roaring_range_iterator_t
+ *****/
+
+typedef struct roaring_range_iterator_s {
+    const roaring_bitmap_t *parent;
+    const container_t *container;  // Current container
+    uint8_t typecode;
+    int32_t container_index;
+    uint32_t highbits;
+    roaring_container_iterator_t container_it;
+    uint16_t container_value;  // Next value of the container not yet read
+    bool container_has_value;
+
+    uint32_t start;
+    uint32_t end;
+    bool has_value;
+} roaring_range_iterator_t;
+
+static void range_iterator_load_container(roaring_range_iterator_t *it,
+                                          int32_t index) {
+    const roaring_array_t *ra = &it->parent->high_low_container;
+    it->container_index = index;
+    it->typecode = ra->typecodes[index];
+    it->container =
+        container_unwrap_shared(ra->containers[index], &it->typecode);
+    it->highbits = ((uint32_t)ra->keys[index]) << 16;
+    it->container_it = container_init_iterator(it->container, it->typecode,
+                                               &it->container_value);
+    it->container_has_value = true;
+}
+
+static bool range_iterator_next(roaring_range_iterator_t *it) {
+    const roaring_array_t *ra = &it->parent->high_low_container;
+    while (!it->container_has_value) {
+        if (it->container_index + 1 >= ra->size) {
+            return (it->has_value = false);
+        }
+        range_iterator_load_container(it, it->container_index + 1);
+    }
+    uint16_t range_end;
+    it->start = it->highbits | it->container_value;
+    it->container_has_value = container_iterator_read_range(
+        it->container, it->typecode, &it->container_it, &it->container_value,
+        &range_end);
+    it->end = it->highbits | range_end;
+    // Extend the range into the following containers while it is contiguous.
+    while (!it->container_has_value && range_end == UINT16_MAX &&
+           it->container_index + 1 < ra->size &&
+           ra->keys[it->container_index + 1] == (it->highbits >> 16) + 1) {
+        range_iterator_load_container(it, it->container_index + 1);
+        if (it->container_value != 0) {
+            break;
+        }
+        it->container_has_value = container_iterator_read_range(
+            it->container, it->typecode, &it->container_it,
+            &it->container_value, &range_end);
+        it->end = it->highbits | range_end;
+    }
+    return (it->has_value = true);
+}
+
+static void range_iterator_init(const roaring_bitmap_t *r,
+                                roaring_range_iterator_t *it) {
+    it->parent = r;
+    it->container_index = -1;
+    it->container_has_value = false;
+    range_iterator_next(it);
+}
+
+roaring_range_iterator_t *roaring_range_iterator_create(
+    const roaring_bitmap_t *r) {
+    roaring_range_iterator_t *it = (roaring_range_iterator_t *)roaring_malloc(
+        sizeof(roaring_range_iterator_t));
+    if (it == NULL) return NULL;
+    range_iterator_init(r, it);
+    return it;
+}
+
+void roaring_range_iterator_free(roaring_range_iterator_t *it) {
+    roaring_free(it);
+}
+
+bool roaring_range_iterator_has_value(const roaring_range_iterator_t *it) {
+    return it->has_value;
+}
+
+uint32_t roaring_range_iterator_start(const roaring_range_iterator_t *it) {
+    return it->start;
+}
+
+uint32_t roaring_range_iterator_end(const roaring_range_iterator_t *it) {
+    return it->end;
+}
+
+bool roaring_range_iterator_advance(roaring_range_iterator_t *it) {
+    if (!it->has_value) {
+        return false;
+    }
+    return range_iterator_next(it);
+}
+
+size_t roaring_bitmap_to_ranges(const roaring_bitmap_t *r, uint32_t *out,
+                                size_t capacity) {
+    roaring_range_iterator_t it;
+    size_t count = 0;
+    for (range_iterator_init(r, &it); it.has_value; range_iterator_next(&it)) {
+        if (count < capacity) {
+            out[2 * count] = it.start;
+            out[2 * count + 1] = it.end;
+        }
+        count++;
+    }
+    return count;
+}
+
+/****
+ * end of roaring_range_iterator_t
+ *****/
+
 bool roaring_bitmap_equals(const roaring_bitmap_t *r1,
                            const roaring_bitmap_t *r2) {
     const roaring_array_t *ra1 = &r1->high_low_container;
@@ -1918,6 +2787,15 @@ bool roaring_bitmap_is_subset(const roaring_bitmap_t *r1,
         return false;
 }
 
+// container_range_of_ones, but full ranges get the full container singleton
+static inline container_t *range_of_ones(uint32_t range_start,
+                                         uint32_t range_end, uint8_t *type) {
+    if (range_start == 0 && range_end == (1 << 16)) {
+        return container_get_full_singleton(type);
+    }
+    return container_range_of_ones(range_start, range_end, type);
+}
+
 static void insert_flipped_container(roaring_array_t *ans_arr,
                                      const roaring_array_t *x1_arr, uint16_t hb,
                                      uint16_t lb_start, uint16_t lb_end) {
@@ -1931,6 +2809,8 @@ static void insert_flipped_container(roaring_array_t *ans_arr,
         flipped_container =
             container_not_range(container_to_flip, ctype_in, (uint32_t)lb_start,
                                 (uint32_t)(lb_end + 1), &ctype_out);
+        flipped_container = container_share_if_full(flipped_container,
+                                                    &ctype_out);
 
         if (container_get_cardinality(flipped_container, ctype_out))
             ra_insert_new_key_value_at(ans_arr, -j - 1, hb, flipped_container,
@@ -1939,8 +2819,8 @@ static void insert_flipped_container(roaring_array_t *ans_arr,
             container_free(flipped_container, ctype_out);
         }
     } else {
-        flipped_container = container_range_of_ones(
-            (uint32_t)lb_start, (uint32_t)(lb_end + 1), &ctype_out);
+        flipped_container = range_of_ones((uint32_t)lb_start,
+                                          (uint32_t)(lb_end + 1), &ctype_out);
         ra_insert_new_key_value_at(ans_arr, -j - 1, hb, flipped_container,
                                    ctype_out);
     }
@@ -1957,6 +2837,8 @@ static void inplace_flip_container(roaring_array_t *x1_arr, uint16_t hb,
         flipped_container = container_inot_range(
             container_to_flip, ctype_in, (uint32_t)lb_start,
             (uint32_t)(lb_end + 1), &ctype_out);
+        flipped_container = container_share_if_full(flipped_container,
+                                                    &ctype_out);
         // if a new container was created, the old one was already freed
         if (container_get_cardinality(flipped_container, ctype_out)) {
             ra_set_container_at_index(x1_arr, i, flipped_container, ctype_out);
@@ -1966,8 +2848,8 @@ static void inplace_flip_container(roaring_array_t *x1_arr, uint16_t hb,
         }
 
     } else {
-        flipped_container = container_range_of_ones(
-            (uint32_t)lb_start, (uint32_t)(lb_end + 1), &ctype_out);
+        flipped_container = range_of_ones((uint32_t)lb_start,
+                                          (uint32_t)(lb_end + 1), &ctype_out);
         ra_insert_new_key_value_at(x1_arr, -i - 1, hb, flipped_container,
                                    ctype_out);
     }
@@ -1992,7 +2874,7 @@ static void insert_fully_flipped_container(roaring_array_t *ans_arr,
             container_free(flipped_container, ctype_out);
         }
     } else {
-        flipped_container = container_range_of_ones(0U, 0x10000U, &ctype_out);
+        flipped_container = container_get_full_singleton(&ctype_out);
         ra_insert_new_key_value_at(ans_arr, -j - 1, hb, flipped_container,
                                    ctype_out);
     }
@@ -2016,7 +2898,7 @@ static void inplace_fully_flip_container(roaring_array_t *x1_arr, uint16_t hb) {
         }
 
     } else {
-        flipped_container = container_range_of_ones(0U, 0x10000U, &ctype_out);
+        flipped_container = container_get_full_singleton(&ctype_out);
         ra_insert_new_key_value_at(x1_arr, -i - 1, hb, flipped_container,
                                    ctype_out);
     }
@@ -2212,6 +3094,9 @@ roaring_bitmap_t *roaring_bitmap_add_offset(const roaring_bitmap_t *bm,
         c = container_unwrap_shared(c, &t);
 
         container_add_offset(c, t, lo_ptr, hi_ptr, in_offset);
+        if (t == PACKED_CONTAINER_TYPE) {
+            t = ARRAY_CONTAINER_TYPE;  // packed containers shift as arrays
+        }
         if (lo != NULL) {
             offset_append_with_merge(ans_ra, (int)k, lo, t);
         }
@@ -2254,9 +3139,13 @@ roaring_bitmap_t *roaring_bitmap_lazy_or(const roaring_bitmap_t *x1,
             container_t *c2 = ra_get_container_at_index(&x2->high_low_container,
                                                         (uint16_t)pos2, &type2);
             container_t *c;
-            if (bitsetconversion &&
-                (get_container_type(c1, type1) != BITSET_CONTAINER_TYPE) &&
-                (get_container_type(c2, type2) != BITSET_CONTAINER_TYPE)) {
+            if (container_is_full(c1, type1) || container_is_full(c2, type2)) {
+                c = container_get_full_singleton(&result_type);
+            } else if (bitsetconversion &&
+                       (get_container_type(c1, type1) !=
+                        BITSET_CONTAINER_TYPE) &&
+                       (get_container_type(c2, type2) !=
+                        BITSET_CONTAINER_TYPE)) {
                 container_t *newc1 =
                     container_mutable_unwrap_shared(c1, &type1);
                 newc1 = container_to_bitset(newc1, type1);
@@ -2340,7 +3229,16 @@ void roaring_bitmap_lazy_or_inplace(roaring_bitmap_t *x1,
         if (s1 == s2) {
             container_t *c1 = ra_get_container_at_index(&x1->high_low_container,
                                                         (uint16_t)pos1, &type1);
-            if (!container_is_full(c1, type1)) {
+            container_t *c2 = ra_get_container_at_index(&x2->high_low_container,
+                                                        (uint16_t)pos2, &type2);
+            if (container_is_full(c2, type2)) {
+                if (!container_is_full_singleton(c1)) {
+                    container_free(c1, type1);
+                    c1 = container_get_full_singleton(&type1);
+                    ra_set_container_at_index(&x1->high_low_container, pos1,
+                                              c1, type1);
+                }
+            } else if (!container_is_full(c1, type1)) {
                 if ((bitsetconversion == false) ||
                     (get_container_type(c1, type1) == BITSET_CONTAINER_TYPE)) {
                     c1 = get_writable_copy_if_shared(c1, &type1);
@@ -2354,8 +3252,6 @@ void roaring_bitmap_lazy_or_inplace(roaring_bitmap_t *x1,
                     type1 = BITSET_CONTAINER_TYPE;
                 }
 
-                container_t *c2 = ra_get_container_at_index(
-                    &x2->high_low_container, (uint16_t)pos2, &type2);
                 container_t *c =
                     container_lazy_ior(c1, type1, c2, type2, &result_type);
 
@@ -2572,6 +3468,7 @@ void roaring_bitmap_repair_after_lazy(roaring_bitmap_t *r) {
         container_t *old_c = ra->containers[i];
         uint8_t new_type = old_type;
         container_t *new_c = container_repair_after_lazy(old_c, &new_type);
+        new_c = container_share_if_full(new_c, &new_type);
         ra->containers[i] = new_c;
         ra->typecodes[i] = new_type;
     }
@@ -2715,33 +3612,22 @@ bool roaring_bitmap_select(const roaring_bitmap_t *bm, uint32_t rank,
 
 bool roaring_bitmap_intersect(const roaring_bitmap_t *x1,
                               const roaring_bitmap_t *x2) {
-    const int length1 = x1->high_low_container.size,
-              length2 = x2->high_low_container.size;
-    uint64_t answer = 0;
-    int pos1 = 0, pos2 = 0;
-
-    while (pos1 < length1 && pos2 < length2) {
-        const uint16_t s1 =
-            ra_get_key_at_index(&x1->high_low_container, (uint16_t)pos1);
-        const uint16_t s2 =
-            ra_get_key_at_index(&x2->high_low_container, (uint16_t)pos2);
-
-        if (s1 == s2) {
+    int32_t pos1 = 0, pos2 = 0;
+    uint16_t index1[KEY_MATCH_BATCH], index2[KEY_MATCH_BATCH];
+    int32_t matched;
+    while ((matched = ra_intersect_keys(&x1->high_low_container, &pos1,
+                                        &x2->high_low_container, &pos2, index1,
+                                        index2, KEY_MATCH_BATCH)) > 0) {
+        for (int32_t i = 0; i < matched; i++) {
             uint8_t type1, type2;
-            container_t *c1 = ra_get_container_at_index(&x1->high_low_container,
-                                                        (uint16_t)pos1, &type1);
-            container_t *c2 = ra_get_container_at_index(&x2->high_low_container,
-                                                        (uint16_t)pos2, &type2);
+            container_t *c1 = ra_get_container_at_index(
+                &x1->high_low_container, index1[i], &type1);
+            container_t *c2 = ra_get_container_at_index(
+                &x2->high_low_container, index2[i], &type2);
             if (container_intersect(c1, type1, c2, type2)) return true;
-            ++pos1;
-            ++pos2;
-        } else if (s1 < s2) {  // s1 < s2
-            pos1 = ra_advance_until(&x1->high_low_container, s2, pos1);
-        } else {  // s1 > s2
-            pos2 = ra_advance_until(&x2->high_low_container, s1, pos2);
         }
     }
-    return answer != 0;
+    return false;
 }
 
 bool roaring_bitmap_intersect_with_range(const roaring_bitmap_t *bm, uint64_t x,
@@ -2765,29 +3651,20 @@ bool roaring_bitmap_intersect_with_range(const roaring_bitmap_t *bm, uint64_t x,
 
 uint64_t roaring_bitmap_and_cardinality(const roaring_bitmap_t *x1,
                                         const roaring_bitmap_t *x2) {
-    const int length1 = x1->high_low_container.size,
-              length2 = x2->high_low_container.size;
     uint64_t answer = 0;
-    int pos1 = 0, pos2 = 0;
-    while (pos1 < length1 && pos2 < length2) {
-        const uint16_t s1 =
-            ra_get_key_at_index(&x1->high_low_container, (uint16_t)pos1);
-        const uint16_t s2 =
-            ra_get_key_at_index(&x2->high_low_container, (uint16_t)pos2);
-
-        if (s1 == s2) {
+    int32_t pos1 = 0, pos2 = 0;
+    uint16_t index1[KEY_MATCH_BATCH], index2[KEY_MATCH_BATCH];
+    int32_t matched;
+    while ((matched = ra_intersect_keys(&x1->high_low_container, &pos1,
+                                        &x2->high_low_container, &pos2, index1,
+                                        index2, KEY_MATCH_BATCH)) > 0) {
+        for (int32_t i = 0; i < matched; i++) {
             uint8_t type1, type2;
-            container_t *c1 = ra_get_container_at_index(&x1->high_low_container,
-                                                        (uint16_t)pos1, &type1);
-            container_t *c2 = ra_get_container_at_index(&x2->high_low_container,
-                                                        (uint16_t)pos2, &type2);
+            container_t *c1 = ra_get_container_at_index(
+                &x1->high_low_container, index1[i], &type1);
+            container_t *c2 = ra_get_container_at_index(
+                &x2->high_low_container, index2[i], &type2);
             answer += container_and_cardinality(c1, type1, c2, type2);
-            ++pos1;
-            ++pos2;
-        } else if (s1 < s2) {  // s1 < s2
-            pos1 = ra_advance_until(&x1->high_low_container, s2, pos1);
-        } else {  // s1 > s2
-            pos2 = ra_advance_until(&x2->high_low_container, s1, pos2);
         }
     }
     return answer;
@@ -2826,6 +3703,7 @@ uint64_t roaring_bitmap_xor_cardinality(const roaring_bitmap_t *x1,
 
 bool roaring_bitmap_contains(const roaring_bitmap_t *r, uint32_t val) {
     const uint16_t hb = val >> 16;
+    if (!ra_may_contain_key(&r->high_low_container, hb)) return false;
     /*
      * the next function call involves a binary search and lots of branching.
      */
@@ -2930,22 +3808,29 @@ size_t roaring_bitmap_frozen_size_in_bytes(const roaring_bitmap_t *rb) {
     const roaring_array_t *ra = &rb->high_low_container;
     size_t num_bytes = 0;
     for (int32_t i = 0; i < ra->size; i++) {
-        switch (ra->typecodes[i]) {
+        uint8_t type = ra->typecodes[i];
+        const container_t *c =
+            container_unwrap_shared(ra->containers[i], &type);
+        switch (type) {
             case BITSET_CONTAINER_TYPE: {
                 num_bytes += BITSET_CONTAINER_SIZE_IN_WORDS * sizeof(uint64_t);
                 break;
             }
             case RUN_CONTAINER_TYPE: {
-                const run_container_t *rc = const_CAST_run(ra->containers[i]);
+                const run_container_t *rc = const_CAST_run(c);
                 num_bytes += rc->n_runs * sizeof(rle16_t);
                 break;
             }
             case ARRAY_CONTAINER_TYPE: {
-                const array_container_t *ac =
-                    const_CAST_array(ra->containers[i]);
+                const array_container_t *ac = const_CAST_array(c);
                 num_bytes += ac->cardinality * sizeof(uint16_t);
                 break;
             }
+            case PACKED_CONTAINER_TYPE: {  // frozen as an array
+                const packed_container_t *pc = const_CAST_packed(c);
+                num_bytes += pc->cardinality * sizeof(uint16_t);
+                break;
+            }
             default:
                 roaring_unreachable;
         }
@@ -2973,23 +3858,30 @@ void roaring_bitmap_frozen_serialize(const roaring_bitmap_t *rb, char *buf) {
     size_t run_zone_size = 0;
     size_t array_zone_size = 0;
     for (int32_t i = 0; i < ra->size; i++) {
-        switch (ra->typecodes[i]) {
+        uint8_t type = ra->typecodes[i];
+        const container_t *c =
+            container_unwrap_shared(ra->containers[i], &type);
+        switch (type) {
             case BITSET_CONTAINER_TYPE: {
                 bitset_zone_size +=
                     BITSET_CONTAINER_SIZE_IN_WORDS * sizeof(uint64_t);
                 break;
             }
             case RUN_CONTAINER_TYPE: {
-                const run_container_t *rc = const_CAST_run(ra->containers[i]);
+                const run_container_t *rc = const_CAST_run(c);
                 run_zone_size += rc->n_runs * sizeof(rle16_t);
                 break;
             }
             case ARRAY_CONTAINER_TYPE: {
-                const array_container_t *ac =
-                    const_CAST_array(ra->containers[i]);
+                const array_container_t *ac = const_CAST_array(c);
                 array_zone_size += ac->cardinality * sizeof(uint16_t);
                 break;
             }
+            case PACKED_CONTAINER_TYPE: {
+                const packed_container_t *pc = const_CAST_packed(c);
+                array_zone_size += pc->cardinality * sizeof(uint16_t);
+                break;
+            }
             default:
                 roaring_unreachable;
         }
@@ -3005,10 +3897,12 @@ void roaring_bitmap_frozen_serialize(const roaring_bitmap_t *rb, char *buf) {
 
     for (int32_t i = 0; i < ra->size; i++) {
         uint16_t count;
-        switch (ra->typecodes[i]) {
+        uint8_t type = ra->typecodes[i];
+        const container_t *c =
+            container_unwrap_shared(ra->containers[i], &type);
+        switch (type) {
             case BITSET_CONTAINER_TYPE: {
-                const bitset_container_t *bc =
-                    const_CAST_bitset(ra->containers[i]);
+                const bitset_container_t *bc = const_CAST_bitset(c);
                 memcpy(bitset_zone, bc->words,
                        BITSET_CONTAINER_SIZE_IN_WORDS * sizeof(uint64_t));
                 bitset_zone += BITSET_CONTAINER_SIZE_IN_WORDS;
@@ -3022,7 +3916,7 @@ void roaring_bitmap_frozen_serialize(const roaring_bitmap_t *rb, char *buf) {
                 break;
             }
             case RUN_CONTAINER_TYPE: {
-                const run_container_t *rc = const_CAST_run(ra->containers[i]);
+                const run_container_t *rc = const_CAST_run(c);
                 size_t num_bytes = rc->n_runs * sizeof(rle16_t);
                 memcpy(run_zone, rc->runs, num_bytes);
                 run_zone += rc->n_runs;
@@ -3030,21 +3924,31 @@ void roaring_bitmap_frozen_serialize(const roaring_bitmap_t *rb, char *buf) {
                 break;
             }
             case ARRAY_CONTAINER_TYPE: {
-                const array_container_t *ac =
-                    const_CAST_array(ra->containers[i]);
+                const array_container_t *ac = const_CAST_array(c);
                 size_t num_bytes = ac->cardinality * sizeof(uint16_t);
                 memcpy(array_zone, ac->array, num_bytes);
                 array_zone += ac->cardinality;
                 count = (uint16_t)(ac->cardinality - 1);
                 break;
             }
+            case PACKED_CONTAINER_TYPE: {
+                // frozen views must point into the buffer, so decode
+                const packed_container_t *pc = const_CAST_packed(c);
+                uint16_t values[DEFAULT_MAX_SIZE];
+                packed_container_decode(pc, values);
+                memcpy(array_zone, values, pc->cardinality * sizeof(uint16_t));
+                array_zone += pc->cardinality;
+                count = (uint16_t)(pc->cardinality - 1);
+                type = ARRAY_CONTAINER_TYPE;
+                break;
+            }
             default:
                 roaring_unreachable;
         }
+        typecode_zone[i] = type;
         memcpy(&count_zone[i], &count, 2);
     }
     memcpy(key_zone, ra->keys, ra->size * sizeof(uint16_t));
-    memcpy(typecode_zone, ra->typecodes, ra->size * sizeof(uint8_t));
     uint32_t header = ((uint32_t)ra->size << 15) | FROZEN_COOKIE;
     memcpy(header_zone, &header, 4);
 }
@@ -3123,6 +4027,7 @@ const roaring_bitmap_t *roaring_bitmap_frozen_view(const char *buf,
     roaring_bitmap_t *rb =
         (roaring_bitmap_t *)arena_alloc(&arena, sizeof(roaring_bitmap_t));
     rb->high_low_container.flags = ROARING_FLAG_FROZEN;
+    rb->high_low_container.key_summary = NULL;
     rb->high_low_container.allocation_size = num_containers;
     rb->high_low_container.size = num_containers;
     rb->high_low_container.keys = (uint16_t *)keys;
@@ -3154,6 +4059,8 @@ const roaring_bitmap_t *roaring_bitmap_frozen_view(const char *buf,
                 run->capacity = counts[i];
                 run->n_runs = counts[i];
                 run->runs = run_zone;
+                // the frozen format does not record the cardinality of runs
+                run->cardinality = run_container_compute_cardinality(run);
                 rb->high_low_container.containers[i] = run;
                 run_zone += run->n_runs;
                 break;
@@ -3258,6 +4165,7 @@ roaring_bitmap_t *roaring_bitmap_portable_deserialize_frozen(const char *buf) {
     roaring_bitmap_t *rb =
         (roaring_bitmap_t *)arena_alloc(&arena, sizeof(roaring_bitmap_t));
     rb->high_low_container.flags = ROARING_FLAG_FROZEN;
+    rb->high_low_container.key_summary = NULL;
     rb->high_low_container.allocation_size = num_containers;
     rb->high_low_container.size = num_containers;
     rb->high_low_container.containers = (container_t **)arena_alloc(
@@ -3303,6 +4211,7 @@ roaring_bitmap_t *roaring_bitmap_portable_deserialize_frozen(const char *buf) {
             run_container_t *c =
                 (run_container_t *)arena_alloc(&arena, sizeof(run_container_t));
             c->capacity = cardinality;
+            c->cardinality = cardinality;
             uint16_t n_runs;
             if (offset_headers != NULL) {
                 memcpy(&n_runs, start_of_buf + offset_headers[i],
@@ -3372,6 +4281,15 @@ bool roaring_bitmap_to_bitset(const roaring_bitmap_t *r, bitset_t *bitset) {
                     bitset_set_lenrange(words, rle.value, rle.length);
                 }
             } break;
+            case PACKED_CONTAINER_TYPE: {
+                const packed_container_t *src = const_CAST_packed(c);
+                uint16_t values[PACKED_BLOCK_SIZE];
+                for (int32_t block = 0; block < src->n_blocks; ++block) {
+                    int32_t length =
+                        packed_container_decode_block(src, block, values);
+                    bitset_set_list(words, values, length);
+                }
+            } break;
             default:
                 roaring_unreachable;
         }
@@ -3379,6 +4297,168 @@ bool roaring_bitmap_to_bitset(const roaring_bitmap_t *r, bitset_t *bitset) {
     return true;
 }
 
+roaring_bitmap_t *roaring_bitmap_from_bitset(const bitset_t *bitset) {
+    // 2^26 words hold 2^32 bits; anything past them cannot be represented
+    size_t words = bitset->arraysize;
+    if (words > ((size_t)1 << 26)) words = (size_t)1 << 26;
+    roaring_bitmap_t *answer = roaring_bitmap_create();
+    if (answer == NULL) return NULL;
+    // The chunk is staged in a bitset container, which gives us dispatched
+    // popcounts and extraction; the container is only handed over to the
+    // answer when the chunk stays a bitset.
+    bitset_container_t *bc = NULL;
+    for (size_t start = 0; start < words; start += 1024) {
+        size_t n = words - start < 1024 ? words - start : 1024;
+        if (bc == NULL) {
+            bc = bitset_container_create();
+            if (bc == NULL) {
+                roaring_bitmap_free(answer);
+                return NULL;
+            }
+        }
+        memcpy(bc->words, bitset->array + start, n * sizeof(uint64_t));
+        if (n < 1024) {
+            memset(bc->words + n, 0, (1024 - n) * sizeof(uint64_t));
+        }
+        bc->cardinality = bitset_container_compute_cardinality(bc);
+        if (bc->cardinality == 0) continue;
+        uint8_t type;
+        container_t *c;
+        if (bc->cardinality <= DEFAULT_MAX_SIZE) {
+            array_container_t *ac = array_container_from_bitset(bc);
+            if (ac == NULL) {
+                bitset_container_free(bc);
+                roaring_bitmap_free(answer);
+                return NULL;
+            }
+            c = convert_run_optimize(ac, ARRAY_CONTAINER_TYPE, &type);
+        } else {
+            c = convert_run_optimize(bc, BITSET_CONTAINER_TYPE, &type);
+            bc = NULL;  // either kept by the answer or freed
+        }
+        ra_append(&answer->high_low_container, (uint16_t)(start >> 10), c,
+                  type);
+    }
+    if (bc != NULL) bitset_container_free(bc);
+    return answer;
+}
+
+/* ORs bits [begin, end) of a bitset container's words into out, starting at
+ * bit position dest. */
+static void dense_or_bits(uint64_t *out, uint64_t dest, const uint64_t *words,
+                          uint32_t begin, uint32_t end) {
+    if ((dest & 63) == 0 && (begin & 63) == 0) {
+        size_t full = (end - begin) / 64;
+        memcpy(out + dest / 64, words + begin / 64, full * sizeof(uint64_t));
+        begin += (uint32_t)full * 64;
+        dest += full * 64;
+    }
+    while (begin < end) {
+        uint32_t shift = begin & 63;
+        uint64_t v = words[begin / 64] >> shift;
+        if (shift != 0 && begin / 64 + 1 < BITSET_CONTAINER_SIZE_IN_WORDS) {
+            v |= words[begin / 64 + 1] << (64 - shift);
+        }
+        uint32_t len = end - begin < 64 ? end - begin : 64;
+        if (len < 64) v &= (UINT64_C(1) << len) - 1;
+        uint32_t dshift = dest & 63;
+        out[dest / 64] |= v << dshift;
+        if (dshift != 0 && dshift + len > 64) {
+            out[dest / 64 + 1] |= v >> (64 - dshift);
+        }
+        begin += len;
+        dest += len;
+    }
+}
+
+/* Sets bits [begin, end) of out. */
+static void dense_set_range(uint64_t *out, uint64_t begin, uint64_t end) {
+    if (begin == end) return;
+    uint64_t firstword = begin / 64;
+    uint64_t endword = (end - 1) / 64;
+    if (firstword == endword) {
+        out[firstword] |= ((~UINT64_C(0)) << (begin % 64)) &
+                          ((~UINT64_C(0)) >> ((~end + 1) % 64));
+        return;
+    }
+    out[firstword] |= (~UINT64_C(0)) << (begin % 64);
+    for (uint64_t i = firstword + 1; i < endword; i++) {
+        out[i] = ~UINT64_C(0);
+    }
+    out[endword] |= (~UINT64_C(0)) >> ((~end + 1) % 64);
+}
+
+void roaring_bitmap_to_dense(const roaring_bitmap_t *r, uint64_t lo,
+                             uint64_t hi, uint64_t *out) {
+    if (hi > UINT64_C(0x100000000)) hi = UINT64_C(0x100000000);
+    if (lo >= hi) return;
+    memset(out, 0, (size_t)((hi - lo + 63) / 64) * sizeof(uint64_t));
+    const roaring_array_t *ra = &r->high_low_container;
+    int32_t i = ra_get_index(ra, (uint16_t)(lo >> 16));
+    if (i < 0) i = -i - 1;
+    for (; i < ra->size; ++i) {
+        uint64_t base = (uint64_t)ra->keys[i] << 16;
+        if (base >= hi) break;
+        // the part of the window inside this container, as [cmin, cmax)
+        uint32_t cmin = lo > base ? (uint32_t)(lo - base) : 0;
+        uint32_t cmax = hi - base < (1 << 16) ? (uint32_t)(hi - base) : 1 << 16;
+        uint8_t type = ra->typecodes[i];
+        const container_t *c = ra->containers[i];
+        if (type == SHARED_CONTAINER_TYPE) {
+            c = container_unwrap_shared(c, &type);
+        }
+        switch (type) {
+            case BITSET_CONTAINER_TYPE:
+                dense_or_bits(out, base + cmin - lo,
+                              const_CAST_bitset(c)->words, cmin, cmax);
+                break;
+            case ARRAY_CONTAINER_TYPE: {
+                const array_container_t *ac = const_CAST_array(c);
+                int32_t j = array_container_index_equalorlarger(
+                    ac, (uint16_t)cmin);
+                if (j < 0) break;
+                for (; j < ac->cardinality && ac->array[j] < cmax; j++) {
+                    uint64_t bit = base + ac->array[j] - lo;
+                    out[bit / 64] |= UINT64_C(1) << (bit % 64);
+                }
+            } break;
+            case RUN_CONTAINER_TYPE: {
+                const run_container_t *rc = const_CAST_run(c);
+                for (int32_t j = 0; j < rc->n_runs; j++) {
+                    uint32_t start = rc->runs[j].value;
+                    uint32_t end = start + rc->runs[j].length + 1;
+                    if (end <= cmin) continue;
+                    if (start >= cmax) break;
+                    if (start < cmin) start = cmin;
+                    if (end > cmax) end = cmax;
+                    dense_set_range(out, base + start - lo, base + end - lo);
+                }
+            } break;
+            case PACKED_CONTAINER_TYPE: {
+                const packed_container_t *pc = const_CAST_packed(c);
+                int32_t j = packed_container_index_equalorlarger(
+                    pc, (uint16_t)cmin);
+                if (j < 0) break;
+                uint16_t values[PACKED_BLOCK_SIZE];
+                for (int32_t block = j / PACKED_BLOCK_SIZE;
+                     block < pc->n_blocks &&
+                     packed_container_firsts(pc)[block] < cmax;
+                     block++) {
+                    int32_t length =
+                        packed_container_decode_block(pc, block, values);
+                    for (int32_t k = 0; k < length && values[k] < cmax; k++) {
+                        if (values[k] < cmin) continue;
+                        uint64_t bit = base + values[k] - lo;
+                        out[bit / 64] |= UINT64_C(1) << (bit % 64);
+                    }
+                }
+            } break;
+            default:
+                roaring_unreachable;
+        }
+    }
+}
+
 #ifdef __cplusplus
 }
 }
@@ -26,6 +26,7 @@ namespace api {
 
 typedef struct roaring64_bitmap_s {
     art_t art;
+    art_slab_t leaf_slab;
     uint8_t flags;
 } roaring64_bitmap_t;
 
@@ -77,15 +78,22 @@ static inline uint64_t minimum(uint64_t a, uint64_t b) {
     return (a < b) ? a : b;
 }
 
-static inline leaf_t *create_leaf(container_t *container, uint8_t typecode) {
-    leaf_t *leaf = (leaf_t *)roaring_malloc(sizeof(leaf_t));
+// Leaves are allocated from the slab allocator of the bitmap holding them.
+static inline leaf_t *alloc_leaf(roaring64_bitmap_t *r) {
+    return (leaf_t *)art_slab_alloc(&r->leaf_slab, sizeof(leaf_t));
+}
+
+static inline leaf_t *create_leaf(roaring64_bitmap_t *r, container_t *container,
+                                  uint8_t typecode) {
+    leaf_t *leaf = alloc_leaf(r);
     leaf->container = container;
     leaf->typecode = typecode;
     return leaf;
 }
 
-static inline leaf_t *copy_leaf_container(const leaf_t *leaf) {
-    leaf_t *result_leaf = (leaf_t *)roaring_malloc(sizeof(leaf_t));
+static inline leaf_t *copy_leaf_container(roaring64_bitmap_t *r,
+                                          const leaf_t *leaf) {
+    leaf_t *result_leaf = alloc_leaf(r);
     result_leaf->typecode = leaf->typecode;
     // get_copy_of_container modifies the typecode passed in.
     result_leaf->container = get_copy_of_container(
@@ -93,7 +101,19 @@ static inline leaf_t *copy_leaf_container(const leaf_t *leaf) {
     return result_leaf;
 }
 
-static inline void free_leaf(leaf_t *leaf) { roaring_free(leaf); }
+// Freed leaves have no container, see roaring64_bitmap_free.
+static inline void free_leaf(roaring64_bitmap_t *r, leaf_t *leaf) {
+    leaf->container = NULL;
+    art_slab_free(&r->leaf_slab, leaf);
+}
+
+static void free_leaf_container(void *object, void *context) {
+    (void)context;
+    leaf_t *leaf = (leaf_t *)object;
+    if (leaf->container != NULL) {
+        container_free(leaf->container, leaf->typecode);
+    }
+}
 
 static inline int compare_high48(art_key_chunk_t key1[],
                                  art_key_chunk_t key2[]) {
@@ -142,25 +162,25 @@ static inline roaring64_iterator_t *roaring64_iterator_init_at(
 roaring64_bitmap_t *roaring64_bitmap_create(void) {
     roaring64_bitmap_t *r =
         (roaring64_bitmap_t *)roaring_malloc(sizeof(roaring64_bitmap_t));
-    r->art.root = NULL;
+    memset(&r->art, 0, sizeof(art_t));
+    memset(&r->leaf_slab, 0, sizeof(art_slab_t));
     r->flags = 0;
     return r;
 }
 
 void roaring64_bitmap_free(roaring64_bitmap_t *r) {
-    art_iterator_t it = art_init_iterator(&r->art, /*first=*/true);
-    while (it.value != NULL) {
-        leaf_t *leaf = (leaf_t *)it.value;
-        container_free(leaf->container, leaf->typecode);
-        free_leaf(leaf);
-        art_iterator_next(&it);
-    }
+    // Visiting the leaves in memory order is faster than walking the ART. The
+    // leaves and the nodes are then released with their slabs.
+    art_slab_iterate(&r->leaf_slab, sizeof(leaf_t), free_leaf_container, NULL);
+    art_slab_release(&r->leaf_slab);
     art_free(&r->art);
     roaring_free(r);
 }
 
 roaring64_bitmap_t *roaring64_bitmap_copy(const roaring64_bitmap_t *r) {
     roaring64_bitmap_t *result = roaring64_bitmap_create();
+    art_builder_t builder;
+    art_builder_init(&builder, &result->art);
 
     art_iterator_t it = art_init_iterator(&r->art, /*first=*/true);
     while (it.value != NULL) {
@@ -168,10 +188,12 @@ roaring64_bitmap_t *roaring64_bitmap_copy(const roaring64_bitmap_t *r) {
         uint8_t result_typecode = leaf->typecode;
         container_t *result_container = get_copy_of_container(
             leaf->container, &result_typecode, /*copy_on_write=*/false);
-        leaf_t *result_leaf = create_leaf(result_container, result_typecode);
-        art_insert(&result->art, it.key, (art_val_t *)result_leaf);
+        leaf_t *result_leaf =
+            create_leaf(result, result_container, result_typecode);
+        art_builder_append(&builder, it.key, (art_val_t *)result_leaf);
         art_iterator_next(&it);
     }
+    art_builder_finish(&builder);
     return result;
 }
 
@@ -202,7 +224,7 @@ roaring64_bitmap_t *roaring64_bitmap_from_range(uint64_t min, uint64_t max,
 
         uint8_t high48[ART_KEY_BYTES];
         split_key(min, high48);
-        leaf_t *leaf = create_leaf(container, typecode);
+        leaf_t *leaf = create_leaf(r, container, typecode);
         art_insert(&r->art, high48, (art_val_t *)leaf);
 
         uint64_t gap = container_max - container_min + step - 1;
@@ -255,7 +277,7 @@ static inline leaf_t *containerptr_roaring64_bitmap_add(roaring64_bitmap_t *r,
         container_t *container =
             container_add(ac, low16, ARRAY_CONTAINER_TYPE, &typecode);
         assert(ac == container);
-        leaf = create_leaf(container, typecode);
+        leaf = create_leaf(r, container, typecode);
         art_insert(&r->art, high48, (art_val_t *)leaf);
         return leaf;
     }
@@ -311,11 +333,83 @@ void roaring64_bitmap_add_bulk(roaring64_bitmap_t *r,
     }
 }
 
+// Returns a container holding the low 16 bits of the given sorted values,
+// which share their high 48 bits. Duplicate values are allowed.
+static container_t *container_from_sorted_values(const uint64_t *vals,
+                                                 size_t n_vals,
+                                                 uint8_t *typecode) {
+    if (n_vals <= DEFAULT_MAX_SIZE) {
+        array_container_t *ac =
+            array_container_create_given_capacity((int32_t)n_vals);
+        for (size_t i = 0; i < n_vals; ++i) {
+            if (i == 0 || vals[i] != vals[i - 1]) {
+                ac->array[ac->cardinality++] = (uint16_t)vals[i];
+            }
+        }
+        *typecode = ARRAY_CONTAINER_TYPE;
+        return ac;
+    }
+    bitset_container_t *bc = bitset_container_create();
+    for (size_t i = 0; i < n_vals; ++i) {
+        bitset_container_set(bc, (uint16_t)vals[i]);
+    }
+    if (bc->cardinality <= DEFAULT_MAX_SIZE) {  // many duplicates
+        array_container_t *ac = array_container_from_bitset(bc);
+        bitset_container_free(bc);
+        *typecode = ARRAY_CONTAINER_TYPE;
+        return ac;
+    }
+    *typecode = BITSET_CONTAINER_TYPE;
+    return bc;
+}
+
+// Fills the empty bitmap r with the given sorted values. The containers are
+// built from each run of values sharing their high 48 bits, and the ART is
+// then built bottom-up from the leaves.
+static void roaring64_bitmap_bulk_load_sorted(roaring64_bitmap_t *r,
+                                              size_t n_args,
+                                              const uint64_t *vals) {
+    size_t n_leaves = 1;
+    for (size_t i = 1; i < n_args; ++i) {
+        if ((vals[i] >> 16) != (vals[i - 1] >> 16)) {
+            n_leaves++;
+        }
+    }
+    art_val_t **leaves =
+        (art_val_t **)roaring_malloc(n_leaves * sizeof(art_val_t *));
+    size_t start = 0;
+    for (size_t i = 0; i < n_leaves; ++i) {
+        size_t end = start + 1;
+        while (end < n_args && (vals[end] >> 16) == (vals[start] >> 16)) {
+            end++;
+        }
+        uint8_t typecode;
+        container_t *container =
+            container_from_sorted_values(vals + start, end - start, &typecode);
+        leaf_t *leaf = create_leaf(r, container, typecode);
+        split_key(vals[start], leaf->_pad.key);
+        leaves[i] = (art_val_t *)leaf;
+        start = end;
+    }
+    art_bulk_load(&r->art, leaves, n_leaves);
+    roaring_free(leaves);
+}
+
 void roaring64_bitmap_add_many(roaring64_bitmap_t *r, size_t n_args,
                                const uint64_t *vals) {
     if (n_args == 0) {
         return;
     }
+    if (art_is_empty(&r->art)) {
+        size_t sorted = 1;
+        while (sorted < n_args && vals[sorted - 1] <= vals[sorted]) {
+            sorted++;
+        }
+        if (sorted == n_args) {
+            roaring64_bitmap_bulk_load_sorted(r, n_args, vals);
+            return;
+        }
+    }
     const uint64_t *end = vals + n_args;
     roaring64_bulk_context_t context = {0};
     for (const uint64_t *current_val = vals; current_val != end;
@@ -324,9 +418,9 @@ void roaring64_bitmap_add_many(roaring64_bitmap_t *r, size_t n_args,
     }
 }
 
-static inline void add_range_closed_at(art_t *art, uint8_t *high48,
+static inline void add_range_closed_at(roaring64_bitmap_t *r, uint8_t *high48,
                                        uint16_t min, uint16_t max) {
-    leaf_t *leaf = (leaf_t *)art_find(art, high48);
+    leaf_t *leaf = (leaf_t *)art_find(&r->art, high48);
     if (leaf != NULL) {
         uint8_t typecode2;
         container_t *container2 = container_add_range(
@@ -342,8 +436,8 @@ static inline void add_range_closed_at(art_t *art, uint8_t *high48,
     // container_add_range is inclusive, but `container_range_of_ones` is
     // exclusive.
     container_t *container = container_range_of_ones(min, max + 1, &typecode);
-    leaf = create_leaf(container, typecode);
-    art_insert(art, high48, (art_val_t *)leaf);
+    leaf = create_leaf(r, container, typecode);
+    art_insert(&r->art, high48, (art_val_t *)leaf);
 }
 
 void roaring64_bitmap_add_range(roaring64_bitmap_t *r, uint64_t min,
@@ -360,29 +454,28 @@ void roaring64_bitmap_add_range_closed(roaring64_bitmap_t *r, uint64_t min,
         return;
     }
 
-    art_t *art = &r->art;
     uint8_t min_high48[ART_KEY_BYTES];
     uint16_t min_low16 = split_key(min, min_high48);
     uint8_t max_high48[ART_KEY_BYTES];
     uint16_t max_low16 = split_key(max, max_high48);
     if (compare_high48(min_high48, max_high48) == 0) {
         // Only populate range within one container.
-        add_range_closed_at(art, min_high48, min_low16, max_low16);
+        add_range_closed_at(r, min_high48, min_low16, max_low16);
         return;
     }
 
     // Populate a range across containers. Fill intermediate containers
     // entirely.
-    add_range_closed_at(art, min_high48, min_low16, 0xffff);
+    add_range_closed_at(r, min_high48, min_low16, 0xffff);
     uint64_t min_high_bits = min >> 16;
     uint64_t max_high_bits = max >> 16;
     for (uint64_t current = min_high_bits + 1; current < max_high_bits;
          ++current) {
         uint8_t current_high48[ART_KEY_BYTES];
         split_key(current << 16, current_high48);
-        add_range_closed_at(art, current_high48, 0, 0xffff);
+        add_range_closed_at(r, current_high48, 0, 0xffff);
     }
-    add_range_closed_at(art, max_high48, 0, max_low16);
+    add_range_closed_at(r, max_high48, 0, max_low16);
 }
 
 bool roaring64_bitmap_contains(const roaring64_bitmap_t *r, uint64_t val) {
@@ -565,7 +658,7 @@ static inline leaf_t *containerptr_roaring64_bitmap_remove(
         container_free(container2, typecode2);
         leaf = (leaf_t *)art_erase(&r->art, high48);
         if (leaf != NULL) {
-            free_leaf(leaf);
+            free_leaf(r, leaf);
         }
         return NULL;
     }
@@ -622,7 +715,7 @@ void roaring64_bitmap_remove_bulk(roaring64_bitmap_t *r,
         if (!container_nonzero_cardinality(container2, typecode2)) {
             leaf_t *leaf = (leaf_t *)art_erase(art, high48);
             container_free(container2, typecode2);
-            free_leaf(leaf);
+            free_leaf(r, leaf);
         }
     } else {
         // We're not positioned anywhere yet or the high bits of the key
@@ -647,9 +740,10 @@ void roaring64_bitmap_remove_many(roaring64_bitmap_t *r, size_t n_args,
     }
 }
 
-static inline void remove_range_closed_at(art_t *art, uint8_t *high48,
-                                          uint16_t min, uint16_t max) {
-    leaf_t *leaf = (leaf_t *)art_find(art, high48);
+static inline void remove_range_closed_at(roaring64_bitmap_t *r,
+                                          uint8_t *high48, uint16_t min,
+                                          uint16_t max) {
+    leaf_t *leaf = (leaf_t *)art_find(&r->art, high48);
     if (leaf == NULL) {
         return;
     }
@@ -662,8 +756,8 @@ static inline void remove_range_closed_at(art_t *art, uint8_t *high48,
             leaf->container = container2;
             leaf->typecode = typecode2;
         } else {
-            art_erase(art, high48);
-            free_leaf(leaf);
+            art_erase(&r->art, high48);
+            free_leaf(r, leaf);
         }
     }
 }
@@ -689,21 +783,21 @@ void roaring64_bitmap_remove_range_closed(roaring64_bitmap_t *r, uint64_t min,
     uint16_t max_low16 = split_key(max, max_high48);
     if (compare_high48(min_high48, max_high48) == 0) {
         // Only remove a range within one container.
-        remove_range_closed_at(art, min_high48, min_low16, max_low16);
+        remove_range_closed_at(r, min_high48, min_low16, max_low16);
         return;
     }
 
     // Remove a range across containers. Remove intermediate containers
     // entirely.
-    remove_range_closed_at(art, min_high48, min_low16, 0xffff);
+    remove_range_closed_at(r, min_high48, min_low16, 0xffff);
 
     art_iterator_t it = art_upper_bound(art, min_high48);
     while (it.value != NULL && art_compare_keys(it.key, max_high48) < 0) {
         leaf_t *leaf = (leaf_t *)art_iterator_erase(art, &it);
         container_free(leaf->container, leaf->typecode);
-        free_leaf(leaf);
+        free_leaf(r, leaf);
     }
-    remove_range_closed_at(art, max_high48, 0, max_low16);
+    remove_range_closed_at(r, max_high48, 0, max_low16);
 }
 
 uint64_t roaring64_bitmap_get_cardinality(const roaring64_bitmap_t *r) {
@@ -803,6 +897,85 @@ bool roaring64_bitmap_run_optimize(roaring64_bitmap_t *r) {
     return has_run_container;
 }
 
+// Returns the number of bytes allocated for the container.
+static size_t container_allocated_size_in_bytes(const container_t *c,
+                                                uint8_t typecode) {
+    switch (typecode) {
+        case BITSET_CONTAINER_TYPE:
+            return sizeof(bitset_container_t) +
+                   BITSET_CONTAINER_SIZE_IN_WORDS * sizeof(uint64_t);
+        case ARRAY_CONTAINER_TYPE:
+            return sizeof(array_container_t) +
+                   const_CAST_array(c)->capacity * sizeof(uint16_t);
+        case RUN_CONTAINER_TYPE:
+            return sizeof(run_container_t) +
+                   const_CAST_run(c)->capacity * sizeof(rle16_t);
+        case PACKED_CONTAINER_TYPE:
+            return packed_container_memory_size_in_bytes(const_CAST_packed(c));
+        default:
+            assert(false);
+            roaring_unreachable;
+            return 0;
+    }
+}
+
+static void leaf_statistics(void *object, void *context) {
+    const leaf_t *leaf = (const leaf_t *)object;
+    roaring64_statistics_t *stat = (roaring64_statistics_t *)context;
+    if (leaf->container == NULL) {
+        return;  // Freed leaf.
+    }
+    uint64_t card = container_get_cardinality(leaf->container, leaf->typecode);
+    uint64_t sbytes = container_size_in_bytes(leaf->container, leaf->typecode);
+    stat->n_containers++;
+    stat->cardinality += card;
+    stat->n_bytes_containers +=
+        container_allocated_size_in_bytes(leaf->container, leaf->typecode);
+    switch (leaf->typecode) {
+        case BITSET_CONTAINER_TYPE:
+            stat->n_bitset_containers++;
+            stat->n_values_bitset_containers += card;
+            stat->n_bytes_bitset_containers += sbytes;
+            break;
+        case ARRAY_CONTAINER_TYPE:
+        case PACKED_CONTAINER_TYPE:  // serialized as an array
+            stat->n_array_containers++;
+            stat->n_values_array_containers += card;
+            stat->n_bytes_array_containers += sbytes;
+            break;
+        case RUN_CONTAINER_TYPE:
+            stat->n_run_containers++;
+            stat->n_values_run_containers += card;
+            stat->n_bytes_run_containers += sbytes;
+            break;
+        default:
+            assert(false);
+            roaring_unreachable;
+    }
+}
+
+void roaring64_bitmap_statistics(const roaring64_bitmap_t *r,
+                                 roaring64_statistics_t *stat) {
+    memset(stat, 0, sizeof(*stat));
+    art_statistics_t art_stats;
+    art_statistics(&r->art, &art_stats);
+    stat->n_art_node4 = art_stats.n_node4;
+    stat->n_art_node16 = art_stats.n_node16;
+    stat->n_art_node48 = art_stats.n_node48;
+    stat->n_art_node256 = art_stats.n_node256;
+    stat->n_bytes_art = art_stats.n_bytes_allocated;
+
+    // The leaves are visited in memory order, skipping the freed ones.
+    art_slab_iterate(&r->leaf_slab, sizeof(leaf_t), leaf_statistics, stat);
+    assert(stat->n_containers == art_stats.n_leaves);
+    stat->n_bytes_leaves = art_slab_size_in_bytes(&r->leaf_slab);
+    stat->n_bytes_total = sizeof(roaring64_bitmap_t) - sizeof(art_t) +
+                          stat->n_bytes_art + stat->n_bytes_leaves +
+                          stat->n_bytes_containers;
+    stat->min_value = roaring64_bitmap_minimum(r);
+    stat->max_value = roaring64_bitmap_maximum(r);
+}
+
 static bool roaring64_leaf_internal_validate(const art_val_t *val,
                                              const char **reason) {
     leaf_t *leaf = (leaf_t *)val;
@@ -877,6 +1050,8 @@ bool roaring64_bitmap_is_strict_subset(const roaring64_bitmap_t *r1,
 roaring64_bitmap_t *roaring64_bitmap_and(const roaring64_bitmap_t *r1,
                                          const roaring64_bitmap_t *r2) {
     roaring64_bitmap_t *result = roaring64_bitmap_create();
+    art_builder_t builder;
+    art_builder_init(&builder, &result->art);
 
     art_iterator_t it1 = art_init_iterator(&r1->art, /*first=*/true);
     art_iterator_t it2 = art_init_iterator(&r2->art, /*first=*/true);
@@ -889,7 +1064,7 @@ roaring64_bitmap_t *roaring64_bitmap_and(const roaring64_bitmap_t *r1,
         int compare_result = compare_high48(it1.key, it2.key);
         if (compare_result == 0) {
             // Case 2: iterators at the same high key position.
-            leaf_t *result_leaf = (leaf_t *)roaring_malloc(sizeof(leaf_t));
+            leaf_t *result_leaf = alloc_leaf(result);
             leaf_t *leaf1 = (leaf_t *)it1.value;
             leaf_t *leaf2 = (leaf_t *)it2.value;
             result_leaf->container = container_and(
@@ -898,10 +1073,10 @@ roaring64_bitmap_t *roaring64_bitmap_and(const roaring64_bitmap_t *r1,
 
             if (container_nonzero_cardinality(result_leaf->container,
                                               result_leaf->typecode)) {
-                art_insert(&result->art, it1.key, (art_val_t *)result_leaf);
+                art_builder_append(&builder, it1.key, (art_val_t *)result_leaf);
             } else {
                 container_free(result_leaf->container, result_leaf->typecode);
-                free_leaf(result_leaf);
+                free_leaf(result, result_leaf);
             }
             art_iterator_next(&it1);
             art_iterator_next(&it2);
@@ -913,6 +1088,7 @@ roaring64_bitmap_t *roaring64_bitmap_and(const roaring64_bitmap_t *r1,
             art_iterator_lower_bound(&it2, it1.key);
         }
     }
+    art_builder_finish(&builder);
     return result;
 }
 
@@ -1000,7 +1176,7 @@ void roaring64_bitmap_and_inplace(roaring64_bitmap_t *r1,
                 if (!container_nonzero_cardinality(container2, typecode2)) {
                     container_free(container2, typecode2);
                     art_iterator_erase(&r1->art, &it1);
-                    free_leaf(leaf1);
+                    free_leaf(r1, leaf1);
                 } else {
                     // Only advance the iterator if we didn't delete the
                     // leaf, as erasing advances by itself.
@@ -1015,7 +1191,7 @@ void roaring64_bitmap_and_inplace(roaring64_bitmap_t *r1,
             leaf_t *leaf = (leaf_t *)art_iterator_erase(&r1->art, &it1);
             assert(leaf != NULL);
             container_free(leaf->container, leaf->typecode);
-            free_leaf(leaf);
+            free_leaf(r1, leaf);
         } else if (compare_result > 0) {
             // Case 2c: it1 is after it2.
             art_iterator_lower_bound(&it2, it1.key);
@@ -1023,24 +1199,108 @@ void roaring64_bitmap_and_inplace(roaring64_bitmap_t *r1,
     }
 }
 
+roaring64_bitmap_t *roaring64_bitmap_and_many(size_t number,
+                                              const roaring64_bitmap_t **rs) {
+    if (number == 0) {
+        return roaring64_bitmap_create();
+    }
+    if (number == 1) {
+        return roaring64_bitmap_copy(rs[0]);
+    }
+    roaring64_bitmap_t *result = roaring64_bitmap_create();
+    art_builder_t builder;
+    art_builder_init(&builder, &result->art);
+
+    art_iterator_t *its =
+        (art_iterator_t *)roaring_malloc(number * sizeof(art_iterator_t));
+    bool done = false;
+    for (size_t i = 0; i < number; ++i) {
+        its[i] = art_init_iterator(&rs[i]->art, /*first=*/true);
+        done |= its[i].value == NULL;
+    }
+    art_key_chunk_t high48[ART_KEY_BYTES];
+    while (!done) {
+        // No key smaller than the largest current key can be in all the
+        // bitmaps, so move every iterator up to it, skipping subtrees.
+        size_t largest = 0;
+        for (size_t i = 1; i < number; ++i) {
+            if (compare_high48(its[i].key, its[largest].key) > 0) {
+                largest = i;
+            }
+        }
+        memcpy(high48, its[largest].key, ART_KEY_BYTES);
+        bool all_equal = true;
+        for (size_t i = 0; i < number && !done; ++i) {
+            if (compare_high48(its[i].key, high48) < 0) {
+                art_iterator_lower_bound(&its[i], high48);
+                if (its[i].value == NULL) {
+                    done = true;
+                } else if (compare_high48(its[i].key, high48) != 0) {
+                    all_equal = false;
+                }
+            }
+        }
+        if (done || !all_equal) {
+            continue;
+        }
+
+        // All the iterators are at the same high key position.
+        const leaf_t *leaf1 = (leaf_t *)its[0].value;
+        const leaf_t *leaf2 = (leaf_t *)its[1].value;
+        uint8_t typecode;
+        container_t *container =
+            container_and(leaf1->container, leaf1->typecode, leaf2->container,
+                          leaf2->typecode, &typecode);
+        for (size_t i = 2; i < number; ++i) {
+            if (!container_nonzero_cardinality(container, typecode)) {
+                break;
+            }
+            const leaf_t *leaf = (leaf_t *)its[i].value;
+            uint8_t result_typecode;
+            container_t *result_container =
+                container_iand(container, typecode, leaf->container,
+                               leaf->typecode, &result_typecode);
+            if (result_container != container) {
+                container_free(container, typecode);
+            }
+            container = result_container;
+            typecode = result_typecode;
+        }
+        if (container_nonzero_cardinality(container, typecode)) {
+            leaf_t *leaf = create_leaf(result, container, typecode);
+            art_builder_append(&builder, high48, (art_val_t *)leaf);
+        } else {
+            container_free(container, typecode);
+        }
+        for (size_t i = 0; i < number; ++i) {
+            art_iterator_next(&its[i]);
+            done |= its[i].value == NULL;
+        }
+    }
+    roaring_free(its);
+    art_builder_finish(&builder);
+    return result;
+}
+
 bool roaring64_bitmap_intersect(const roaring64_bitmap_t *r1,
                                 const roaring64_bitmap_t *r2) {
-    bool intersect = false;
     art_iterator_t it1 = art_init_iterator(&r1->art, /*first=*/true);
     art_iterator_t it2 = art_init_iterator(&r2->art, /*first=*/true);
 
     while (it1.value != NULL && it2.value != NULL) {
         // Cases:
-        // 1. it1 <  it2 -> it1++
-        // 2. it1 == it1 -> intersect |= it1 & it2, it1++, it2++
-        // 3. it1 >  it2 -> it2++
+        // 1. it1 <  it2 -> it1 = lower_bound(it1, it2)
+        // 2. it1 == it1 -> return true if it1 & it2, it1++, it2++
+        // 3. it1 >  it2 -> it2 = lower_bound(it2, it1)
         int compare_result = compare_high48(it1.key, it2.key);
         if (compare_result == 0) {
             // Case 2: iterators at the same high key position.
             leaf_t *leaf1 = (leaf_t *)it1.value;
             leaf_t *leaf2 = (leaf_t *)it2.value;
-            intersect |= container_intersect(leaf1->container, leaf1->typecode,
-                                             leaf2->container, leaf2->typecode);
+            if (container_intersect(leaf1->container, leaf1->typecode,
+                                    leaf2->container, leaf2->typecode)) {
+                return true;
+            }
             art_iterator_next(&it1);
             art_iterator_next(&it2);
         } else if (compare_result < 0) {
@@ -1051,7 +1311,7 @@ bool roaring64_bitmap_intersect(const roaring64_bitmap_t *r1,
             art_iterator_lower_bound(&it2, it1.key);
         }
     }
-    return intersect;
+    return false;
 }
 
 bool roaring64_bitmap_intersect_with_range(const roaring64_bitmap_t *r,
@@ -1079,6 +1339,8 @@ double roaring64_bitmap_jaccard_index(const roaring64_bitmap_t *r1,
 roaring64_bitmap_t *roaring64_bitmap_or(const roaring64_bitmap_t *r1,
                                         const roaring64_bitmap_t *r2) {
     roaring64_bitmap_t *result = roaring64_bitmap_create();
+    art_builder_t builder;
+    art_builder_init(&builder, &result->art);
 
     art_iterator_t it1 = art_init_iterator(&r1->art, /*first=*/true);
     art_iterator_t it2 = art_init_iterator(&r2->art, /*first=*/true);
@@ -1101,27 +1363,30 @@ roaring64_bitmap_t *roaring64_bitmap_or(const roaring64_bitmap_t *r1,
                 // Case 3b: iterators at the same high key position.
                 leaf_t *leaf1 = (leaf_t *)it1.value;
                 leaf_t *leaf2 = (leaf_t *)it2.value;
-                leaf_t *result_leaf = (leaf_t *)roaring_malloc(sizeof(leaf_t));
+                leaf_t *result_leaf = alloc_leaf(result);
                 result_leaf->container = container_or(
                     leaf1->container, leaf1->typecode, leaf2->container,
                     leaf2->typecode, &result_leaf->typecode);
-                art_insert(&result->art, it1.key, (art_val_t *)result_leaf);
+                art_builder_append(&builder, it1.key, (art_val_t *)result_leaf);
                 art_iterator_next(&it1);
                 art_iterator_next(&it2);
             }
         }
         if ((it1_present && !it2_present) || compare_result < 0) {
             // Cases 1 and 3a: it1 is the only iterator or is before it2.
-            leaf_t *result_leaf = copy_leaf_container((leaf_t *)it1.value);
-            art_insert(&result->art, it1.key, (art_val_t *)result_leaf);
+            leaf_t *result_leaf =
+                copy_leaf_container(result, (leaf_t *)it1.value);
+            art_builder_append(&builder, it1.key, (art_val_t *)result_leaf);
             art_iterator_next(&it1);
         } else if ((!it1_present && it2_present) || compare_result > 0) {
             // Cases 2 and 3c: it2 is the only iterator or is before it1.
-            leaf_t *result_leaf = copy_leaf_container((leaf_t *)it2.value);
-            art_insert(&result->art, it2.key, (art_val_t *)result_leaf);
+            leaf_t *result_leaf =
+                copy_leaf_container(result, (leaf_t *)it2.value);
+            art_builder_append(&builder, it2.key, (art_val_t *)result_leaf);
             art_iterator_next(&it2);
         }
     }
+    art_builder_finish(&builder);
     return result;
 }
 
@@ -1184,7 +1449,7 @@ void roaring64_bitmap_or_inplace(roaring64_bitmap_t *r1,
             art_iterator_next(&it1);
         } else if ((!it1_present && it2_present) || compare_result > 0) {
             // Cases 2 and 3c: it2 is the only iterator or is before it1.
-            leaf_t *result_leaf = copy_leaf_container((leaf_t *)it2.value);
+            leaf_t *result_leaf = copy_leaf_container(r1, (leaf_t *)it2.value);
             art_iterator_insert(&r1->art, &it1, it2.key,
                                 (art_val_t *)result_leaf);
             art_iterator_next(&it2);
@@ -1192,9 +1457,153 @@ void roaring64_bitmap_or_inplace(roaring64_bitmap_t *r1,
     }
 }
 
+// Merges the leaves of many bitmaps in key order. The iterators of the
+// bitmaps that are not exhausted are kept in a binary min-heap ordered on
+// their high 48 bits.
+typedef struct leaf_merge_s {
+    art_iterator_t *its;
+    size_t *heap;
+    size_t size;
+} leaf_merge_t;
+
+static void leaf_merge_sift_down(leaf_merge_t *merge, size_t i) {
+    size_t top = merge->heap[i];
+    while (true) {
+        size_t child = 2 * i + 1;
+        if (child >= merge->size) {
+            break;
+        }
+        if (child + 1 < merge->size &&
+            compare_high48(merge->its[merge->heap[child + 1]].key,
+                           merge->its[merge->heap[child]].key) < 0) {
+            child++;
+        }
+        if (compare_high48(merge->its[merge->heap[child]].key,
+                           merge->its[top].key) >= 0) {
+            break;
+        }
+        merge->heap[i] = merge->heap[child];
+        i = child;
+    }
+    merge->heap[i] = top;
+}
+
+static void leaf_merge_init(leaf_merge_t *merge, size_t number,
+                            const roaring64_bitmap_t **rs) {
+    merge->its =
+        (art_iterator_t *)roaring_malloc(number * sizeof(art_iterator_t));
+    merge->heap = (size_t *)roaring_malloc(number * sizeof(size_t));
+    merge->size = 0;
+    for (size_t i = 0; i < number; ++i) {
+        merge->its[i] = art_init_iterator(&rs[i]->art, /*first=*/true);
+        if (merge->its[i].value != NULL) {
+            merge->heap[merge->size++] = i;
+        }
+    }
+    for (size_t i = merge->size / 2; i-- > 0;) {
+        leaf_merge_sift_down(merge, i);
+    }
+}
+
+static void leaf_merge_free(leaf_merge_t *merge) {
+    roaring_free(merge->its);
+    roaring_free(merge->heap);
+}
+
+// Moves past the leaves with the smallest high 48 bits, which are written to
+// `high48`. The leaves are written to `leaves` and their number is returned.
+static size_t leaf_merge_next(leaf_merge_t *merge, art_key_chunk_t high48[],
+                              const leaf_t **leaves) {
+    memcpy(high48, merge->its[merge->heap[0]].key, ART_KEY_BYTES);
+    size_t count = 0;
+    while (merge->size > 0 &&
+           compare_high48(merge->its[merge->heap[0]].key, high48) == 0) {
+        art_iterator_t *it = &merge->its[merge->heap[0]];
+        leaves[count++] = (leaf_t *)it->value;
+        art_iterator_next(it);
+        if (it->value == NULL) {
+            merge->heap[0] = merge->heap[--merge->size];
+        }
+        if (merge->size > 0) {
+            leaf_merge_sift_down(merge, 0);
+        }
+    }
+    return count;
+}
+
+// Whether the union or the xor of the leaves may not fit in an array container,
+// in which case the leaves are accumulated in a bitset.
+static bool leaves_need_bitset(const leaf_t **leaves, size_t count) {
+    uint64_t cardinality = 0;
+    for (size_t i = 0; i < count; ++i) {
+        cardinality += (uint32_t)container_get_cardinality(
+            leaves[i]->container, leaves[i]->typecode);
+        if (cardinality > DEFAULT_MAX_SIZE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+roaring64_bitmap_t *roaring64_bitmap_or_many(size_t number,
+                                             const roaring64_bitmap_t **rs) {
+    roaring64_bitmap_t *result = roaring64_bitmap_create();
+    if (number == 0) {
+        return result;
+    }
+    art_builder_t builder;
+    art_builder_init(&builder, &result->art);
+    leaf_merge_t merge;
+    leaf_merge_init(&merge, number, rs);
+    const leaf_t **leaves =
+        (const leaf_t **)roaring_malloc(number * sizeof(leaf_t *));
+    art_key_chunk_t high48[ART_KEY_BYTES];
+    while (merge.size > 0) {
+        size_t count = leaf_merge_next(&merge, high48, leaves);
+        if (count == 1) {
+            leaf_t *leaf = copy_leaf_container(result, leaves[0]);
+            art_builder_append(&builder, high48, (art_val_t *)leaf);
+            continue;
+        }
+        uint8_t typecode;
+        container_t *container;
+        size_t i;
+        if (leaves_need_bitset(leaves, count)) {
+            container = bitset_container_create();
+            typecode = BITSET_CONTAINER_TYPE;
+            i = 0;
+        } else {
+            container = container_lazy_or(
+                leaves[0]->container, leaves[0]->typecode,
+                leaves[1]->container, leaves[1]->typecode, &typecode);
+            i = 2;
+        }
+        for (; i < count; ++i) {
+            uint8_t result_typecode;
+            container_t *result_container = container_lazy_ior(
+                container, typecode, leaves[i]->container, leaves[i]->typecode,
+                &result_typecode);
+            if (result_container != container) {
+                container_free(container, typecode);
+            }
+            container = result_container;
+            typecode = result_typecode;
+        }
+        container = container_repair_after_lazy(container, &typecode);
+        leaf_t *leaf = create_leaf(result, container, typecode);
+        art_builder_append(&builder, high48, (art_val_t *)leaf);
+    }
+    roaring_free(leaves);
+    leaf_merge_free(&merge);
+    art_builder_finish(&builder);
+    return result;
+}
+
 roaring64_bitmap_t *roaring64_bitmap_xor(const roaring64_bitmap_t *r1,
                                          const roaring64_bitmap_t *r2) {
     roaring64_bitmap_t *result = roaring64_bitmap_create();
+    art_builder_t builder;
+    art_builder_init(&builder, &result->art);
 
     art_iterator_t it1 = art_init_iterator(&r1->art, /*first=*/true);
     art_iterator_t it2 = art_init_iterator(&r2->art, /*first=*/true);
@@ -1217,17 +1626,18 @@ roaring64_bitmap_t *roaring64_bitmap_xor(const roaring64_bitmap_t *r1,
                 // Case 3b: iterators at the same high key position.
                 leaf_t *leaf1 = (leaf_t *)it1.value;
                 leaf_t *leaf2 = (leaf_t *)it2.value;
-                leaf_t *result_leaf = (leaf_t *)roaring_malloc(sizeof(leaf_t));
+                leaf_t *result_leaf = alloc_leaf(result);
                 result_leaf->container = container_xor(
                     leaf1->container, leaf1->typecode, leaf2->container,
                     leaf2->typecode, &result_leaf->typecode);
                 if (container_nonzero_cardinality(result_leaf->container,
                                                   result_leaf->typecode)) {
-                    art_insert(&result->art, it1.key, (art_val_t *)result_leaf);
+                    art_builder_append(&builder, it1.key,
+                                       (art_val_t *)result_leaf);
                 } else {
                     container_free(result_leaf->container,
                                    result_leaf->typecode);
-                    free_leaf(result_leaf);
+                    free_leaf(result, result_leaf);
                 }
                 art_iterator_next(&it1);
                 art_iterator_next(&it2);
@@ -1235,16 +1645,19 @@ roaring64_bitmap_t *roaring64_bitmap_xor(const roaring64_bitmap_t *r1,
         }
         if ((it1_present && !it2_present) || compare_result < 0) {
             // Cases 1 and 3a: it1 is the only iterator or is before it2.
-            leaf_t *result_leaf = copy_leaf_container((leaf_t *)it1.value);
-            art_insert(&result->art, it1.key, (art_val_t *)result_leaf);
+            leaf_t *result_leaf =
+                copy_leaf_container(result, (leaf_t *)it1.value);
+            art_builder_append(&builder, it1.key, (art_val_t *)result_leaf);
             art_iterator_next(&it1);
         } else if ((!it1_present && it2_present) || compare_result > 0) {
             // Cases 2 and 3c: it2 is the only iterator or is before it1.
-            leaf_t *result_leaf = copy_leaf_container((leaf_t *)it2.value);
-            art_insert(&result->art, it2.key, (art_val_t *)result_leaf);
+            leaf_t *result_leaf =
+                copy_leaf_container(result, (leaf_t *)it2.value);
+            art_builder_append(&builder, it2.key, (art_val_t *)result_leaf);
             art_iterator_next(&it2);
         }
     }
+    art_builder_finish(&builder);
     return result;
 }
 
@@ -1305,7 +1718,7 @@ void roaring64_bitmap_xor_inplace(roaring64_bitmap_t *r1,
                 if (!container_nonzero_cardinality(container2, typecode2)) {
                     container_free(container2, typecode2);
                     art_iterator_erase(&r1->art, &it1);
-                    free_leaf(leaf1);
+                    free_leaf(r1, leaf1);
                 } else {
                     // Only advance the iterator if we didn't delete the
                     // leaf, as erasing advances by itself.
@@ -1319,7 +1732,7 @@ void roaring64_bitmap_xor_inplace(roaring64_bitmap_t *r1,
             art_iterator_next(&it1);
         } else if ((!it1_present && it2_present) || compare_result > 0) {
             // Cases 2 and 3c: it2 is the only iterator or is before it1.
-            leaf_t *result_leaf = copy_leaf_container((leaf_t *)it2.value);
+            leaf_t *result_leaf = copy_leaf_container(r1, (leaf_t *)it2.value);
             if (it1_present) {
                 art_iterator_insert(&r1->art, &it1, it2.key,
                                     (art_val_t *)result_leaf);
@@ -1332,83 +1745,238 @@ void roaring64_bitmap_xor_inplace(roaring64_bitmap_t *r1,
     }
 }
 
-roaring64_bitmap_t *roaring64_bitmap_andnot(const roaring64_bitmap_t *r1,
-                                            const roaring64_bitmap_t *r2) {
+roaring64_bitmap_t *roaring64_bitmap_lazy_or(const roaring64_bitmap_t *r1,
+                                             const roaring64_bitmap_t *r2,
+                                             bool bitsetconversion) {
     roaring64_bitmap_t *result = roaring64_bitmap_create();
+    art_builder_t builder;
+    art_builder_init(&builder, &result->art);
 
     art_iterator_t it1 = art_init_iterator(&r1->art, /*first=*/true);
     art_iterator_t it2 = art_init_iterator(&r2->art, /*first=*/true);
 
-    while (it1.value != NULL) {
+    while (it1.value != NULL || it2.value != NULL) {
+        bool it1_present = it1.value != NULL;
+        bool it2_present = it2.value != NULL;
+
         // Cases:
-        // 1. it1_present && !it2_present -> output it1, it1++
-        // 2. it1_present && it2_present
+        // 1. it1_present  && !it2_present -> output it1, it1++
+        // 2. !it1_present && it2_present  -> output it2, it2++
+        // 3. it1_present  && it2_present
         //    a. it1 <  it2 -> output it1, it1++
-        //    b. it1 == it2 -> output it1 - it2, it1++, it2++
-        //    c. it1 >  it2 -> it2++
-        bool it2_present = it2.value != NULL;
+        //    b. it1 == it2 -> output it1 | it2 (lazy), it1++, it2++
+        //    c. it1 >  it2 -> output it2, it2++
         int compare_result = 0;
-        if (it2_present) {
+        if (it1_present && it2_present) {
             compare_result = compare_high48(it1.key, it2.key);
             if (compare_result == 0) {
-                // Case 2b: iterators at the same high key position.
-                leaf_t *result_leaf = (leaf_t *)roaring_malloc(sizeof(leaf_t));
+                // Case 3b: iterators at the same high key position.
                 leaf_t *leaf1 = (leaf_t *)it1.value;
                 leaf_t *leaf2 = (leaf_t *)it2.value;
-                result_leaf->container = container_andnot(
-                    leaf1->container, leaf1->typecode, leaf2->container,
-                    leaf2->typecode, &result_leaf->typecode);
-
-                if (container_nonzero_cardinality(result_leaf->container,
-                                                  result_leaf->typecode)) {
-                    art_insert(&result->art, it1.key, (art_val_t *)result_leaf);
+                container_t *container1 = leaf1->container;
+                uint8_t typecode1 = leaf1->typecode;
+                uint8_t typecode;
+                container_t *container;
+                if (bitsetconversion &&
+                    get_container_type(container1, typecode1) !=
+                        BITSET_CONTAINER_TYPE &&
+                    get_container_type(leaf2->container, leaf2->typecode) !=
+                        BITSET_CONTAINER_TYPE) {
+                    container1 =
+                        container_mutable_unwrap_shared(container1, &typecode1);
+                    container_t *bitset =
+                        container_to_bitset(container1, typecode1);
+                    container = container_lazy_ior(
+                        bitset, BITSET_CONTAINER_TYPE, leaf2->container,
+                        leaf2->typecode, &typecode);
+                    if (container != bitset) {
+                        container_free(bitset, BITSET_CONTAINER_TYPE);
+                    }
                 } else {
-                    container_free(result_leaf->container,
-                                   result_leaf->typecode);
-                    free_leaf(result_leaf);
+                    container = container_lazy_or(
+                        container1, typecode1, leaf2->container,
+                        leaf2->typecode, &typecode);
                 }
+                art_builder_append(
+                    &builder, it1.key,
+                    (art_val_t *)create_leaf(result, container, typecode));
                 art_iterator_next(&it1);
                 art_iterator_next(&it2);
             }
         }
-        if (!it2_present || compare_result < 0) {
-            // Cases 1 and 2a: it1 is the only iterator or is before it2.
-            leaf_t *result_leaf = copy_leaf_container((leaf_t *)it1.value);
-            art_insert(&result->art, it1.key, (art_val_t *)result_leaf);
+        if ((it1_present && !it2_present) || compare_result < 0) {
+            // Cases 1 and 3a: it1 is the only iterator or is before it2.
+            leaf_t *result_leaf =
+                copy_leaf_container(result, (leaf_t *)it1.value);
+            art_builder_append(&builder, it1.key, (art_val_t *)result_leaf);
             art_iterator_next(&it1);
-        } else if (compare_result > 0) {
-            // Case 2c: it1 is after it2.
+        } else if ((!it1_present && it2_present) || compare_result > 0) {
+            // Cases 2 and 3c: it2 is the only iterator or is before it1.
+            leaf_t *result_leaf =
+                copy_leaf_container(result, (leaf_t *)it2.value);
+            art_builder_append(&builder, it2.key, (art_val_t *)result_leaf);
             art_iterator_next(&it2);
         }
     }
+    art_builder_finish(&builder);
     return result;
 }
 
-uint64_t roaring64_bitmap_andnot_cardinality(const roaring64_bitmap_t *r1,
-                                             const roaring64_bitmap_t *r2) {
-    uint64_t c1 = roaring64_bitmap_get_cardinality(r1);
-    uint64_t inter = roaring64_bitmap_and_cardinality(r1, r2);
-    return c1 - inter;
+void roaring64_bitmap_lazy_or_inplace(roaring64_bitmap_t *r1,
+                                      const roaring64_bitmap_t *r2,
+                                      bool bitsetconversion) {
+    if (r1 == r2) {
+        return;
+    }
+    art_iterator_t it1 = art_init_iterator(&r1->art, /*first=*/true);
+    art_iterator_t it2 = art_init_iterator(&r2->art, /*first=*/true);
+
+    while (it1.value != NULL || it2.value != NULL) {
+        bool it1_present = it1.value != NULL;
+        bool it2_present = it2.value != NULL;
+
+        // Cases:
+        // 1. it1_present  && !it2_present -> it1++
+        // 2. !it1_present && it2_present  -> add it2, it2++
+        // 3. it1_present  && it2_present
+        //    a. it1 <  it2 -> it1++
+        //    b. it1 == it2 -> it1 | it2 (lazy), it1++, it2++
+        //    c. it1 >  it2 -> add it2, it2++
+        int compare_result = 0;
+        if (it1_present && it2_present) {
+            compare_result = compare_high48(it1.key, it2.key);
+            if (compare_result == 0) {
+                // Case 3b: iterators at the same high key position.
+                leaf_t *leaf1 = (leaf_t *)it1.value;
+                leaf_t *leaf2 = (leaf_t *)it2.value;
+                container_t *container1 = leaf1->container;
+                uint8_t typecode1 = leaf1->typecode;
+                if (!container_is_full(container1, typecode1)) {
+                    if (bitsetconversion &&
+                        get_container_type(container1, typecode1) !=
+                            BITSET_CONTAINER_TYPE) {
+                        // Accumulate in a bitset from now on.
+                        container_t *old_container1 = container1;
+                        uint8_t old_typecode1 = typecode1;
+                        container1 =
+                            container_mutable_unwrap_shared(container1,
+                                                            &typecode1);
+                        container1 = container_to_bitset(container1, typecode1);
+                        container_free(old_container1, old_typecode1);
+                        typecode1 = BITSET_CONTAINER_TYPE;
+                    } else {
+                        container1 =
+                            get_writable_copy_if_shared(container1, &typecode1);
+                    }
+                    uint8_t typecode2;
+                    container_t *container2 = container_lazy_ior(
+                        container1, typecode1, leaf2->container,
+                        leaf2->typecode, &typecode2);
+                    if (container2 != container1) {
+                        container_free(container1, typecode1);
+                    }
+                    leaf1->container = container2;
+                    leaf1->typecode = typecode2;
+                }
+                art_iterator_next(&it1);
+                art_iterator_next(&it2);
+            }
+        }
+        if ((it1_present && !it2_present) || compare_result < 0) {
+            // Cases 1 and 3a: it1 is the only iterator or is before it2.
+            art_iterator_next(&it1);
+        } else if ((!it1_present && it2_present) || compare_result > 0) {
+            // Cases 2 and 3c: it2 is the only iterator or is before it1.
+            leaf_t *result_leaf = copy_leaf_container(r1, (leaf_t *)it2.value);
+            art_iterator_insert(&r1->art, &it1, it2.key,
+                                (art_val_t *)result_leaf);
+            art_iterator_next(&it2);
+        }
+    }
 }
 
-void roaring64_bitmap_andnot_inplace(roaring64_bitmap_t *r1,
-                                     const roaring64_bitmap_t *r2) {
+roaring64_bitmap_t *roaring64_bitmap_lazy_xor(const roaring64_bitmap_t *r1,
+                                              const roaring64_bitmap_t *r2) {
+    roaring64_bitmap_t *result = roaring64_bitmap_create();
+    art_builder_t builder;
+    art_builder_init(&builder, &result->art);
+
     art_iterator_t it1 = art_init_iterator(&r1->art, /*first=*/true);
     art_iterator_t it2 = art_init_iterator(&r2->art, /*first=*/true);
 
-    while (it1.value != NULL) {
+    while (it1.value != NULL || it2.value != NULL) {
+        bool it1_present = it1.value != NULL;
+        bool it2_present = it2.value != NULL;
+
         // Cases:
-        // 1. it1_present && !it2_present -> it1++
-        // 2. it1_present &&  it2_present
-        //    a. it1 <  it2 -> it1++
-        //    b. it1 == it2 -> it1 - it2, it1++, it2++
-        //    c. it1 >  it2 -> it2++
+        // 1. it1_present  && !it2_present -> output it1, it1++
+        // 2. !it1_present && it2_present  -> output it2, it2++
+        // 3. it1_present  && it2_present
+        //    a. it1 <  it2 -> output it1, it1++
+        //    b. it1 == it2 -> output it1 ^ it2 (lazy), it1++, it2++
+        //    c. it1 >  it2 -> output it2, it2++
+        int compare_result = 0;
+        if (it1_present && it2_present) {
+            compare_result = compare_high48(it1.key, it2.key);
+            if (compare_result == 0) {
+                // Case 3b: iterators at the same high key position.
+                leaf_t *leaf1 = (leaf_t *)it1.value;
+                leaf_t *leaf2 = (leaf_t *)it2.value;
+                uint8_t typecode;
+                container_t *container = container_lazy_xor(
+                    leaf1->container, leaf1->typecode, leaf2->container,
+                    leaf2->typecode, &typecode);
+                if (container_nonzero_cardinality(container, typecode)) {
+                    art_builder_append(
+                        &builder, it1.key,
+                        (art_val_t *)create_leaf(result, container, typecode));
+                } else {
+                    container_free(container, typecode);
+                }
+                art_iterator_next(&it1);
+                art_iterator_next(&it2);
+            }
+        }
+        if ((it1_present && !it2_present) || compare_result < 0) {
+            // Cases 1 and 3a: it1 is the only iterator or is before it2.
+            leaf_t *result_leaf =
+                copy_leaf_container(result, (leaf_t *)it1.value);
+            art_builder_append(&builder, it1.key, (art_val_t *)result_leaf);
+            art_iterator_next(&it1);
+        } else if ((!it1_present && it2_present) || compare_result > 0) {
+            // Cases 2 and 3c: it2 is the only iterator or is before it1.
+            leaf_t *result_leaf =
+                copy_leaf_container(result, (leaf_t *)it2.value);
+            art_builder_append(&builder, it2.key, (art_val_t *)result_leaf);
+            art_iterator_next(&it2);
+        }
+    }
+    art_builder_finish(&builder);
+    return result;
+}
+
+void roaring64_bitmap_lazy_xor_inplace(roaring64_bitmap_t *r1,
+                                       const roaring64_bitmap_t *r2) {
+    assert(r1 != r2);
+    art_iterator_t it1 = art_init_iterator(&r1->art, /*first=*/true);
+    art_iterator_t it2 = art_init_iterator(&r2->art, /*first=*/true);
+
+    while (it1.value != NULL || it2.value != NULL) {
+        bool it1_present = it1.value != NULL;
         bool it2_present = it2.value != NULL;
+
+        // Cases:
+        // 1.  it1_present && !it2_present -> it1++
+        // 2. !it1_present &&  it2_present -> add it2, it2++
+        // 3.  it1_present &&  it2_present
+        //    a. it1 <  it2 -> it1++
+        //    b. it1 == it2 -> it1 ^ it2 (lazy), it1++, it2++
+        //    c. it1 >  it2 -> add it2, it2++
         int compare_result = 0;
-        if (it2_present) {
+        if (it1_present && it2_present) {
             compare_result = compare_high48(it1.key, it2.key);
             if (compare_result == 0) {
-                // Case 2b: iterators at the same high key position.
+                // Case 3b: iterators at the same high key position.
                 leaf_t *leaf1 = (leaf_t *)it1.value;
                 leaf_t *leaf2 = (leaf_t *)it2.value;
                 container_t *container1 = leaf1->container;
@@ -1416,29 +1984,27 @@ void roaring64_bitmap_andnot_inplace(roaring64_bitmap_t *r1,
                 uint8_t typecode2;
                 container_t *container2;
                 if (leaf1->typecode == SHARED_CONTAINER_TYPE) {
-                    container2 = container_andnot(
+                    container2 = container_lazy_xor(
                         leaf1->container, leaf1->typecode, leaf2->container,
                         leaf2->typecode, &typecode2);
                     if (container2 != container1) {
-                        // We only free when doing container_andnot, not
-                        // container_iandnot, as iandnot frees the original
-                        // internally.
+                        // We only free when doing container_lazy_xor, not
+                        // container_lazy_ixor, as lazy_ixor frees the
+                        // original internally.
                         container_free(container1, typecode1);
                     }
                 } else {
-                    container2 = container_iandnot(
+                    container2 = container_lazy_ixor(
                         leaf1->container, leaf1->typecode, leaf2->container,
                         leaf2->typecode, &typecode2);
                 }
-                if (container2 != container1) {
-                    leaf1->container = container2;
-                    leaf1->typecode = typecode2;
-                }
+                leaf1->container = container2;
+                leaf1->typecode = typecode2;
 
                 if (!container_nonzero_cardinality(container2, typecode2)) {
                     container_free(container2, typecode2);
                     art_iterator_erase(&r1->art, &it1);
-                    free_leaf(leaf1);
+                    free_leaf(r1, leaf1);
                 } else {
                     // Only advance the iterator if we didn't delete the
                     // leaf, as erasing advances by itself.
@@ -1447,24 +2013,266 @@ void roaring64_bitmap_andnot_inplace(roaring64_bitmap_t *r1,
                 art_iterator_next(&it2);
             }
         }
+        if ((it1_present && !it2_present) || compare_result < 0) {
+            // Cases 1 and 3a: it1 is the only iterator or is before it2.
+            art_iterator_next(&it1);
+        } else if ((!it1_present && it2_present) || compare_result > 0) {
+            // Cases 2 and 3c: it2 is the only iterator or is before it1.
+            leaf_t *result_leaf = copy_leaf_container(r1, (leaf_t *)it2.value);
+            if (it1_present) {
+                art_iterator_insert(&r1->art, &it1, it2.key,
+                                    (art_val_t *)result_leaf);
+                art_iterator_next(&it1);
+            } else {
+                art_insert(&r1->art, it2.key, (art_val_t *)result_leaf);
+            }
+            art_iterator_next(&it2);
+        }
+    }
+}
+
+void roaring64_bitmap_repair_after_lazy(roaring64_bitmap_t *r) {
+    art_iterator_t it = art_init_iterator(&r->art, /*first=*/true);
+    while (it.value != NULL) {
+        leaf_t *leaf = (leaf_t *)it.value;
+        // container_repair_after_lazy frees the original container if it
+        // returns a new one.
+        leaf->container =
+            container_repair_after_lazy(leaf->container, &leaf->typecode);
+        art_iterator_next(&it);
+    }
+}
+
+// Flips the values of `container` in `bitset`, without maintaining the
+// cardinality of the bitset, which must be repaired afterwards.
+static void bitset_container_lazy_ixor(bitset_container_t *bitset,
+                                       const container_t *container,
+                                       uint8_t typecode) {
+    container = container_unwrap_shared(container, &typecode);
+    switch (typecode) {
+        case BITSET_CONTAINER_TYPE:
+            bitset_container_xor_nocard(bitset, const_CAST_bitset(container),
+                                        bitset);
+            break;
+        case ARRAY_CONTAINER_TYPE: {
+            const array_container_t *array = const_CAST_array(container);
+            bitset_flip_list(bitset->words, array->array,
+                             (uint64_t)array->cardinality);
+            break;
+        }
+        case RUN_CONTAINER_TYPE: {
+            const run_container_t *run = const_CAST_run(container);
+            for (int32_t i = 0; i < run->n_runs; ++i) {
+                uint32_t start = run->runs[i].value;
+                bitset_flip_range(bitset->words, start,
+                                  start + run->runs[i].length + 1);
+            }
+            break;
+        }
+        case PACKED_CONTAINER_TYPE: {
+            const packed_container_t *packed = const_CAST_packed(container);
+            uint16_t values[DEFAULT_MAX_SIZE];
+            packed_container_decode(packed, values);
+            bitset_flip_list(bitset->words, values,
+                             (uint64_t)packed->cardinality);
+            break;
+        }
+        default:
+            assert(false);
+            roaring_unreachable;
+    }
+    bitset->cardinality = BITSET_UNKNOWN_CARDINALITY;
+}
+
+roaring64_bitmap_t *roaring64_bitmap_xor_many(size_t number,
+                                              const roaring64_bitmap_t **rs) {
+    roaring64_bitmap_t *result = roaring64_bitmap_create();
+    if (number == 0) {
+        return result;
+    }
+    art_builder_t builder;
+    art_builder_init(&builder, &result->art);
+    leaf_merge_t merge;
+    leaf_merge_init(&merge, number, rs);
+    const leaf_t **leaves =
+        (const leaf_t **)roaring_malloc(number * sizeof(leaf_t *));
+    art_key_chunk_t high48[ART_KEY_BYTES];
+    while (merge.size > 0) {
+        size_t count = leaf_merge_next(&merge, high48, leaves);
+        if (count == 1) {
+            leaf_t *leaf = copy_leaf_container(result, leaves[0]);
+            art_builder_append(&builder, high48, (art_val_t *)leaf);
+            continue;
+        }
+        uint8_t typecode;
+        container_t *container;
+        if (leaves_need_bitset(leaves, count)) {
+            bitset_container_t *bitset = bitset_container_create();
+            for (size_t i = 0; i < count; ++i) {
+                bitset_container_lazy_ixor(bitset, leaves[i]->container,
+                                           leaves[i]->typecode);
+            }
+            container = bitset;
+            typecode = BITSET_CONTAINER_TYPE;
+        } else {
+            container = container_lazy_xor(
+                leaves[0]->container, leaves[0]->typecode,
+                leaves[1]->container, leaves[1]->typecode, &typecode);
+            for (size_t i = 2; i < count; ++i) {
+                // container_lazy_ixor frees the original container if it
+                // returns a new one.
+                container = container_lazy_ixor(container, typecode,
+                                                leaves[i]->container,
+                                                leaves[i]->typecode, &typecode);
+            }
+        }
+        container = container_repair_after_lazy(container, &typecode);
+        if (container_nonzero_cardinality(container, typecode)) {
+            leaf_t *leaf = create_leaf(result, container, typecode);
+            art_builder_append(&builder, high48, (art_val_t *)leaf);
+        } else {
+            container_free(container, typecode);
+        }
+    }
+    roaring_free(leaves);
+    leaf_merge_free(&merge);
+    art_builder_finish(&builder);
+    return result;
+}
+
+roaring64_bitmap_t *roaring64_bitmap_andnot(const roaring64_bitmap_t *r1,
+                                            const roaring64_bitmap_t *r2) {
+    roaring64_bitmap_t *result = roaring64_bitmap_create();
+    art_builder_t builder;
+    art_builder_init(&builder, &result->art);
+
+    art_iterator_t it1 = art_init_iterator(&r1->art, /*first=*/true);
+    art_iterator_t it2 = art_init_iterator(&r2->art, /*first=*/true);
+
+    while (it1.value != NULL) {
+        // Cases:
+        // 1. it1_present && !it2_present -> output it1, it1++
+        // 2. it1_present && it2_present
+        //    a. it1 <  it2 -> output it1, it1++
+        //    b. it1 == it2 -> output it1 - it2, it1++, it2++
+        //    c. it1 >  it2 -> it2 = lower_bound(it2, it1)
+        bool it2_present = it2.value != NULL;
+        int compare_result = 0;
+        if (it2_present) {
+            compare_result = compare_high48(it1.key, it2.key);
+            if (compare_result == 0) {
+                // Case 2b: iterators at the same high key position.
+                leaf_t *result_leaf = alloc_leaf(result);
+                leaf_t *leaf1 = (leaf_t *)it1.value;
+                leaf_t *leaf2 = (leaf_t *)it2.value;
+                result_leaf->container = container_andnot(
+                    leaf1->container, leaf1->typecode, leaf2->container,
+                    leaf2->typecode, &result_leaf->typecode);
+
+                if (container_nonzero_cardinality(result_leaf->container,
+                                                  result_leaf->typecode)) {
+                    art_builder_append(&builder, it1.key,
+                                       (art_val_t *)result_leaf);
+                } else {
+                    container_free(result_leaf->container,
+                                   result_leaf->typecode);
+                    free_leaf(result, result_leaf);
+                }
+                art_iterator_next(&it1);
+                art_iterator_next(&it2);
+            }
+        }
         if (!it2_present || compare_result < 0) {
             // Cases 1 and 2a: it1 is the only iterator or is before it2.
+            leaf_t *result_leaf =
+                copy_leaf_container(result, (leaf_t *)it1.value);
+            art_builder_append(&builder, it1.key, (art_val_t *)result_leaf);
             art_iterator_next(&it1);
         } else if (compare_result > 0) {
             // Case 2c: it1 is after it2.
+            art_iterator_lower_bound(&it2, it1.key);
+        }
+    }
+    art_builder_finish(&builder);
+    return result;
+}
+
+uint64_t roaring64_bitmap_andnot_cardinality(const roaring64_bitmap_t *r1,
+                                             const roaring64_bitmap_t *r2) {
+    uint64_t c1 = roaring64_bitmap_get_cardinality(r1);
+    uint64_t inter = roaring64_bitmap_and_cardinality(r1, r2);
+    return c1 - inter;
+}
+
+void roaring64_bitmap_andnot_inplace(roaring64_bitmap_t *r1,
+                                     const roaring64_bitmap_t *r2) {
+    art_iterator_t it1 = art_init_iterator(&r1->art, /*first=*/true);
+    art_iterator_t it2 = art_init_iterator(&r2->art, /*first=*/true);
+
+    // Leaves of it1 past the last leaf of it2 are unchanged.
+    while (it1.value != NULL && it2.value != NULL) {
+        // Cases:
+        // 1. it1 <  it2 -> it1 = lower_bound(it1, it2)
+        // 2. it1 == it2 -> it1 - it2, it1++, it2++
+        // 3. it1 >  it2 -> it2 = lower_bound(it2, it1)
+        int compare_result = compare_high48(it1.key, it2.key);
+        if (compare_result == 0) {
+            // Case 2: iterators at the same high key position.
+            leaf_t *leaf1 = (leaf_t *)it1.value;
+            leaf_t *leaf2 = (leaf_t *)it2.value;
+            container_t *container1 = leaf1->container;
+            uint8_t typecode1 = leaf1->typecode;
+            uint8_t typecode2;
+            container_t *container2;
+            if (leaf1->typecode == SHARED_CONTAINER_TYPE) {
+                container2 = container_andnot(
+                    leaf1->container, leaf1->typecode, leaf2->container,
+                    leaf2->typecode, &typecode2);
+                if (container2 != container1) {
+                    // We only free when doing container_andnot, not
+                    // container_iandnot, as iandnot frees the original
+                    // internally.
+                    container_free(container1, typecode1);
+                }
+            } else {
+                container2 = container_iandnot(
+                    leaf1->container, leaf1->typecode, leaf2->container,
+                    leaf2->typecode, &typecode2);
+            }
+            if (container2 != container1) {
+                leaf1->container = container2;
+                leaf1->typecode = typecode2;
+            }
+
+            if (!container_nonzero_cardinality(container2, typecode2)) {
+                container_free(container2, typecode2);
+                art_iterator_erase(&r1->art, &it1);
+                free_leaf(r1, leaf1);
+            } else {
+                // Only advance the iterator if we didn't delete the
+                // leaf, as erasing advances by itself.
+                art_iterator_next(&it1);
+            }
             art_iterator_next(&it2);
+        } else if (compare_result < 0) {
+            // Case 1: it1 is before it2, skip the leaves in between.
+            art_iterator_lower_bound(&it1, it2.key);
+        } else {
+            // Case 3: it2 is before it1, skip the leaves in between.
+            art_iterator_lower_bound(&it2, it1.key);
         }
     }
 }
 
 /**
- * Flips the leaf at high48 in the range [min, max), returning a new leaf with a
- * new container. If the high48 key is not found in the existing bitmap, a new
- * container is created. Returns null if the negation results in an empty range.
+ * Flips the leaf at high48 in the range [min, max), returning a new leaf of r2
+ * with a new container. If the high48 key is not found in the existing bitmap,
+ * a new container is created. Returns null if the negation results in an empty
+ * range.
  */
 static leaf_t *roaring64_flip_leaf(const roaring64_bitmap_t *r,
-                                   uint8_t high48[], uint32_t min,
-                                   uint32_t max) {
+                                   roaring64_bitmap_t *r2, uint8_t high48[],
+                                   uint32_t min, uint32_t max) {
     leaf_t *leaf1 = (leaf_t *)art_find(&r->art, high48);
     container_t *container2;
     uint8_t typecode2;
@@ -1481,7 +2289,7 @@ static leaf_t *roaring64_flip_leaf(const roaring64_bitmap_t *r,
                                          max, &typecode2);
     }
     if (container_nonzero_cardinality(container2, typecode2)) {
-        return create_leaf(container2, typecode2);
+        return create_leaf(r2, container2, typecode2);
     }
     container_free(container2, typecode2);
     return NULL;
@@ -1501,7 +2309,7 @@ static void roaring64_flip_leaf_inplace(roaring64_bitmap_t *r, uint8_t high48[],
         // No container at this key, insert a full container.
         container2 = container_range_of_ones(min, max, &typecode2);
         art_insert(&r->art, high48,
-                   (art_val_t *)create_leaf(container2, typecode2));
+                   (art_val_t *)create_leaf(r, container2, typecode2));
         return;
     }
 
@@ -1521,7 +2329,7 @@ static void roaring64_flip_leaf_inplace(roaring64_bitmap_t *r, uint8_t high48[],
     if (!container_nonzero_cardinality(leaf->container, leaf->typecode)) {
         art_erase(&r->art, high48);
         container_free(leaf->container, leaf->typecode);
-        free_leaf(leaf);
+        free_leaf(r, leaf);
     }
 }
 
@@ -1546,6 +2354,8 @@ roaring64_bitmap_t *roaring64_bitmap_flip_closed(const roaring64_bitmap_t *r1,
     uint64_t max_high48_bits = (max & 0xFFFFFFFFFFFF0000ULL) >> 16;
 
     roaring64_bitmap_t *r2 = roaring64_bitmap_create();
+    art_builder_t builder;
+    art_builder_init(&builder, &r2->art);
     art_iterator_t it = art_init_iterator(&r1->art, /*first=*/true);
 
     // Copy the containers before min unchanged.
@@ -1554,8 +2364,8 @@ roaring64_bitmap_t *roaring64_bitmap_flip_closed(const roaring64_bitmap_t *r1,
         uint8_t typecode2 = leaf1->typecode;
         container_t *container2 = get_copy_of_container(
             leaf1->container, &typecode2, /*copy_on_write=*/false);
-        art_insert(&r2->art, it.key,
-                   (art_val_t *)create_leaf(container2, typecode2));
+        art_builder_append(&builder, it.key,
+                           (art_val_t *)create_leaf(r2, container2, typecode2));
         art_iterator_next(&it);
     }
 
@@ -1574,10 +2384,10 @@ roaring64_bitmap_t *roaring64_bitmap_flip_closed(const roaring64_bitmap_t *r1,
             max_container = max_low16 + 1;  // Exclusive.
         }
 
-        leaf_t *leaf = roaring64_flip_leaf(r1, current_high48_key,
+        leaf_t *leaf = roaring64_flip_leaf(r1, r2, current_high48_key,
                                            min_container, max_container);
         if (leaf != NULL) {
-            art_insert(&r2->art, current_high48_key, (art_val_t *)leaf);
+            art_builder_append(&builder, current_high48_key, (art_val_t *)leaf);
         }
     }
 
@@ -1588,11 +2398,12 @@ roaring64_bitmap_t *roaring64_bitmap_flip_closed(const roaring64_bitmap_t *r1,
         uint8_t typecode2 = leaf1->typecode;
         container_t *container2 = get_copy_of_container(
             leaf1->container, &typecode2, /*copy_on_write=*/false);
-        art_insert(&r2->art, it.key,
-                   (art_val_t *)create_leaf(container2, typecode2));
+        art_builder_append(&builder, it.key,
+                           (art_val_t *)create_leaf(r2, container2, typecode2));
         art_iterator_next(&it);
     }
 
+    art_builder_finish(&builder);
     return r2;
 }
 
@@ -1897,7 +2708,7 @@ roaring64_bitmap_t *roaring64_bitmap_portable_deserialize_safe(
                 (((uint64_t)high32) << 32) | (((uint64_t)key16) << 16);
             uint8_t high48[ART_KEY_BYTES];
             split_key(high48_bits, high48);
-            leaf_t *leaf = create_leaf(container, typecode);
+            leaf_t *leaf = create_leaf(r, container, typecode);
             art_insert(&r->art, high48, (art_val_t *)leaf);
         }
         roaring_bitmap_free_without_containers(bitmap32);
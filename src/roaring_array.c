@@ -21,6 +21,9 @@ namespace internal {
 
 extern inline int32_t ra_get_size(const roaring_array_t *ra);
 extern inline int32_t ra_get_index(const roaring_array_t *ra, uint16_t x);
+extern inline bool ra_may_contain_key(const roaring_array_t *ra, uint16_t x);
+extern inline void ra_summary_add_key(roaring_array_t *ra, uint16_t x);
+extern inline void ra_summary_remove_key(roaring_array_t *ra, uint16_t x);
 
 extern inline container_t *ra_get_container_at_index(const roaring_array_t *ra,
                                                      uint16_t i,
@@ -121,6 +124,31 @@ void ra_init(roaring_array_t *new_ra) {
     new_ra->allocation_size = 0;
     new_ra->size = 0;
     new_ra->flags = 0;
+    new_ra->key_summary = NULL;
+}
+
+#define KEY_SUMMARY_WORDS (0x10000 / 64)
+
+bool ra_enable_key_summary(roaring_array_t *ra) {
+    if (ra->key_summary != NULL) return true;
+    ra->key_summary =
+        (uint64_t *)roaring_malloc(KEY_SUMMARY_WORDS * sizeof(uint64_t));
+    if (ra->key_summary == NULL) return false;
+    ra_rebuild_key_summary(ra);
+    return true;
+}
+
+void ra_disable_key_summary(roaring_array_t *ra) {
+    roaring_free(ra->key_summary);
+    ra->key_summary = NULL;
+}
+
+void ra_rebuild_key_summary(roaring_array_t *ra) {
+    if (ra->key_summary == NULL) return;
+    memset(ra->key_summary, 0, KEY_SUMMARY_WORDS * sizeof(uint64_t));
+    for (int32_t i = 0; i < ra->size; ++i) {
+        ra_summary_add_key(ra, ra->keys[i]);
+    }
 }
 
 bool ra_overwrite(const roaring_array_t *source, roaring_array_t *dest,
@@ -128,7 +156,8 @@ bool ra_overwrite(const roaring_array_t *source, roaring_array_t *dest,
     ra_clear_containers(dest);  // we are going to overwrite them
     if (source->size == 0) {    // Note: can't call memcpy(NULL), even w/size
         dest->size = 0;         // <--- This is important.
-        return true;            // output was just cleared, so they match
+        ra_rebuild_key_summary(dest);
+        return true;  // output was just cleared, so they match
     }
     if (dest->allocation_size < source->size) {
         if (!realloc_array(dest, source->size)) {
@@ -137,6 +166,7 @@ bool ra_overwrite(const roaring_array_t *source, roaring_array_t *dest,
     }
     dest->size = source->size;
     memcpy(dest->keys, source->keys, dest->size * sizeof(uint16_t));
+    ra_rebuild_key_summary(dest);
     // we go through the containers, turning them into shared containers...
     if (copy_on_write) {
         for (int32_t i = 0; i < dest->size; ++i) {
@@ -176,11 +206,13 @@ void ra_reset(roaring_array_t *ra) {
     ra_clear_containers(ra);
     ra->size = 0;
     ra_shrink_to_fit(ra);
+    ra_disable_key_summary(ra);  // no auxiliary allocation left
 }
 
 void ra_clear_without_containers(roaring_array_t *ra) {
     roaring_free(
         ra->containers);  // keys and typecodes are allocated with containers
+    ra_disable_key_summary(ra);
     ra->size = 0;
     ra->allocation_size = 0;
     ra->containers = NULL;
@@ -215,6 +247,7 @@ void ra_append(roaring_array_t *ra, uint16_t key, container_t *c,
     const int32_t pos = ra->size;
 
     ra->keys[pos] = key;
+    ra_summary_add_key(ra, key);
     ra->containers[pos] = c;
     ra->typecodes[pos] = typecode;
     ra->size++;
@@ -227,6 +260,7 @@ void ra_append_copy(roaring_array_t *ra, const roaring_array_t *sa,
 
     // old contents is junk that does not need freeing
     ra->keys[pos] = sa->keys[index];
+    ra_summary_add_key(ra, sa->keys[index]);
     // the shared container will be in two bitmaps
     if (copy_on_write) {
         sa->containers[index] = get_copy_of_container(
@@ -256,6 +290,7 @@ void ra_append_copy_range(roaring_array_t *ra, const roaring_array_t *sa,
     for (int32_t i = start_index; i < end_index; ++i) {
         const int32_t pos = ra->size;
         ra->keys[pos] = sa->keys[i];
+        ra_summary_add_key(ra, sa->keys[i]);
         if (copy_on_write) {
             sa->containers[i] = get_copy_of_container(
                 sa->containers[i], &sa->typecodes[i], copy_on_write);
@@ -288,6 +323,7 @@ void ra_append_move_range(roaring_array_t *ra, roaring_array_t *sa,
         const int32_t pos = ra->size;
 
         ra->keys[pos] = sa->keys[i];
+        ra_summary_add_key(ra, sa->keys[i]);
         ra->containers[pos] = sa->containers[i];
         ra->typecodes[pos] = sa->typecodes[i];
         ra->size++;
@@ -302,6 +338,7 @@ void ra_append_range(roaring_array_t *ra, roaring_array_t *sa,
     for (int32_t i = start_index; i < end_index; ++i) {
         const int32_t pos = ra->size;
         ra->keys[pos] = sa->keys[i];
+        ra_summary_add_key(ra, sa->keys[i]);
         if (copy_on_write) {
             sa->containers[i] = get_copy_of_container(
                 sa->containers[i], &sa->typecodes[i], copy_on_write);
@@ -340,11 +377,110 @@ extern inline int32_t ra_advance_until(const roaring_array_t *ra, uint16_t x,
 int32_t ra_advance_until_freeing(roaring_array_t *ra, uint16_t x, int32_t pos) {
     while (pos < ra->size && ra->keys[pos] < x) {
         container_free(ra->containers[pos], ra->typecodes[pos]);
+        ra_summary_remove_key(ra, ra->keys[pos]);
         ++pos;
     }
     return pos;
 }
 
+// Returns the smallest key >= x set in both summaries, or -1 if none.
+static int32_t key_summary_next_common(const uint64_t *s1, const uint64_t *s2,
+                                       uint16_t x) {
+    int32_t w = x >> 6;
+    uint64_t word = s1[w] & s2[w] & (UINT64_MAX << (x & 63));
+    while (word == 0) {
+        if (++w == KEY_SUMMARY_WORDS) return -1;
+        word = s1[w] & s2[w];
+    }
+    return w * 64 + roaring_trailing_zeroes(word);
+}
+
+int32_t ra_intersect_keys(const roaring_array_t *ra1, int32_t *pos1,
+                          const roaring_array_t *ra2, int32_t *pos2,
+                          uint16_t *index1, uint16_t *index2,
+                          int32_t capacity) {
+    assert(capacity >= 8);
+    int32_t p1 = *pos1, p2 = *pos2;
+    const int32_t remaining1 = ra1->size - p1, remaining2 = ra2->size - p2;
+    if (remaining1 <= 0 || remaining2 <= 0) return 0;
+    int32_t count = 0;
+    if (ra1->key_summary != NULL && ra2->key_summary != NULL) {
+        // Jump straight to the next key present in both summaries. Stale
+        // bits only cost an extra comparison.
+        while (p1 < ra1->size && p2 < ra2->size && count < capacity) {
+            const uint16_t k1 = ra1->keys[p1], k2 = ra2->keys[p2];
+            if (k1 == k2) {
+                index1[count] = (uint16_t)p1++;
+                index2[count] = (uint16_t)p2++;
+                count++;
+                continue;
+            }
+            const int32_t next = key_summary_next_common(
+                ra1->key_summary, ra2->key_summary, k1 > k2 ? k1 : k2);
+            if (next < 0) {
+                p1 = ra1->size;
+                p2 = ra2->size;
+                break;
+            }
+            p1 = advanceUntil(ra1->keys, p1 - 1, ra1->size, (uint16_t)next);
+            p2 = advanceUntil(ra2->keys, p2 - 1, ra2->size, (uint16_t)next);
+        }
+    } else if ((int64_t)remaining1 * 64 < remaining2) {
+        // When one side is much smaller, gallop through the larger one.
+        while (p1 < ra1->size && count < capacity) {
+            p2 = advanceUntil(ra2->keys, p2 - 1, ra2->size, ra1->keys[p1]);
+            if (p2 == ra2->size) {
+                p1 = ra1->size;
+                break;
+            }
+            if (ra2->keys[p2] == ra1->keys[p1]) {
+                index1[count] = (uint16_t)p1;
+                index2[count] = (uint16_t)p2;
+                count++;
+                p2++;
+            }
+            p1++;
+        }
+    } else if ((int64_t)remaining2 * 64 < remaining1) {
+        while (p2 < ra2->size && count < capacity) {
+            p1 = advanceUntil(ra1->keys, p1 - 1, ra1->size, ra2->keys[p2]);
+            if (p1 == ra1->size) {
+                p2 = ra2->size;
+                break;
+            }
+            if (ra1->keys[p1] == ra2->keys[p2]) {
+                index1[count] = (uint16_t)p1;
+                index2[count] = (uint16_t)p2;
+                count++;
+                p1++;
+            }
+            p2++;
+        }
+    } else {
+        size_t i1 = (size_t)p1, i2 = (size_t)p2;
+#if CROARING_IS_X64
+        if (croaring_hardware_support() & ROARING_SUPPORTS_AVX2) {
+            count = match_vector16(ra1->keys, (size_t)ra1->size, &i1,
+                                   ra2->keys, (size_t)ra2->size, &i2, index1,
+                                   index2, (size_t)capacity);
+        } else {
+            count = match_uint16(ra1->keys, (size_t)ra1->size, &i1, ra2->keys,
+                                 (size_t)ra2->size, &i2, index1, index2,
+                                 (size_t)capacity);
+        }
+#else
+        count = match_uint16(ra1->keys, (size_t)ra1->size, &i1, ra2->keys,
+                             (size_t)ra2->size, &i2, index1, index2,
+                             (size_t)capacity);
+#endif
+        p1 = (int32_t)i1;
+        p2 = (int32_t)i2;
+    }
+    *pos1 = p1;
+    *pos2 = p2;
+    return count;
+}
+
 void ra_insert_new_key_value_at(roaring_array_t *ra, int32_t i, uint16_t key,
                                 container_t *c, uint8_t typecode) {
     extend_array(ra, 1);
@@ -356,6 +492,7 @@ void ra_insert_new_key_value_at(roaring_array_t *ra, int32_t i, uint16_t key,
     memmove(&(ra->typecodes[i + 1]), &(ra->typecodes[i]),
             sizeof(uint8_t) * (ra->size - i));
     ra->keys[i] = key;
+    ra_summary_add_key(ra, key);
     ra->containers[i] = c;
     ra->typecodes[i] = typecode;
     ra->size++;
@@ -372,6 +509,7 @@ void ra_downsize(roaring_array_t *ra, int32_t new_length) {
 }
 
 void ra_remove_at_index(roaring_array_t *ra, int32_t i) {
+    ra_summary_remove_key(ra, ra->keys[i]);
     memmove(&(ra->containers[i]), &(ra->containers[i + 1]),
             sizeof(container_t *) * (ra->size - i - 1));
     memmove(&(ra->keys[i]), &(ra->keys[i + 1]),
@@ -447,19 +585,10 @@ bool ra_range_uint32_array(const roaring_array_t *ra, size_t offset,
     size_t cur_len = 0;
 
     for (int i = 0; i < ra->size; ++i) {
+        uint8_t typecode = ra->typecodes[i];
         const container_t *c =
-            container_unwrap_shared(ra->containers[i], &ra->typecodes[i]);
-        switch (ra->typecodes[i]) {
-            case BITSET_CONTAINER_TYPE:
-                t_limit = (const_CAST_bitset(c))->cardinality;
-                break;
-            case ARRAY_CONTAINER_TYPE:
-                t_limit = (const_CAST_array(c))->cardinality;
-                break;
-            case RUN_CONTAINER_TYPE:
-                t_limit = run_container_cardinality(const_CAST_run(c));
-                break;
-        }
+            container_unwrap_shared(ra->containers[i], &typecode);
+        t_limit = container_get_cardinality(c, typecode);
         if (ctr + t_limit - 1 >= offset && ctr < offset + limit) {
             if (!first) {
                 // first_skip = t_limit - (ctr + t_limit - offset);
@@ -487,23 +616,8 @@ bool ra_range_uint32_array(const roaring_array_t *ra, size_t offset,
                 roaring_free(t_ans);
                 t_ans = append_ans;
             }
-            switch (ra->typecodes[i]) {
-                case BITSET_CONTAINER_TYPE:
-                    container_to_uint32_array(t_ans + dtr, const_CAST_bitset(c),
-                                              ra->typecodes[i],
-                                              ((uint32_t)ra->keys[i]) << 16);
-                    break;
-                case ARRAY_CONTAINER_TYPE:
-                    container_to_uint32_array(t_ans + dtr, const_CAST_array(c),
-                                              ra->typecodes[i],
-                                              ((uint32_t)ra->keys[i]) << 16);
-                    break;
-                case RUN_CONTAINER_TYPE:
-                    container_to_uint32_array(t_ans + dtr, const_CAST_run(c),
-                                              ra->typecodes[i],
-                                              ((uint32_t)ra->keys[i]) << 16);
-                    break;
-            }
+            container_to_uint32_array(t_ans + dtr, c, typecode,
+                                      ((uint32_t)ra->keys[i]) << 16);
             dtr += t_limit;
         }
         ctr += t_limit;
@@ -6,6 +6,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <roaring/containers/array.h>
 #include <roaring/containers/bitset.h>
@@ -85,6 +86,35 @@ DEFINE_TEST(add_contains_test) {
     array_container_free(B);
 }
 
+// Exercises every search path, including the vectorized ones, against a
+// plain membership table.
+DEFINE_TEST(contains_all_sizes_test) {
+    const int32_t sizes[] = {0, 1, 2, 7, 15, 16, 17, 31, 32, 33, 64, 100, 1000,
+                             4096};
+    bool* present = (bool*)malloc(65536 * sizeof(bool));
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        array_container_t* B = array_container_create();
+        memset(present, 0, 65536 * sizeof(bool));
+        const uint32_t gap = 65535 / (sizes[s] + 1) + 1;
+        for (int32_t i = 0; i < sizes[s]; i++) {
+            // values shifted towards both ends of the range
+            const uint16_t v = (uint16_t)(i == 0 ? 0 : i * gap - (i % 3));
+            array_container_add(B, v);
+            present[v] = true;
+        }
+        if (sizes[s] > 1) {
+            array_container_add(B, 65535);
+            present[65535] = true;
+        }
+        for (uint32_t v = 0; v < 65536; v++) {
+            assert_int_equal(array_container_contains(B, (uint16_t)v),
+                             present[v]);
+        }
+        array_container_free(B);
+    }
+    free(present);
+}
+
 DEFINE_TEST(and_or_test) {
     DESCRIBE_TEST;
 
@@ -371,6 +401,7 @@ int main() {
             mini_fuzz_recycle_array_container_intersection_inplace),
         cmocka_unit_test(printf_test),
         cmocka_unit_test(add_contains_test),
+        cmocka_unit_test(contains_all_sizes_test),
         cmocka_unit_test(and_or_test),
         cmocka_unit_test(to_uint32_array_test),
         cmocka_unit_test(select_test),
@@ -3,8 +3,10 @@
 #include <iomanip>
 #include <ios>
 #include <map>
+#include <set>
 #include <sstream>
 #include <stdio.h>
+#include <string.h>
 #include <string>
 #include <vector>
 
@@ -102,6 +104,16 @@ class ShadowedART {
         shadow_.erase(key);
     }
 
+    void assertFindValid(Key key) {
+        auto shadow_it = shadow_.find(key);
+        Value* found_val = (Value*)art_find(&art_, key.data());
+        if (shadow_it == shadow_.end()) {
+            assert_null(found_val);
+        } else {
+            assert_true(found_val == &shadow_it->second);
+        }
+    }
+
     void assertLowerBoundValid(Key key) {
         auto shadow_it = shadow_.lower_bound(key);
         auto art_it = art_lower_bound(&art_, key.data());
@@ -156,7 +168,7 @@ class ShadowedART {
         }
     }
     std::map<Key, Value> shadow_;
-    art_t art_{NULL};
+    art_t art_{};
 };
 
 DEFINE_TEST(test_art_simple) {
@@ -165,7 +177,7 @@ DEFINE_TEST(test_art_simple) {
     };
     std::vector<Value> values = {{1}, {2}, {3}, {4}, {5}};
 
-    art_t art{NULL};
+    art_t art{};
     for (size_t i = 0; i < keys.size(); ++i) {
         art_insert(&art, (art_key_chunk_t*)keys[i], &values[i]);
     }
@@ -180,7 +192,7 @@ DEFINE_TEST(test_art_erase_all) {
     std::vector<const char*> keys = {"000001", "000002"};
     std::vector<Value> values = {{1}, {2}};
 
-    art_t art{NULL};
+    art_t art{};
     art_insert(&art, (uint8_t*)keys[0], &values[0]);
     art_insert(&art, (uint8_t*)keys[1], &values[1]);
     assert_art_valid(&art);
@@ -200,7 +212,7 @@ DEFINE_TEST(test_art_is_empty) {
     };
     std::vector<Value> values = {{1}, {2}, {3}, {4}, {5}};
 
-    art_t art{NULL};
+    art_t art{};
     assert_art_valid(&art);
     assert_true(art_is_empty(&art));
     const char* key = "000001";
@@ -225,7 +237,7 @@ DEFINE_TEST(test_art_iterator_next) {
                 values.push_back({static_cast<uint64_t>(i) * j});
             }
         }
-        art_t art{NULL};
+        art_t art{};
         for (size_t i = 0; i < keys.size(); ++i) {
             art_insert(&art, (art_key_chunk_t*)keys[i].data(), &values[i]);
             assert_art_valid(&art);
@@ -248,7 +260,7 @@ DEFINE_TEST(test_art_iterator_next) {
             {1, 0, 0, 0, 0, 0},
         };
         std::vector<Value> values = {{0, 1, 2, 3, 4, 5, 6}};
-        art_t art{NULL};
+        art_t art{};
         for (size_t i = 0; i < keys.size(); ++i) {
             art_insert(&art, (art_key_chunk_t*)keys[i].data(), &values[i]);
             assert_art_valid(&art);
@@ -279,7 +291,7 @@ DEFINE_TEST(test_art_iterator_prev) {
                 values.push_back({static_cast<uint64_t>(i) * j});
             }
         }
-        art_t art{NULL};
+        art_t art{};
         for (size_t i = 0; i < keys.size(); ++i) {
             art_insert(&art, (art_key_chunk_t*)keys[i].data(), &values[i]);
             assert_art_valid(&art);
@@ -301,7 +313,7 @@ DEFINE_TEST(test_art_iterator_prev) {
             {1, 0, 0, 0, 0, 0},
         };
         std::vector<Value> values = {{0, 1, 2, 3, 4, 5, 6}};
-        art_t art{NULL};
+        art_t art{};
         for (size_t i = 0; i < keys.size(); ++i) {
             art_insert(&art, (art_key_chunk_t*)keys[i].data(), &values[i]);
             assert_art_valid(&art);
@@ -324,7 +336,7 @@ DEFINE_TEST(test_art_iterator_lower_bound) {
             "000001", "000002", "000003", "000004", "001005",
         };
         std::vector<Value> values = {{1}, {2}, {3}, {4}, {5}};
-        art_t art{NULL};
+        art_t art{};
         for (size_t i = 0; i < keys.size(); ++i) {
             art_insert(&art, (art_key_chunk_t*)keys[i], &values[i]);
             assert_art_valid(&art);
@@ -344,7 +356,7 @@ DEFINE_TEST(test_art_iterator_lower_bound) {
         std::vector<const char*> keys = {"000001", "000003", "000004",
                                          "001005"};
         std::vector<Value> values = {{1}, {3}, {4}, {5}};
-        art_t art{NULL};
+        art_t art{};
         for (size_t i = 0; i < keys.size(); ++i) {
             art_insert(&art, (art_key_chunk_t*)keys[i], &values[i]);
             assert_art_valid(&art);
@@ -369,7 +381,7 @@ DEFINE_TEST(test_art_iterator_lower_bound) {
         // smaller.
         std::vector<const char*> keys = {"000100", "000200", "000300"};
         std::vector<Value> values = {{1}, {2}, {3}};
-        art_t art{NULL};
+        art_t art{};
         for (size_t i = 0; i < keys.size(); ++i) {
             art_insert(&art, (art_key_chunk_t*)keys[i], &values[i]);
             assert_art_valid(&art);
@@ -418,7 +430,7 @@ DEFINE_TEST(test_art_iterator_lower_bound) {
         // Lower bound search with only a single leaf.
         const char* key1 = "000001";
         Value value{1};
-        art_t art{NULL};
+        art_t art{};
         art_insert(&art, (art_key_chunk_t*)key1, &value);
 
         art_iterator_t iterator = art_init_iterator(&art, true);
@@ -445,7 +457,7 @@ DEFINE_TEST(test_art_lower_bound) {
         "000001", "000002", "000003", "000004", "001005",
     };
     std::vector<Value> values = {{1}, {2}, {3}, {4}, {5}};
-    art_t art{NULL};
+    art_t art{};
     for (size_t i = 0; i < keys.size(); ++i) {
         art_insert(&art, (art_key_chunk_t*)keys[i], &values[i]);
         assert_art_valid(&art);
@@ -483,7 +495,7 @@ DEFINE_TEST(test_art_upper_bound) {
         "000001", "000002", "000003", "000004", "001005",
     };
     std::vector<Value> values = {{1}, {2}, {3}, {4}, {5}};
-    art_t art{NULL};
+    art_t art{};
     for (size_t i = 0; i < keys.size(); ++i) {
         art_insert(&art, (art_key_chunk_t*)keys[i], &values[i]);
         assert_art_valid(&art);
@@ -528,7 +540,7 @@ DEFINE_TEST(test_art_iterator_erase) {
             values.push_back({static_cast<uint64_t>(i) * j});
         }
     }
-    art_t art{NULL};
+    art_t art{};
     for (size_t i = 0; i < keys.size(); ++i) {
         art_insert(&art, (art_key_chunk_t*)keys[i].data(), &values[i]);
         assert_art_valid(&art);
@@ -552,7 +564,7 @@ DEFINE_TEST(test_art_iterator_insert) {
         "000001", "000002", "000003", "000004", "001005",
     };
     std::vector<Value> values = {{1}, {2}, {3}, {4}, {5}};
-    art_t art{NULL};
+    art_t art{};
     art_insert(&art, (art_key_chunk_t*)keys[0], &values[0]);
     art_iterator_t iterator = art_init_iterator(&art, true);
     for (size_t i = 1; i < keys.size(); ++i) {
@@ -581,7 +593,7 @@ DEFINE_TEST(test_art_shadowed) {
 }
 
 DEFINE_TEST(test_art_shrink_grow_node48) {
-    art_t art{nullptr};
+    art_t art{};
     std::vector<Value> values(48);
     // Make a full node48.
     for (int i = 0; i < 48; i++) {
@@ -629,6 +641,177 @@ DEFINE_TEST(test_art_shrink_grow_node48) {
     art_free(&art);
 }
 
+DEFINE_TEST(test_art_find_all_node_sizes) {
+    // Node4 and node16 search all their keys at once, so check every key
+    // chunk, present or not, at each size and around the extreme chunks.
+    for (int size = 1; size <= 20; ++size) {
+        ShadowedART art;
+        for (int i = 0; i < size; ++i) {
+            int chunk = (i % 2 == 0) ? i * 6 : 255 - i * 6;
+            art.insert(0x0100 | chunk, i);
+        }
+        art.assertValid();
+        for (uint64_t chunk = 0; chunk < 256; ++chunk) {
+            art.assertFindValid(0x0100 | chunk);
+            art.assertLowerBoundValid(0x0100 | chunk);
+        }
+        art.assertFindValid(0x0200);
+        art.assertLowerBoundValid(0x00ff);
+        for (int i = 0; i < size; i += 2) {
+            art.erase(0x0100 | (i * 6));
+            for (uint64_t chunk = 0; chunk < 256; ++chunk) {
+                art.assertFindValid(0x0100 | chunk);
+            }
+        }
+        art.assertValid();
+    }
+}
+
+DEFINE_TEST(test_art_bulk_load) {
+    // Keys giving nodes of every type and prefixes of every length.
+    std::vector<uint64_t> keys;
+    for (uint64_t i = 0; i < 3; ++i) {
+        keys.push_back(i);
+    }
+    for (uint64_t i = 0; i < 10; ++i) {
+        keys.push_back(0x000100000000 + (i << 8));
+    }
+    for (uint64_t i = 0; i < 40; ++i) {
+        keys.push_back(0x010000000000 + (i << 16) + i);
+    }
+    for (uint64_t i = 0; i < 256; ++i) {
+        keys.push_back(0x020000000000 + (i << 24));
+    }
+    keys.push_back(0xffffffffffff);
+    std::vector<Value> values(keys.size());
+    std::vector<art_val_t*> vals(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        values[i].val = keys[i];
+        memcpy(values[i].key, Key(keys[i]).data(), ART_KEY_BYTES);
+        vals[i] = &values[i];
+    }
+    for (size_t count : {size_t(0), size_t(1), size_t(2), keys.size()}) {
+        art_t art{};
+        art_bulk_load(&art, vals.data(), count);
+        assert_art_valid(&art);
+        art_iterator_t iterator = art_init_iterator(&art, true);
+        for (size_t i = 0; i < count; ++i) {
+            assert_true(art_find(&art, Key(keys[i]).data()) == &values[i]);
+            assert_key_eq(iterator.key, Key(keys[i]).data());
+            art_iterator_next(&iterator);
+        }
+        assert_null(iterator.value);
+        assert_null(art_find(&art, Key(0x000100000001).data()));
+        if (count > 0) {
+            // The bulk loaded ART can be updated like any other.
+            Value extra;
+            art_insert(&art, Key(0x000100000001).data(), &extra);
+            assert_art_valid(&art);
+            assert_true(art_find(&art, Key(0x000100000001).data()) == &extra);
+            art_erase(&art, Key(keys[0]).data());
+            assert_art_valid(&art);
+        }
+        art_free(&art);
+    }
+}
+
+DEFINE_TEST(test_art_builder) {
+    {
+        art_t art{};
+        art_builder_t builder;
+        art_builder_init(&builder, &art);
+        art_builder_finish(&builder);
+        assert_true(art_is_empty(&art));
+
+        Value value;
+        art_builder_append(&builder, Key(1).data(), &value);
+        art_builder_finish(&builder);
+        assert_art_valid(&art);
+        assert_true(art_find(&art, Key(1).data()) == &value);
+        art_free(&art);
+    }
+    // Clustered keys, so that nodes of all types are grown and split at all
+    // depths.
+    std::set<uint64_t> keys;
+    uint64_t x = 1;
+    for (size_t i = 0; i < 20000; ++i) {
+        x = x * 6364136223846793005 + 1442695040888963407;
+        uint64_t mask = (i % 3 == 0) ? 0xff0000ffffff : 0xffffff;
+        keys.insert((x >> 16) & mask);
+    }
+    std::vector<Value> values(keys.size());
+    art_t art{};
+    art_builder_t builder;
+    art_builder_init(&builder, &art);
+    size_t i = 0;
+    for (uint64_t key : keys) {
+        values[i].val = key;
+        art_builder_append(&builder, Key(key).data(), &values[i]);
+        i++;
+    }
+    art_builder_finish(&builder);
+    assert_art_valid(&art);
+    art_iterator_t iterator = art_init_iterator(&art, true);
+    for (i = 0; i < values.size(); ++i) {
+        assert_true(art_find(&art, Key(values[i].val).data()) == &values[i]);
+        assert_true(iterator.value == &values[i]);
+        art_iterator_next(&iterator);
+    }
+    assert_null(iterator.value);
+    art_free(&art);
+}
+
+DEFINE_TEST(test_art_slab) {
+    {
+        art_slab_t slab{};
+        std::vector<void*> objects;
+        for (size_t i = 0; i < 1000; ++i) {
+            objects.push_back(art_slab_alloc(&slab, 24));
+            memset(objects.back(), 0xff, 24);
+        }
+        size_t size = art_slab_size_in_bytes(&slab);
+        assert_true(size >= 1000 * 24);
+        // Freed objects are reused before the slab grows.
+        art_slab_free(&slab, objects[10]);
+        art_slab_free(&slab, objects[500]);
+        assert_true(art_slab_alloc(&slab, 24) == objects[500]);
+        assert_true(art_slab_alloc(&slab, 24) == objects[10]);
+        assert_int_equal(art_slab_size_in_bytes(&slab), size);
+        std::set<void*> visited;
+        art_slab_iterate(
+            &slab, 24,
+            [](void* object, void* context) {
+                ((std::set<void*>*)context)->insert(object);
+            },
+            &visited);
+        assert_true(visited == std::set<void*>(objects.begin(), objects.end()));
+        art_slab_release(&slab);
+        assert_int_equal(art_slab_size_in_bytes(&slab), 0);
+    }
+    // Erasing and re-inserting keys reuses the nodes of the ART.
+    std::vector<Value> values(10000);
+    art_t art{};
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i].val = i * 257;
+        art_insert(&art, Key(values[i].val).data(), &values[i]);
+    }
+    size_t allocated = art_allocated_size_in_bytes(&art);
+    assert_true(allocated >= art_size_in_bytes(&art));
+    for (size_t i = 0; i < values.size(); ++i) {
+        art_erase(&art, Key(values[i].val).data());
+    }
+    assert_true(art_is_empty(&art));
+    assert_int_equal(art_allocated_size_in_bytes(&art), allocated);
+    for (size_t i = 0; i < values.size(); ++i) {
+        art_insert(&art, Key(values[i].val).data(), &values[i]);
+    }
+    assert_art_valid(&art);
+    assert_int_equal(art_allocated_size_in_bytes(&art), allocated);
+    art_free(&art);
+    assert_true(art_is_empty(&art));
+    assert_int_equal(art_allocated_size_in_bytes(&art), sizeof(art_t));
+}
+
 }  // namespace
 
 int main() {
@@ -645,6 +828,10 @@ int main() {
         cmocka_unit_test(test_art_iterator_insert),
         cmocka_unit_test(test_art_shadowed),
         cmocka_unit_test(test_art_shrink_grow_node48),
+        cmocka_unit_test(test_art_find_all_node_sizes),
+        cmocka_unit_test(test_art_bulk_load),
+        cmocka_unit_test(test_art_builder),
+        cmocka_unit_test(test_art_slab),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -1,6 +1,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <roaring/bitset/bitset.h>
 
@@ -260,6 +261,241 @@ void test_contains_all() {
     bitset_free(subset);
 }
 
+/* Fills a bitset of the given size in bits with pseudo-random content. */
+static bitset_t *make_random_bitset(size_t bits, uint64_t *seed) {
+    bitset_t *b = bitset_create_with_capacity(bits);
+    for (size_t i = 0; i < bits; i++) {
+        *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        if ((*seed >> 61) < 3) bitset_set(b, i);
+    }
+    return b;
+}
+
+/* Exercises the vectorized paths: sizes straddle the SIMD threshold and are
+not multiples of the vector width, and the operands differ in length. */
+void test_large_ops() {
+    const size_t sizes[] = {1, 100, 4095, 4096, 4097, 64 * 67 + 13, 100003};
+    const size_t nsizes = sizeof(sizes) / sizeof(sizes[0]);
+    uint64_t seed = 1234;
+    for (size_t i = 0; i < nsizes; i++) {
+        for (size_t j = 0; j < nsizes; j++) {
+            bitset_t *b1 = make_random_bitset(sizes[i], &seed);
+            bitset_t *b2 = make_random_bitset(sizes[j], &seed);
+            size_t bits = sizes[i] > sizes[j] ? sizes[i] : sizes[j];
+            size_t inter = 0, uni = 0, diff = 0, sym = 0, c1 = 0;
+            for (size_t x = 0; x < bits; x++) {
+                bool in1 = x < sizes[i] && bitset_get(b1, x);
+                bool in2 = x < sizes[j] && bitset_get(b2, x);
+                c1 += in1;
+                inter += in1 && in2;
+                uni += in1 || in2;
+                diff += in1 && !in2;
+                sym += in1 != in2;
+            }
+            assert_true(bitset_count(b1) == c1);
+            assert_true(bitset_intersection_count(b1, b2) == inter);
+            assert_true(bitset_union_count(b1, b2) == uni);
+            assert_true(bitset_difference_count(b1, b2) == diff);
+            assert_true(bitset_symmetric_difference_count(b1, b2) == sym);
+
+            bitset_t *t = bitset_copy(b1);
+            assert_true(bitset_inplace_union(t, b2));
+            assert_true(bitset_count(t) == uni);
+            bitset_free(t);
+            t = bitset_copy(b1);
+            bitset_inplace_intersection(t, b2);
+            assert_true(bitset_count(t) == inter);
+            assert_true(bitset_contains_all(b1, t));
+            assert_true(bitset_contains_all(b2, t));
+            bitset_free(t);
+            t = bitset_copy(b1);
+            bitset_inplace_difference(t, b2);
+            assert_true(bitset_count(t) == diff);
+            assert_true(bitsets_disjoint(t, b2));
+            bitset_free(t);
+            t = bitset_copy(b1);
+            assert_true(bitset_inplace_symmetric_difference(t, b2));
+            assert_true(bitset_count(t) == sym);
+            assert_true(bitset_inplace_symmetric_difference(t, b2));
+            assert_true(bitset_intersection_count(t, b1) == c1);
+            assert_true(bitset_count(t) == c1);
+            bitset_free(t);
+
+            bitset_free(b1);
+            bitset_free(b2);
+        }
+    }
+}
+
+/* Fills the words of a bitset directly; sparse or dense depending on
+one_in_four (0 to 4). */
+static bitset_t *make_random_words(size_t words, int one_in_four,
+                                   uint64_t *seed) {
+    bitset_t *b = bitset_create_with_capacity(words * 64);
+    for (size_t i = 0; i < words; i++) {
+        uint64_t w = 0;
+        for (int j = 0; j < one_in_four; j++) {
+            *seed = *seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            w |= *seed;
+        }
+        b->array[i] = one_in_four == 0 ? (*seed & 1) << (i % 64) : w;
+    }
+    return b;
+}
+
+static bool bitsets_equal(const bitset_t *b1, const bitset_t *b2) {
+    if (b1->arraysize != b2->arraysize) return false;
+    return memcmp(b1->array, b2->array, b1->arraysize * sizeof(uint64_t)) ==
+           0;
+}
+
+/* The parallel variants must agree with the sequential ones, whatever the
+number of threads and however the lengths fall on chunk boundaries. */
+void test_parallel_ops() {
+    const size_t chunk = 1 << 15;  // words per chunk in src/bitset.c
+    const size_t lengths[] = {10, chunk, 3 * chunk + 77, 5 * chunk};
+    const size_t nlengths = sizeof(lengths) / sizeof(lengths[0]);
+    const size_t threads[] = {0, 1, 3, 8};
+    uint64_t seed = 42;
+    for (size_t i = 0; i < nlengths; i++) {
+        for (size_t j = 0; j < nlengths; j++) {
+            bitset_t *b1 = make_random_words(lengths[i], (int)(i % 3), &seed);
+            bitset_t *b2 = make_random_words(lengths[j], (int)(j % 3) + 1,
+                                             &seed);
+            size_t card = bitset_count(b1);
+            uint32_t *expected =
+                (uint32_t *)malloc((card + 1) * sizeof(uint32_t));
+            uint32_t *out = (uint32_t *)malloc((card + 1) * sizeof(uint32_t));
+            size_t n = 0;
+            for (size_t x = 0; bitset_next_set_bit(b1, &x); x++) {
+                expected[n++] = (uint32_t)x;
+            }
+            assert_true(n == card);
+
+            bitset_t *uni = bitset_copy(b1);
+            bitset_t *inter = bitset_copy(b1);
+            bitset_t *diff = bitset_copy(b1);
+            assert_true(bitset_inplace_union(uni, b2));
+            bitset_inplace_intersection(inter, b2);
+            bitset_inplace_difference(diff, b2);
+            for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); t++) {
+                assert_true(bitset_count_parallel(b1, threads[t]) == card);
+                assert_true(bitset_extract_setbits_parallel(b1, out,
+                                                            threads[t]) ==
+                            card);
+                assert_true(memcmp(out, expected, card * sizeof(uint32_t)) ==
+                            0);
+
+                bitset_t *r = bitset_copy(b1);
+                assert_true(bitset_inplace_union_parallel(r, b2, threads[t]));
+                assert_true(bitsets_equal(r, uni));
+                bitset_free(r);
+                r = bitset_copy(b1);
+                bitset_inplace_intersection_parallel(r, b2, threads[t]);
+                assert_true(bitsets_equal(r, inter));
+                bitset_free(r);
+                r = bitset_copy(b1);
+                bitset_inplace_difference_parallel(r, b2, threads[t]);
+                assert_true(bitsets_equal(r, diff));
+                bitset_free(r);
+            }
+            bitset_free(uni);
+            bitset_free(inter);
+            bitset_free(diff);
+            free(expected);
+            free(out);
+            bitset_free(b1);
+            bitset_free(b2);
+        }
+    }
+}
+
+bool count_values(size_t value, void *param) {
+    (void)value;
+    *(size_t *)param += 1;
+    return true;
+}
+
+void test_view() {
+    uint64_t words[100];
+    for (size_t i = 0; i < 100; i++) {
+        words[i] = i % 3 == 0 ? UINT64_C(0x8000000000000001) : 0;
+    }
+    bitset_t view;
+    assert_true(bitset_view_init(&view, words, 100));
+    assert_true(bitset_is_view(&view));
+    assert_true(view.array == words);  // no copy
+    assert_true(bitset_count(&view) == 68);
+    assert_true(bitset_get(&view, 63) && bitset_get(&view, 192));
+    assert_true(!bitset_get(&view, 64));
+    assert_true(bitset_minimum(&view) == 0);
+    assert_true(bitset_maximum(&view) == 99 * 64 + 63);
+
+    size_t buffer[8];
+    size_t startfrom = 0;
+    assert_true(bitset_next_set_bits(&view, buffer, 8, &startfrom) == 8);
+    assert_true(buffer[2] == 192 && buffer[7] == 9 * 64 + 63);
+    size_t visited = 0;
+    assert_true(bitset_for_each(&view, count_values, &visited));
+    assert_true(visited == 68);
+
+    bitset_t *owned = bitset_create();
+    for (size_t i = 0; i < 100 * 64; i += 64) bitset_set(owned, i);
+    assert_true(bitset_intersection_count(&view, owned) == 34);
+    assert_true(bitset_union_count(owned, &view) == 134);
+    assert_true(bitset_contains_all(owned, &view) == false);
+    // a view can be the read-only operand of an in-place operation
+    bitset_inplace_union(owned, &view);
+    assert_true(bitset_count(owned) == 134);
+    bitset_free(owned);
+
+    // copies own their memory
+    bitset_t *copy = bitset_copy(&view);
+    assert_true(!bitset_is_view(copy) && copy->array != words);
+    assert_true(bitset_count(copy) == 68);
+    bitset_set(copy, 100 * 64);
+    bitset_free(copy);
+
+    // views cannot be resized, and the external memory is left alone
+    assert_true(!bitset_resize(&view, 200, true));
+    assert_true(!bitset_grow(&view, 200));
+    assert_true(!bitset_trim(&view));
+    assert_true(view.array == words && view.arraysize == 100);
+    // nor modified: the words stay as they were
+    bitset_t *other = bitset_create_with_capacity(200 * 64);
+    bitset_fill(other);
+    bitset_set(&view, 64);
+    bitset_set(&view, 200 * 64);
+    bitset_set_to_value(&view, 0, false);
+    bitset_clear(&view);
+    bitset_fill(&view);
+    bitset_shift_left(&view, 3);
+    bitset_shift_right(&view, 3);
+    assert_true(!bitset_inplace_union(&view, other));
+    assert_true(!bitset_inplace_symmetric_difference(&view, other));
+    bitset_inplace_intersection(&view, other);
+    bitset_inplace_difference(&view, other);
+    assert_true(!bitset_inplace_union_parallel(&view, other, 4));
+    bitset_inplace_intersection_parallel(&view, other, 4);
+    bitset_inplace_difference_parallel(&view, other, 4);
+    assert_true(view.array == words && view.arraysize == 100);
+    for (size_t i = 0; i < 100; i++) {
+        assert_true(words[i] ==
+                    (i % 3 == 0 ? UINT64_C(0x8000000000000001) : 0));
+    }
+
+    assert_true(!bitset_view_init(&view, (const uint64_t *)((char *)words + 4),
+                                  10));
+    // empty views are views too, and do not allocate when written to
+    assert_true(bitset_view_init(&view, words, 0));
+    assert_true(bitset_count(&view) == 0 && bitset_is_view(&view));
+    bitset_set(&view, 10);
+    assert_true(!bitset_inplace_union(&view, other));
+    assert_true(view.array == NULL && view.arraysize == 0);
+    assert_true(bitset_is_view(&view));
+    bitset_free(other);
+}
+
 int main() {
     test_set_to_val();
     test_construct();
@@ -274,5 +510,8 @@ int main() {
     test_intersects();
     test_contains_all();
     test_contains_all_different_sizes();
+    test_large_ops();
+    test_parallel_ops();
+    test_view();
     printf("All asserts passed. Code is probably ok.\n");
 }
@@ -776,6 +776,16 @@ DEFINE_TEST(test_cpp_contains_bulk) {
     }
 }
 
+DEFINE_TEST(test_cpp_contains_many) {
+    std::vector<uint32_t> values = {10,         123,        2000,
+                                    9999,       0xFFFFFFF,  0xFFFFFFF7,
+                                    0xFFFFFFF9, 0xFFFFFFFF, 123};
+    Roaring r = Roaring::bitmapOf(4, 9999, 123, 0xFFFFFFFF, 0xFFFFFFF7);
+    uint64_t bits = 0;
+    r.containsMany(values.size(), values.data(), &bits);
+    assert_int_equal(bits, 0x1AA);
+}
+
 DEFINE_TEST(test_cpp_remove_range) {
     {
         // min < r1.minimum, max > r1.maximum
@@ -2160,6 +2170,37 @@ DEFINE_TEST(test_cpp_copy_map_iterator_to_different_map) {
     assert_int_equal(2, n);
 }
 
+DEFINE_TEST(test_cpp_container_range) {
+    Roaring r;
+    r.addRange(0, 100000);
+    for (uint32_t v = 0; v < 100; v++) {
+        r.add(5 * 65536 + v * 10);
+    }
+    r.runOptimize();
+    size_t n = 0;
+    uint64_t cardinality = 0;
+    for (const auto &view : r.containers()) {
+        assert_int_equal(view.key, r.roaring.high_low_container.keys[n]);
+        cardinality += view.cardinality;
+        n++;
+    }
+    assert_true(n == r.containers().size());
+    assert_true(n == 3);
+    assert_true(cardinality == r.cardinality());
+
+    auto it = r.containers().begin();
+    assert_int_equal(it->typecode, ROARING_CONTAINER_TYPE_RUN);
+    it++;
+    assert_int_equal(it->typecode, ROARING_CONTAINER_TYPE_RUN);
+    ++it;
+    assert_int_equal(it->typecode, ROARING_CONTAINER_TYPE_ARRAY);
+    assert_int_equal(((const uint16_t *)it->data)[1], 10);
+    assert_true(++it == r.containers().end());
+
+    Roaring empty;
+    assert_true(empty.containers().begin() == empty.containers().end());
+}
+
 int main() {
     roaring::misc::tellmeall();
     const struct CMUnitTest tests[] = {
@@ -2188,6 +2229,7 @@ int main() {
         cmocka_unit_test(test_cpp_add_range_closed_combinatoric_64),
         cmocka_unit_test(test_cpp_add_bulk),
         cmocka_unit_test(test_cpp_contains_bulk),
+        cmocka_unit_test(test_cpp_contains_many),
         cmocka_unit_test(test_cpp_rank_many),
         cmocka_unit_test(test_cpp_remove_range_closed_64),
         cmocka_unit_test(test_cpp_remove_range_64),
@@ -2237,6 +2279,7 @@ int main() {
         cmocka_unit_test(test_cpp_remove_run_compression),
         cmocka_unit_test(test_cpp_contains_range_interleaved_containers),
         cmocka_unit_test(test_cpp_copy_map_iterator_to_different_map),
+        cmocka_unit_test(test_cpp_container_range),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
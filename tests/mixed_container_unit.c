@@ -1983,6 +1983,144 @@ DEFINE_TEST(run_negation_range_test9) {
                              false, false);
 }
 
+// The array values skip over many runs, or the runs over many array values.
+DEFINE_TEST(array_run_skewed_test) {
+    const int32_t strides[] = {1, 7, 61, 1000, 20000};
+    const int32_t run_gaps[] = {3, 40, 900, 30000};
+    for (size_t s = 0; s < sizeof(strides) / sizeof(strides[0]); s++) {
+        for (size_t g = 0; g < sizeof(run_gaps) / sizeof(run_gaps[0]); g++) {
+            array_container_t* a = array_container_create();
+            run_container_t* r = run_container_create();
+            for (int32_t x = 0; x < 65536; x += strides[s]) {
+                array_container_add(a, (uint16_t)x);
+            }
+            // runs of length gap / 3 starting every gap values, and a last
+            // one that ends the container
+            for (int32_t x = 5; x < 65536; x += run_gaps[g]) {
+                for (int32_t y = x; y <= x + run_gaps[g] / 3 && y < 65536;
+                     y++) {
+                    run_container_add(r, (uint16_t)y);
+                }
+            }
+            for (int32_t y = 65530; y < 65536; y++) {
+                run_container_add(r, (uint16_t)y);
+            }
+            int32_t inter = 0;
+            for (int32_t i = 0; i < a->cardinality; i++) {
+                inter += run_container_contains(r, a->array[i]);
+            }
+
+            array_container_t* out = array_container_create();
+            array_run_container_intersection(a, r, out);
+            assert_int_equal(out->cardinality, inter);
+            for (int32_t i = 0; i < out->cardinality; i++) {
+                assert_true(run_container_contains(r, out->array[i]));
+                assert_true(array_container_contains(a, out->array[i]));
+            }
+            assert_int_equal(array_run_container_intersection_cardinality(a, r),
+                             inter);
+            assert_int_equal(array_run_container_intersect(a, r), inter > 0);
+
+            array_run_container_andnot(a, r, out);
+            assert_int_equal(out->cardinality, a->cardinality - inter);
+            for (int32_t i = 0; i < out->cardinality; i++) {
+                assert_false(run_container_contains(r, out->array[i]));
+                assert_true(array_container_contains(a, out->array[i]));
+            }
+
+            array_container_free(out);
+            array_container_free(a);
+            run_container_free(r);
+        }
+    }
+}
+
+// Checks the array/bitset and run/bitset operations on the short and long
+// inputs that take different paths.
+DEFINE_TEST(array_run_bitset_sizes_test) {
+    const int32_t strides[] = {1, 3, 17, 1000, 30000};
+    const int32_t run_lengths[] = {0, 5, 16, 100, 3000};
+    bitset_container_t* b = bitset_container_create();
+    for (int32_t x = 0; x < 65536; x++) {
+        // dense stretches and sparse ones
+        if ((x / 4096) % 2 == 0 ? (x % 3 != 0) : (x % 61 == 0)) {
+            bitset_container_set(b, (uint16_t)x);
+        }
+    }
+    b->cardinality = bitset_container_compute_cardinality(b);
+    for (size_t s = 0; s < sizeof(strides) / sizeof(strides[0]); s++) {
+        array_container_t* a = array_container_create();
+        for (int32_t x = 1; x < 65536; x += strides[s]) {
+            array_container_add(a, (uint16_t)x);
+        }
+        int32_t inter = 0;
+        for (int32_t i = 0; i < a->cardinality; i++) {
+            inter += bitset_container_contains(b, a->array[i]);
+        }
+        array_container_t* out = array_container_create();
+        array_bitset_container_intersection(a, b, out);
+        assert_int_equal(out->cardinality, inter);
+        for (int32_t i = 0; i < out->cardinality; i++) {
+            assert_true(bitset_container_contains(b, out->array[i]));
+        }
+        assert_int_equal(array_bitset_container_intersection_cardinality(a, b),
+                         inter);
+        assert_int_equal(array_bitset_container_intersect(a, b), inter > 0);
+        array_bitset_container_andnot(a, b, out);
+        assert_int_equal(out->cardinality, a->cardinality - inter);
+        for (int32_t i = 0; i < out->cardinality; i++) {
+            assert_false(bitset_container_contains(b, out->array[i]));
+            assert_true(array_container_contains(a, out->array[i]));
+        }
+        array_container_free(out);
+        array_container_free(a);
+    }
+    for (size_t l = 0; l < sizeof(run_lengths) / sizeof(run_lengths[0]); l++) {
+        run_container_t* r = run_container_create();
+        for (int32_t x = 7; x + run_lengths[l] < 65536;
+             x += 2 * run_lengths[l] + 4099) {
+            for (int32_t y = x; y <= x + run_lengths[l]; y++) {
+                run_container_add(r, (uint16_t)y);
+            }
+        }
+        int32_t card = run_container_cardinality(r);
+        int32_t inter = 0;
+        for (int32_t x = 0; x < 65536; x++) {
+            inter += run_container_contains(r, (uint16_t)x) &&
+                     bitset_container_contains(b, (uint16_t)x);
+        }
+        container_t* out = NULL;
+        if (run_bitset_container_intersection(r, b, &out)) {
+            assert_int_equal(bitset_container_cardinality(CAST_bitset(out)),
+                             inter);
+            bitset_container_free(CAST_bitset(out));
+        } else {
+            array_container_t* ac = CAST_array(out);
+            assert_int_equal(ac->cardinality, inter);
+            for (int32_t i = 0; i < ac->cardinality; i++) {
+                assert_true(run_container_contains(r, ac->array[i]));
+                assert_true(bitset_container_contains(b, ac->array[i]));
+            }
+            array_container_free(ac);
+        }
+        if (run_bitset_container_andnot(r, b, &out)) {
+            assert_int_equal(bitset_container_cardinality(CAST_bitset(out)),
+                             card - inter);
+            bitset_container_free(CAST_bitset(out));
+        } else {
+            array_container_t* ac = CAST_array(out);
+            assert_int_equal(ac->cardinality, card - inter);
+            for (int32_t i = 0; i < ac->cardinality; i++) {
+                assert_true(run_container_contains(r, ac->array[i]));
+                assert_false(bitset_container_contains(b, ac->array[i]));
+            }
+            array_container_free(ac);
+        }
+        run_container_free(r);
+    }
+    bitset_container_free(b);
+}
+
 int main() {
     tellmeall();
 
@@ -1994,6 +2132,8 @@ int main() {
         cmocka_unit_test(run_andnot_test),
         cmocka_unit_test(run_iandnot_test),
         cmocka_unit_test(run_array_andnot_bug_test),
+        cmocka_unit_test(array_run_skewed_test),
+        cmocka_unit_test(array_run_bitset_sizes_test),
         cmocka_unit_test(array_bitset_ixor_test),
         cmocka_unit_test(array_bitset_iandnot_test),
         cmocka_unit_test(array_negation_empty_test),
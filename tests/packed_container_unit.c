@@ -0,0 +1,165 @@
+/*
+ * packed_container_unit.c
+ *
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <roaring/containers/containers.h>
+#include <roaring/containers/packed.h>
+#include <roaring/misc/configreport.h>
+
+#ifdef __cplusplus  // stronger type checking errors if C built in C++ mode
+using namespace roaring::internal;
+#endif
+
+#include "test.h"
+
+// fills values with `card' sorted values whose gaps are at most max_gap + 1
+static int32_t make_values(uint16_t* values, int32_t card, uint32_t max_gap,
+                           unsigned int seed) {
+    srand(seed);
+    uint32_t v = (uint32_t)rand() % 16;
+    int32_t n = 0;
+    while (n < card && v < (1 << 16)) {
+        values[n++] = (uint16_t)v;
+        v += 1 + (max_gap == 0 ? 0 : (uint32_t)rand() % (max_gap + 1));
+    }
+    return n;
+}
+
+static void check_against_array(const uint16_t* values, int32_t card) {
+    packed_container_t* P = packed_container_create_from_values(values, card);
+    assert_non_null(P);
+    const char* reason = NULL;
+    assert_true(packed_container_validate(P, &reason));
+    assert_int_equal(packed_container_cardinality(P), card);
+    assert_int_equal(packed_container_minimum(P), values[0]);
+    assert_int_equal(packed_container_maximum(P), values[card - 1]);
+
+    uint16_t* decoded = (uint16_t*)malloc((card + 1) * sizeof(uint16_t));
+    decoded[card] = 0xCAFE;  // canary
+    packed_container_decode(P, decoded);
+    assert_true(memcmp(decoded, values, card * sizeof(uint16_t)) == 0);
+    assert_int_equal(decoded[card], 0xCAFE);
+
+    for (int32_t i = 0; i < card; i++) {
+        assert_int_equal(packed_container_get(P, i), values[i]);
+    }
+    int32_t index = 0;
+    for (uint32_t x = 0; x < (1 << 16); x++) {
+        while (index < card && values[index] < x) index++;
+        bool present = index < card && values[index] == x;
+        assert_int_equal(packed_container_contains(P, (uint16_t)x), present);
+        assert_int_equal(packed_container_get_index(P, (uint16_t)x),
+                         present ? index : -1);
+        assert_int_equal(packed_container_rank(P, (uint16_t)x),
+                         present ? index + 1 : index);
+        assert_int_equal(
+            packed_container_index_equalorlarger(P, (uint16_t)x),
+            index < card ? index : -1);
+    }
+
+    int32_t runs = 0;
+    for (int32_t i = 0; i < card; i++) {
+        if (i == 0 || values[i] != values[i - 1] + 1) runs++;
+    }
+    assert_int_equal(packed_container_number_of_runs(P), runs);
+
+    char* buf = (char*)malloc(packed_container_size_in_bytes(P));
+    assert_int_equal(packed_container_write(P, buf),
+                     packed_container_size_in_bytes(P));
+    assert_true(memcmp(buf, values, card * sizeof(uint16_t)) == 0);
+    free(buf);
+
+    packed_container_t* Q = packed_container_clone(P);
+    assert_true(packed_container_equals(P, Q));
+    packed_container_free(Q);
+
+    free(decoded);
+    packed_container_free(P);
+}
+
+DEFINE_TEST(printf_test) {
+    uint16_t values[] = {1, 2, 3, 10, 10000};
+    packed_container_t* P = packed_container_create_from_values(values, 5);
+    assert_non_null(P);
+
+    packed_container_printf(P);
+    printf("\n");
+    packed_container_printf_as_uint32_array(P, 1 << 16);
+    printf("\n");
+
+    packed_container_free(P);
+}
+
+DEFINE_TEST(all_widths_test) {
+    uint16_t* values = (uint16_t*)malloc(DEFAULT_MAX_SIZE * sizeof(uint16_t));
+    // a maximal gap of 2^w - 1 needs w bits
+    for (uint32_t width = 0; width <= 16; width++) {
+        uint32_t max_gap = width == 0 ? 0 : (UINT32_C(1) << width) - 1;
+        int32_t card = make_values(values, DEFAULT_MAX_SIZE, max_gap, width);
+        check_against_array(values, card);
+    }
+    free(values);
+}
+
+DEFINE_TEST(block_boundaries_test) {
+    uint16_t* values = (uint16_t*)malloc(DEFAULT_MAX_SIZE * sizeof(uint16_t));
+    int32_t cards[] = {1, 2, 31, 32, 33, 63, 64, 65, 4095, 4096};
+    for (size_t i = 0; i < sizeof(cards) / sizeof(cards[0]); i++) {
+        int32_t card = make_values(values, cards[i], 13, (unsigned int)i);
+        assert_int_equal(card, cards[i]);
+        check_against_array(values, card);
+    }
+    // extreme values
+    uint16_t ends[] = {0, 65535};
+    check_against_array(ends, 2);
+    for (int32_t i = 0; i < 40; i++) values[i] = (uint16_t)(65535 - 39 + i);
+    check_against_array(values, 40);
+    free(values);
+}
+
+DEFINE_TEST(convert_test) {
+    array_container_t* A = array_container_create();
+    uint8_t type;
+
+    // a single value costs more packed
+    array_container_add(A, 7);
+    container_t* c = convert_array_to_packed_if_smaller(A, &type);
+    assert_ptr_equal(c, A);
+    assert_int_equal(type, ARRAY_CONTAINER_TYPE);
+
+    for (uint32_t x = 0; x < (1 << 16); x += 17) {
+        array_container_add(A, (uint16_t)x);
+    }
+    array_container_t* copy = array_container_clone(A);
+    c = convert_array_to_packed_if_smaller(A, &type);  // frees A
+    assert_int_equal(type, PACKED_CONTAINER_TYPE);
+    packed_container_t* P = CAST_packed(c);
+    assert_true(packed_container_memory_size_in_bytes(P) <
+                array_container_size_in_bytes(copy));
+
+    array_container_t* B = array_container_from_packed(P);
+    assert_true(array_container_equals(B, copy));
+
+    packed_container_free(P);
+    array_container_free(B);
+    array_container_free(copy);
+}
+
+int main() {
+    tellmeall();
+
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(printf_test),
+        cmocka_unit_test(all_widths_test),
+        cmocka_unit_test(block_boundaries_test),
+        cmocka_unit_test(convert_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -225,6 +225,48 @@ DEFINE_TEST(test_add_many) {
         assert_int_equal(roaring64_bitmap_get_cardinality(r), 1);
         roaring64_bitmap_free(r);
     }
+    {
+        // Sorted values are loaded in bulk: check against single adds.
+        std::vector<uint64_t> vals;
+        for (uint64_t i = 0; i < 300; ++i) {
+            vals.push_back(i << 16);  // a node256 of leaves
+        }
+        for (uint64_t i = 0; i < 20; ++i) {
+            vals.push_back((uint64_t(1) << 40) + (i << 24) + i);  // a node16
+        }
+        for (uint64_t i = 0; i < 10000; ++i) {
+            vals.push_back((uint64_t(3) << 40) + i);  // a bitset
+        }
+        for (uint64_t i = 0; i < 5000; ++i) {
+            // Duplicates making an array
+            vals.push_back((uint64_t(4) << 40) + i / 2);
+        }
+        vals.push_back(UINT64_MAX - 1);
+        vals.push_back(UINT64_MAX);
+        vals.push_back(UINT64_MAX);
+
+        roaring64_bitmap_t* r = roaring64_bitmap_create();
+        roaring64_bitmap_add_many(r, vals.size(), vals.data());
+        assert_r64_valid(r);
+        roaring64_bitmap_t* expected = roaring64_bitmap_create();
+        for (uint64_t v : vals) {
+            roaring64_bitmap_add(expected, v);
+        }
+        assert_true(roaring64_bitmap_equals(r, expected));
+        assert_int_equal(roaring64_bitmap_get_cardinality(r),
+                         300 + 20 + 10000 + 2500 + 2);
+        roaring64_bitmap_free(expected);
+
+        // Adding to a bitmap that is not empty goes through the ART.
+        uint64_t more[] = {5, 1 << 16, uint64_t(2) << 40};
+        roaring64_bitmap_add_many(r, 3, more);
+        assert_r64_valid(r);
+        assert_true(roaring64_bitmap_contains(r, 5));
+        assert_true(roaring64_bitmap_contains(r, uint64_t(2) << 40));
+        assert_int_equal(roaring64_bitmap_get_cardinality(r),
+                         300 + 20 + 10000 + 2500 + 2 + 2);
+        roaring64_bitmap_free(r);
+    }
 }
 
 DEFINE_TEST(test_add_range_closed) {
@@ -787,6 +829,52 @@ DEFINE_TEST(test_run_optimize) {
     roaring64_bitmap_free(r);
 }
 
+DEFINE_TEST(test_statistics) {
+    roaring64_bitmap_t* r = roaring64_bitmap_create();
+    roaring64_statistics_t stats;
+    roaring64_bitmap_statistics(r, &stats);
+    assert_int_equal(stats.n_containers, 0);
+    assert_int_equal(stats.cardinality, 0);
+    assert_int_equal(stats.n_art_node4, 0);
+    assert_int_equal(stats.n_bytes_leaves, 0);
+    assert_true(stats.n_bytes_total > 0);
+
+    // An array, a bitset and a run container, and a removed container.
+    roaring64_bitmap_add(r, 5);
+    roaring64_bitmap_add(r, 7);
+    for (uint64_t i = 0; i < 10000; ++i) {
+        roaring64_bitmap_add(r, (1ULL << 32) + 2 * i);
+    }
+    roaring64_bitmap_add_range_closed(r, 1ULL << 48, (1ULL << 48) + 50000);
+    roaring64_bitmap_run_optimize(r);
+    roaring64_bitmap_add(r, 1ULL << 40);
+    roaring64_bitmap_remove(r, 1ULL << 40);
+
+    roaring64_bitmap_statistics(r, &stats);
+    assert_int_equal(stats.n_containers, 3);
+    assert_int_equal(stats.n_array_containers, 1);
+    assert_int_equal(stats.n_bitset_containers, 1);
+    assert_int_equal(stats.n_run_containers, 1);
+    assert_int_equal(stats.n_values_array_containers, 2);
+    assert_int_equal(stats.n_values_bitset_containers, 10000);
+    assert_int_equal(stats.n_values_run_containers, 50001);
+    assert_int_equal(stats.n_bytes_array_containers, 2 * sizeof(uint16_t));
+    assert_int_equal(stats.n_bytes_bitset_containers, 8192);
+    assert_int_equal(stats.cardinality, roaring64_bitmap_get_cardinality(r));
+    assert_int_equal(stats.min_value, 5);
+    assert_int_equal(stats.max_value, (1ULL << 48) + 50000);
+    assert_int_equal(stats.n_art_node4, 2);
+    assert_int_equal(
+        stats.n_art_node16 + stats.n_art_node48 + stats.n_art_node256, 0);
+    assert_true(stats.n_bytes_leaves > 0);
+    assert_true(stats.n_bytes_containers > 8192);
+    assert_true(stats.n_bytes_total > stats.n_bytes_art +
+                                          stats.n_bytes_leaves +
+                                          stats.n_bytes_containers);
+
+    roaring64_bitmap_free(r);
+}
+
 DEFINE_TEST(test_equals) {
     roaring64_bitmap_t* r1 = roaring64_bitmap_create();
     roaring64_bitmap_t* r2 = roaring64_bitmap_create();
@@ -1275,6 +1363,258 @@ DEFINE_TEST(test_andnot_inplace) {
     }
 }
 
+DEFINE_TEST(test_sparse_dense_ops) {
+    // One value in each of many containers, against a few values spread far
+    // apart, so that the operations skip most of the leaves of the dense
+    // bitmap.
+    roaring64_bitmap_t* dense = roaring64_bitmap_create();
+    for (uint64_t i = 0; i < 100000; ++i) {
+        roaring64_bitmap_add(dense, i << 16);
+    }
+    roaring64_bitmap_t* sparse = roaring64_bitmap_create();
+    uint64_t sparse_values[] = {5, 1000ULL << 16, 54321ULL << 16,
+                                (99999ULL << 16) + 1, 1ULL << 40};
+    for (uint64_t v : sparse_values) {
+        roaring64_bitmap_add(sparse, v);
+    }
+
+    roaring64_bitmap_t* r = roaring64_bitmap_and(dense, sparse);
+    assert_r64_valid(r);
+    assert_int_equal(roaring64_bitmap_get_cardinality(r), 2);
+    assert_true(roaring64_bitmap_contains(r, 1000ULL << 16));
+    assert_true(roaring64_bitmap_contains(r, 54321ULL << 16));
+    roaring64_bitmap_free(r);
+
+    assert_int_equal(roaring64_bitmap_and_cardinality(dense, sparse), 2);
+    assert_true(roaring64_bitmap_intersect(dense, sparse));
+    assert_false(roaring64_bitmap_is_subset(sparse, dense));
+
+    r = roaring64_bitmap_andnot(sparse, dense);
+    assert_r64_valid(r);
+    assert_int_equal(roaring64_bitmap_get_cardinality(r), 3);
+    assert_true(roaring64_bitmap_contains(r, 5));
+    assert_true(roaring64_bitmap_contains(r, (99999ULL << 16) + 1));
+    assert_true(roaring64_bitmap_contains(r, 1ULL << 40));
+    roaring64_bitmap_free(r);
+
+    r = roaring64_bitmap_andnot(dense, sparse);
+    assert_r64_valid(r);
+    assert_int_equal(roaring64_bitmap_get_cardinality(r), 99998);
+    assert_false(roaring64_bitmap_contains(r, 1000ULL << 16));
+    assert_true(roaring64_bitmap_contains(r, 99999ULL << 16));
+
+    roaring64_bitmap_t* copy = roaring64_bitmap_copy(dense);
+    roaring64_bitmap_andnot_inplace(copy, sparse);
+    assert_r64_valid(copy);
+    assert_true(roaring64_bitmap_equals(copy, r));
+    roaring64_bitmap_free(copy);
+    roaring64_bitmap_free(r);
+
+    roaring64_bitmap_andnot_inplace(sparse, dense);
+    assert_r64_valid(sparse);
+    assert_int_equal(roaring64_bitmap_get_cardinality(sparse), 3);
+    assert_false(roaring64_bitmap_intersect(dense, sparse));
+    assert_false(roaring64_bitmap_is_subset(sparse, dense));
+
+    roaring64_bitmap_remove(sparse, 5);
+    roaring64_bitmap_remove(sparse, (99999ULL << 16) + 1);
+    roaring64_bitmap_remove(sparse, 1ULL << 40);
+    roaring64_bitmap_add(sparse, 777ULL << 16);
+    assert_true(roaring64_bitmap_is_subset(sparse, dense));
+
+    roaring64_bitmap_free(sparse);
+    roaring64_bitmap_free(dense);
+}
+
+// Bitmaps sharing some of their keys, with array, bitset and run containers.
+std::vector<roaring64_bitmap_t*> make_many_bitmaps(size_t number) {
+    std::vector<roaring64_bitmap_t*> rs;
+    uint64_t seed = 1234;
+    for (size_t i = 0; i < number; ++i) {
+        roaring64_bitmap_t* r = roaring64_bitmap_create();
+        for (uint64_t key = 0; key < 40; ++key) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            uint64_t base = (key << 16) + ((key % 7) << 36);
+            switch ((seed >> 33) % 4) {
+                case 0:
+                    break;
+                case 1:  // array
+                    for (uint64_t j = 0; j < 100; ++j) {
+                        roaring64_bitmap_add(r, base + ((seed >> (j % 16)) %
+                                                        (1 << 16)));
+                    }
+                    break;
+                case 2:  // bitset
+                    for (uint64_t j = i; j < (1 << 16); j += 3) {
+                        roaring64_bitmap_add(r, base + j);
+                    }
+                    break;
+                case 3:  // run
+                    roaring64_bitmap_add_range_closed(r, base + 1000 * i,
+                                                      base + 40000);
+                    roaring64_bitmap_run_optimize(r);
+                    break;
+            }
+        }
+        rs.push_back(r);
+    }
+    return rs;
+}
+
+DEFINE_TEST(test_or_many) {
+    roaring64_bitmap_t* empty = roaring64_bitmap_or_many(0, nullptr);
+    assert_true(roaring64_bitmap_is_empty(empty));
+    roaring64_bitmap_free(empty);
+
+    for (size_t number = 1; number <= 9; ++number) {
+        std::vector<roaring64_bitmap_t*> rs = make_many_bitmaps(number);
+        roaring64_bitmap_t* expected = roaring64_bitmap_create();
+        for (roaring64_bitmap_t* r : rs) {
+            roaring64_bitmap_or_inplace(expected, r);
+        }
+        roaring64_bitmap_t* actual = roaring64_bitmap_or_many(
+            number, (const roaring64_bitmap_t**)rs.data());
+        assert_r64_valid(actual);
+        assert_true(roaring64_bitmap_equals(actual, expected));
+        roaring64_bitmap_free(actual);
+        roaring64_bitmap_free(expected);
+        for (roaring64_bitmap_t* r : rs) {
+            roaring64_bitmap_free(r);
+        }
+    }
+}
+
+DEFINE_TEST(test_and_many) {
+    roaring64_bitmap_t* empty = roaring64_bitmap_and_many(0, nullptr);
+    assert_true(roaring64_bitmap_is_empty(empty));
+    roaring64_bitmap_free(empty);
+
+    for (size_t number = 1; number <= 9; ++number) {
+        std::vector<roaring64_bitmap_t*> rs = make_many_bitmaps(number);
+        // Make sure that the intersection is not empty.
+        for (roaring64_bitmap_t* r : rs) {
+            roaring64_bitmap_add_range_closed(r, 1ULL << 40,
+                                              (1ULL << 40) + 100000);
+        }
+        roaring64_bitmap_t* expected = roaring64_bitmap_copy(rs[0]);
+        for (roaring64_bitmap_t* r : rs) {
+            roaring64_bitmap_and_inplace(expected, r);
+        }
+        roaring64_bitmap_t* actual = roaring64_bitmap_and_many(
+            number, (const roaring64_bitmap_t**)rs.data());
+        assert_r64_valid(actual);
+        assert_false(roaring64_bitmap_is_empty(actual));
+        assert_true(roaring64_bitmap_equals(actual, expected));
+        roaring64_bitmap_free(actual);
+        roaring64_bitmap_free(expected);
+
+        // One empty bitmap empties the intersection.
+        rs.push_back(roaring64_bitmap_create());
+        actual = roaring64_bitmap_and_many(
+            rs.size(), (const roaring64_bitmap_t**)rs.data());
+        assert_true(roaring64_bitmap_is_empty(actual));
+        roaring64_bitmap_free(actual);
+        for (roaring64_bitmap_t* r : rs) {
+            roaring64_bitmap_free(r);
+        }
+    }
+}
+
+DEFINE_TEST(test_xor_many) {
+    roaring64_bitmap_t* empty = roaring64_bitmap_xor_many(0, nullptr);
+    assert_true(roaring64_bitmap_is_empty(empty));
+    roaring64_bitmap_free(empty);
+
+    for (size_t number = 1; number <= 9; ++number) {
+        std::vector<roaring64_bitmap_t*> rs = make_many_bitmaps(number);
+        roaring64_bitmap_t* expected = roaring64_bitmap_create();
+        for (roaring64_bitmap_t* r : rs) {
+            roaring64_bitmap_xor_inplace(expected, r);
+        }
+        roaring64_bitmap_t* actual = roaring64_bitmap_xor_many(
+            number, (const roaring64_bitmap_t**)rs.data());
+        assert_r64_valid(actual);
+        assert_true(roaring64_bitmap_equals(actual, expected));
+        roaring64_bitmap_free(actual);
+        roaring64_bitmap_free(expected);
+        for (roaring64_bitmap_t* r : rs) {
+            roaring64_bitmap_free(r);
+        }
+    }
+    // Containers cancelling out are dropped.
+    roaring64_bitmap_t* r = roaring64_bitmap_from_range(0, 1 << 20, 3);
+    const roaring64_bitmap_t* rs[] = {r, r, r, r};
+    roaring64_bitmap_t* actual = roaring64_bitmap_xor_many(4, rs);
+    assert_r64_valid(actual);
+    assert_true(roaring64_bitmap_is_empty(actual));
+    roaring64_bitmap_free(actual);
+    roaring64_bitmap_free(r);
+}
+
+DEFINE_TEST(test_lazy_or) {
+    std::vector<roaring64_bitmap_t*> rs = make_many_bitmaps(8);
+    for (bool bitsetconversion : {false, true}) {
+        roaring64_bitmap_t* expected = roaring64_bitmap_or(rs[0], rs[1]);
+        roaring64_bitmap_t* actual =
+            roaring64_bitmap_lazy_or(rs[0], rs[1], bitsetconversion);
+        roaring64_bitmap_repair_after_lazy(actual);
+        assert_r64_valid(actual);
+        assert_true(roaring64_bitmap_equals(actual, expected));
+        roaring64_bitmap_free(actual);
+
+        actual = roaring64_bitmap_lazy_or(rs[0], rs[1], bitsetconversion);
+        for (size_t i = 2; i < rs.size(); ++i) {
+            roaring64_bitmap_or_inplace(expected, rs[i]);
+            roaring64_bitmap_lazy_or_inplace(actual, rs[i], bitsetconversion);
+        }
+        roaring64_bitmap_repair_after_lazy(actual);
+        assert_r64_valid(actual);
+        assert_true(roaring64_bitmap_equals(actual, expected));
+        roaring64_bitmap_free(actual);
+
+        // Starting from an empty bitmap.
+        actual = roaring64_bitmap_create();
+        for (roaring64_bitmap_t* r : rs) {
+            roaring64_bitmap_lazy_or_inplace(actual, r, bitsetconversion);
+        }
+        roaring64_bitmap_repair_after_lazy(actual);
+        assert_r64_valid(actual);
+        assert_true(roaring64_bitmap_equals(actual, expected));
+        roaring64_bitmap_free(actual);
+        roaring64_bitmap_free(expected);
+    }
+    for (roaring64_bitmap_t* r : rs) {
+        roaring64_bitmap_free(r);
+    }
+}
+
+DEFINE_TEST(test_lazy_xor) {
+    std::vector<roaring64_bitmap_t*> rs = make_many_bitmaps(8);
+    roaring64_bitmap_t* expected = roaring64_bitmap_xor(rs[0], rs[1]);
+    roaring64_bitmap_t* actual = roaring64_bitmap_lazy_xor(rs[0], rs[1]);
+    for (size_t i = 2; i < rs.size(); ++i) {
+        roaring64_bitmap_xor_inplace(expected, rs[i]);
+        roaring64_bitmap_lazy_xor_inplace(actual, rs[i]);
+    }
+    roaring64_bitmap_repair_after_lazy(actual);
+    assert_r64_valid(actual);
+    assert_true(roaring64_bitmap_equals(actual, expected));
+
+    // Containers cancelling out are dropped.
+    for (size_t i = 0; i < rs.size(); ++i) {
+        roaring64_bitmap_lazy_xor_inplace(actual, rs[i]);
+    }
+    roaring64_bitmap_repair_after_lazy(actual);
+    assert_r64_valid(actual);
+    assert_true(roaring64_bitmap_is_empty(actual));
+
+    roaring64_bitmap_free(actual);
+    roaring64_bitmap_free(expected);
+    for (roaring64_bitmap_t* r : rs) {
+        roaring64_bitmap_free(r);
+    }
+}
+
 DEFINE_TEST(test_flip) {
     {
         // Flipping an empty bitmap should result in a non-empty range.
@@ -1805,6 +2145,7 @@ int main() {
         cmocka_unit_test(test_minimum),
         cmocka_unit_test(test_maximum),
         cmocka_unit_test(test_run_optimize),
+        cmocka_unit_test(test_statistics),
         cmocka_unit_test(test_equals),
         cmocka_unit_test(test_is_subset),
         cmocka_unit_test(test_is_strict_subset),
@@ -1822,6 +2163,12 @@ int main() {
         cmocka_unit_test(test_andnot),
         cmocka_unit_test(test_andnot_cardinality),
         cmocka_unit_test(test_andnot_inplace),
+        cmocka_unit_test(test_sparse_dense_ops),
+        cmocka_unit_test(test_or_many),
+        cmocka_unit_test(test_and_many),
+        cmocka_unit_test(test_xor_many),
+        cmocka_unit_test(test_lazy_or),
+        cmocka_unit_test(test_lazy_xor),
         cmocka_unit_test(test_flip),
         cmocka_unit_test(test_flip_inplace),
         cmocka_unit_test(test_portable_serialize),
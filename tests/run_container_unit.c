@@ -6,6 +6,7 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <roaring/containers/run.h>
 #include <roaring/misc/configreport.h>
@@ -83,6 +84,37 @@ DEFINE_TEST(add_contains_test) {
     run_container_free(B);
 }
 
+// Exercises every search path, including the vectorized ones, against a
+// plain membership table.
+DEFINE_TEST(contains_all_sizes_test) {
+    const int32_t sizes[] = {0, 1, 2, 7, 8, 9, 15, 16, 17, 31, 32, 100, 1000};
+    bool* present = (bool*)malloc(65536 * sizeof(bool));
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        run_container_t* B = run_container_create_given_capacity(sizes[s]);
+        memset(present, 0, 65536 * sizeof(bool));
+        const uint32_t stride = 65536 / (sizes[s] + 1);
+        for (int32_t i = 0; i < sizes[s]; i++) {
+            // runs of varied lengths, the first one starting at 0 and the
+            // last one ending at 65535
+            const uint32_t start = i * stride;
+            uint32_t end = start + (i * 7) % (stride - 1);
+            if (i == sizes[s] - 1) end = 65535;
+            B->runs[i].value = (uint16_t)start;
+            B->runs[i].length = (uint16_t)(end - start);
+            B->n_runs++;
+            B->cardinality += end - start + 1;
+            for (uint32_t v = start; v <= end; v++) present[v] = true;
+        }
+        assert_int_equal(B->n_runs, sizes[s]);
+        for (uint32_t v = 0; v < 65536; v++) {
+            assert_int_equal(run_container_contains(B, (uint16_t)v),
+                             present[v]);
+        }
+        run_container_free(B);
+    }
+    free(present);
+}
+
 DEFINE_TEST(and_or_test) {
     run_container_t* B1 = run_container_create();
     run_container_t* B2 = run_container_create();
@@ -124,6 +156,93 @@ DEFINE_TEST(and_or_test) {
     run_container_free(TMP);
 }
 
+// Fills B with n_runs runs of at most max_length values spread over
+// [0, 65536), and marks their values in present.
+static void fill_random_runs(run_container_t* B, bool* present, int32_t n_runs,
+                             uint32_t max_length) {
+    memset(present, 0, 65536 * sizeof(bool));
+    B->n_runs = 0;
+    B->cardinality = 0;
+    run_container_grow(B, n_runs, false);
+    const uint32_t stride = 65536 / n_runs;
+    for (int32_t i = 0; i < n_runs; i++) {
+        // at least one missing value after each run, so that no two runs are
+        // adjacent
+        uint32_t length = (uint32_t)rand() % max_length;
+        if (length > stride - 2) length = stride - 2;
+        const uint32_t start =
+            i * stride + (uint32_t)rand() % (stride - 1 - length);
+        B->runs[B->n_runs++] = MAKE_RLE16(start, length);
+        B->cardinality += length + 1;
+        for (uint32_t v = start; v <= start + length; v++) present[v] = true;
+    }
+}
+
+static void assert_run_matches(const run_container_t* B, const bool* present) {
+    int32_t card = 0;
+    for (uint32_t v = 0; v < 65536; v++) {
+        assert_int_equal(run_container_contains(B, (uint16_t)v), present[v]);
+        card += present[v];
+    }
+    assert_int_equal(run_container_cardinality(B), card);
+    for (int32_t i = 1; i < B->n_runs; i++) {
+        // the results must be normalized: sorted, disjoint and not adjacent
+        assert_true(B->runs[i].value >
+                    B->runs[i - 1].value + B->runs[i - 1].length + 1);
+    }
+}
+
+// Checks the merges on inputs with very different numbers of runs, where they
+// skip over many runs at once, and on inputs with similar numbers of runs.
+DEFINE_TEST(skewed_operations_test) {
+    const int32_t n_runs[] = {1, 2, 16, 100, 930, 5000, 16384};
+    const size_t count = sizeof(n_runs) / sizeof(n_runs[0]);
+    bool* p1 = (bool*)malloc(65536 * sizeof(bool));
+    bool* p2 = (bool*)malloc(65536 * sizeof(bool));
+    bool* expected = (bool*)malloc(65536 * sizeof(bool));
+    run_container_t* B1 = run_container_create();
+    run_container_t* B2 = run_container_create();
+    run_container_t* out = run_container_create();
+    srand(1234);
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < count; j++) {
+            fill_random_runs(B1, p1, n_runs[i], 1 + 32768 / n_runs[i]);
+            fill_random_runs(B2, p2, n_runs[j], 1 + 32768 / n_runs[j]);
+            int32_t inter = 0;
+            for (uint32_t v = 0; v < 65536; v++) {
+                expected[v] = p1[v] || p2[v];
+                inter += p1[v] && p2[v];
+            }
+            run_container_union(B1, B2, out);
+            assert_run_matches(out, expected);
+            run_container_copy(B1, out);
+            run_container_union_inplace(out, B2);
+            assert_run_matches(out, expected);
+
+            for (uint32_t v = 0; v < 65536; v++) expected[v] = p1[v] && p2[v];
+            run_container_intersection(B1, B2, out);
+            assert_run_matches(out, expected);
+            assert_int_equal(run_container_intersection_cardinality(B1, B2),
+                             inter);
+            assert_int_equal(run_container_intersect(B1, B2), inter > 0);
+
+            for (uint32_t v = 0; v < 65536; v++) expected[v] = p1[v] != p2[v];
+            run_container_xor(B1, B2, out);
+            assert_run_matches(out, expected);
+
+            for (uint32_t v = 0; v < 65536; v++) expected[v] = p1[v] && !p2[v];
+            run_container_andnot(B1, B2, out);
+            assert_run_matches(out, expected);
+        }
+    }
+    run_container_free(B1);
+    run_container_free(B2);
+    run_container_free(out);
+    free(p1);
+    free(p2);
+    free(expected);
+}
+
 // returns 0 on error, 1 if ok.
 DEFINE_TEST(to_uint32_array_test) {
     for (size_t offset = 1; offset < 128; offset *= 2) {
@@ -216,13 +335,64 @@ DEFINE_TEST(remove_range_test) {
     run_container_free(run);
 }
 
+// The cardinality is kept up to date by the functions that modify the runs,
+// which run_container_validate checks.
+DEFINE_TEST(cardinality_maintenance_test) {
+    run_container_t* B = run_container_create();
+    bool* present = (bool*)calloc(65536, sizeof(bool));
+    int32_t card = 0;
+    const char* reason = NULL;
+    srand(4321);
+    for (int i = 0; i < 20000; i++) {
+        const uint32_t x = (uint32_t)rand() % 65536;
+        const uint32_t y = x + (uint32_t)rand() % 100;
+        const uint32_t max = (y < 65536) ? y : 65535;
+        switch (rand() % 4) {
+            case 0:
+                if (run_container_add(B, (uint16_t)x)) card++;
+                present[x] = true;
+                break;
+            case 1:
+                if (run_container_remove(B, (uint16_t)x)) card--;
+                present[x] = false;
+                break;
+            case 2:
+                _run_container_add_range(B, x, max);
+                for (uint32_t v = x; v <= max; v++) {
+                    card += !present[v];
+                    present[v] = true;
+                }
+                break;
+            default:
+                run_container_remove_range(B, x, max);
+                for (uint32_t v = x; v <= max; v++) {
+                    card -= present[v];
+                    present[v] = false;
+                }
+                break;
+        }
+        assert_int_equal(run_container_cardinality(B), card);
+        if (card > 0) assert_true(run_container_validate(B, &reason));
+    }
+    // the hook catches a stale cardinality
+    assert_true(card > 0);
+    B->cardinality++;
+    assert_false(run_container_validate(B, &reason));
+    assert_string_equal(reason, "cardinality is incorrect");
+    free(present);
+    run_container_free(B);
+}
+
 int main() {
     tellmeall();
 
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(printf_test), cmocka_unit_test(add_contains_test),
-        cmocka_unit_test(and_or_test), cmocka_unit_test(to_uint32_array_test),
+        cmocka_unit_test(contains_all_sizes_test),
+        cmocka_unit_test(and_or_test), cmocka_unit_test(skewed_operations_test),
+        cmocka_unit_test(to_uint32_array_test),
         cmocka_unit_test(select_test), cmocka_unit_test(remove_range_test),
+        cmocka_unit_test(cardinality_maintenance_test),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
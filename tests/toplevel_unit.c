@@ -199,6 +199,67 @@ DEFINE_TEST(contains_bulk) {
     roaring_bitmap_free(bm);
 }
 
+static void check_contains_many(const roaring_bitmap_t *bm,
+                                const uint32_t *values, size_t n) {
+    uint64_t *bits = (uint64_t *)malloc(((n + 63) / 64 + 1) * sizeof(uint64_t));
+    bits[(n + 63) / 64] = 0xDEADBEEF;  // must not be written
+    roaring_bitmap_contains_many(bm, values, n, bits);
+    for (size_t i = 0; i < n; i++) {
+        assert_int_equal((bits[i / 64] >> (i % 64)) & 1,
+                         roaring_bitmap_contains(bm, values[i]));
+    }
+    assert_int_equal(bits[(n + 63) / 64], 0xDEADBEEF);
+    free(bits);
+}
+
+DEFINE_TEST(contains_many) {
+    roaring_bitmap_t *bm = roaring_bitmap_create();
+    const size_t n = 20000;
+    uint32_t *values = (uint32_t *)malloc(n * sizeof(uint32_t));
+    for (size_t i = 0; i < n; i++) {
+        values[i] = (uint32_t)(i * 389);
+    }
+    check_contains_many(bm, values, n);
+    roaring_bitmap_contains_many(bm, values, 0, NULL);
+
+    roaring_bitmap_add_range_closed(bm, 0, 1000);  // run
+    for (uint32_t i = 77000; i < 87000; i += 2) {  // array
+        roaring_bitmap_add(bm, i);
+    }
+    for (uint32_t i = 132000; i < 140000; i += 2) {  // bitset
+        roaring_bitmap_add(bm, i);
+    }
+    for (uint32_t i = 0; i < 100; i++) {  // runs separated by gaps
+        roaring_bitmap_add_range(bm, 300000 + i * 400, 300000 + i * 400 + 50);
+    }
+    roaring_bitmap_add(bm, UINT32_MAX);
+
+    // sorted, with duplicates and probes of absent keys
+    check_contains_many(bm, values, n);
+    // strictly descending within and across containers
+    for (size_t i = 0; i < n; i++) {
+        values[i] = (uint32_t)(400000 - i * 19);
+    }
+    check_contains_many(bm, values, n);
+    // unordered
+    for (size_t i = 0; i < n; i++) {
+        values[i] = (uint32_t)((i * 2654435761u) % 450000);
+    }
+    values[n - 1] = UINT32_MAX;
+    check_contains_many(bm, values, n);
+
+    // same answers with a key summary and through shared containers
+    assert_true(roaring_bitmap_enable_key_summary(bm));
+    check_contains_many(bm, values, n);
+    roaring_bitmap_set_copy_on_write(bm, true);
+    roaring_bitmap_t *copy = roaring_bitmap_copy(bm);
+    check_contains_many(copy, values, 77);
+    roaring_bitmap_free(copy);
+
+    free(values);
+    roaring_bitmap_free(bm);
+}
+
 DEFINE_TEST(is_really_empty) {
     roaring_bitmap_t *bm = roaring_bitmap_create();
     assert_true(roaring_bitmap_is_empty(bm));
@@ -461,9 +522,11 @@ void sbs_remove_many(sbs_t *sbs, size_t n_args, uint32_t *vals) {
 
 bool sbs_check_type(sbs_t *sbs, uint8_t type) {
     bool answer = true;
-    for (int32_t i = 0; i < sbs->roaring->high_low_container.size; i++) {
-        answer =
-            answer && (sbs->roaring->high_low_container.typecodes[i] == type);
+    const roaring_array_t *ra = &sbs->roaring->high_low_container;
+    for (int32_t i = 0; i < ra->size; i++) {
+        // full chunks may be the shared full container singleton
+        answer = answer && (get_container_type(ra->containers[i],
+                                               ra->typecodes[i]) == type);
     }
     return answer;
 }
@@ -2401,6 +2464,174 @@ void test_andnot(bool copy_on_write) {
     for (int i = 0; r[i]; ++i) roaring_bitmap_free(r[i]);
 }
 
+// Key sets chosen to exercise both the galloping and the block-wise key
+// matching in and, andnot, intersect and and_cardinality.
+DEFINE_TEST(test_key_matching_ops) {
+    const uint32_t strides[] = {1, 2, 3, 7, 100, 5000};
+    const size_t nstrides = sizeof(strides) / sizeof(strides[0]);
+    for (size_t i = 0; i < nstrides; i++) {
+        for (size_t j = 0; j < nstrides; j++) {
+            roaring_bitmap_t *r1 = roaring_bitmap_create();
+            roaring_bitmap_t *r2 = roaring_bitmap_create();
+            for (uint32_t key = 0; key < 65536; key += strides[i]) {
+                roaring_bitmap_add(r1, (key << 16) | (key & 0xFF));
+            }
+            for (uint32_t key = 0; key < 65536; key += strides[j]) {
+                roaring_bitmap_add(r2, (key << 16) | (key & 0xFF));
+                roaring_bitmap_add(r2, (key << 16) | 0xFFFF);
+            }
+            uint64_t expected_and = 0;
+            roaring_bitmap_t *expected_andnot = roaring_bitmap_create();
+            roaring_uint32_iterator_t *it = roaring_iterator_create(r1);
+            while (it->has_value) {
+                if (roaring_bitmap_contains(r2, it->current_value)) {
+                    expected_and++;
+                } else {
+                    roaring_bitmap_add(expected_andnot, it->current_value);
+                }
+                roaring_uint32_iterator_advance(it);
+            }
+            roaring_uint32_iterator_free(it);
+
+            roaring_bitmap_t *r_and = roaring_bitmap_and(r1, r2);
+            assert_int_equal(roaring_bitmap_get_cardinality(r_and),
+                             expected_and);
+            assert_true(roaring_bitmap_is_subset(r_and, r1));
+            assert_true(roaring_bitmap_is_subset(r_and, r2));
+            assert_int_equal(roaring_bitmap_and_cardinality(r1, r2),
+                             expected_and);
+            assert_int_equal(roaring_bitmap_intersect(r1, r2),
+                             expected_and > 0);
+            roaring_bitmap_t *r_andnot = roaring_bitmap_andnot(r1, r2);
+            assert_true(roaring_bitmap_equals(r_andnot, expected_andnot));
+
+            roaring_bitmap_free(r_and);
+            roaring_bitmap_free(r_andnot);
+            roaring_bitmap_free(expected_andnot);
+            roaring_bitmap_free(r1);
+            roaring_bitmap_free(r2);
+        }
+    }
+}
+
+// The summary must hold exactly the keys in use, and lookups must agree
+// with a bitmap that has no summary.
+static void check_key_summary(const roaring_bitmap_t *r,
+                              const roaring_bitmap_t *ref) {
+    const roaring_array_t *ra = &r->high_low_container;
+    assert_true(roaring_bitmap_has_key_summary(r));
+    for (uint32_t key = 0; key < 0x10000; key++) {
+        assert_int_equal(ra_may_contain_key(ra, (uint16_t)key),
+                         ra_get_index(ra, (uint16_t)key) >= 0);
+    }
+    assert_true(roaring_bitmap_equals(r, ref));
+    for (uint32_t key = 0; key < 0x10000; key += 3) {
+        const uint32_t val = (key << 16) | (key & 0xFFF);
+        assert_int_equal(roaring_bitmap_contains(r, val),
+                         roaring_bitmap_contains(ref, val));
+    }
+}
+
+DEFINE_TEST(test_key_summary) {
+    roaring_bitmap_t *r = roaring_bitmap_create();
+    roaring_bitmap_t *ref = roaring_bitmap_create();
+    assert_false(roaring_bitmap_has_key_summary(r));
+    assert_true(roaring_bitmap_enable_key_summary(r));
+    assert_true(roaring_bitmap_enable_key_summary(r));
+    check_key_summary(r, ref);
+
+    uint32_t values[2000];
+    for (uint32_t i = 0; i < 2000; i++) {
+        values[i] = (i * 7919u) << 13 | (i & 0xFFF);
+    }
+    roaring_bitmap_add_many(r, 2000, values);
+    roaring_bitmap_add_many(ref, 2000, values);
+    check_key_summary(r, ref);
+
+    roaring_bitmap_add_range_closed(r, 100000, 9000000);
+    roaring_bitmap_add_range_closed(ref, 100000, 9000000);
+    check_key_summary(r, ref);
+
+    roaring_bitmap_remove_range_closed(r, 5000000, 600000000);
+    roaring_bitmap_remove_range_closed(ref, 5000000, 600000000);
+    check_key_summary(r, ref);
+
+    roaring_bitmap_remove_many(r, 1000, values);
+    roaring_bitmap_remove_many(ref, 1000, values);
+    check_key_summary(r, ref);
+
+    roaring_bitmap_flip_inplace(r, 1u << 30, (1u << 30) + (1u << 20));
+    roaring_bitmap_flip_inplace(ref, 1u << 30, (1u << 30) + (1u << 20));
+    check_key_summary(r, ref);
+
+    roaring_bitmap_t *other = roaring_bitmap_from_range(0, 1u << 31, 70001);
+    roaring_bitmap_t *ops[2] = {r, ref};
+    for (int k = 0; k < 2; k++) {
+        roaring_bitmap_xor_inplace(ops[k], other);
+    }
+    check_key_summary(r, ref);
+    for (int k = 0; k < 2; k++) {
+        roaring_bitmap_or_inplace(ops[k], other);
+    }
+    check_key_summary(r, ref);
+    for (int k = 0; k < 2; k++) {
+        roaring_bitmap_andnot_inplace(ops[k], other);
+    }
+    check_key_summary(r, ref);
+    roaring_bitmap_add_range_closed(other, 0, 200000000);
+    for (int k = 0; k < 2; k++) {
+        roaring_bitmap_and_inplace(ops[k], other);
+    }
+    check_key_summary(r, ref);
+
+    // pairwise operations where both sides have a summary
+    roaring_bitmap_t *r2 = roaring_bitmap_from_range(0, 1u << 31, 1u << 20);
+    roaring_bitmap_add_range(r2, 3000000, 4000000);
+    roaring_bitmap_t *ref2 = roaring_bitmap_copy(r2);
+    assert_false(roaring_bitmap_has_key_summary(ref2));
+    assert_true(roaring_bitmap_enable_key_summary(r2));
+    roaring_bitmap_t *a = roaring_bitmap_and(r, r2);
+    roaring_bitmap_t *b = roaring_bitmap_and(ref, ref2);
+    assert_true(roaring_bitmap_equals(a, b));
+    assert_false(roaring_bitmap_has_key_summary(a));
+    roaring_bitmap_free(a);
+    roaring_bitmap_free(b);
+    a = roaring_bitmap_andnot(r, r2);
+    b = roaring_bitmap_andnot(ref, ref2);
+    assert_true(roaring_bitmap_equals(a, b));
+    roaring_bitmap_free(a);
+    roaring_bitmap_free(b);
+    assert_int_equal(roaring_bitmap_and_cardinality(r, r2),
+                     roaring_bitmap_and_cardinality(ref, ref2));
+    assert_int_equal(roaring_bitmap_intersect(r, r2),
+                     roaring_bitmap_intersect(ref, ref2));
+
+    assert_true(roaring_bitmap_overwrite(r, r2));
+    check_key_summary(r, ref2);
+    roaring_bitmap_andnot_inplace(r, r2);
+    roaring_bitmap_andnot_inplace(r, r2);  // from an empty bitmap
+    roaring_bitmap_clear(ref);
+    check_key_summary(r, ref);
+    assert_true(roaring_bitmap_overwrite(r, r2));
+    roaring_bitmap_disable_key_summary(r);
+    assert_false(roaring_bitmap_has_key_summary(r));
+
+    // clearing releases the summary: no auxiliary allocation is left
+    roaring_bitmap_t stack_bitmap;
+    roaring_bitmap_init_cleared(&stack_bitmap);
+    roaring_bitmap_add_range(&stack_bitmap, 0, 1000000);
+    assert_true(roaring_bitmap_enable_key_summary(&stack_bitmap));
+    roaring_bitmap_clear(&stack_bitmap);
+    assert_false(roaring_bitmap_has_key_summary(&stack_bitmap));
+    assert_null(stack_bitmap.high_low_container.containers);
+    assert_false(roaring_bitmap_contains(&stack_bitmap, 0));
+    roaring_bitmap_free(other);
+    roaring_bitmap_free(r2);
+    roaring_bitmap_free(ref2);
+    roaring_bitmap_free(r);
+    roaring_bitmap_free(ref);
+}
+
 DEFINE_TEST(test_andnot_true) { test_andnot(true); }
 
 DEFINE_TEST(test_andnot_false) { test_andnot(false); }
@@ -4120,6 +4351,347 @@ DEFINE_TEST(test_iterator_reuse) { test_iterator_reuse_retry_count(0); }
 
 DEFINE_TEST(test_iterator_reuse_many) { test_iterator_reuse_retry_count(10); }
 
+// Checks a lazy set operation iterator against the materialized result.
+void check_many_iterator(roaring_many_iterator_t *it,
+                         const roaring_bitmap_t *expected) {
+    uint64_t card = roaring_bitmap_get_cardinality(expected);
+    uint32_t *values = (uint32_t *)malloc((card + 1) * sizeof(uint32_t));
+    roaring_bitmap_to_uint32_array(expected, values);
+    // Alternate single steps and bulk reads of varying sizes.
+    uint32_t buf[777];
+    uint64_t pos = 0;
+    uint32_t chunk = 1;
+    while (roaring_many_iterator_has_value(it)) {
+        assert_true(pos < card);
+        assert_int_equal(roaring_many_iterator_value(it), values[pos]);
+        if (chunk % 3 == 0) {
+            roaring_many_iterator_advance(it);
+            pos++;
+        } else {
+            uint32_t n = roaring_many_iterator_read(it, buf, chunk);
+            for (uint32_t i = 0; i < n; i++) {
+                assert_int_equal(buf[i], values[pos + i]);
+            }
+            pos += n;
+        }
+        chunk = (chunk * 7 + 1) % 777;
+    }
+    assert_true(pos == card);
+    free(values);
+}
+
+// Checks move_equalorlarger on a fresh iterator against the expected result.
+void check_many_iterator_skip(roaring_many_iterator_t *it,
+                              const roaring_bitmap_t *expected) {
+    roaring_uint32_iterator_t *ref = roaring_iterator_create(expected);
+    for (uint64_t val = 0; val <= UINT32_MAX; val += 33331) {
+        bool ref_has_value =
+            roaring_uint32_iterator_move_equalorlarger(ref, (uint32_t)val);
+        bool has_value =
+            roaring_many_iterator_move_equalorlarger(it, (uint32_t)val);
+        assert_true(has_value == ref_has_value);
+        if (!has_value) break;
+        assert_int_equal(roaring_many_iterator_value(it), ref->current_value);
+    }
+    roaring_uint32_iterator_free(ref);
+}
+
+DEFINE_TEST(test_many_iterators) {
+    // Every pair of inputs shares keys with different container types.
+    roaring_bitmap_t *inputs[4];
+    for (int i = 0; i < 4; i++) {
+        inputs[i] = roaring_bitmap_create();
+        for (uint32_t key = 0; key < 64; key++) {
+            uint32_t base = (key * (i + 3)) << 16;
+            switch ((key + i) % 3) {
+                case 0:  // array
+                    for (uint32_t v = 0; v < 1500; v++) {
+                        roaring_bitmap_add(inputs[i], base + v * (11 + i));
+                    }
+                    break;
+                case 1:  // bitset
+                    for (uint32_t v = 0; v < 30000; v++) {
+                        roaring_bitmap_add(inputs[i], base + v * (2 + i % 2));
+                    }
+                    break;
+                default:  // run
+                    for (uint32_t v = 0; v < 8; v++) {
+                        roaring_bitmap_add_range(
+                            inputs[i], base + v * 7000 + i * 100,
+                            base + v * 7000 + i * 100 + 3000);
+                    }
+                    break;
+            }
+        }
+        roaring_bitmap_run_optimize(inputs[i]);
+    }
+    roaring_bitmap_set_copy_on_write(inputs[3], true);
+    roaring_bitmap_t *shared = roaring_bitmap_copy(inputs[3]);
+    const roaring_bitmap_t *x[5] = {inputs[0], inputs[1], inputs[2], inputs[3],
+                                    shared};
+
+    for (size_t number = 0; number <= 5; number++) {
+        roaring_bitmap_t *expected_or = roaring_bitmap_create();
+        roaring_bitmap_t *expected_xor = roaring_bitmap_create();
+        roaring_bitmap_t *expected_and =
+            number > 0 ? roaring_bitmap_copy(x[0]) : roaring_bitmap_create();
+        roaring_bitmap_t *expected_andnot = roaring_bitmap_copy(expected_and);
+        for (size_t i = 0; i < number; i++) {
+            roaring_bitmap_or_inplace(expected_or, x[i]);
+            roaring_bitmap_xor_inplace(expected_xor, x[i]);
+            roaring_bitmap_and_inplace(expected_and, x[i]);
+            if (i > 0) roaring_bitmap_andnot_inplace(expected_andnot, x[i]);
+        }
+
+        roaring_many_iterator_t *(*create[4])(size_t,
+                                              const roaring_bitmap_t **) = {
+            roaring_or_many_iterator_create, roaring_xor_many_iterator_create,
+            roaring_and_many_iterator_create,
+            roaring_andnot_many_iterator_create};
+        const roaring_bitmap_t *expected[4] = {expected_or, expected_xor,
+                                               expected_and, expected_andnot};
+        for (int op = 0; op < 4; op++) {
+            roaring_many_iterator_t *it = create[op](number, x);
+            assert_non_null(it);
+            check_many_iterator(it, expected[op]);
+            roaring_many_iterator_free(it);
+            it = create[op](number, x);
+            check_many_iterator_skip(it, expected[op]);
+            roaring_many_iterator_free(it);
+        }
+
+        roaring_bitmap_free(expected_or);
+        roaring_bitmap_free(expected_xor);
+        roaring_bitmap_free(expected_and);
+        roaring_bitmap_free(expected_andnot);
+    }
+    roaring_many_iterator_free(NULL);  // like the other free functions
+    roaring_bitmap_free(shared);
+    for (int i = 0; i < 4; i++) {
+        roaring_bitmap_free(inputs[i]);
+    }
+}
+
+// Checks the range iterator and roaring_bitmap_to_ranges against ranges
+// computed from the individual values.
+void check_ranges(const roaring_bitmap_t *r) {
+    uint64_t card = roaring_bitmap_get_cardinality(r);
+    uint32_t *values = (uint32_t *)malloc((card + 1) * sizeof(uint32_t));
+    roaring_bitmap_to_uint32_array(r, values);
+    uint32_t *expected = (uint32_t *)malloc(2 * (card + 1) * sizeof(uint32_t));
+    size_t n_expected = 0;
+    for (uint64_t i = 0; i < card; i++) {
+        if (n_expected > 0 && expected[2 * n_expected - 1] + 1 == values[i]) {
+            expected[2 * n_expected - 1] = values[i];
+        } else {
+            expected[2 * n_expected] = values[i];
+            expected[2 * n_expected + 1] = values[i];
+            n_expected++;
+        }
+    }
+
+    roaring_range_iterator_t *it = roaring_range_iterator_create(r);
+    size_t count = 0;
+    while (roaring_range_iterator_has_value(it)) {
+        assert_true(count < n_expected);
+        assert_int_equal(roaring_range_iterator_start(it), expected[2 * count]);
+        assert_int_equal(roaring_range_iterator_end(it),
+                         expected[2 * count + 1]);
+        count++;
+        roaring_range_iterator_advance(it);
+    }
+    assert_true(count == n_expected);
+    roaring_range_iterator_free(it);
+
+    assert_true(roaring_bitmap_to_ranges(r, NULL, 0) == n_expected);
+    uint32_t *ranges =
+        (uint32_t *)malloc(2 * (n_expected + 1) * sizeof(uint32_t));
+    size_t half = n_expected / 2;
+    assert_true(roaring_bitmap_to_ranges(r, ranges, half) == n_expected);
+    assert_true(memcmp(ranges, expected, 2 * half * sizeof(uint32_t)) == 0);
+    assert_true(roaring_bitmap_to_ranges(r, ranges, n_expected) == n_expected);
+    assert_true(memcmp(ranges, expected, 2 * n_expected * sizeof(uint32_t)) ==
+                0);
+    free(ranges);
+    free(expected);
+    free(values);
+}
+
+DEFINE_TEST(test_range_iterator) {
+    roaring_bitmap_t *r = roaring_bitmap_create();
+    check_ranges(r);
+
+    roaring_bitmap_add(r, 0);
+    roaring_bitmap_add(r, UINT32_MAX);
+    check_ranges(r);
+
+    // Runs crossing container boundaries, possibly several containers.
+    roaring_bitmap_add_range(r, 65000, 3 * 65536 + 10);
+    roaring_bitmap_add_range(r, 10 * 65536 - 1, 10 * 65536 + 1);
+    roaring_bitmap_add_range(r, 20 * 65536, 21 * 65536);
+    roaring_bitmap_add_range(r, 22 * 65536, 23 * 65536);
+    // Array containers with consecutive values.
+    for (uint32_t v = 0; v < 1000; v++) {
+        if (v % 7 != 0) roaring_bitmap_add(r, 30 * 65536 + v);
+    }
+    roaring_bitmap_add(r, 31 * 65536 - 1);
+    roaring_bitmap_add(r, 31 * 65536);
+    // Bitset containers with ranges across word boundaries.
+    for (uint32_t v = 0; v < 60000; v++) {
+        if (v % 131 < 70) roaring_bitmap_add(r, 40 * 65536 + v);
+    }
+    roaring_bitmap_add_range(r, 41 * 65536 - 100, 41 * 65536 + 5);
+    for (uint32_t v = 41 * 65536 + 6; v < 41 * 65536 + 50000; v += 2) {
+        roaring_bitmap_add(r, v);
+    }
+    roaring_bitmap_add_range(r, 42 * 65536 - 64, 42 * 65536);
+    for (uint32_t v = 42 * 65536 - 10000; v < 42 * 65536 - 64; v += 3) {
+        roaring_bitmap_add(r, v);
+    }
+    check_ranges(r);
+
+    roaring_bitmap_run_optimize(r);
+    check_ranges(r);
+
+    roaring_bitmap_remove_run_compression(r);
+    check_ranges(r);
+
+    roaring_bitmap_free(r);
+}
+
+// Rebuilds a bitmap from the raw container payloads.
+bool rebuild_from_container_view(const roaring_container_view_t *view,
+                                 void *param) {
+    roaring_bitmap_t *r = (roaring_bitmap_t *)param;
+    uint32_t base = (uint32_t)view->key << 16;
+    int32_t cardinality = 0;
+    switch (view->typecode) {
+        case ROARING_CONTAINER_TYPE_ARRAY: {
+            const uint16_t *values = (const uint16_t *)view->data;
+            for (int32_t i = 0; i < view->length; i++) {
+                roaring_bitmap_add(r, base | values[i]);
+            }
+            cardinality = view->length;
+            break;
+        }
+        case ROARING_CONTAINER_TYPE_BITSET: {
+            const uint64_t *words = (const uint64_t *)view->data;
+            assert_int_equal(view->length, 1024);
+            for (int32_t i = 0; i < view->length * 64; i++) {
+                if (words[i / 64] & (UINT64_C(1) << (i % 64))) {
+                    roaring_bitmap_add(r, base | i);
+                    cardinality++;
+                }
+            }
+            break;
+        }
+        case ROARING_CONTAINER_TYPE_RUN: {
+            const uint16_t *runs = (const uint16_t *)view->data;
+            for (int32_t i = 0; i < view->length; i++) {
+                roaring_bitmap_add_range_closed(r, base | runs[2 * i],
+                                                base | (runs[2 * i] +
+                                                        runs[2 * i + 1]));
+                cardinality += runs[2 * i + 1] + 1;
+            }
+            break;
+        }
+        case ROARING_CONTAINER_TYPE_PACKED: {
+            const uint8_t *bytes = (const uint8_t *)view->data;
+            int32_t n_blocks = (view->cardinality + 31) / 32;
+            const uint8_t *widths = bytes + 4 * n_blocks;
+            const uint8_t *gaps = bytes + 5 * n_blocks;
+            for (int32_t b = 0; b < n_blocks; b++) {
+                uint16_t first, offset;
+                memcpy(&first, bytes + 2 * b, sizeof(first));
+                memcpy(&offset, bytes + 2 * (n_blocks + b), sizeof(offset));
+                uint32_t value = first;
+                uint32_t bit = 8 * (uint32_t)offset;
+                roaring_bitmap_add(r, base | value);
+                cardinality++;
+                for (int32_t i = 1; i < 32 && cardinality < view->cardinality;
+                     i++) {
+                    uint32_t gap = 0;
+                    for (uint32_t w = 0; w < widths[b]; w++, bit++) {
+                        gap |= (uint32_t)((gaps[bit / 8] >> (bit % 8)) & 1)
+                               << w;
+                    }
+                    value += gap + 1;
+                    roaring_bitmap_add(r, base | value);
+                    cardinality++;
+                }
+                assert_true(bit <= 8 * (uint32_t)(view->length - 5 * n_blocks));
+            }
+            break;
+        }
+        default:
+            fail();
+    }
+    assert_int_equal(cardinality, view->cardinality);
+    return true;
+}
+
+bool count_container_views(const roaring_container_view_t *view,
+                           void *param) {
+    (void)view;
+    return ++*(int *)param < 2;
+}
+
+void check_container_views(const roaring_bitmap_t *r) {
+    roaring_bitmap_t *copy = roaring_bitmap_create();
+    assert_true(
+        roaring_iterate_containers(r, rebuild_from_container_view, copy));
+    assert_true(roaring_bitmap_equals(r, copy));
+    roaring_bitmap_free(copy);
+
+    uint32_t count = roaring_bitmap_container_count(r);
+    roaring_container_view_t view;
+    for (uint32_t i = 0; i < count; i++) {
+        assert_true(roaring_bitmap_container_view(r, i, &view));
+        assert_int_equal(view.key, r->high_low_container.keys[i]);
+    }
+    assert_false(roaring_bitmap_container_view(r, count, &view));
+
+    int visited = 0;
+    assert_false(
+        roaring_iterate_containers(r, count_container_views, &visited));
+    assert_int_equal(visited, 2);
+}
+
+DEFINE_TEST(test_container_views) {
+    roaring_bitmap_t *r = roaring_bitmap_create();
+    for (uint32_t v = 0; v < 1000; v++) {
+        roaring_bitmap_add(r, v * 3);
+    }
+    for (uint32_t v = 0; v < 40000; v++) {
+        roaring_bitmap_add(r, 5 * 65536 + v * 2);
+    }
+    roaring_bitmap_add_range(r, 9 * 65536 + 10, 12 * 65536 + 100);
+    roaring_bitmap_add(r, UINT32_MAX);
+    roaring_bitmap_run_optimize(r);
+    check_container_views(r);
+
+#if !CROARING_IS_BIG_ENDIAN
+    size_t num_bytes = roaring_bitmap_frozen_size_in_bytes(r);
+    char *buf = (char *)roaring_aligned_malloc(32, num_bytes);
+    roaring_bitmap_frozen_serialize(r, buf);
+    const roaring_bitmap_t *frozen = roaring_bitmap_frozen_view(buf, num_bytes);
+    check_container_views(frozen);
+    roaring_container_view_t view;
+    assert_true(roaring_bitmap_container_view(frozen, 0, &view));
+    assert_true((const char *)view.data >= buf &&
+                (const char *)view.data < buf + num_bytes);
+    roaring_bitmap_free(frozen);
+    roaring_aligned_free(buf);
+#endif
+
+    // Shared containers expose the payload of the underlying container.
+    roaring_bitmap_set_copy_on_write(r, true);
+    roaring_bitmap_t *shared = roaring_bitmap_copy(r);
+    check_container_views(shared);
+    roaring_bitmap_free(shared);
+    roaring_bitmap_free(r);
+}
+
 DEFINE_TEST(read_uint32_iterator_zero_count) {
     roaring_bitmap_t *r = roaring_bitmap_from_range(0, 10000, 1);
     roaring_uint32_iterator_t *iterator = roaring_iterator_create(r);
@@ -4132,6 +4704,157 @@ DEFINE_TEST(read_uint32_iterator_zero_count) {
     roaring_bitmap_free(r);
 }
 
+// Checks that the chunk of key `key' is the full container singleton.
+static bool is_full_singleton_at(const roaring_bitmap_t *r, uint16_t key) {
+    const roaring_array_t *ra = &r->high_low_container;
+    int32_t i = ra_get_index(ra, key);
+    return i >= 0 && container_is_full_singleton(ra->containers[i]);
+}
+
+DEFINE_TEST(test_full_container_singleton) {
+    for (int cow = 0; cow < 2; cow++) {
+        roaring_bitmap_t *full = roaring_bitmap_from_range(0, 3 << 16, 1);
+        roaring_bitmap_set_copy_on_write(full, cow);
+        assert_true(is_full_singleton_at(full, 0));
+        assert_true(is_full_singleton_at(full, 2));
+        assert_true(roaring_bitmap_internal_validate(full, NULL));
+        assert_true(roaring_bitmap_get_cardinality(full) == 3 << 16);
+
+        roaring_bitmap_t *sparse = roaring_bitmap_create();
+        roaring_bitmap_set_copy_on_write(sparse, cow);
+        for (uint32_t v = 7; v < (4 << 16); v += 1001) {
+            roaring_bitmap_add(sparse, v);
+        }
+        roaring_bitmap_add_range(sparse, 3 << 16, 4 << 16);
+        assert_true(is_full_singleton_at(sparse, 3));
+        roaring_bitmap_add(sparse, (3 << 16) + 5);  // nothing to add
+        assert_false(roaring_bitmap_add_checked(sparse, (3 << 16) + 5));
+        assert_true(is_full_singleton_at(sparse, 3));
+
+        // copies reference the singleton, and writers get their own copy
+        roaring_bitmap_t *copy = roaring_bitmap_copy(full);
+        assert_true(is_full_singleton_at(copy, 1));
+        roaring_bitmap_remove(copy, 65536 + 10);
+        assert_false(is_full_singleton_at(copy, 1));
+        assert_false(roaring_bitmap_contains(copy, 65536 + 10));
+        assert_true(roaring_bitmap_contains(full, 65536 + 10));
+        roaring_bitmap_add(copy, 65536 + 10);
+        assert_true(roaring_bitmap_equals(copy, full));
+        roaring_bitmap_free(copy);
+
+        // OR gives full, AND is the identity, ANDNOT is the complement
+        roaring_bitmap_t *r = roaring_bitmap_or(full, sparse);
+        assert_true(is_full_singleton_at(r, 0));
+        assert_true(is_full_singleton_at(r, 3));
+        assert_true(roaring_bitmap_get_cardinality(r) ==
+                    (3 << 16) + (1 << 16));
+        roaring_bitmap_free(r);
+
+        r = roaring_bitmap_and(full, sparse);
+        roaring_bitmap_t *expected = roaring_bitmap_copy(sparse);
+        roaring_bitmap_remove_range(expected, 3 << 16, 4 << 16);
+        assert_true(roaring_bitmap_equals(r, expected));
+        roaring_bitmap_free(r);
+        r = roaring_bitmap_copy(sparse);
+        roaring_bitmap_and_inplace(r, full);
+        assert_true(roaring_bitmap_equals(r, expected));
+        roaring_bitmap_free(r);
+        r = roaring_bitmap_copy(full);
+        roaring_bitmap_and_inplace(r, sparse);
+        assert_true(roaring_bitmap_equals(r, expected));
+        roaring_bitmap_free(r);
+
+        r = roaring_bitmap_andnot(full, sparse);
+        roaring_bitmap_t *complement =
+            roaring_bitmap_flip(expected, 0, 3 << 16);
+        assert_true(roaring_bitmap_equals(r, complement));
+        roaring_bitmap_free(r);
+        r = roaring_bitmap_copy(full);
+        roaring_bitmap_andnot_inplace(r, sparse);
+        assert_true(roaring_bitmap_equals(r, complement));
+        roaring_bitmap_free(r);
+        r = roaring_bitmap_andnot(sparse, full);
+        roaring_bitmap_t *rest = roaring_bitmap_from_range(3 << 16, 4 << 16, 1);
+        assert_true(roaring_bitmap_equals(r, rest));
+        roaring_bitmap_free(r);
+        r = roaring_bitmap_copy(sparse);
+        roaring_bitmap_andnot_inplace(r, full);
+        assert_true(roaring_bitmap_equals(r, rest));
+        roaring_bitmap_free(r);
+
+        r = roaring_bitmap_copy(sparse);
+        roaring_bitmap_or_inplace(r, full);
+        assert_true(is_full_singleton_at(r, 1));
+        assert_true(roaring_bitmap_get_cardinality(r) == 4 << 16);
+        roaring_bitmap_free(r);
+        r = roaring_bitmap_lazy_or(sparse, full, true);
+        roaring_bitmap_repair_after_lazy(r);
+        assert_true(is_full_singleton_at(r, 2));
+        assert_true(roaring_bitmap_get_cardinality(r) == 4 << 16);
+        roaring_bitmap_lazy_or_inplace(r, full, false);
+        roaring_bitmap_repair_after_lazy(r);
+        assert_true(roaring_bitmap_get_cardinality(r) == 4 << 16);
+        roaring_bitmap_free(r);
+        r = roaring_bitmap_xor(full, sparse);
+        roaring_bitmap_t *expected_xor = roaring_bitmap_copy(complement);
+        roaring_bitmap_or_inplace(expected_xor, rest);
+        roaring_bitmap_remove_range(expected_xor, 3 << 16, 4 << 16);
+        roaring_bitmap_xor_inplace(r, rest);
+        assert_true(roaring_bitmap_equals(r, expected_xor));
+        roaring_bitmap_free(r);
+        roaring_bitmap_free(expected_xor);
+
+        // chunks that become full are replaced by the singleton
+        r = roaring_bitmap_copy(complement);
+        roaring_bitmap_or_inplace(r, expected);
+        assert_true(is_full_singleton_at(r, 0));
+        roaring_bitmap_flip_inplace(r, 0, 1 << 16);
+        assert_true(roaring_bitmap_get_cardinality(r) == 2 << 16);
+        roaring_bitmap_flip_inplace(r, 0, 1 << 16);
+        assert_true(is_full_singleton_at(r, 0));
+        roaring_bitmap_t *flipped = roaring_bitmap_flip(r, 5 << 16, 6 << 16);
+        assert_true(is_full_singleton_at(flipped, 5));
+        roaring_bitmap_free(flipped);
+        assert_true(roaring_bitmap_run_optimize(r));
+        assert_true(is_full_singleton_at(r, 1));
+        assert_true(roaring_bitmap_remove_run_compression(r));
+        assert_false(is_full_singleton_at(r, 1));
+        assert_true(roaring_bitmap_equals(r, full));
+        roaring_bitmap_free(r);
+
+        // serialized like any full run container
+        size_t size = roaring_bitmap_portable_size_in_bytes(sparse);
+        char *buf = (char *)malloc(size);
+        assert_true(roaring_bitmap_portable_serialize(sparse, buf) == size);
+        r = roaring_bitmap_portable_deserialize_safe(buf, size);
+        assert_true(roaring_bitmap_equals(r, sparse));
+        roaring_bitmap_free(r);
+        free(buf);
+#if !CROARING_IS_BIG_ENDIAN
+        size = roaring_bitmap_frozen_size_in_bytes(sparse);
+        buf = (char *)roaring_aligned_malloc(32, size);
+        roaring_bitmap_frozen_serialize(sparse, buf);
+        const roaring_bitmap_t *frozen = roaring_bitmap_frozen_view(buf, size);
+        assert_true(roaring_bitmap_equals(frozen, sparse));
+        roaring_bitmap_free(frozen);
+        roaring_aligned_free(buf);
+#endif
+
+        roaring_bitmap_free(rest);
+        roaring_bitmap_free(complement);
+        roaring_bitmap_free(expected);
+        roaring_bitmap_free(sparse);
+        roaring_bitmap_free(full);
+    }
+    // the singleton itself was never modified
+    uint8_t type = SHARED_CONTAINER_TYPE;
+    const container_t *c =
+        container_unwrap_shared(&container_full_singleton, &type);
+    assert_int_equal(type, RUN_CONTAINER_TYPE);
+    assert_true(run_container_is_full(const_CAST_run(c)));
+    assert_int_equal(run_container_cardinality(const_CAST_run(c)), 1 << 16);
+}
+
 DEFINE_TEST(test_add_range) {
     // autoconversion: BITSET -> BITSET -> RUN
     {
@@ -4624,6 +5347,429 @@ DEFINE_TEST(test_portable_deserialize_frozen) {
     free(serialized);
 }
 
+DEFINE_TEST(convert_from_bitset) {
+    bitset_t *bitset = bitset_create();
+    roaring_bitmap_t *expected = roaring_bitmap_create();
+    // sparse, dense, and run-friendly chunks, then a partial last chunk
+    for (uint32_t i = 100; i < 65536; i += 1000) {
+        bitset_set(bitset, i);
+        roaring_bitmap_add(expected, i);
+    }
+    for (uint32_t i = 65536; i < 2 * 65536; i += 3) {
+        bitset_set(bitset, i);
+        roaring_bitmap_add(expected, i);
+    }
+    for (uint32_t i = 3 * 65536 + 5; i < 4 * 65536 - 7; i++) {
+        bitset_set(bitset, i);
+    }
+    roaring_bitmap_add_range(expected, 3 * 65536 + 5, 4 * 65536 - 7);
+    for (uint32_t i = 5 * 65536; i < 5 * 65536 + 1000; i += 2) {
+        bitset_set(bitset, i);
+        roaring_bitmap_add(expected, i);
+    }
+    roaring_bitmap_t *r = roaring_bitmap_from_bitset(bitset);
+    assert_non_null(r);
+    assert_true(roaring_bitmap_equals(r, expected));
+    const roaring_array_t *ra = &r->high_low_container;
+    assert_int_equal(ra->size, 4);
+    assert_int_equal(ra->typecodes[0], ARRAY_CONTAINER_TYPE);
+    assert_int_equal(ra->typecodes[1], BITSET_CONTAINER_TYPE);
+    assert_int_equal(ra->typecodes[2], RUN_CONTAINER_TYPE);
+    assert_int_equal(ra->typecodes[3], ARRAY_CONTAINER_TYPE);
+
+    bitset_t *back = bitset_create();
+    assert_true(roaring_bitmap_to_bitset(r, back));
+    assert_true(bitset_count(back) == roaring_bitmap_get_cardinality(r));
+    assert_true(bitset_intersection_count(back, bitset) == bitset_count(back));
+    bitset_free(back);
+    roaring_bitmap_free(r);
+
+    // views over external words convert without copying the words first
+    bitset_t view;
+    assert_true(bitset_view_init(&view, bitset->array, bitset->arraysize));
+    r = roaring_bitmap_from_bitset(&view);
+    assert_true(roaring_bitmap_equals(r, expected));
+    roaring_bitmap_free(r);
+
+    bitset_t *empty = bitset_create();
+    r = roaring_bitmap_from_bitset(empty);
+    assert_true(roaring_bitmap_is_empty(r));
+    roaring_bitmap_free(r);
+    bitset_free(empty);
+
+    bitset_free(bitset);
+    roaring_bitmap_free(expected);
+}
+
+static void check_to_dense(const roaring_bitmap_t *r, uint64_t lo,
+                           uint64_t hi) {
+    size_t words = (size_t)((hi - lo + 63) / 64);
+    uint64_t *out = (uint64_t *)malloc((words + 1) * sizeof(uint64_t));
+    memset(out, 0xFF, (words + 1) * sizeof(uint64_t));
+    roaring_bitmap_to_dense(r, lo, hi, out);
+    for (uint64_t x = lo; x < lo + words * 64; x++) {
+        uint64_t bit = x - lo;
+        bool set = (out[bit / 64] >> (bit % 64)) & 1;
+        bool expected = x < hi && roaring_bitmap_contains(r, (uint32_t)x);
+        assert_true(set == expected);
+    }
+    assert_true(out[words] == UINT64_MAX);  // nothing written past the window
+    free(out);
+}
+
+DEFINE_TEST(convert_to_dense) {
+    roaring_bitmap_t *r = roaring_bitmap_create();
+    for (uint32_t i = 100; i < 65536; i += 1000) {
+        roaring_bitmap_add(r, i);
+    }
+    for (uint32_t i = 65536; i < 2 * 65536; i += 3) {
+        roaring_bitmap_add(r, i);
+    }
+    roaring_bitmap_add_range(r, 3 * 65536 + 5, 4 * 65536 - 7);
+    roaring_bitmap_add_range(r, 4 * 65536 + 70, 4 * 65536 + 200);
+    roaring_bitmap_add(r, UINT32_MAX);
+    roaring_bitmap_run_optimize(r);
+
+    check_to_dense(r, 0, 5 * 65536);
+    check_to_dense(r, 64, 3 * 65536 + 128);
+    check_to_dense(r, 1, 2 * 65536 + 1);
+    check_to_dense(r, 65536 + 17, 65536 + 18);
+    check_to_dense(r, 65536 + 17, 65536 + 1000);
+    check_to_dense(r, 3 * 65536 - 3, 4 * 65536 + 150);
+    check_to_dense(r, 4 * 65536 + 69, 4 * 65536 + 201);
+    check_to_dense(r, UINT64_C(0xFFFFFF00), UINT64_C(0x100000000));
+    check_to_dense(r, 7 * 65536, 8 * 65536);
+
+    // hi is capped at 2^32, and empty windows write nothing
+    uint64_t out[3] = {UINT64_MAX, UINT64_MAX, UINT64_MAX};
+    roaring_bitmap_to_dense(r, UINT64_C(0xFFFFFFC0), UINT64_C(0x200000000),
+                            out);
+    assert_true(out[0] == UINT64_C(0x8000000000000000));
+    assert_true(out[1] == UINT64_MAX);
+    roaring_bitmap_to_dense(r, 10, 10, out + 1);
+    assert_true(out[1] == UINT64_MAX);
+    roaring_bitmap_free(r);
+}
+
+// Sparse clustered chunks (packed by roaring_bitmap_pack_optimize) mixed
+// with the other container types.
+static roaring_bitmap_t *make_packable_bitmap(uint32_t salt) {
+    roaring_bitmap_t *r = roaring_bitmap_create();
+    uint32_t state = salt;
+    for (uint32_t key = 0; key < 8; key++) {
+        uint32_t v = (key << 16) + salt * 7 + key;
+        for (uint32_t i = 0; i < 500 + 300 * key; i++) {
+            roaring_bitmap_add(r, v);
+            state = state * 1103515245 + 12345;
+            v += 1 + ((state >> 16) % (2 + 4 * key));
+        }
+    }
+    roaring_bitmap_add(r, (9 << 16) + salt);  // too small to pack
+    roaring_bitmap_add_range(r, (10 << 16) + salt, (10 << 16) + 5000);
+    for (uint32_t v = salt; v < 60000; v += 3) {
+        roaring_bitmap_add(r, (11 << 16) + v);
+    }
+    roaring_bitmap_add(r, UINT32_MAX - salt);
+    return r;
+}
+
+// Checks the binary operations on packed bitmaps (x1, x2) against the same
+// operations on their unpacked copies (y1, y2).
+static void check_packed_ops(const roaring_bitmap_t *x1,
+                             const roaring_bitmap_t *x2,
+                             const roaring_bitmap_t *y1,
+                             const roaring_bitmap_t *y2) {
+    roaring_bitmap_t *(*ops[4])(const roaring_bitmap_t *,
+                                const roaring_bitmap_t *) = {
+        roaring_bitmap_and, roaring_bitmap_or, roaring_bitmap_xor,
+        roaring_bitmap_andnot};
+    void (*inplace_ops[4])(roaring_bitmap_t *, const roaring_bitmap_t *) = {
+        roaring_bitmap_and_inplace, roaring_bitmap_or_inplace,
+        roaring_bitmap_xor_inplace, roaring_bitmap_andnot_inplace};
+    for (int op = 0; op < 4; op++) {
+        roaring_bitmap_t *expected = ops[op](y1, y2);
+        roaring_bitmap_t *actual = ops[op](x1, x2);
+        assert_true(roaring_bitmap_internal_validate(actual, NULL));
+        assert_true(roaring_bitmap_equals(actual, expected));
+        roaring_bitmap_free(actual);
+
+        actual = roaring_bitmap_copy(x1);
+        inplace_ops[op](actual, x2);
+        assert_true(roaring_bitmap_internal_validate(actual, NULL));
+        assert_true(roaring_bitmap_equals(actual, expected));
+        roaring_bitmap_free(actual);
+        roaring_bitmap_free(expected);
+    }
+
+    roaring_bitmap_t *expected = roaring_bitmap_or(y1, y2);
+    roaring_bitmap_t *actual = roaring_bitmap_lazy_or(x1, x2, true);
+    roaring_bitmap_repair_after_lazy(actual);
+    assert_true(roaring_bitmap_equals(actual, expected));
+    roaring_bitmap_free(actual);
+    actual = roaring_bitmap_copy(x1);
+    roaring_bitmap_lazy_or_inplace(actual, x2, false);
+    roaring_bitmap_repair_after_lazy(actual);
+    assert_true(roaring_bitmap_equals(actual, expected));
+    roaring_bitmap_free(actual);
+    roaring_bitmap_free(expected);
+
+    expected = roaring_bitmap_xor(y1, y2);
+    actual = roaring_bitmap_lazy_xor(x1, x2);
+    roaring_bitmap_repair_after_lazy(actual);
+    assert_true(roaring_bitmap_equals(actual, expected));
+    roaring_bitmap_free(actual);
+    roaring_bitmap_free(expected);
+
+    // the lazy results have bitsets without a cardinality, which must not be
+    // used by the xor with the packed containers that follows
+    roaring_bitmap_t *y12 = roaring_bitmap_xor(y1, y2);
+    expected = roaring_bitmap_xor(y12, y1);
+    actual = roaring_bitmap_lazy_xor(x1, x2);
+    roaring_bitmap_lazy_xor_inplace(actual, x1);
+    roaring_bitmap_repair_after_lazy(actual);
+    assert_true(roaring_bitmap_internal_validate(actual, NULL));
+    assert_true(roaring_bitmap_equals(actual, expected));
+    roaring_bitmap_free(actual);
+    roaring_bitmap_free(expected);
+    roaring_bitmap_free(y12);
+
+    const roaring_bitmap_t *packed_inputs[3] = {x1, x2, x2};
+    const roaring_bitmap_t *inputs[3] = {y1, y2, y2};
+    expected = roaring_bitmap_xor_many(3, inputs);
+    actual = roaring_bitmap_xor_many(3, packed_inputs);
+    assert_true(roaring_bitmap_internal_validate(actual, NULL));
+    assert_true(roaring_bitmap_equals(actual, expected));
+    roaring_bitmap_free(actual);
+    roaring_bitmap_free(expected);
+
+    assert_true(roaring_bitmap_and_cardinality(x1, x2) ==
+                roaring_bitmap_and_cardinality(y1, y2));
+    assert_true(roaring_bitmap_or_cardinality(x1, x2) ==
+                roaring_bitmap_or_cardinality(y1, y2));
+    assert_true(roaring_bitmap_intersect(x1, x2) ==
+                roaring_bitmap_intersect(y1, y2));
+    assert_true(roaring_bitmap_is_subset(x1, x2) ==
+                roaring_bitmap_is_subset(y1, y2));
+    assert_true(roaring_bitmap_equals(x1, x2) == roaring_bitmap_equals(y1, y2));
+}
+
+DEFINE_TEST(test_pack_optimize) {
+    roaring_bitmap_t *y1 = make_packable_bitmap(0);
+    roaring_bitmap_t *y2 = make_packable_bitmap(3);
+    roaring_bitmap_t *x1 = roaring_bitmap_copy(y1);
+    roaring_bitmap_t *x2 = roaring_bitmap_copy(y2);
+    assert_true(roaring_bitmap_pack_optimize(x1));
+    assert_true(roaring_bitmap_pack_optimize(x2));
+    assert_true(roaring_bitmap_internal_validate(x1, NULL));
+    assert_true(roaring_bitmap_equals(x1, y1));
+    assert_true(roaring_bitmap_equals(y1, x1));
+
+    roaring_statistics_t stats_x, stats_y;
+    roaring_bitmap_statistics(x1, &stats_x);
+    roaring_bitmap_statistics(y1, &stats_y);
+    assert_true(stats_x.n_array_containers == stats_y.n_array_containers);
+    assert_true(stats_x.cardinality == stats_y.cardinality);
+
+    // queries
+    uint64_t card = roaring_bitmap_get_cardinality(y1);
+    assert_true(roaring_bitmap_get_cardinality(x1) == card);
+    assert_true(roaring_bitmap_minimum(x1) == roaring_bitmap_minimum(y1));
+    assert_true(roaring_bitmap_maximum(x1) == roaring_bitmap_maximum(y1));
+    for (uint32_t v = 0; v < (12 << 16); v += 7) {
+        assert_true(roaring_bitmap_contains(x1, v) ==
+                    roaring_bitmap_contains(y1, v));
+        assert_true(roaring_bitmap_rank(x1, v) == roaring_bitmap_rank(y1, v));
+        assert_true(roaring_bitmap_get_index(x1, v) ==
+                    roaring_bitmap_get_index(y1, v));
+        assert_true(roaring_bitmap_contains_range(x1, v, v + 2) ==
+                    roaring_bitmap_contains_range(y1, v, v + 2));
+        assert_true(roaring_bitmap_range_cardinality(x1, v, v + 1000) ==
+                    roaring_bitmap_range_cardinality(y1, v, v + 1000));
+    }
+    uint32_t *values = (uint32_t *)malloc(card * sizeof(uint32_t));
+    uint32_t *packed_values = (uint32_t *)malloc(card * sizeof(uint32_t));
+    roaring_bitmap_to_uint32_array(y1, values);
+    roaring_bitmap_to_uint32_array(x1, packed_values);
+    assert_true(memcmp(values, packed_values, card * sizeof(uint32_t)) == 0);
+    for (size_t offset = 0; offset + 1000 <= card; offset += 995) {
+        assert_true(
+            roaring_bitmap_range_uint32_array(x1, offset, 10, packed_values));
+        assert_true(memcmp(packed_values, values + offset,
+                           10 * sizeof(uint32_t)) == 0);
+        assert_true(
+            roaring_bitmap_range_uint32_array(x1, offset, 1000, packed_values));
+        assert_true(memcmp(packed_values, values + offset,
+                           1000 * sizeof(uint32_t)) == 0);
+    }
+    for (uint32_t i = 0; i < card; i++) {
+        uint32_t element;
+        assert_true(roaring_bitmap_select(x1, i, &element));
+        assert_int_equal(element, values[i]);
+        assert_true(roaring_bitmap_contains_range(x1, values[i],
+                                                  values[i] + 1));
+    }
+    check_contains_many(x1, values, card);
+    uint64_t *ranks = (uint64_t *)malloc(card * sizeof(uint64_t));
+    roaring_bitmap_rank_many(x1, values, values + card, ranks);
+    for (uint32_t i = 0; i < card; i++) assert_true(ranks[i] == i + 1);
+    free(ranks);
+
+    // iterators
+    roaring_uint32_iterator_t *it = roaring_iterator_create(x1);
+    for (uint32_t i = 0; i < card; i++) {
+        assert_true(it->has_value);
+        assert_int_equal(it->current_value, values[i]);
+        roaring_uint32_iterator_advance(it);
+    }
+    assert_false(it->has_value);
+    roaring_iterator_init_last(x1, it);
+    for (uint32_t i = (uint32_t)card; i-- > 0;) {
+        assert_true(it->has_value);
+        assert_int_equal(it->current_value, values[i]);
+        roaring_uint32_iterator_previous(it);
+    }
+    assert_false(it->has_value);
+    roaring_uint32_iterator_free(it);
+    it = roaring_iterator_create(x1);
+    roaring_uint32_iterator_t *ref = roaring_iterator_create(y1);
+    for (uint32_t v = 0; v < (12 << 16); v += 97) {
+        assert_true(roaring_uint32_iterator_move_equalorlarger(it, v) ==
+                    roaring_uint32_iterator_move_equalorlarger(ref, v));
+        assert_int_equal(it->current_value, ref->current_value);
+    }
+    roaring_uint32_iterator_free(ref);
+    roaring_uint32_iterator_free(it);
+    uint32_t iterated = 0;
+    assert_true(roaring_iterate(x1, roaring_iterator_sumall, &iterated));
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < card; i++) sum += values[i];
+    assert_int_equal(iterated, sum);
+    check_ranges(x1);
+    check_container_views(x1);
+    check_to_dense(x1, 0, 12 << 16);
+    check_to_dense(x1, 3 * 65536 + 17, 4 * 65536 + 1000);
+    bitset_t *bitset = bitset_create();
+    assert_true(roaring_bitmap_to_bitset(x1, bitset));
+    assert_true(bitset_count(bitset) == card);
+    for (uint32_t i = 0; i < card; i++) {
+        assert_true(bitset_get(bitset, values[i]));
+    }
+    bitset_free(bitset);
+
+    const roaring_bitmap_t *inputs[2] = {x1, x2};
+    roaring_bitmap_t *expected = roaring_bitmap_or(y1, y2);
+    roaring_many_iterator_t *many = roaring_or_many_iterator_create(2, inputs);
+    check_many_iterator(many, expected);
+    roaring_many_iterator_free(many);
+    roaring_bitmap_free(expected);
+    expected = roaring_bitmap_and(y1, y2);
+    many = roaring_and_many_iterator_create(2, inputs);
+    check_many_iterator(many, expected);
+    roaring_many_iterator_free(many);
+    roaring_bitmap_free(expected);
+
+    // binary operations, with packed containers on either side or both
+    check_packed_ops(x1, x2, y1, y2);
+    check_packed_ops(x1, y2, y1, y2);
+    check_packed_ops(y1, x2, y1, y2);
+    check_packed_ops(x1, x1, y1, y1);
+
+    // updates go through array containers
+    roaring_bitmap_t *x = roaring_bitmap_copy(x1);
+    roaring_bitmap_t *y = roaring_bitmap_copy(y1);
+    for (uint32_t v = 1; v < (12 << 16); v += 4099) {
+        roaring_bitmap_add(x, v);
+        roaring_bitmap_add(y, v);
+        roaring_bitmap_remove(x, v + 3);
+        roaring_bitmap_remove(y, v + 3);
+    }
+    assert_true(roaring_bitmap_equals(x, y));
+    roaring_bitmap_free(x);
+    roaring_bitmap_free(y);
+    x = roaring_bitmap_copy(x1);
+    y = roaring_bitmap_copy(y1);
+    roaring_bitmap_add_range(x, 2 * 65536 + 100, 2 * 65536 + 200);
+    roaring_bitmap_add_range(y, 2 * 65536 + 100, 2 * 65536 + 200);
+    roaring_bitmap_remove_range(x, 3 * 65536 + 10, 5 * 65536 + 20);
+    roaring_bitmap_remove_range(y, 3 * 65536 + 10, 5 * 65536 + 20);
+    roaring_bitmap_flip_inplace(x, 6 * 65536 + 5, 7 * 65536 + 5);
+    roaring_bitmap_flip_inplace(y, 6 * 65536 + 5, 7 * 65536 + 5);
+    assert_true(roaring_bitmap_internal_validate(x, NULL));
+    assert_true(roaring_bitmap_equals(x, y));
+    roaring_bitmap_free(x);
+    roaring_bitmap_free(y);
+    x = roaring_bitmap_flip(x1, 65536 + 3, 2 * 65536 + 3);
+    y = roaring_bitmap_flip(y1, 65536 + 3, 2 * 65536 + 3);
+    assert_true(roaring_bitmap_equals(x, y));
+    roaring_bitmap_free(x);
+    roaring_bitmap_free(y);
+    x = roaring_bitmap_add_offset(x1, 1000);
+    y = roaring_bitmap_add_offset(y1, 1000);
+    assert_true(roaring_bitmap_equals(x, y));
+    roaring_bitmap_free(x);
+    roaring_bitmap_free(y);
+    x = roaring_bitmap_copy(x1);
+    roaring_bitmap_run_optimize(x);
+    assert_true(roaring_bitmap_equals(x, y1));
+    roaring_bitmap_free(x);
+
+    // packed containers are serialized as arrays
+    size_t size = roaring_bitmap_portable_size_in_bytes(x1);
+    assert_true(size == roaring_bitmap_portable_size_in_bytes(y1));
+    char *buf_x = (char *)malloc(size);
+    char *buf_y = (char *)malloc(size);
+    assert_true(roaring_bitmap_portable_serialize(x1, buf_x) == size);
+    roaring_bitmap_portable_serialize(y1, buf_y);
+    assert_true(memcmp(buf_x, buf_y, size) == 0);
+    free(buf_x);
+    free(buf_y);
+    size = roaring_bitmap_size_in_bytes(x1);
+    assert_true(size == roaring_bitmap_size_in_bytes(y1));
+    buf_x = (char *)malloc(size);
+    buf_y = (char *)malloc(size);
+    assert_true(roaring_bitmap_serialize(x1, buf_x) == size);
+    roaring_bitmap_serialize(y1, buf_y);
+    assert_true(memcmp(buf_x, buf_y, size) == 0);
+    free(buf_x);
+    free(buf_y);
+#if !CROARING_IS_BIG_ENDIAN
+    size = roaring_bitmap_frozen_size_in_bytes(x1);
+    assert_true(size == roaring_bitmap_frozen_size_in_bytes(y1));
+    buf_x = (char *)roaring_aligned_malloc(32, size);
+    buf_y = (char *)roaring_aligned_malloc(32, size);
+    roaring_bitmap_frozen_serialize(x1, buf_x);
+    roaring_bitmap_frozen_serialize(y1, buf_y);
+    assert_true(memcmp(buf_x, buf_y, size) == 0);
+    const roaring_bitmap_t *frozen = roaring_bitmap_frozen_view(buf_x, size);
+    assert_true(roaring_bitmap_equals(frozen, y1));
+    roaring_bitmap_free(frozen);
+    roaring_aligned_free(buf_x);
+    roaring_aligned_free(buf_y);
+#endif
+
+    // copy-on-write copies share the packed containers
+    roaring_bitmap_set_copy_on_write(x1, true);
+    x = roaring_bitmap_copy(x1);
+    check_container_views(x);
+    roaring_bitmap_add(x, 4 * 65536 + 1);
+    assert_true(roaring_bitmap_equals(x1, y1));
+    check_packed_ops(x, x1, x, y1);
+    roaring_bitmap_free(x);
+    roaring_bitmap_set_copy_on_write(x1, false);
+
+    // nothing to pack
+    x = roaring_bitmap_from_range(0, 200000, 1);
+    assert_false(roaring_bitmap_pack_optimize(x));
+    roaring_bitmap_free(x);
+
+    free(values);
+    free(packed_values);
+    roaring_bitmap_free(x1);
+    roaring_bitmap_free(x2);
+    roaring_bitmap_free(y1);
+    roaring_bitmap_free(y2);
+}
+
 DEFINE_TEST(convert_to_bitset) {
     roaring_bitmap_t *r1 = roaring_bitmap_create();
     for (uint32_t i = 100; i < 100000; i += 1 + (i % 5)) {
@@ -4791,6 +5937,9 @@ int main() {
         cmocka_unit_test(robust_deserialization),
         cmocka_unit_test(issue457),
         cmocka_unit_test(convert_to_bitset),
+        cmocka_unit_test(convert_from_bitset),
+        cmocka_unit_test(convert_to_dense),
+        cmocka_unit_test(test_pack_optimize),
         cmocka_unit_test(issue440),
         cmocka_unit_test(issue436),
         cmocka_unit_test(issue433),
@@ -4806,6 +5955,7 @@ int main() {
         cmocka_unit_test(issue208b),
         cmocka_unit_test(range_contains),
         cmocka_unit_test(contains_bulk),
+        cmocka_unit_test(contains_many),
         cmocka_unit_test(inplaceorwide),
         cmocka_unit_test(test_contains_range),
         cmocka_unit_test(check_range_contains_from_end),
@@ -4880,6 +6030,8 @@ int main() {
         cmocka_unit_test(test_andnot_inplace_false),
         cmocka_unit_test(test_andnot_true),
         cmocka_unit_test(test_andnot_inplace_true),
+        cmocka_unit_test(test_key_matching_ops),
+        cmocka_unit_test(test_key_summary),
         cmocka_unit_test(test_conversion_to_int_array),
         cmocka_unit_test(test_array_to_run),
         cmocka_unit_test(test_array_to_self),
@@ -4927,7 +6079,11 @@ int main() {
         cmocka_unit_test(test_iterator_reuse),
         cmocka_unit_test(test_iterator_reuse_many),
         cmocka_unit_test(read_uint32_iterator_zero_count),
+        cmocka_unit_test(test_many_iterators),
+        cmocka_unit_test(test_range_iterator),
+        cmocka_unit_test(test_container_views),
         cmocka_unit_test(test_add_range),
+        cmocka_unit_test(test_full_container_singleton),
         cmocka_unit_test(test_remove_range),
         cmocka_unit_test(test_remove_many),
         cmocka_unit_test(test_range_cardinality),
@@ -7,7 +7,9 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include <roaring/array_util.h>
 #include <roaring/bitset_util.h>
 #include <roaring/misc/configreport.h>
 
@@ -74,12 +76,149 @@ DEFINE_TEST(setandextract_uint32) {
     }
 }
 
+static void check_match(const uint16_t* A, size_t s_a, const uint16_t* B,
+                        size_t s_b, bool vector) {
+    uint16_t* expected = (uint16_t*)malloc((s_a + 1) * sizeof(uint16_t));
+    size_t expected_count = 0;
+    for (size_t i = 0, j = 0; i < s_a && j < s_b;) {
+        if (A[i] < B[j]) {
+            i++;
+        } else if (B[j] < A[i]) {
+            j++;
+        } else {
+            expected[expected_count++] = A[i];
+            i++;
+            j++;
+        }
+    }
+    uint16_t pos_a[16], pos_b[16];
+    size_t i_a = 0, i_b = 0, count = 0;
+    int32_t n;
+    do {
+#if CROARING_IS_X64
+        if (vector) {
+            n = match_vector16(A, s_a, &i_a, B, s_b, &i_b, pos_a, pos_b, 16);
+        } else {
+            n = match_uint16(A, s_a, &i_a, B, s_b, &i_b, pos_a, pos_b, 16);
+        }
+#else
+        (void)vector;
+        n = match_uint16(A, s_a, &i_a, B, s_b, &i_b, pos_a, pos_b, 16);
+#endif
+        for (int32_t k = 0; k < n; k++) {
+            assert_int_equal(A[pos_a[k]], B[pos_b[k]]);
+            assert_true(count < expected_count);
+            assert_int_equal(A[pos_a[k]], expected[count]);
+            count++;
+        }
+    } while (n > 0);
+    assert_int_equal(count, expected_count);
+    free(expected);
+}
+
+DEFINE_TEST(match_positions) {
+    const size_t size = 1000;
+    uint16_t* A = (uint16_t*)malloc(size * sizeof(uint16_t));
+    uint16_t* B = (uint16_t*)malloc(size * sizeof(uint16_t));
+    for (unsigned int stride_a = 1; stride_a < 8; stride_a++) {
+        for (unsigned int stride_b = 1; stride_b < 8; stride_b++) {
+            for (size_t k = 0; k < size; k++) {
+                A[k] = (uint16_t)(k * stride_a);
+                B[k] = (uint16_t)(k * stride_b + stride_a / 2);
+            }
+            for (size_t s_a = 0; s_a < size; s_a += 61) {
+                check_match(A, s_a, B, size, false);
+                check_match(B, size, A, s_a, false);
+#if CROARING_IS_X64
+                if (croaring_hardware_support() & ROARING_SUPPORTS_AVX2) {
+                    check_match(A, s_a, B, size, true);
+                    check_match(B, size, A, s_a, true);
+                }
+#endif
+            }
+        }
+    }
+    free(A);
+    free(B);
+}
+
+#if CROARING_IS_X64 && CROARING_COMPILER_SUPPORTS_AVX512
+// fills out with the values of [start, 65536) kept with probability
+// 1/one_in, stopping after max values
+static size_t random_sorted_uint16(uint16_t* out, size_t max, uint32_t start,
+                                   int one_in) {
+    size_t n = 0;
+    for (uint32_t v = start; v < (1 << 16) && n < max; v++) {
+        if (rand() % one_in == 0) out[n++] = (uint16_t)v;
+    }
+    return n;
+}
+
+static void check_merge_avx512(const uint16_t* A, size_t s_a,
+                               const uint16_t* B, size_t s_b) {
+    // the SSE functions, used for small inputs, may write a vector past the
+    // result; otherwise the sizes are exact so that sanitizers catch any
+    // write past the result
+    const size_t slack = (s_a < 32 || s_b < 32) ? 16 : 1;
+    uint16_t* expected = (uint16_t*)malloc((s_a + s_b + 1) * sizeof(uint16_t));
+    size_t expected_count = union_uint16(A, s_a, B, s_b, expected);
+    uint16_t* result =
+        (uint16_t*)malloc((expected_count + slack) * sizeof(uint16_t));
+    uint32_t count = avx512_union_vector16(A, (uint32_t)s_a, B, (uint32_t)s_b,
+                                           result);
+    assert_int_equal(count, expected_count);
+    assert_true(memcmp(result, expected, count * sizeof(uint16_t)) == 0);
+    free(result);
+
+    expected_count = (size_t)xor_uint16(A, (int32_t)s_a, B, (int32_t)s_b,
+                                        expected);
+    result = (uint16_t*)malloc((expected_count + slack) * sizeof(uint16_t));
+    count = avx512_xor_vector16(A, (uint32_t)s_a, B, (uint32_t)s_b, result);
+    assert_int_equal(count, expected_count);
+    assert_true(memcmp(result, expected, count * sizeof(uint16_t)) == 0);
+    free(result);
+    free(expected);
+}
+#endif
+
+DEFINE_TEST(merge_avx512) {
+#if CROARING_IS_X64 && CROARING_COMPILER_SUPPORTS_AVX512
+    if (!(croaring_hardware_support() & ROARING_SUPPORTS_AVX512)) return;
+    const size_t size = 4096;
+    uint16_t* A = (uint16_t*)malloc(size * sizeof(uint16_t));
+    uint16_t* B = (uint16_t*)malloc(size * sizeof(uint16_t));
+    const int one_in[] = {1, 2, 3, 16, 500};
+    const uint32_t starts[] = {0, 1, 30000, 65000, 65500};
+    srand(1234);
+    for (size_t i = 0; i < sizeof(one_in) / sizeof(one_in[0]); i++) {
+        for (size_t j = 0; j < sizeof(one_in) / sizeof(one_in[0]); j++) {
+            for (size_t k = 0; k < sizeof(starts) / sizeof(starts[0]); k++) {
+                for (size_t max = 1; max <= size; max = max * 3 + 7) {
+                    size_t s_a = random_sorted_uint16(A, max, 0, one_in[i]);
+                    size_t s_b =
+                        random_sorted_uint16(B, size, starts[k], one_in[j]);
+                    check_merge_avx512(A, s_a, B, s_b);
+                    check_merge_avx512(B, s_b, A, s_a);
+                    // B contains A
+                    check_merge_avx512(B, s_b, B, max < s_b ? max : s_b);
+                    check_merge_avx512(B, s_b, B + s_b / 2, s_b - s_b / 2);
+                }
+            }
+        }
+    }
+    free(A);
+    free(B);
+#endif
+}
+
 int main() {
     tellmeall();
 
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(setandextract_uint16),
         cmocka_unit_test(setandextract_uint32),
+        cmocka_unit_test(match_positions),
+        cmocka_unit_test(merge_avx512),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);